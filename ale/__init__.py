@@ -24,4 +24,4 @@ except:
 # bring ale stuff into main ale module
 from . import drivers
 from . import formatters
-from . drivers import load, loads
+from . drivers import load, loads, load_many
@@ -1,3 +1,8 @@
+from contextlib import contextmanager
+import logging
+import threading
+import time as time_module
+
 import spiceypy as spice
 import numpy as np
 import scipy.constants
@@ -8,6 +13,145 @@ from ale.transformation import FrameChain
 from ale.rotation import TimeDependentRotation
 from ale import util
 
+logger = logging.getLogger(__name__)
+
+
+class KernelPool():
+    """
+    The NAIF SPICE kernels furnished by the drivers in this process.
+
+    By default, drivers furnish their kernels when they are entered and
+    unload them when they exit. In warm mode, kernels stay furnished after
+    the drivers using them exit, so that the next driver only unloads and
+    furnishes the difference between its kernels and the loaded ones. Only
+    the kernels at the start of both lists are kept, so the furnish order,
+    and with it the kernel priority, matches a fresh load. Metakernel
+    searches are also cached in warm mode.
+
+    Warm mode is meant for worker processes that generate many ISDs from the
+    same kernels, such as isd_generate with --warm_kernels.
+    """
+
+    def __init__(self):
+        self.warm = False
+        self._loaded = []
+        self._counts = {}
+        self._metakernel_searches = {}
+
+    @property
+    def loaded(self):
+        """
+        Returns the kernels furnished in warm mode, in the order they were furnished.
+        """
+        return list(self._loaded)
+
+    def furnish(self, kernels):
+        """
+        Furnish the kernels for a driver that is entered.
+
+        Parameters
+        ----------
+        kernels : list
+                  The kernels to furnish, in order
+        """
+        kernels = [str(k) for k in kernels]
+        if not self.warm:
+            [spice.furnsh(k) for k in kernels]
+            return
+
+        if not any(self._counts.values()):
+            # Nothing is in use, so swap everything after the common start
+            common = 0
+            while common < min(len(self._loaded), len(kernels)) and self._loaded[common] == kernels[common]:
+                common += 1
+            [spice.unload(k) for k in reversed(self._loaded[common:])]
+            [spice.furnsh(k) for k in kernels[common:]]
+            self._loaded = self._loaded[:common] + kernels[common:]
+        else:
+            # Another driver is using the loaded kernels, so only add to them
+            for k in kernels:
+                if k not in self._loaded:
+                    spice.furnsh(k)
+                    self._loaded.append(k)
+
+        for k in kernels:
+            self._counts[k] = self._counts.get(k, 0) + 1
+
+    def release(self, kernels):
+        """
+        Release the kernels of a driver that exits. Outside of warm mode,
+        the kernels are unloaded.
+
+        Parameters
+        ----------
+        kernels : list
+                  The kernels the driver furnished
+        """
+        kernels = [str(k) for k in kernels]
+        if not self.warm:
+            [spice.unload(k) for k in kernels]
+            return
+
+        for k in kernels:
+            if self._counts.get(k, 0) > 0:
+                self._counts[k] -= 1
+
+    def clear(self):
+        """
+        Unload every kernel furnished in warm mode and forget the cached
+        metakernel searches.
+        """
+        [spice.unload(k) for k in reversed(self._loaded)]
+        self._loaded = []
+        self._counts = {}
+        self._metakernel_searches = {}
+
+    def get_metakernels(self, spice_dir, missions, years, versions):
+        """
+        Search for metakernels with ale.util.get_metakernels. In warm mode,
+        the results are cached.
+        """
+        if not self.warm:
+            return util.get_metakernels(spice_dir, missions=missions, years=years, versions=versions)
+        key = (spice_dir, str(missions), str(years), str(versions))
+        if key not in self._metakernel_searches:
+            self._metakernel_searches[key] = util.get_metakernels(spice_dir, missions=missions,
+                                                                  years=years, versions=versions)
+        return self._metakernel_searches[key]
+
+
+kernel_pool = KernelPool()
+
+_active_pool = threading.local()
+
+
+def active_kernel_pool():
+    """
+    Returns the kernel pool that drivers entered on this thread use. This is
+    kernel_pool unless use_kernel_pool set another one for the thread.
+    """
+    return getattr(_active_pool, 'pool', kernel_pool)
+
+
+@contextmanager
+def use_kernel_pool(pool):
+    """
+    Makes drivers entered on this thread use *pool* instead of kernel_pool
+    for the duration of the context. Other threads are not affected.
+
+    Parameters
+    ----------
+    pool : KernelPool
+           The kernel pool to use
+    """
+    previous = active_kernel_pool()
+    _active_pool.pool = pool
+    try:
+        yield pool
+    finally:
+        _active_pool.pool = previous
+
+
 class NaifSpice():
     """
     Mix-in for reading data from NAIF SPICE Kernels.
@@ -19,7 +163,9 @@ class NaifSpice():
         to get the kernels furnished.
         """
         if self.kernels:
-            [spice.furnsh(k) for k in self.kernels]
+            # Released to the same pool even if the active one changes
+            self._kernel_pool = active_kernel_pool()
+            self._kernel_pool.furnish(self.kernels)
         return self
 
     def __exit__(self, exc_type, exc_val, exc_tb):
@@ -29,7 +175,7 @@ class NaifSpice():
         kernels can be unloaded.
         """
         if self.kernels:
-            [spice.unload(k) for k in self.kernels]
+            getattr(self, '_kernel_pool', kernel_pool).release(self.kernels)
 
     @property
     def kernels(self):
@@ -67,7 +213,7 @@ class NaifSpice():
                 if not ale.spice_root:
                     raise EnvironmentError(f'ale.spice_root is not set, cannot search for metakernels. ale.spice_root = "{ale.spice_root}"')
 
-                search_results = util.get_metakernels(ale.spice_root, missions=self.short_mission_name, years=self.utc_start_time.year, versions='latest')
+                search_results = active_kernel_pool().get_metakernels(ale.spice_root, missions=self.short_mission_name, years=self.utc_start_time.year, versions='latest')
 
                 if search_results['count'] == 0:
                     raise ValueError(f'Failed to find metakernels. mission: {self.short_mission_name}, year:{self.utc_start_time.year}, versions="latest" spice root = "{ale.spice_root}"')
@@ -331,19 +477,18 @@ class NaifSpice():
         times = self.ephemeris_time
         if len(times) > 1:
             times = [times[0], times[-1]]
-        positions = []
-        velocities = []
 
-        for time in times:
-            sun_state, _ = spice.spkezr("SUN",
-                                         time,
-                                         self.reference_frame,
-                                         'LT+S',
-                                         self.target_name)
-            positions.append(sun_state[:3])
-            velocities.append(sun_state[3:6])
-        positions = 1000 * np.asarray(positions)
-        velocities = 1000 * np.asarray(velocities)
+        start = time_module.perf_counter()
+        sun_states, _ = spice.spkezr("SUN",
+                                     np.asarray(times, dtype=float),
+                                     self.reference_frame,
+                                     'LT+S',
+                                     self.target_name)
+        sun_states = np.asarray(sun_states).reshape(-1, 6)
+        positions = 1000 * sun_states[:, :3]
+        velocities = 1000 * sun_states[:, 3:6]
+        logger.debug('sun_position: spkezr %.6fs for %d times',
+                     time_module.perf_counter() - start, len(times))
 
         return positions, velocities, times
 
@@ -364,9 +509,8 @@ class NaifSpice():
           a tuple containing a list of positions, a list of velocities, and a list of times
         """
         if not hasattr(self, '_position'):
-            ephem = self.ephemeris_time
-            pos = []
-            vel = []
+            ephem = np.asarray(self.ephemeris_time, dtype=float)
+            timings = {}
 
             target = self.spacecraft_name
             observer = self.target_name
@@ -375,50 +519,63 @@ class NaifSpice():
                 target = self.target_name
                 observer = self.spacecraft_name
 
-            for time in ephem:
-                # spkezr returns a vector from the observer's location to the aberration-corrected
-                # location of the target. For more information, see:
-                # https://naif.jpl.nasa.gov/pub/naif/toolkit_docs/FORTRAN/spicelib/spkezr.html
-                if self.correct_lt_to_surface and self.light_time_correction.upper() == 'LT+S':
-                    obs_tar_state, obs_tar_lt = spice.spkezr(target,
-                                                             time,
-                                                             'J2000',
-                                                             self.light_time_correction,
-                                                             observer)
-                    # ssb to spacecraft
-                    ssb_obs_state, ssb_obs_lt = spice.spkezr(observer,
-                                                             time,
-                                                             'J2000',
-                                                             'NONE',
-                                                             'SSB')
-
-                    radius_lt = (self.target_body_radii[2] + self.target_body_radii[0]) / 2 / (scipy.constants.c/1000.0)
-                    adjusted_time = time - obs_tar_lt + radius_lt
-                    ssb_tar_state, ssb_tar_lt = spice.spkezr(target,
-                                                             adjusted_time,
-                                                             'J2000',
-                                                             'NONE',
-                                                             'SSB')
-                    state = ssb_tar_state - ssb_obs_state
-                    matrix = spice.sxform("J2000", self.reference_frame, time)
-                    state = spice.mxvg(matrix, state)
-                else:
-                    state, _ = spice.spkezr(target,
-                                            time,
-                                            self.reference_frame,
-                                            self.light_time_correction,
-                                            observer)
-
-                if self.swap_observer_target:
-                    pos.append(-state[:3])
-                    vel.append(-state[3:])
-                else:
-                    pos.append(state[:3])
-                    vel.append(state[3:])
+            # spkezr and sxform are passed the whole array of times. spiceypy
+            # still calls CSPICE once per time inside of them, so this only
+            # saves the driver side loop. The light time arithmetic and the
+            # rotation of the states run in numpy over every time at once.
+            # spkezr returns a vector from the observer's location to the aberration-corrected
+            # location of the target. For more information, see:
+            # https://naif.jpl.nasa.gov/pub/naif/toolkit_docs/FORTRAN/spicelib/spkezr.html
+            if self.correct_lt_to_surface and self.light_time_correction.upper() == 'LT+S':
+                start = time_module.perf_counter()
+                _, obs_tar_lts = spice.spkezr(target,
+                                              ephem,
+                                              'J2000',
+                                              self.light_time_correction,
+                                              observer)
+                # ssb to spacecraft
+                ssb_obs_states, _ = spice.spkezr(observer,
+                                                 ephem,
+                                                 'J2000',
+                                                 'NONE',
+                                                 'SSB')
+
+                radius_lt = (self.target_body_radii[2] + self.target_body_radii[0]) / 2 / (scipy.constants.c/1000.0)
+                adjusted_times = ephem - np.asarray(obs_tar_lts, dtype=float).reshape(-1) + radius_lt
+                ssb_tar_states, _ = spice.spkezr(target,
+                                                 adjusted_times,
+                                                 'J2000',
+                                                 'NONE',
+                                                 'SSB')
+                timings['spkezr'] = time_module.perf_counter() - start
+
+                start = time_module.perf_counter()
+                states = np.asarray(ssb_tar_states).reshape(-1, 6) - np.asarray(ssb_obs_states).reshape(-1, 6)
+                matrices = np.asarray(spice.sxform("J2000", self.reference_frame, ephem)).reshape(-1, 6, 6)
+                timings['sxform'] = time_module.perf_counter() - start
+
+                start = time_module.perf_counter()
+                states = np.einsum('nij,nj->ni', matrices, states)
+                timings['rotate'] = time_module.perf_counter() - start
+            else:
+                start = time_module.perf_counter()
+                states, _ = spice.spkezr(target,
+                                         ephem,
+                                         self.reference_frame,
+                                         self.light_time_correction,
+                                         observer)
+                states = np.asarray(states).reshape(-1, 6)
+                timings['spkezr'] = time_module.perf_counter() - start
+
+            if self.swap_observer_target:
+                states = -states
 
             # By default, SPICE works in km, so convert to m
-            self._position = [p * 1000 for p in pos]
-            self._velocity = [v * 1000 for v in vel]
+            self._position = list(states[:, :3] * 1000)
+            self._velocity = list(states[:, 3:] * 1000)
+            logger.debug('sensor_position: %s for %d times',
+                         ', '.join('{} {:.6f}s'.format(stage, seconds) for stage, seconds in timings.items()),
+                         len(ephem))
         return self._position, self._velocity, self.ephemeris_time
 
     @property
@@ -10,14 +10,15 @@ import numpy as np
 import datetime
 from datetime import datetime
 import traceback
+import time
 
 from ale.formatters.usgscsm_formatter import to_usgscsm
 from ale.formatters.isis_formatter import to_isis
-from ale.formatters.formatter import to_isd
+from ale.formatters.formatter import to_isd, furnished_kernels
 from ale.base.data_isis import IsisSpice
 from ale.base.label_isis import IsisLabel
 from ale.base.label_pds3 import Pds3Label
-from ale.base.data_naif import NaifSpice
+from ale.base.data_naif import NaifSpice, KernelPool, kernel_pool, use_kernel_pool
 
 
 from abc import ABC
@@ -52,7 +53,27 @@ class AleJsonEncoder(json.JSONEncoder):
             return obj.isoformat()
         return json.JSONEncoder.default(self, obj)
 
-def load(label, props={}, formatter='ale', verbose=False, only_isis_spice=False, only_naif_spice=False):
+def _record_stage(stats, name, start, size=0):
+    """
+    Record a finished stage of a load in a stats dictionary, if there is one.
+    See load for the layout.
+    """
+    if stats is not None:
+        stats.setdefault('stages', []).append({'name': name,
+                                               'seconds': time.perf_counter() - start,
+                                               'size': size})
+
+def _record_driver(stats, driver_name, start, error=None):
+    """
+    Record a driver attempt in a stats dictionary, if there is one.
+    See load for the layout.
+    """
+    if stats is not None:
+        stats.setdefault('drivers', []).append({'driver': driver_name,
+                                                'seconds': time.perf_counter() - start,
+                                                'error': None if error is None else str(error)})
+
+def load(label, props={}, formatter='ale', verbose=False, only_isis_spice=False, only_naif_spice=False, stats=None):
     """
     Attempt to load a given label from possible drivers.
 
@@ -81,6 +102,11 @@ def load(label, props={}, formatter='ale', verbose=False, only_isis_spice=False,
             loading. Each driver specifies its own set of properties to use.
             For example, Drivers that use the NaifSpice mix-in use the 'kernels'
             property to specify an explicit set of kernels and load order.
+            If 'record_kernels' is True, the absolute paths of every kernel
+            that was furnished when the ISD was formatted, including
+            metakernels and the kernels they furnish, are added to the ISD as
+            furnished_kernels. ale::IsdCache uses this to check that a cached
+            ISD is still current.
 
     formatter : {'ale', 'isis', 'usgscsm'}
                 Output format for the ISD. As of 0.8.0, it is recommended that
@@ -99,14 +125,33 @@ def load(label, props={}, formatter='ale', verbose=False, only_isis_spice=False,
                       Explicitly searches for drivers constructed from the NaifSpice
                       component class
 
+    stats : dict
+            If given, the timings of the load are recorded in it, even if no
+            driver succeeds. ``stats['stages']`` is a list of
+            ``{'name', 'seconds', 'size'}`` dictionaries for find_drivers,
+            parse_label, and, for each driver that gets that far,
+            driver_enter, which furnishes its kernels, and format. ``stats['drivers']`` is
+            a list of ``{'driver', 'seconds', 'error'}`` dictionaries, one for
+            each driver attempted, where error is None for the driver that
+            succeeds.
+
     Returns
     -------
     dict
          The ISD as a dictionary
     """
+    start = time.perf_counter()
     if isinstance(formatter, str):
         formatter = __formatters__[formatter]
-    
+    drivers = _find_drivers(only_isis_spice, only_naif_spice)
+    _record_stage(stats, 'find_drivers', start, len(drivers))
+    return _load_with_drivers(label, drivers, props, formatter, verbose, stats)
+
+def _find_drivers(only_isis_spice=False, only_naif_spice=False):
+    """
+    Returns the drivers to try for a load, in the order to try them.
+    See load for the only_* parameters.
+    """
     driver_mask = [only_isis_spice, only_naif_spice]
     class_list = [IsisSpice, NaifSpice]
     class_list = list(compress(class_list, driver_mask))
@@ -115,8 +160,14 @@ def load(label, props={}, formatter='ale', verbose=False, only_isis_spice=False,
     predicat = lambda x: inspect.isclass(x) and "_driver" in x.__module__ and [i for i in class_list if i in inspect.getmro(x)] == class_list
     driver_list = [inspect.getmembers(dmod, predicat) for dmod in __driver_modules__]
     drivers = chain.from_iterable(driver_list)
-    drivers = sort_drivers([d[1] for d in drivers])
+    return sort_drivers([d[1] for d in drivers])
 
+def _load_with_drivers(label, drivers, props, formatter, verbose, stats):
+    """
+    Try a list of drivers on a label until one of them produces an ISD.
+    See load for the parameters.
+    """
+    start = time.perf_counter()
     if verbose:
         print("Attempting to pre-parse label file")
     try:
@@ -135,6 +186,7 @@ def load(label, props={}, formatter='ale', verbose=False, only_isis_spice=False,
                 print(e)
             # If both fail, then don't parse the label, and just pass the driver a file.
             parsed_label = None
+    _record_stage(stats, 'parse_label', start)
 
     if verbose:
         if parsed_label:
@@ -145,23 +197,116 @@ def load(label, props={}, formatter='ale', verbose=False, only_isis_spice=False,
     for driver in drivers:
         if verbose:
             print(f'Trying {driver}')
+        driver_name = driver.__name__
+        driver_start = time.perf_counter()
         try:
             res = driver(label, props=props, parsed_label=parsed_label)
             # get instrument_id to force early failure
             res.instrument_id
+            start = time.perf_counter()
             with res as driver:
+                _record_stage(stats, 'driver_enter', start)
+                start = time.perf_counter()
                 isd = formatter(driver)
+                _record_stage(stats, 'format', start)
+                if driver._props.get('record_kernels') and isinstance(isd, dict):
+                    isd['furnished_kernels'] = [os.path.abspath(kernel) for kernel in furnished_kernels(metakernels=True)]
                 if verbose:
                     print("Success with: ", driver)
                     print("ISD:\n", json.dumps(isd, indent=2, cls=AleJsonEncoder))
-                return isd
+            _record_driver(stats, driver_name, driver_start)
+            return isd
         except Exception as e:
+            _record_driver(stats, driver_name, driver_start, e)
             if verbose:
                 print(f'Failed: {e}\n')
                 traceback.print_exc()
     raise Exception('No Such Driver for Label')
 
-def loads(label, props='', formatter='ale', indent = 2, verbose=False, only_isis_spice=False, only_naif_spice=False):
+def load_many(labels, props={}, formatter='ale', verbose=False, only_isis_spice=False, only_naif_spice=False, callback=None, stats=None):
+    """
+    Attempt to load a batch of labels from possible drivers.
+
+    This is the same as calling load on each label, except that the drivers
+    are only found once for the whole batch, and NAIF SPICE kernels stay
+    furnished from one label to the next, as in the warm mode of
+    ale.base.data_naif.kernel_pool, so labels that share kernels only load
+    them once.
+
+    If ale.base.data_naif.kernel_pool is already in warm mode, the batch
+    uses it. Otherwise the batch uses a warm KernelPool of its own on the
+    calling thread, and every kernel that pool furnished is unloaded once
+    the batch is done. Loads on other threads, such as ale::loads calls
+    made while the callback runs, keep using kernel_pool and are not
+    affected by the batch's pool. The SPICE kernel pool itself is still
+    shared by the process, so, as with any two concurrent loads, a
+    concurrent load that uses the same kernel files as the batch can see
+    them unloaded when the batch is done with them.
+
+    A label that cannot be loaded does not stop the batch.
+
+    See load for shared parameter documentation.
+
+    Parameters
+    ----------
+    labels : list
+             String paths to the label files
+
+    callback : callable
+               If given, called as ``callback(index, isd, error)`` as soon as
+               each label is done, in order, where index is the position of the
+               label in labels. isd is the ISD as a dictionary and error is
+               None, or isd is None and error is the string of the exception
+               if the label could not be loaded. Exceptions raised by the
+               callback stop the batch.
+
+    stats : dict
+            If given, ``stats['stages']`` records the find_drivers stage for
+            the batch and ``stats['labels']`` is a list with a dictionary for
+            each label that is done, with the same stages and driver attempts
+            as load records, other than find_drivers.
+
+    Returns
+    -------
+    list
+         If there is no callback, the ISD as a dictionary for each label, or
+         the exception for a label that could not be loaded. Otherwise None.
+    """
+    start = time.perf_counter()
+    if isinstance(formatter, str):
+        formatter = __formatters__[formatter]
+    drivers = _find_drivers(only_isis_spice, only_naif_spice)
+    _record_stage(stats, 'find_drivers', start, len(drivers))
+
+    results = None if callback else []
+    if kernel_pool.warm:
+        pool = kernel_pool
+    else:
+        pool = KernelPool()
+        pool.warm = True
+    with use_kernel_pool(pool):
+        try:
+            for index, label in enumerate(labels):
+                label_stats = None
+                if stats is not None:
+                    label_stats = {}
+                    stats.setdefault('labels', []).append(label_stats)
+                try:
+                    isd = _load_with_drivers(label, drivers, props, formatter, verbose, label_stats)
+                    error = None
+                except Exception as e:
+                    isd = None
+                    error = e
+                if callback:
+                    callback(index, isd, None if error is None else str(error))
+                else:
+                    results.append(isd if error is None else error)
+        finally:
+            if pool is not kernel_pool:
+                pool.clear()
+    return results
+
+def loads(label, props='', formatter='ale', indent = 2, verbose=False, only_isis_spice=False, only_naif_spice=False, stats=None):
     """
     Attempt to load a given label from all possible drivers.
 
@@ -175,6 +320,10 @@ def loads(label, props='', formatter='ale', indent = 2, verbose=False, only_isis
              The number of spaces to indent each nested component of the JSON string.
              See json.dumps.
 
+    stats : dict
+            If given, the same timings as load are recorded in it, followed
+            by a json_dumps stage whose size is the length of the string.
+
     Returns
     -------
     str
@@ -184,8 +333,11 @@ def loads(label, props='', formatter='ale', indent = 2, verbose=False, only_isis
     --------
     load
     """
-    res = load(label, props, formatter, verbose, only_isis_spice, only_naif_spice)
-    return json.dumps(res, indent=indent, cls=AleJsonEncoder)
+    res = load(label, props, formatter, verbose, only_isis_spice, only_naif_spice, stats)
+    start = time.perf_counter()
+    isd_str = json.dumps(res, indent=indent, cls=AleJsonEncoder)
+    _record_stage(stats, 'json_dumps', start, len(isd_str))
+    return isd_str
 
 def parse_label(label, grammar=pvl.grammar.PVLGrammar()):
     """
@@ -1,4 +1,7 @@
+import copy
 import json
+import logging
+import os
 import numpy as np
 from scipy.interpolate import interp1d, BPoly
 
@@ -10,21 +13,149 @@ from ale.transformation import FrameChain
 from ale.base.type_sensor import LineScanner, Framer, Radar, PushFrame
 from ale.rotation import ConstantRotation, TimeDependentRotation
 
-def to_isd(driver):
+logger = logging.getLogger(__name__)
+
+# The ISD sections computed from the kernels, the rest is the metadata
+ISD_KERNEL_SECTIONS = ('instrument_position', 'sun_position', 'instrument_pointing', 'body_rotation')
+
+# SPICE frame classes, see frames.req
+_PCK_FRAME = 2
+_CK_FRAME = 3
+_DYNAMIC_FRAMES = (5, 6)
+
+def to_isd(driver, base_isd=None, changed_kernels=None, record_provenance=False):
     """
     Formatter to create sensor model meta data from a driver.
 
+    When only some kernels have changed since an ISD was generated, pass it
+    as base_isd with the changed kernels to only recompute the sections
+    that depend on them, see dependent_sections. Everything else is copied
+    from base_isd.
+
     Parameters
     ----------
     driver : Driver
         Concrete driver for the image that meta data is being generated for.
 
+    base_isd : dict
+        An existing ISD for the same image. If given, only the kernel
+        sections that changed_kernels can change are recomputed. If the
+        changed kernels can change the metadata, the whole ISD is
+        recomputed.
+
+    changed_kernels : list
+        The kernels that were added, removed, or replaced since base_isd was
+        generated. If None, every kernel section of base_isd is recomputed.
+
+    record_provenance : bool
+        If True, the kernels that each section depends on are recorded in
+        the ISD as kernel_provenance, see kernel_provenance. This is always
+        done if base_isd has a kernel_provenance.
+
     Returns
     -------
     string
         The ISIS compatible meta data as a JSON encoded string.
     """
+    nadir = getattr(driver, '_props', {}).get('nadir', False)
+
+    sections = set(ISD_KERNEL_SECTIONS)
+    if base_isd is not None:
+        record_provenance = record_provenance or 'kernel_provenance' in base_isd
+        if changed_kernels is not None:
+            sections = dependent_sections(base_isd, changed_kernels, nadir)
+        if 'metadata' in sections:
+            base_isd = None
+            sections = set(ISD_KERNEL_SECTIONS)
+        else:
+            logger.info('Recomputing the ISD sections %s', sorted(sections))
+
+    if base_isd is None:
+        meta_data = _isd_metadata(driver)
+    else:
+        meta_data = copy.deepcopy(base_isd)
+
+    J2000 = 1 # J2000 frame id
+    computed = {}
+    if sections:
+        frame_chain = driver.frame_chain
+        target_frame = driver.target_frame_id
+
+    if 'body_rotation' in sections:
+        body_rotation = {}
+        source_frame, destination_frame, time_dependent_target_frame = frame_chain.last_time_dependent_frame_between(target_frame, J2000)
+
+        if source_frame != J2000:
+            # Reverse the frame order because ISIS orders frames as
+            # (destination, intermediate, ..., intermediate, source)
+            body_rotation['time_dependent_frames'] = shortest_path(frame_chain, source_frame, J2000)
+            time_dependent_rotation = frame_chain.compute_rotation(J2000, source_frame)
+            body_rotation['ck_table_start_time'] = time_dependent_rotation.times[0]
+            body_rotation['ck_table_end_time'] = time_dependent_rotation.times[-1]
+            body_rotation['ck_table_original_size'] = len(time_dependent_rotation.times)
+            body_rotation['ephemeris_times'] = time_dependent_rotation.times
+            body_rotation['quaternions'] = time_dependent_rotation.quats[:, [3, 0, 1, 2]]
+            body_rotation['angular_velocities'] = time_dependent_rotation.av
+
+        if source_frame != target_frame:
+            # Reverse the frame order because ISIS orders frames as
+            # (destination, intermediate, ..., intermediate, source)
+            body_rotation['constant_frames'] = shortest_path(frame_chain, target_frame, source_frame)
+            constant_rotation = frame_chain.compute_rotation(source_frame, target_frame)
+            body_rotation['constant_rotation'] = constant_rotation.rotation_matrix().flatten()
+
+        body_rotation["reference_frame"] = destination_frame
+        computed['body_rotation'] = body_rotation
+
+    if 'instrument_pointing' in sections:
+        # sensor orientation
+        sensor_frame = driver.sensor_frame_id
+
+        instrument_pointing = {}
+        source_frame, destination_frame, _ = frame_chain.last_time_dependent_frame_between(1, sensor_frame)
+
+        # Reverse the frame order because ISIS orders frames as
+        # (destination, intermediate, ..., intermediate, source)
+        instrument_pointing['time_dependent_frames'] = shortest_path(frame_chain, destination_frame, J2000)
+        time_dependent_rotation = frame_chain.compute_rotation(J2000, destination_frame)
+        instrument_pointing['ck_table_start_time'] = time_dependent_rotation.times[0]
+        instrument_pointing['ck_table_end_time'] = time_dependent_rotation.times[-1]
+        instrument_pointing['ck_table_original_size'] = len(time_dependent_rotation.times)
+        instrument_pointing['ephemeris_times'] = time_dependent_rotation.times
+        instrument_pointing['quaternions'] = time_dependent_rotation.quats[:, [3, 0, 1, 2]]
+        instrument_pointing['angular_velocities'] = time_dependent_rotation.av
+
+        # reference frame should be the last frame in the chain
+        instrument_pointing["reference_frame"] = instrument_pointing['time_dependent_frames'][-1]
+
+        # Reverse the frame order because ISIS orders frames as
+        # (destination, intermediate, ..., intermediate, source)
+        instrument_pointing['constant_frames'] = shortest_path(frame_chain, sensor_frame, destination_frame)
+        constant_rotation = frame_chain.compute_rotation(destination_frame, sensor_frame)
+        instrument_pointing['constant_rotation'] = constant_rotation.rotation_matrix().flatten()
+
+        computed['instrument_pointing'] = instrument_pointing
+
+    if 'instrument_position' in sections or 'sun_position' in sections:
+        j2000_rotation = frame_chain.compute_rotation(target_frame, J2000)
+
+    if 'instrument_position' in sections:
+        computed['instrument_position'] = _position_section(driver.sensor_position, j2000_rotation)
+
+    if 'sun_position' in sections:
+        computed['sun_position'] = _position_section(driver.sun_position, j2000_rotation)
+
+    meta_data = _insert_kernel_sections(meta_data, computed)
+
+    if record_provenance:
+        meta_data['kernel_provenance'] = kernel_provenance(meta_data, nadir)
 
+    return meta_data
+
+def _isd_metadata(driver):
+    """
+    Returns everything in the ISD other than the kernel sections, see to_isd.
+    """
     meta_data = {}
 
     meta_data['isis_camera_version'] = driver.sensor_model_version
@@ -88,63 +219,6 @@ def to_isd(driver):
         'unit' : 'km'
     }
 
-    frame_chain = driver.frame_chain
-    target_frame = driver.target_frame_id
-
-    J2000 = 1 # J2000 frame id
-    body_rotation = {}
-    source_frame, destination_frame, time_dependent_target_frame = frame_chain.last_time_dependent_frame_between(target_frame, J2000)
-    
-    if source_frame != J2000:
-        # Reverse the frame order because ISIS orders frames as
-        # (destination, intermediate, ..., intermediate, source)
-        body_rotation['time_dependent_frames'] = shortest_path(frame_chain, source_frame, J2000)
-        time_dependent_rotation = frame_chain.compute_rotation(J2000, source_frame)
-        body_rotation['ck_table_start_time'] = time_dependent_rotation.times[0]
-        body_rotation['ck_table_end_time'] = time_dependent_rotation.times[-1]
-        body_rotation['ck_table_original_size'] = len(time_dependent_rotation.times)
-        body_rotation['ephemeris_times'] = time_dependent_rotation.times
-        body_rotation['quaternions'] = time_dependent_rotation.quats[:, [3, 0, 1, 2]]
-        body_rotation['angular_velocities'] = time_dependent_rotation.av
-
-    if source_frame != target_frame:
-        # Reverse the frame order because ISIS orders frames as
-        # (destination, intermediate, ..., intermediate, source)
-        body_rotation['constant_frames'] = shortest_path(frame_chain, target_frame, source_frame)
-        constant_rotation = frame_chain.compute_rotation(source_frame, target_frame)
-        body_rotation['constant_rotation'] = constant_rotation.rotation_matrix().flatten()
-
-    body_rotation["reference_frame"] = destination_frame
-    meta_data['body_rotation'] = body_rotation
-
-    # sensor orientation
-    sensor_frame = driver.sensor_frame_id
-
-    instrument_pointing = {}
-    source_frame, destination_frame, _ = frame_chain.last_time_dependent_frame_between(1, sensor_frame)
-
-    # Reverse the frame order because ISIS orders frames as
-    # (destination, intermediate, ..., intermediate, source)
-    instrument_pointing['time_dependent_frames'] = shortest_path(frame_chain, destination_frame, J2000)
-    time_dependent_rotation = frame_chain.compute_rotation(J2000, destination_frame)
-    instrument_pointing['ck_table_start_time'] = time_dependent_rotation.times[0]
-    instrument_pointing['ck_table_end_time'] = time_dependent_rotation.times[-1]
-    instrument_pointing['ck_table_original_size'] = len(time_dependent_rotation.times)
-    instrument_pointing['ephemeris_times'] = time_dependent_rotation.times
-    instrument_pointing['quaternions'] = time_dependent_rotation.quats[:, [3, 0, 1, 2]]
-    instrument_pointing['angular_velocities'] = time_dependent_rotation.av
-
-    # reference frame should be the last frame in the chain
-    instrument_pointing["reference_frame"] = instrument_pointing['time_dependent_frames'][-1]
-
-    # Reverse the frame order because ISIS orders frames as
-    # (destination, intermediate, ..., intermediate, source)
-    instrument_pointing['constant_frames'] = shortest_path(frame_chain, sensor_frame, destination_frame)
-    constant_rotation = frame_chain.compute_rotation(destination_frame, sensor_frame)
-    instrument_pointing['constant_rotation'] = constant_rotation.rotation_matrix().flatten()
-    
-    meta_data['instrument_pointing'] = instrument_pointing
-
     # interior orientation
     meta_data['naif_keywords'] = driver.naif_keywords
 
@@ -167,49 +241,204 @@ def to_isd(driver):
         meta_data['starting_detector_line'] = driver.detector_start_line
         meta_data['starting_detector_sample'] = driver.detector_start_sample
 
-    j2000_rotation = frame_chain.compute_rotation(target_frame, J2000)
+    if (driver.projection != ""):
+        meta_data["projection"] = driver.projection
+        meta_data["geotransform"] = driver.geotransform
 
-    instrument_position = {}
-    positions, velocities, times = driver.sensor_position
-    instrument_position['spk_table_start_time'] = times[0]
-    instrument_position['spk_table_end_time'] = times[-1]
-    instrument_position['spk_table_original_size'] = len(times)
-    instrument_position['ephemeris_times'] = times
-    # Rotate positions and velocities into J2000 then scale into kilometers
-    # If velocities are provided, then rotate and add to ISD
-    if velocities is not None:
-        velocities = j2000_rotation.rotate_velocity_at(positions, velocities, times)/1000
-        instrument_position['velocities'] = velocities
-    positions = j2000_rotation.apply_at(positions, times)/1000
-    instrument_position['positions'] = positions
-    instrument_position["reference_frame"] = j2000_rotation.dest
+    # check that there is a valid sensor model name
+    if 'name_model' not in meta_data:
+        raise Exception('No CSM sensor model name found!')
 
-    meta_data['instrument_position'] = instrument_position
+    return meta_data
 
-    sun_position = {}
-    positions, velocities, times = driver.sun_position
-    sun_position['spk_table_start_time'] = times[0]
-    sun_position['spk_table_end_time'] = times[-1]
-    sun_position['spk_table_original_size'] = len(times)
-    sun_position['ephemeris_times'] = times
+def _insert_kernel_sections(meta_data, computed):
+    """
+    Returns meta_data with the computed kernel sections. Sections that
+    meta_data already has are replaced where they are, new ones are inserted
+    where to_isd has always written them: the rotations before naif_keywords
+    and the positions before projection.
+    """
+    missing = {key: value for key, value in computed.items() if key not in meta_data}
+    ordered = {}
+    for key, value in meta_data.items():
+        if key == 'naif_keywords':
+            for section in ('body_rotation', 'instrument_pointing'):
+                if section in missing:
+                    ordered[section] = missing.pop(section)
+        if key == 'projection':
+            for section in ('instrument_position', 'sun_position'):
+                if section in missing:
+                    ordered[section] = missing.pop(section)
+        ordered[key] = computed.get(key, value)
+    for section in ISD_KERNEL_SECTIONS:
+        if section in missing:
+            ordered[section] = missing.pop(section)
+    return ordered
+
+def _position_section(position, j2000_rotation):
+    """
+    Returns an ISD position section from a driver position, such as
+    sensor_position, in J2000 and kilometers.
+    """
+    position_section = {}
+    positions, velocities, times = position
+    position_section['spk_table_start_time'] = times[0]
+    position_section['spk_table_end_time'] = times[-1]
+    position_section['spk_table_original_size'] = len(times)
+    position_section['ephemeris_times'] = times
     # Rotate positions and velocities into J2000 then scale into kilometers
     # If velocities are provided, then rotate and add to ISD
     if velocities is not None:
         velocities = j2000_rotation.rotate_velocity_at(positions, velocities, times)/1000
-        sun_position['velocities'] = velocities
-    
+        position_section['velocities'] = velocities
     positions = j2000_rotation.apply_at(positions, times)/1000
-    sun_position['positions'] = positions
-    sun_position["reference_frame"] = j2000_rotation.dest
+    position_section['positions'] = positions
+    position_section["reference_frame"] = j2000_rotation.dest
+    return position_section
 
-    meta_data['sun_position'] = sun_position
+def _frame_classes(isd, section):
+    """
+    Returns the SPICE frame class and class ID of each frame of a rotation
+    section of an ISD, or None if a frame is not in the kernel pool.
+    """
+    rotation = isd.get(section, {})
+    frames = list(rotation.get('time_dependent_frames', [])) + list(rotation.get('constant_frames', []))
+    try:
+        return [spice.frinfo(int(frame))[1:] for frame in frames]
+    except Exception:
+        return None
+
+def kernel_sections(kernel, isd, nadir=False):
+    """
+    Returns the sections of an ISD that a kernel can change.
 
-    if (driver.projection != ""):
-        meta_data["projection"] = driver.projection
-        meta_data["geotransform"] = driver.geotransform
+    SPKs change the positions. Binary CKs and PCKs change the rotation
+    sections with a frame that they provide, and the positions if they
+    change the body rotation, because the positions are rotated out of the
+    body fixed frame. Dynamic frames, and nadir pointing, also depend on the
+    SPKs. Any other kernel, such as frame, instrument, time, or text PCK
+    kernels, and kernels that can not be read, can change everything, which
+    is returned as every section and 'metadata'.
 
-    # check that there is a valid sensor model name
-    if 'name_model' not in meta_data:
-        raise Exception('No CSM sensor model name found!')
+    Parameters
+    ----------
+    kernel : str
+             The path to the kernel
 
-    return meta_data
+    isd : dict
+          The ISD, for the frames of its rotation sections. The frames are
+          looked up in the kernel pool, so the frame kernels must be furnished.
+
+    nadir : bool
+            If the instrument pointing is nadir pointing computed from the positions
+
+    Returns
+    -------
+    set
+        The names of the sections
+    """
+    everything = set(ISD_KERNEL_SECTIONS) | {'metadata'}
+    try:
+        architecture, kernel_type = spice.getfat(str(kernel))
+    except Exception:
+        return everything
+
+    sections = set()
+    if kernel_type == 'SPK':
+        sections |= {'instrument_position', 'sun_position'}
+        for section in ('instrument_pointing', 'body_rotation'):
+            frame_classes = _frame_classes(isd, section)
+            if frame_classes is None:
+                return everything
+            if any(frame_class in _DYNAMIC_FRAMES for frame_class, _ in frame_classes):
+                sections.add(section)
+    elif architecture == 'DAF' and kernel_type in ('CK', 'PCK'):
+        try:
+            if kernel_type == 'CK':
+                provided_class, provided_ids = _CK_FRAME, set(spice.ckobj(str(kernel)))
+            else:
+                provided_class, provided_ids = _PCK_FRAME, set(spice.pckfrm(str(kernel)))
+        except Exception:
+            return everything
+        for section in ('instrument_pointing', 'body_rotation'):
+            frame_classes = _frame_classes(isd, section)
+            if frame_classes is None:
+                return everything
+            if any(frame_class == provided_class and class_id in provided_ids
+                   for frame_class, class_id in frame_classes):
+                sections.add(section)
+    else:
+        return everything
+
+    if 'body_rotation' in sections:
+        sections |= {'instrument_position', 'sun_position'}
+    if nadir and 'instrument_position' in sections:
+        sections.add('instrument_pointing')
+    return sections
+
+def furnished_kernels(metakernels=False):
+    """
+    Returns the paths of the furnished kernels, in the order they were
+    furnished. The kernels that metakernels furnish are always listed, and
+    the metakernels themselves only if metakernels is True.
+    """
+    kernels = []
+    for index in range(spice.ktotal('ALL')):
+        kernel, kernel_type, _, _ = spice.kdata(index, 'ALL')
+        if metakernels or kernel_type != 'META':
+            kernels.append(kernel)
+    return kernels
+
+def kernel_provenance(isd, nadir=False):
+    """
+    Returns the furnished kernels that each section of an ISD depends on,
+    see kernel_sections. The kernels that the rest of the ISD depends on are
+    under 'metadata'.
+
+    Returns
+    -------
+    dict
+        The list of kernels for each section
+    """
+    provenance = {section: [] for section in ISD_KERNEL_SECTIONS + ('metadata',)}
+    for kernel in furnished_kernels():
+        for section in kernel_sections(kernel, isd, nadir):
+            provenance[section].append(kernel)
+    return provenance
+
+def dependent_sections(isd, changed_kernels, nadir=False):
+    """
+    Returns the sections of an ISD that need to be recomputed after some
+    kernels changed. These are the sections whose kernel_provenance lists a
+    changed kernel, which covers kernels that were removed, and the sections
+    that each changed kernel can change, see kernel_sections. If the result
+    has 'metadata', the whole ISD needs to be recomputed.
+
+    Parameters
+    ----------
+    isd : dict
+          The ISD generated before the kernels changed
+
+    changed_kernels : list
+                      The paths of the kernels that were added, removed, or replaced
+
+    nadir : bool
+            If the instrument pointing is nadir pointing computed from the positions
+
+    Returns
+    -------
+    set
+        The names of the sections
+    """
+    provenance = {section: {os.path.abspath(kernel) for kernel in kernels}
+                  for section, kernels in isd.get('kernel_provenance', {}).items()}
+    sections = set()
+    for kernel in changed_kernels:
+        kernel = os.path.abspath(str(kernel))
+        used_by = {section for section, kernels in provenance.items() if kernel in kernels}
+        sections |= used_by
+        if used_by and not os.path.exists(kernel):
+            # A kernel that was removed only changes what it was used for
+            continue
+        sections |= kernel_sections(kernel, isd, nadir)
+    return sections
@@ -12,16 +12,20 @@
 
 import argparse
 import concurrent.futures
+import functools
 import logging
 import os
 import pvl
+import struct
 from pathlib import Path, PurePath
 import sys
 
 import ale
+import ale.base.data_naif
 import brotli
 import json
 from ale.drivers import AleJsonEncoder
+from ale.formatters.formatter import to_isd
 
 logger = logging.getLogger(__name__)
 
@@ -46,6 +50,16 @@ def main():
              "machine.  If you want to throttle this to use less resources on "
              "your machine, indicate the number of processors you want to use."
     )
+    parser.add_argument(
+        "-w", "--warm_kernels",
+        action="store_true",
+        help="If more than one file is provided, keep kernels furnished in "
+             "each worker process between files instead of loading and "
+             "unloading them for every file. Files are grouped by kernel set "
+             "and each worker only loads the kernels that differ from the "
+             "ones it already has. Use this for large batches of images "
+             "that share kernels."
+    )
     parser.add_argument(
         "-o", "--out",
         type=Path,
@@ -60,13 +74,45 @@ def main():
         action="store_true",
         help="Display information as program runs."
     )
-    parser.add_argument(
+    output_format = parser.add_mutually_exclusive_group()
+    output_format.add_argument(
         "-c", "--compress",
         action="store_true",
         help="Output a compressed isd json file with .br file extension. "
              "Ale uses the brotli compression algorithm. "
              "To decompress an isd file run: python -c \"import ale.isd_generate as isdg; isdg.decompress_json('/path/to/isd.br')\""
     )
+    output_format.add_argument(
+        "-b", "--binary",
+        action="store_true",
+        help="Output a binary isd file with .bisd file extension. "
+             "Binary isds store the ephemeris and pointing arrays as raw "
+             "doubles so that they can be memory mapped by ale::BinaryIsd."
+    )
+    parser.add_argument(
+        "-u", "--update",
+        action="store_true",
+        help="Update existing output ISDs instead of generating them from "
+             "scratch. Only the positions and rotations that depend on the "
+             "--changed_kernel kernels are recomputed, or all of them if no "
+             "changed kernels are given, and everything else is kept. Files "
+             "without an existing output ISD are generated as usual."
+    )
+    parser.add_argument(
+        "-C", "--changed_kernel",
+        action="append",
+        type=Path,
+        default=None,
+        help="A kernel that was added, removed, or replaced since the ISDs "
+             "were generated, for --update. Can be given more than once."
+    )
+    parser.add_argument(
+        "-p", "--provenance",
+        action="store_true",
+        help="Record the kernels that each position and rotation section "
+             "depends on in the ISD as kernel_provenance, so that --update "
+             "can also tell which sections used kernels that were removed."
+    )
     parser.add_argument(
         "-i", "--only_isis_spice",
         action="store_true",
@@ -119,22 +165,42 @@ def main():
 
     if len(args.input) == 1:
         try:
-            file_to_isd(args.input[0], args.out, kernels=k, log_level=log_level, compress=args.compress, only_isis_spice=args.only_isis_spice, only_naif_spice=args.only_naif_spice, local=args.local)
+            file_to_isd(args.input[0], args.out, kernels=k, log_level=log_level, compress=args.compress, binary=args.binary, only_isis_spice=args.only_isis_spice, only_naif_spice=args.only_naif_spice, local=args.local, update=args.update, changed_kernels=args.changed_kernel, provenance=args.provenance)
         except Exception as err:
             # Seriously, this just throws a generic Exception?
             sys.exit(f"File {args.input[0]}: {err}")
     else:
+        file_kwargs = {"kernels": k,
+                       "log_level": log_level,
+                       "compress": args.compress,
+                       "binary": args.binary,
+                       "only_isis_spice": args.only_isis_spice,
+                       "only_naif_spice": args.only_naif_spice,
+                       "local": args.local,
+                       "nadir": args.nadir,
+                       "update": args.update,
+                       "changed_kernels": args.changed_kernel,
+                       "provenance": args.provenance}
+        if args.warm_kernels:
+            max_workers = args.max_workers or os.cpu_count() or 1
+            with concurrent.futures.ProcessPoolExecutor(
+                max_workers=max_workers, initializer=_enable_warm_kernels
+            ) as executor:
+                futures = [
+                    executor.submit(files_to_isd, files, **file_kwargs)
+                    for files in group_by_kernels(args.input, k, max_workers)
+                ]
+                for f in concurrent.futures.as_completed(futures):
+                    for file, err in f.result():
+                        logger.error(f"File {file}: {err}")
+            return
+
         with concurrent.futures.ProcessPoolExecutor(
             max_workers=args.max_workers
         ) as executor:
             futures = {
                 executor.submit(
-                    file_to_isd, f, **{"kernels": k, 
-                                       "log_level": log_level, 
-                                       "only_isis_spice": args.only_isis_spice, 
-                                       "only_naif_spice": args.only_naif_spice,
-                                       "local": args.local,
-                                       "nadir": args.nadir}
+                    file_to_isd, f, **file_kwargs
                 ): f for f in args.input
             }
             for f in concurrent.futures.as_completed(futures):
@@ -148,31 +214,116 @@ def main():
                     logger.error(f"File {futures[f]}: {err}")
 
 
+def _enable_warm_kernels():
+    """
+    Initializes a worker process so that kernels stay furnished between files.
+    """
+    ale.base.data_naif.kernel_pool.warm = True
+
+
+def kernel_set(file, kernels=None):
+    """
+    Returns the kernels that generating an ISD for *file* is expected to use,
+    as a tuple. These are the *kernels* if given, otherwise the kernels from
+    the spiceinit of the ISIS cube or an empty tuple if *file* is not a
+    spiceinit'd cube.
+    """
+    if kernels is not None:
+        return tuple(str(PurePath(p)) for p in kernels)
+    try:
+        return tuple(str(p) for p in ale.util.generate_kernels_from_cube(file, expand=True))
+    except Exception:
+        return ()
+
+
+def group_by_kernels(files, kernels=None, num_groups=1):
+    """
+    Groups *files* by their kernel set, see kernel_set(), so that a worker
+    that keeps its kernels furnished processes files with the same kernels
+    one after another. Each kernel set is split into up to *num_groups*
+    groups so that a single kernel set still runs in parallel.
+
+    Returns
+    -------
+    list
+        The lists of files, in the order of the input files within each list
+    """
+    by_kernels = {}
+    for file in files:
+        by_kernels.setdefault(kernel_set(file, kernels), []).append(file)
+
+    groups = []
+    for kernel_files in by_kernels.values():
+        num_chunks = max(1, min(num_groups, len(kernel_files)))
+        chunk_size = -(-len(kernel_files) // num_chunks)
+        for start in range(0, len(kernel_files), chunk_size):
+            groups.append(kernel_files[start:start + chunk_size])
+    return groups
+
+
+def files_to_isd(files, **kwargs):
+    """
+    Runs file_to_isd() on each of *files* in turn with the same keyword
+    arguments. Errors are collected instead of raised so that one bad file
+    does not stop the rest.
+
+    Returns
+    -------
+    list
+        (file, error) tuples for each file that failed
+    """
+    errors = []
+    for file in files:
+        try:
+            file_to_isd(file, **kwargs)
+        except Exception as err:
+            errors.append((file, str(err)))
+    return errors
+
+
 def file_to_isd(
     file: os.PathLike,
     out: os.PathLike = None,
     kernels: list = None,
     log_level=logging.WARNING,
     compress=False,
+    binary=False,
     only_isis_spice=False,
     only_naif_spice=False,
     local=False,
-    nadir=False
+    nadir=False,
+    update=False,
+    changed_kernels=None,
+    provenance=False
 ):
     """
     Returns nothing, but acts as a thin wrapper to take the *file* and generate
     an ISD at *out* (if given, defaults to replacing the extension on *file*
     with .json), optionally using the passed *kernels*.
+
+    If *update* is True and the output ISD exists, it is updated instead,
+    recomputing only the sections that depend on the *changed_kernels*, see
+    ale.formatters.formatter.to_isd. If *provenance* is True, the kernels
+    each section depends on are recorded in the ISD.
     """
     # Yes, it is aggravating to have to pass the log_level into the function.
     # If this weren't trying to be fancy with multiprocessing, it wouldn't
     # be needed, and if this program were more complex, you'd build different
     # infrastructure.  Probably overkill to use logging here.
 
+    if compress and binary:
+        raise ValueError("Only one of compress and binary can be given")
+
     if out is None:
         isd_file = Path(file).with_suffix(".json")
     else:
         isd_file = Path(out)
+    if compress:
+        output_file = os.path.splitext(isd_file)[0] + '.br'
+    elif binary:
+        output_file = os.path.splitext(isd_file)[0] + '.bisd'
+    else:
+        output_file = str(isd_file)
 
     # These two lines might seem redundant, but they are the only
     # way to guarantee that when file_to_isd() is spun up in its own
@@ -189,36 +340,83 @@ def file_to_isd(
     if nadir:
         props['nadir'] = nadir
 
+    # Only pass a formatter when one of its options is used
+    formatter_kwargs = {}
+    if provenance:
+        formatter_kwargs["record_provenance"] = True
+    if update and os.path.exists(output_file):
+        logger.info(f"Updating: {output_file}")
+        formatter_kwargs["base_isd"] = read_isd(output_file)
+        if changed_kernels is not None:
+            formatter_kwargs["changed_kernels"] = [str(PurePath(p)) for p in changed_kernels]
+    load_kwargs = {}
+    if formatter_kwargs:
+        load_kwargs["formatter"] = functools.partial(to_isd, **formatter_kwargs)
+
     if kernels is not None:
         kernels = [str(PurePath(p)) for p in kernels]
         props["kernels"] = kernels
-        usgscsm_str = ale.loads(file, props=props, verbose=log_level>logging.INFO, only_isis_spice=only_isis_spice, only_naif_spice=only_naif_spice)
+        usgscsm_str = ale.loads(file, props=props, verbose=log_level>logging.INFO, only_isis_spice=only_isis_spice, only_naif_spice=only_naif_spice, **load_kwargs)
     else:
-        usgscsm_str = ale.loads(file, props=props, verbose=log_level>logging.INFO, only_isis_spice=only_isis_spice, only_naif_spice=only_naif_spice)
+        usgscsm_str = ale.loads(file, props=props, verbose=log_level>logging.INFO, only_isis_spice=only_isis_spice, only_naif_spice=only_naif_spice, **load_kwargs)
 
     if compress:
-        logger.info(f"Writing: {os.path.splitext(isd_file)[0] + '.br'}")
-        compress_json(usgscsm_str, os.path.splitext(isd_file)[0] + '.br')
+        logger.info(f"Writing: {output_file}")
+        compress_json(usgscsm_str, output_file)
+    elif binary:
+        logger.info(f"Writing: {output_file}")
+        write_binary_isd(usgscsm_str, output_file)
     else:
         logger.info(f"Writing: {isd_file}")  
         isd_file.write_text(usgscsm_str)
 
     return
 
+def read_isd(isd_file):
+    """
+    Reads an ISD written by file_to_isd, as JSON, brotli compressed JSON
+    with the .br extension, or a binary isd with the .bisd extension.
+
+    Parameters
+    ----------
+    isd_file : str
+        The ISD file path
+
+    Returns
+    -------
+    dict
+        The ISD
+    """
+    extension = os.path.splitext(isd_file)[1]
+    if extension == '.br':
+        with open(isd_file, 'rb') as f:
+            isd = json.loads(brotli.decompress(f.read()).decode('utf-8'))
+        # Older versions of compress_json serialized the already serialized
+        # ISD, so the JSON holds a string that is the ISD
+        if isinstance(isd, str):
+            isd = json.loads(isd)
+        return isd
+    if extension == '.bisd':
+        return read_binary_isd(isd_file)
+    with open(isd_file, 'r') as f:
+        return json.load(f)
+
 def compress_json(json_data, output_file):
     """
     Compresses inputted JSON data using brotli compression algorithm.
     
     Parameters
     ----------
-    json_data : str
-        JSON data
+    json_data : str or dict
+        JSON data, either already serialized or as a dictionary
 
     output_file : str
         The output compressed file path with .br extension.
 
     """
-    binary_json = json.dumps(json_data).encode('utf-8')
+    if not isinstance(json_data, str):
+        json_data = json.dumps(json_data)
+    binary_json = json_data.encode('utf-8')
 
     if not os.path.splitext(output_file)[1] == '.br':
         raise ValueError("Output file {} is not a valid .br file extension".format(output_file.split(".")[1]))
@@ -252,6 +450,127 @@ def decompress_json(compressed_json_file):
 
     return os.path.splitext(compressed_json_file)[0] + '.json'
 
+BINARY_ISD_MAGIC = b"ALEBISD\x00"
+BINARY_ISD_VERSION = 1
+_BINARY_ISD_HEADER = struct.Struct("<8sIIQQ")
+_BINARY_ISD_ENTRY = struct.Struct("<24s24sQII")
+_BINARY_ISD_ALIGNMENT = 64
+# The arrays stored as raw doubles and their number of columns
+_BINARY_ISD_ARRAYS = {
+    "instrument_position": {"ephemeris_times": 1, "positions": 3, "velocities": 3},
+    "sun_position": {"ephemeris_times": 1, "positions": 3, "velocities": 3},
+    "instrument_pointing": {"ephemeris_times": 1, "quaternions": 4, "angular_velocities": 3},
+    "body_rotation": {"ephemeris_times": 1, "quaternions": 4, "angular_velocities": 3},
+}
+
+
+def _binary_isd_align(offset):
+    return (offset + _BINARY_ISD_ALIGNMENT - 1) // _BINARY_ISD_ALIGNMENT * _BINARY_ISD_ALIGNMENT
+
+
+def write_binary_isd(json_data, output_file):
+    """
+    Writes ISD JSON data to a binary isd file that can be memory mapped by
+    ale::BinaryIsd. The ephemeris times, positions, velocities, quaternions,
+    and angular velocities are stored as little endian doubles and everything
+    else is stored as JSON. See BinaryIsd.h for the layout.
+
+    Parameters
+    ----------
+    json_data : str or dict
+        JSON data
+
+    output_file : str
+        The output binary file path with .bisd extension.
+    """
+    if not os.path.splitext(output_file)[1] == '.bisd':
+        raise ValueError("Output file {} is not a valid .bisd file extension".format(output_file))
+
+    if isinstance(json_data, str):
+        isd = json.loads(json_data)
+    else:
+        isd = json.loads(json.dumps(json_data, cls=AleJsonEncoder))
+
+    arrays = []
+    for section, columns_by_name in _BINARY_ISD_ARRAYS.items():
+        if not isinstance(isd.get(section), dict):
+            continue
+        for name, columns in columns_by_name.items():
+            if name not in isd[section]:
+                continue
+            values = isd[section].pop(name)
+            if columns == 1:
+                flat = [float(value) for value in values]
+            else:
+                flat = []
+                for row in values:
+                    if len(row) < columns:
+                        raise ValueError("Each row of {} {} must have {} values".format(section, name, columns))
+                    flat.extend(float(value) for value in row[:columns])
+            arrays.append((section, name, len(flat) // columns, columns, flat))
+
+    metadata = json.dumps(isd).encode('utf-8')
+    metadata_offset = _BINARY_ISD_HEADER.size + len(arrays) * _BINARY_ISD_ENTRY.size
+    offset = _binary_isd_align(metadata_offset + len(metadata))
+    array_offsets = []
+    for array in arrays:
+        array_offsets.append(offset)
+        offset = _binary_isd_align(offset + 8 * len(array[4]))
+
+    buffer = bytearray(offset)
+    _BINARY_ISD_HEADER.pack_into(buffer, 0, BINARY_ISD_MAGIC, BINARY_ISD_VERSION,
+                                 len(arrays), metadata_offset, len(metadata))
+    for i, (section, name, rows, columns, flat) in enumerate(arrays):
+        _BINARY_ISD_ENTRY.pack_into(buffer, _BINARY_ISD_HEADER.size + i * _BINARY_ISD_ENTRY.size,
+                                    section.encode('utf-8'), name.encode('utf-8'),
+                                    array_offsets[i], rows, columns)
+        struct.pack_into("<{}d".format(len(flat)), buffer, array_offsets[i], *flat)
+    buffer[metadata_offset:metadata_offset + len(metadata)] = metadata
+
+    with open(output_file, 'wb') as f:
+        f.write(buffer)
+
+
+def read_binary_isd(binary_isd_file):
+    """
+    Reads a binary isd file back into an ISD dictionary.
+
+    Parameters
+    ----------
+    binary_isd_file : str
+        .bisd file path
+
+    Returns
+    -------
+    dict
+        The ISD
+    """
+    with open(binary_isd_file, 'rb') as f:
+        data = f.read()
+
+    if len(data) < _BINARY_ISD_HEADER.size:
+        raise ValueError("The file {} is not a binary isd".format(binary_isd_file))
+    magic, version, num_arrays, metadata_offset, metadata_size = _BINARY_ISD_HEADER.unpack_from(data, 0)
+    if magic != BINARY_ISD_MAGIC:
+        raise ValueError("The file {} is not a binary isd".format(binary_isd_file))
+    if version != BINARY_ISD_VERSION:
+        raise ValueError("Unsupported binary isd version {}".format(version))
+
+    isd = json.loads(data[metadata_offset:metadata_offset + metadata_size].decode('utf-8'))
+    for i in range(num_arrays):
+        section, name, offset, rows, columns = _BINARY_ISD_ENTRY.unpack_from(
+            data, _BINARY_ISD_HEADER.size + i * _BINARY_ISD_ENTRY.size)
+        section = section.rstrip(b'\x00').decode('utf-8')
+        name = name.rstrip(b'\x00').decode('utf-8')
+        flat = list(struct.unpack_from("<{}d".format(rows * columns), data, offset))
+        if columns == 1:
+            values = flat
+        else:
+            values = [flat[j:j + columns] for j in range(0, len(flat), columns)]
+        isd.setdefault(section, {})[name] = values
+
+    return isd
+
 if __name__ == "__main__":
     try:
         sys.exit(main())
@@ -0,0 +1,44 @@
+# Look for the brotli decoder and encoder libraries and headers.
+# Defines the Brotli::decoder and Brotli::encoder imported targets.
+find_path(BROTLI_INCLUDE_DIR
+          NAMES brotli/decode.h
+          DOC "Path to the brotli headers")
+
+find_library(BROTLI_COMMON_LIBRARY
+             NAMES brotlicommon
+             DOC "Path to the brotli common library")
+
+find_library(BROTLI_DECODER_LIBRARY
+             NAMES brotlidec
+             DOC "Path to the brotli decoder library")
+
+find_library(BROTLI_ENCODER_LIBRARY
+             NAMES brotlienc
+             DOC "Path to the brotli encoder library")
+
+include(FindPackageHandleStandardArgs)
+
+#Handle standard arguments to find_package like REQUIRED and QUIET
+find_package_handle_standard_args(Brotli
+                                  "Failed to find the brotli libraries"
+                                  BROTLI_INCLUDE_DIR
+                                  BROTLI_COMMON_LIBRARY
+                                  BROTLI_DECODER_LIBRARY
+                                  BROTLI_ENCODER_LIBRARY)
+
+if(Brotli_FOUND AND NOT TARGET Brotli::decoder)
+  add_library(Brotli::common UNKNOWN IMPORTED)
+  set_target_properties(Brotli::common PROPERTIES
+                        IMPORTED_LOCATION ${BROTLI_COMMON_LIBRARY}
+                        INTERFACE_INCLUDE_DIRECTORIES ${BROTLI_INCLUDE_DIR})
+
+  add_library(Brotli::decoder UNKNOWN IMPORTED)
+  set_target_properties(Brotli::decoder PROPERTIES
+                        IMPORTED_LOCATION ${BROTLI_DECODER_LIBRARY}
+                        INTERFACE_LINK_LIBRARIES Brotli::common)
+
+  add_library(Brotli::encoder UNKNOWN IMPORTED)
+  set_target_properties(Brotli::encoder PROPERTIES
+                        IMPORTED_LOCATION ${BROTLI_ENCODER_LIBRARY}
+                        INTERFACE_LINK_LIBRARIES Brotli::common)
+endif()
@@ -0,0 +1,134 @@
+#ifndef ALE_BINARYISD_H
+#define ALE_BINARYISD_H
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "ale/Isd.h"
+#include "ale/Orientations.h"
+#include "ale/States.h"
+
+namespace ale {
+
+  /**
+   * A memory mapped binary ISD file.
+   *
+   * Binary ISDs store the ephemeris times, positions, velocities, quaternions,
+   * and angular velocities as raw doubles so that they can be read without
+   * parsing any decimal text. Everything else is stored as a JSON document
+   * with the same keys as a JSON ISD.
+   *
+   * The layout of a version 1 file is, with all values little endian:
+   *   - The header: the 8 byte magic string "ALEBISD\0", a uint32 version,
+   *     a uint32 number of arrays, a uint64 metadata offset, and a uint64
+   *     metadata size.
+   *   - The array table: one 64 byte entry per array. Each entry is a 24 byte
+   *     null padded section name such as "instrument_position", a 24 byte
+   *     null padded array name such as "positions", a uint64 offset, a uint32
+   *     number of rows, and a uint32 number of columns.
+   *   - The metadata: the ISD as UTF-8 JSON without the arrays in the table.
+   *   - The arrays: row major doubles, each starting on a 64 byte boundary.
+   */
+  class BinaryIsd {
+    public:
+      static const uint32_t VERSION = 1; //!< The binary ISD version that is read and written
+
+      /**
+       * Map a binary ISD file.
+       *
+       * @param path The path to the binary ISD
+       */
+      BinaryIsd(const std::string &path);
+
+      ~BinaryIsd();
+
+      /**
+       * Get the metadata. This is the ISD without the arrays in the array table.
+       */
+      const nlohmann::json &getMetadata() const;
+
+      /**
+       * Check if the file has an array.
+       *
+       * @param section The ISD section the array is in, such as "instrument_position"
+       * @param name The name of the array, such as "positions"
+       */
+      bool hasArray(const std::string &section, const std::string &name) const;
+
+      /**
+       * Get an array. The returned pointer is into the mapped file, so it is
+       * only valid while this object exists.
+       *
+       * @param section The ISD section the array is in, such as "instrument_position"
+       * @param name The name of the array, such as "positions"
+       * @param rows Set to the number of rows in the array
+       * @param columns Set to the number of columns in the array
+       *
+       * @return A pointer to the row major array
+       */
+      const double *getArray(const std::string &section, const std::string &name,
+                             size_t &rows, size_t &columns) const;
+
+      /**
+       * Create a States from one of the position sections.
+       *
+       * @param section The section, either "instrument_position" or "sun_position"
+       */
+      States getStates(const std::string &section) const;
+
+      /**
+       * Create an Orientations from one of the rotation sections.
+       *
+       * @param section The section, either "instrument_pointing" or "body_rotation"
+       */
+      Orientations getOrientations(const std::string &section) const;
+
+      /**
+       * Write an ISD to a binary ISD file.
+       *
+       * @param isd The ISD to write
+       * @param path The path to write the binary ISD to
+       */
+      static void write(const Isd &isd, const std::string &path);
+
+      /**
+       * Write a JSON ISD to a binary ISD file. The arrays in the position and
+       * rotation sections are written as raw doubles and every other key is
+       * kept in the metadata, so the JSON can be recovered with toJson().
+       *
+       * @param isd The JSON ISD to write
+       * @param path The path to write the binary ISD to
+       */
+      static void write(const nlohmann::json &isd, const std::string &path);
+
+      /**
+       * Get the full ISD as JSON, with the arrays put back into the metadata.
+       */
+      nlohmann::json toJson() const;
+
+    private:
+      BinaryIsd(const BinaryIsd &) = delete;
+      BinaryIsd &operator=(const BinaryIsd &) = delete;
+
+      /** The location of an array in the file **/
+      struct Array {
+        size_t offset;
+        size_t rows;
+        size_t columns;
+      };
+
+      const char *m_data; //!< The start of the file contents
+      size_t m_size; //!< The size of the file in bytes
+      bool m_mapped; //!< If m_data is a memory map instead of m_buffer
+      std::vector<char> m_buffer; //!< The file contents when memory maps are not available
+      std::map<std::string, Array> m_arrays; //!< The arrays, keyed on section/name
+      nlohmann::json m_metadata; //!< The non-array part of the ISD
+  };
+}
+
+#endif
@@ -0,0 +1,99 @@
+#ifndef ALE_BROTLI_H
+#define ALE_BROTLI_H
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <istream>
+#include <memory>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+#include "ale/Isd.h"
+#include "ale/Stats.h"
+
+// Forward declaration of the brotli decoder so that brotli is not a public include
+struct BrotliDecoderStateStruct;
+
+namespace ale {
+
+  /**
+   * A stream buffer that decompresses a brotli compressed stream as it is read.
+   *
+   * Only a chunk of the compressed and decompressed data is held at a time,
+   * so a compressed ISD can be parsed without decompressing all of it first.
+   *
+   * If the compressed data is corrupt or truncated, reading throws a
+   * std::runtime_error. The ISD parser reads the buffer directly, so the
+   * exception reaches the caller of Isd(std::istream &).
+   */
+  class BrotliStreambuf : public std::streambuf {
+    public:
+      /**
+       * Create a stream buffer that decompresses a stream.
+       *
+       * @param source The compressed stream, which must outlive the buffer
+       * @param bufferSize The number of bytes to read and decompress at a time
+       */
+      explicit BrotliStreambuf(std::istream &source, size_t bufferSize=65536);
+
+      ~BrotliStreambuf();
+
+    protected:
+      int_type underflow() override;
+
+    private:
+      BrotliStreambuf(const BrotliStreambuf &) = delete;
+      BrotliStreambuf &operator=(const BrotliStreambuf &) = delete;
+
+      std::istream &m_source; //!< The compressed stream
+      BrotliDecoderStateStruct *m_decoder; //!< The brotli decoder
+      std::vector<uint8_t> m_input; //!< The compressed bytes read from the source
+      const uint8_t *m_nextIn; //!< The next compressed byte to decompress
+      size_t m_availableIn; //!< The number of compressed bytes left to decompress
+      std::vector<char> m_output; //!< The decompressed bytes
+      bool m_finished; //!< If the end of the compressed stream has been decompressed
+  };
+
+
+  /**
+   * An input stream that decompresses a brotli compressed stream or file.
+   */
+  class BrotliIstream : public std::istream {
+    public:
+      /**
+       * Decompress a stream, which must outlive this.
+       */
+      explicit BrotliIstream(std::istream &source);
+
+      /**
+       * Decompress a file.
+       *
+       * @throws std::runtime_error If the file could not be opened
+       */
+      explicit BrotliIstream(const std::string &path);
+
+    private:
+      std::unique_ptr<std::ifstream> m_file; //!< The compressed file, if this opened it
+      BrotliStreambuf m_buffer; //!< The decompressing buffer
+  };
+
+
+  /**
+   * Read a brotli compressed ISD, such as the .br files written by
+   * isd_generate --compress.
+   *
+   * The decompressed JSON is streamed into the ISD parser. Older versions of
+   * isd_generate compressed the ISD as a JSON string holding the ISD. Those
+   * are read as well, but are decompressed in full first.
+   *
+   * @param path The compressed ISD file
+   * @param stats If given, the stages of reading the ISD are recorded in it. See Isd::Isd.
+   *
+   * @throws std::runtime_error If the file could not be opened or decompressed
+   */
+  Isd readBrotliIsd(const std::string &path, Stats *stats=nullptr);
+}
+
+#endif
@@ -0,0 +1,210 @@
+#ifndef ALE_CHEBYSHEV_H
+#define ALE_CHEBYSHEV_H
+
+#include <cstddef>
+#include <vector>
+
+#include "ale/Orientations.h"
+#include "ale/Rotation.h"
+#include "ale/States.h"
+#include "ale/Vectors.h"
+
+namespace ale {
+
+  /**
+   * Evaluate a Chebyshev series and its derivative with the Clenshaw
+   * recurrence, in O(numCoefficients) time and without allocating.
+   *
+   * @param coefficients The coefficients of T0 to T(numCoefficients - 1)
+   * @param numCoefficients The number of coefficients. Must be at least 1.
+   * @param s The point to evaluate at, in [-1, 1] within the series' interval
+   * @param value The output value
+   * @param derivative The output derivative with respect to s
+   */
+  void chebyshevEvaluate(const double *coefficients, size_t numCoefficients, double s,
+                         double &value, double &derivative);
+
+  /**
+   * Piecewise Chebyshev polynomials for a set of components.
+   *
+   * Segment i covers [boundaries[i], boundaries[i + 1]] and has degree + 1
+   * coefficients for each component, stored component by component. Times
+   * outside of the boundaries are extrapolated from the first or last segment.
+   */
+  class ChebyshevSeries {
+    public:
+      /**
+       * Create an empty series.
+       */
+      ChebyshevSeries();
+
+      /**
+       * Create a series from its segments.
+       *
+       * @param boundaries The segment boundaries, one more than the number of segments
+       * @param coefficients The coefficients for every segment and component
+       * @param numComponents The number of components
+       * @param degree The polynomial degree of every segment
+       */
+      ChebyshevSeries(const std::vector<double> &boundaries,
+                      const std::vector<double> &coefficients,
+                      size_t numComponents, size_t degree);
+
+      /**
+       * Fit a set of samples within a tolerance.
+       *
+       * Segments are grown from the start of the samples as long as the least
+       * squares fit of the samples they cover is within the tolerance of
+       * every sample. Consecutive segments share their boundary sample.
+       *
+       * @param times The sample times in increasing order
+       * @param values The samples, numComponents per time
+       * @param derivatives The derivatives of the first numDerivatives
+       *                    components, numDerivatives per time. These are
+       *                    fit alongside the values. May be null.
+       * @param numComponents The number of components
+       * @param numDerivatives The number of components with derivatives
+       * @param degree The maximum polynomial degree
+       * @param tolerances The maximum error of each component
+       *
+       * @throws std::invalid_argument If two consecutive samples cannot be
+       *                               fit within the tolerances. With
+       *                               derivatives, this can happen when the
+       *                               degree is less than 3.
+       */
+      static ChebyshevSeries fit(const std::vector<double> &times,
+                                 const std::vector<double> &values,
+                                 const std::vector<double> *derivatives,
+                                 size_t numComponents, size_t numDerivatives,
+                                 size_t degree, const std::vector<double> &tolerances);
+
+      /**
+       * Evaluate every component and its derivative with the Clenshaw
+       * recurrence, in O(degree) time per component and without allocating.
+       *
+       * @param time The time to evaluate at
+       * @param values The output values, numComponents long
+       * @param derivatives The output time derivatives, numComponents long. May be null.
+       */
+      void evaluate(double time, double *values, double *derivatives=nullptr) const;
+
+      const std::vector<double> &getBoundaries() const;
+      const std::vector<double> &getCoefficients() const;
+      size_t getNumComponents() const;
+      size_t getDegree() const;
+      size_t getNumSegments() const;
+
+    private:
+      std::vector<double> m_boundaries; //!< The segment boundaries
+      std::vector<double> m_coefficients; //!< The coefficients of each segment and component
+      size_t m_numComponents; //!< The number of components
+      size_t m_degree; //!< The polynomial degree of every segment
+  };
+
+
+  /**
+   * A compact set of states as piecewise Chebyshev polynomials.
+   *
+   * Positions are the polynomials and velocities are their derivatives.
+   * Create one with States::fitChebyshev.
+   */
+  class ChebyshevStates {
+    public:
+      ChebyshevStates();
+
+      /**
+       * Create Chebyshev states from a series.
+       *
+       * @param series The series with 3 components for x, y, and z
+       * @param refFrame Naif ID for the reference frame the states are in
+       */
+      ChebyshevStates(const ChebyshevSeries &series, int refFrame=1);
+
+      /** Evaluate the position and velocity at a time **/
+      State getState(double time) const;
+
+      /** Evaluate the position at a time **/
+      Vec3d getPosition(double time) const;
+
+      /** Evaluate the states at a set of times **/
+      std::vector<State> getStates(const std::vector<double> &times) const;
+
+      /**
+       * Sample the polynomials into a States.
+       *
+       * @param times The times to sample at
+       */
+      States toStates(const std::vector<double> &times) const;
+
+      const ChebyshevSeries &getSeries() const;
+      int getReferenceFrame() const;
+      double getStartTime() const;
+      double getStopTime() const;
+
+    private:
+      ChebyshevSeries m_series; //!< The x, y, and z polynomials
+      int m_refFrame; //!< Naif ID for the reference frame the states are in
+  };
+
+
+  /**
+   * A compact set of orientations as piecewise Chebyshev polynomials.
+   *
+   * The quaternion components are the polynomials, normalized when they are
+   * evaluated. Angular velocities, if any, are polynomials as well. The
+   * constant rotation and frames are the same as the fit Orientations.
+   * Create one with Orientations::fitChebyshev.
+   */
+  class ChebyshevOrientations {
+    public:
+      ChebyshevOrientations();
+
+      /**
+       * Create Chebyshev orientations from a series.
+       *
+       * @param series The series with 4 quaternion components, w, x, y, and z,
+       *               optionally followed by 3 angular velocity components
+       * @param constRot The constant rotation applied after the time dependent rotations
+       * @param constFrames The frame ids that constRot rotates through
+       * @param timeDepFrames The frame ids that the time dependent rotations rotate through
+       */
+      ChebyshevOrientations(const ChebyshevSeries &series,
+                            const Rotation &constRot=Rotation(1, 0, 0, 0),
+                            const std::vector<int> &constFrames=std::vector<int>(),
+                            const std::vector<int> &timeDepFrames=std::vector<int>());
+
+      /** Evaluate the time dependent rotation at a time **/
+      Rotation interpolateTimeDep(double time) const;
+
+      /** Evaluate the full rotation at a time **/
+      Rotation interpolate(double time) const;
+
+      /** Evaluate the angular velocity at a time. There must be angular velocities. **/
+      Vec3d interpolateAV(double time) const;
+
+      /** Returns true if there are angular velocities **/
+      bool hasAngularVelocity() const;
+
+      /**
+       * Sample the polynomials into an Orientations.
+       *
+       * @param times The times to sample at
+       */
+      Orientations toOrientations(const std::vector<double> &times) const;
+
+      const ChebyshevSeries &getSeries() const;
+      Rotation getConstantRotation() const;
+      std::vector<int> getConstantFrames() const;
+      std::vector<int> getTimeDependentFrames() const;
+      double getStartTime() const;
+      double getStopTime() const;
+
+    private:
+      ChebyshevSeries m_series; //!< The quaternion and angular velocity polynomials
+      Rotation m_constRotation; //!< The constant rotation applied after the time dependent rotations
+      std::vector<int> m_constFrames; //!< The frame IDs that the constant rotation rotates through
+      std::vector<int> m_timeDepFrames; //!< The frame IDs that the time dependent rotations rotate through
+  };
+}
+
+#endif
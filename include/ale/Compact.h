@@ -0,0 +1,212 @@
+#ifndef ALE_COMPACT_H
+#define ALE_COMPACT_H
+
+#include <cstddef>
+#include <vector>
+
+#include "ale/InterpUtils.h"
+#include "ale/Orientations.h"
+#include "ale/Rotation.h"
+#include "ale/States.h"
+#include "ale/Vectors.h"
+
+namespace ale {
+
+  /**
+   * A set of states stored in reduced precision.
+   *
+   * The states are split into segments of consecutive states. Each segment
+   * has a double precision origin at the middle of its range of positions,
+   * and velocities if there are any, and every state stores its position and
+   * velocity as single precision offsets from that origin. Times are kept in
+   * double precision. This takes 32 bytes per state, including its time,
+   * with velocities and 20 without, instead of 56.
+   *
+   * Rounding the offsets to single precision moves each component by at most
+   * 2^-25 times the range of that component within its segment. The largest
+   * error over every state is measured when the states are compacted, see
+   * getMaxPositionError() and getMaxVelocityError().
+   *
+   * Interpolation decodes the states around the interpolation time and
+   * interpolates them the same way States does, so results match a States
+   * of the decoded states. Single time queries decode onto the stack and do
+   * not allocate. Any number of threads may use the same CompactStates at
+   * once.
+   */
+  class CompactStates {
+    public:
+      CompactStates();
+
+      /**
+       * Compact a set of states.
+       *
+       * @param states The states to compact
+       * @param segmentSize The number of states that share an origin
+       */
+      CompactStates(const States &states, size_t segmentSize=256);
+
+      /** Returns a single state by interpolating state. See States::getState() **/
+      State getState(double time, PositionInterpolation interp=LINEAR) const;
+
+      /**
+       * Returns the states interpolated at a set of times. Each segment is
+       * decoded once for all of the times in it. See States::getStates().
+       */
+      std::vector<State> getStates(const std::vector<double> &times,
+                                   PositionInterpolation interp=LINEAR) const;
+
+      /** Gets positions at a set of times. Operates the same way as getStates(times) **/
+      std::vector<Vec3d> getPositions(const std::vector<double> &times,
+                                      PositionInterpolation interp=LINEAR) const;
+
+      /** Gets a position at a single time. Operates the same way as getState() **/
+      Vec3d getPosition(double time, PositionInterpolation interp=LINEAR) const;
+
+      /** Gets a velocity at a single time. Operates the same way as getState() **/
+      Vec3d getVelocity(double time, PositionInterpolation interp=LINEAR) const;
+
+      /** Decode every state into a States **/
+      States toStates() const;
+
+      const std::vector<double> &getTimes() const;
+      int getReferenceFrame() const;
+      bool hasVelocity() const;
+      size_t getSegmentSize() const;
+
+      /** Returns the largest position component error at a state **/
+      double getMaxPositionError() const;
+
+      /** Returns the largest velocity component error at a state **/
+      double getMaxVelocityError() const;
+
+      /** Returns the number of bytes used to store the states **/
+      size_t getMemoryUsage() const;
+
+    private:
+      /** Decode the states needed to interpolate between two interpolation indices **/
+      States window(int firstIndex, int lastIndex) const;
+
+      /** Decode a single state **/
+      State decodeState(int index) const;
+
+      std::vector<double> m_times; //!< The times of the states
+      std::vector<double> m_positionOrigins; //!< The position origin of each segment, 3 per segment
+      std::vector<float> m_positionOffsets; //!< The position offsets, 3 per state
+      std::vector<double> m_velocityOrigins; //!< The velocity origin of each segment, empty if there are no velocities
+      std::vector<float> m_velocityOffsets; //!< The velocity offsets, empty if there are no velocities
+      size_t m_segmentSize; //!< The number of states in each segment
+      int m_refFrame; //!< Naif ID for the reference frame the states are in
+      double m_maxPositionError; //!< The largest position component error
+      double m_maxVelocityError; //!< The largest velocity component error
+  };
+
+
+  /**
+   * A set of orientations stored in reduced precision.
+   *
+   * This uses the same segments as CompactStates. The time dependent
+   * quaternions are stored as single precision offsets from a double
+   * precision origin quaternion for each segment, and the angular
+   * velocities, if any, the same way. Each quaternion is sign aligned with
+   * its segment so the offsets stay small and the sign is restored when it
+   * is decoded. Decoded quaternions are normalized. The constant rotation
+   * and frames are kept as they are. This takes 36 bytes per rotation,
+   * including its time, with angular velocities and 24 without, instead
+   * of 64.
+   *
+   * Each quaternion component moves by at most 2^-25 times the range of that
+   * component within its segment, so the angle of the error rotation is at
+   * most about 2^-23 times the largest component range. The largest angle
+   * over every rotation is measured when the orientations are compacted,
+   * see getMaxAngularError().
+   *
+   * Single time queries decode the two rotations around the time onto the
+   * stack and do not allocate. Any number of threads may use the same
+   * CompactOrientations at once.
+   */
+  class CompactOrientations {
+    public:
+      CompactOrientations();
+
+      /**
+       * Compact a set of orientations.
+       *
+       * @param orientations The orientations to compact
+       * @param segmentSize The number of rotations that share an origin
+       */
+      CompactOrientations(const Orientations &orientations, size_t segmentSize=256);
+
+      /** See Orientations::interpolateTimeDep() **/
+      Rotation interpolateTimeDep(double time, RotationInterpolation interpType=SLERP) const;
+
+      /** See Orientations::interpolate() **/
+      Rotation interpolate(double time, RotationInterpolation interpType=SLERP) const;
+
+      /** See Orientations::interpolateAV() **/
+      Vec3d interpolateAV(double time) const;
+
+      /** See Orientations::rotateVectorAt() **/
+      Vec3d rotateVectorAt(double time, const Vec3d &vector,
+                           RotationInterpolation interpType=SLERP, bool invert=false) const;
+
+      /** See Orientations::rotateStateAt() **/
+      State rotateStateAt(double time, const State &state,
+                          RotationInterpolation interpType=SLERP, bool invert=false) const;
+
+      /**
+       * Get the time dependent rotations at a set of times. Each segment is
+       * decoded once for all of the times in it. See
+       * Orientations::interpolateTimeDep(times).
+       */
+      std::vector<Rotation> interpolateTimeDep(const std::vector<double> &times,
+                                               RotationInterpolation interpType=SLERP) const;
+
+      /** See Orientations::interpolate(times) **/
+      std::vector<Rotation> interpolate(const std::vector<double> &times,
+                                        RotationInterpolation interpType=SLERP) const;
+
+      /** Decode every rotation into an Orientations **/
+      Orientations toOrientations() const;
+
+      const std::vector<double> &getTimes() const;
+      Rotation getConstantRotation() const;
+      std::vector<int> getConstantFrames() const;
+      std::vector<int> getTimeDependentFrames() const;
+      bool hasAngularVelocity() const;
+      size_t getSegmentSize() const;
+
+      /** Returns the largest angle, in radians, between a decoded and original rotation **/
+      double getMaxAngularError() const;
+
+      /** Returns the largest angular velocity component error **/
+      double getMaxAngularVelocityError() const;
+
+      /** Returns the number of bytes used to store the orientations **/
+      size_t getMemoryUsage() const;
+
+    private:
+      /** Decode the rotations needed to interpolate between two interpolation indices **/
+      Orientations window(int firstIndex, int lastIndex) const;
+
+      /** Decode a single time dependent rotation and restore its sign **/
+      Rotation decodeRotation(int index) const;
+
+      /** Decode a single angular velocity **/
+      Vec3d decodeAv(int index) const;
+
+      std::vector<double> m_times; //!< The times of the rotations
+      std::vector<double> m_quatOrigins; //!< The quaternion origin of each segment, 4 per segment
+      std::vector<float> m_quatOffsets; //!< The quaternion offsets, 4 per rotation
+      std::vector<bool> m_quatFlipped; //!< If each quaternion was negated to align it with its segment
+      std::vector<double> m_avOrigins; //!< The angular velocity origin of each segment, empty if there are none
+      std::vector<float> m_avOffsets; //!< The angular velocity offsets, empty if there are none
+      size_t m_segmentSize; //!< The number of rotations in each segment
+      Rotation m_constRotation; //!< The constant rotation applied after the time dependent rotations
+      std::vector<int> m_constFrames; //!< The frame IDs that the constant rotation rotates through
+      std::vector<int> m_timeDepFrames; //!< The frame IDs that the time dependent rotations rotate through
+      double m_maxAngularError; //!< The largest angle between a decoded and original rotation
+      double m_maxAvError; //!< The largest angular velocity component error
+  };
+}
+
+#endif
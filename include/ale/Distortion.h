@@ -1,6 +1,9 @@
 #ifndef ALE_DISTORTION_H
 #define ALE_DISTORTION_H
 
+#include <cstddef>
+#include <vector>
+
 namespace ale {
   enum DistortionType {
     TRANSVERSE,
@@ -12,6 +15,152 @@ namespace ale {
     LUNARORBITER,
     RADTAN
   };
+
+  /**
+   * An optical distortion model that maps between undistorted and distorted
+   * focal plane coordinates.
+   *
+   * The coefficients are laid out the same way getDistortionCoeffs() reads
+   * them from an ISD:
+   *  - TRANSVERSE: 10 x then 10 y coefficients of the cubic polynomials in
+   *    the undistorted x and y that give the distorted x and y.
+   *  - RADIAL: k0, k1, k2. The undistorted point is d (1 - (k0 + k1 r^2 + k2 r^4)),
+   *    where r is the distance of the distorted point d from the origin.
+   *  - KAGUYALISM: the x boresight and 4 x coefficients, then the y boresight
+   *    and 4 y coefficients. The undistorted point is d + boresight + a0 + a1 r
+   *    + a2 r^2 + a3 r^3 with the x and y coefficients, from the Kaguya IK.
+   *  - DAWNFC: k. The distorted point is u (1 + k r^2), where r is the distance
+   *    of the undistorted point u from the origin.
+   *  - LROLROCNAC: k. The undistorted y is d_y / (1 + k d_y^2) and x is unchanged.
+   *  - CAHVOR: k0, k1, k2, then the x and y of the distortion center. The same
+   *    as RADIAL about the center.
+   *  - RADTAN: k1, k2, p1, p2, k3 of the radial and tangential model.
+   * LUNARORBITER is not supported because its radial coefficients are not
+   * part of the ISD.
+   *
+   * One direction of each model is closed form and the other is solved for
+   * with Newton's method. See isDistortIterative(). The iterative direction
+   * starts from its input point, or from a lookup grid if one has been
+   * prepared with prepareGrid(), which typically saves one Newton step per
+   * point for the TRANSVERSE, KAGUYALISM, DAWNFC, and LROLROCNAC models.
+   * A point that the solve does not converge for within 30 Newton steps,
+   * or where the model's Jacobian is singular, is output as NaN, so
+   * callers can find the points that have no valid solution with
+   * std::isnan.
+   *
+   * Any number of threads may call the const methods of the same Distortion
+   * at once. prepareGrid() must not run at the same time as any other method.
+   */
+  class Distortion {
+    public:
+      /**
+       * Create a distortion model.
+       *
+       * @param type The distortion model
+       * @param coefficients The model coefficients, see the class description
+       */
+      Distortion(DistortionType type, const std::vector<double> &coefficients);
+
+      DistortionType getType() const; //!< Returns the distortion model
+      const std::vector<double> &getCoefficients() const; //!< Returns the model coefficients
+
+      /** Returns true if distort() is solved iteratively and undistort() is closed form **/
+      bool isDistortIterative() const;
+
+      /**
+       * Distort a single undistorted focal plane point.
+       *
+       * @param x The undistorted x
+       * @param y The undistorted y
+       * @param distortedX The output distorted x
+       * @param distortedY The output distorted y
+       */
+      void distort(double x, double y, double &distortedX, double &distortedY) const;
+
+      /**
+       * Undistort a single distorted focal plane point.
+       *
+       * @param x The distorted x
+       * @param y The distorted y
+       * @param undistortedX The output undistorted x
+       * @param undistortedY The output undistorted y
+       */
+      void undistort(double x, double y, double &undistortedX, double &undistortedY) const;
+
+      /**
+       * Distort a batch of undistorted focal plane points. The outputs may
+       * be the same arrays as the inputs.
+       *
+       * @param x The undistorted x of each point
+       * @param y The undistorted y of each point
+       * @param numPoints The number of points
+       * @param distortedX The output buffer for the distorted x. Must have room for numPoints values.
+       * @param distortedY The output buffer for the distorted y. Must have room for numPoints values.
+       */
+      void distort(const double *x, const double *y, size_t numPoints,
+                   double *distortedX, double *distortedY) const;
+
+      /**
+       * Undistort a batch of distorted focal plane points. The outputs may
+       * be the same arrays as the inputs.
+       *
+       * @param x The distorted x of each point
+       * @param y The distorted y of each point
+       * @param numPoints The number of points
+       * @param undistortedX The output buffer for the undistorted x. Must have room for numPoints values.
+       * @param undistortedY The output buffer for the undistorted y. Must have room for numPoints values.
+       */
+      void undistort(const double *x, const double *y, size_t numPoints,
+                     double *undistortedX, double *undistortedY) const;
+
+      /**
+       * Precompute the iterative direction on a grid of points, so that
+       * Newton's method starts next to the solution. The grid covers the
+       * inputs of the iterative direction: undistorted points if
+       * isDistortIterative(), distorted points otherwise. Points outside of
+       * it start from themselves. Results match the unprepared solve up to
+       * the solver tolerance.
+       *
+       * The Newton steps the grid saves are measured at the centers of its
+       * cells. If it saves less than half a step per point, which is about
+       * the cost of looking up a guess, the grid is not kept and
+       * isGridPrepared() returns false. This is usually the case for the
+       * RADIAL, CAHVOR, and RADTAN models, which converge in about two steps
+       * from the input point.
+       *
+       * @param minX The smallest x the grid covers
+       * @param maxX The largest x the grid covers
+       * @param minY The smallest y the grid covers
+       * @param maxY The largest y the grid covers
+       * @param gridSize The number of grid cells along each axis
+       */
+      void prepareGrid(double minX, double maxX, double minY, double maxY, size_t gridSize=32);
+
+      /** Returns true if a lookup grid has been prepared **/
+      bool isGridPrepared() const;
+
+    private:
+      /** Map points in the closed form direction **/
+      void evaluateClosed(const double *x, const double *y, size_t numPoints,
+                          double *outX, double *outY) const;
+
+      /** Invert the closed form direction at a batch of points. Returns the number of Newton steps taken. **/
+      size_t evaluateIterative(const double *x, const double *y, size_t numPoints,
+                               double *outX, double *outY) const;
+
+      /** Get the Newton starting point for the iterative direction from the grid **/
+      bool gridGuess(double x, double y, double &guessX, double &guessY) const;
+
+      DistortionType m_type; //!< The distortion model
+      std::vector<double> m_coefficients; //!< The model coefficients
+      size_t m_gridSize; //!< The number of grid cells along each axis, 0 if there is no grid
+      double m_gridMinX; //!< The smallest x the grid covers
+      double m_gridMinY; //!< The smallest y the grid covers
+      double m_gridStepX; //!< The width of a grid cell
+      double m_gridStepY; //!< The height of a grid cell
+      std::vector<double> m_gridX; //!< The solved x at each grid node, row by row
+      std::vector<double> m_gridY; //!< The solved y at each grid node, row by row
+  };
 }
 
 #endif
@@ -0,0 +1,129 @@
+#ifndef ALE_FRAMECHAIN_H
+#define ALE_FRAMECHAIN_H
+
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "ale/Orientations.h"
+#include "ale/Rotation.h"
+
+namespace ale {
+
+  /**
+   * A graph of reference frames connected by rotations.
+   *
+   * This is the C++ counterpart of ale.transformation.FrameChain. Frames are
+   * NAIF IDs and every edge is either a constant Rotation or a time
+   * dependent Orientations. The inverse of every edge is added with it, so
+   * any two connected frames can be rotated between.
+   *
+   * Composed rotations are cached per source and destination pair, so each
+   * is only composed once until the graph changes. The cache makes
+   * FrameChain unsafe to query from multiple threads at once.
+   */
+  class FrameChain {
+    public:
+      /**
+       * Create an empty frame chain.
+       */
+      FrameChain();
+
+      /**
+       * Add a constant rotation between two frames.
+       *
+       * @param source The NAIF ID of the frame the rotation rotates from
+       * @param destination The NAIF ID of the frame the rotation rotates to
+       * @param rotation The rotation
+       */
+      void addRotation(int source, int destination, const Rotation &rotation);
+
+      /**
+       * Add a time dependent rotation between two frames. Its constant
+       * rotation is folded into its time dependent rotations.
+       *
+       * @param source The NAIF ID of the frame the rotations rotate from
+       * @param destination The NAIF ID of the frame the rotations rotate to
+       * @param orientations The rotations
+       */
+      void addRotation(int source, int destination, const Orientations &orientations);
+
+      /**
+       * Add an Orientations using its own frames, such as the instrument
+       * pointing or body rotation of an ISD. The time dependent rotations
+       * are added from the last to the first time dependent frame and the
+       * constant rotation, if any, from there to the first constant frame.
+       *
+       * @param orientations The rotations, with their frames set
+       */
+      void addOrientations(const Orientations &orientations);
+
+      /** Returns true if a frame is in the chain **/
+      bool hasFrame(int frame) const;
+
+      /**
+       * Find the shortest path of frames between two frames.
+       *
+       * @return The frames from source to destination, inclusive
+       */
+      std::vector<int> path(int source, int destination) const;
+
+      /**
+       * Find the last frame between two frames that a time dependent
+       * rotation rotates into. The rotation from it to the destination is
+       * constant. If every rotation between the frames is constant, this
+       * is the source.
+       */
+      int lastTimeDependentFrame(int source, int destination) const;
+
+      /**
+       * Compose the rotations between two frames.
+       *
+       * The rotations up to the last time dependent frame are merged into
+       * the time dependent rotations and the rest are folded into the
+       * constant rotation. The constant and time dependent frames are set.
+       * If every rotation between the frames is constant, there is a single
+       * identity time dependent rotation.
+       *
+       * @param source The NAIF ID of the frame to rotate from
+       * @param destination The NAIF ID of the frame to rotate to
+       *
+       * @return The rotations from source to destination. This is a
+       *         reference to the cached rotations, which is only valid until
+       *         the next call to addRotation(), addOrientations(), or
+       *         clearCache(), or until the FrameChain is destroyed. Copy the
+       *         Orientations to keep them longer.
+       */
+      const Orientations &compute(int source, int destination);
+
+      /**
+       * Get the rotation between two frames at a time.
+       *
+       * @param source The NAIF ID of the frame to rotate from
+       * @param destination The NAIF ID of the frame to rotate to
+       * @param time The time to interpolate at
+       */
+      Rotation rotationAt(int source, int destination, double time);
+
+      /**
+       * Forget every composed rotation.
+       */
+      void clearCache();
+
+    private:
+      /** A rotation between two adjacent frames **/
+      struct Edge {
+        bool timeDependent; //!< If orientations is set instead of rotation
+        Rotation rotation; //!< The constant rotation
+        Orientations orientations; //!< The time dependent rotations, with no constant rotation
+      };
+
+      void addEdge(int source, int destination, const Edge &edge);
+
+      std::map<int, std::vector<int>> m_adjacent; //!< The frames each frame has an edge to
+      std::map<std::pair<int, int>, Edge> m_edges; //!< The edges by source and destination
+      std::map<std::pair<int, int>, Orientations> m_cache; //!< The composed rotations
+  };
+}
+
+#endif
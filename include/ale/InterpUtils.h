@@ -1,6 +1,9 @@
 #ifndef ALE_INCLUDE_INTERP_UTILS_H
 #define ALE_INCLUDE_INTERP_UTILS_H
 
+#include <algorithm>
+#include <array>
+#include <stdexcept>
 #include <vector>
 
 #include "ale/Vectors.h"
@@ -71,6 +74,64 @@ namespace ale {
    */
   int interpolationIndex(const std::vector<double> &times, double interpTime);
 
+  /**
+   * Compute the index of the first time to use when interpolating at a given
+   * time, searching an array of times. See interpolationIndex(times, interpTime).
+   *
+   * @param times The ordered times to search.
+   * @param numTimes The number of times. Must be at least 1.
+   * @param interpTime The time to search for the interpolation index of.
+   */
+  int interpolationIndex(const double *times, size_t numTimes, double interpTime);
+
+  /**
+   * Tracks the interpolation index for a sequence of interpolation times.
+   *
+   * The cursor remembers the last interval it found and checks the
+   * neighboring intervals before falling back to a binary search. For
+   * monotonic sweeps through the times, finding the next index is amortized
+   * constant time. The results are the same as interpolationIndex.
+   *
+   * The cursor keeps a reference to the times, so they must outlive it.
+   */
+  class InterpolationCursor {
+    public:
+      /**
+       * Create a cursor over a set of times.
+       *
+       * @param times The ordered vector of times to search.
+       */
+      InterpolationCursor(const std::vector<double> &times);
+
+      /**
+       * Compute the index of the first time to use when interpolating at a given time.
+       *
+       * @param interpTime The time to search for the interpolation index of.
+       *
+       * @return int The same index that interpolationIndex returns
+       */
+      int index(double interpTime);
+
+      /** Returns the last index found, -1 if there is not one **/
+      int getIndex() const;
+
+      /**
+       * Start the next search from an index, such as one that a cursor over
+       * the same times found. The index only decides where the search
+       * starts, so a wrong or out of range index still gives the same result.
+       */
+      void hint(int index);
+
+      /**
+       * Forget the last index. The next search will be a full binary search.
+       */
+      void reset();
+
+    private:
+      const std::vector<double> *m_times; //!< The times being searched
+      int m_index; //!< The last index found, -1 if there is not one
+  };
+
   /**
    * Merge, sort, and remove duplicates from two vectors
    *
@@ -135,6 +196,15 @@ namespace ale {
   double lagrangeInterpolateDerivative(const std::vector<double>& times, const std::vector<double>& values,
                                        double time, int order=8);
 
+  /**
+   * Get the order of the lagrange polynomials used for an interpolation method.
+   *
+   * @param interp The interpolation method
+   *
+   * @return The number of points used by the interpolation method
+   */
+  int interpolationOrder(PositionInterpolation interp);
+
   /**
    * @brief Interpolates a value from a set of points and times
    *
@@ -147,8 +217,146 @@ namespace ale {
    *
    * @return The interpolated value
    */
-  double interpolate(std::vector<double> points, std::vector<double> times, double time, PositionInterpolation interp, int d);
+  double interpolate(const std::vector<double> &points, const std::vector<double> &times,
+                     double time, PositionInterpolation interp, int d);
 
+  /**
+   * Evaluate the lagrange basis polynomials of a window of times and their
+   * first derivatives at a time.
+   *
+   * Each value and derivative are built together in one pass with the
+   * product rule, so the derivatives are also defined at the window times.
+   *
+   * @param windowTimes The times in the window
+   * @param size The number of times in the window
+   * @param time The time to evaluate at
+   * @param values The output values, size long
+   * @param derivatives The output first derivatives, size long
+   */
+  inline void lagrangeBasis(const double *windowTimes, int size, double time,
+                            double *values, double *derivatives) {
+    for (int i = 0; i < size; i++) {
+      double weight = 1;
+      double product = 1;
+      double productDerivative = 0;
+      for (int j = 0; j < size; j++) {
+        if (i == j) {
+          continue;
+        }
+        double diff = time - windowTimes[j];
+        productDerivative = productDerivative * diff + product;
+        product *= diff;
+        weight *= windowTimes[i] - windowTimes[j];
+      }
+      values[i] = product / weight;
+      derivatives[i] = productDerivative / weight;
+    }
+  }
+
+  /**
+   * The lagrange basis polynomials around an interpolation time.
+   *
+   * The window is the one lagrangeInterpolate uses, up to Order times
+   * centered on the interval of the interpolation time and fewer near the
+   * ends of the times. The window is on the stack, so evaluating does not
+   * allocate, and the polynomials are only evaluated once no matter how
+   * many components are interpolated with them.
+   *
+   * @tparam Order The largest number of times in the window. Must be even.
+   */
+  template<int Order>
+  class LagrangeBasis {
+    static_assert(Order > 0 && Order % 2 == 0, "The lagrange order must be positive and even.");
+
+    public:
+      /**
+       * Evaluate the basis polynomials at a time.
+       *
+       * @param times The times to interpolate over, in increasing order
+       * @param numTimes The number of times
+       * @param index The interpolation index of time, see interpolationIndex
+       * @param time The time to interpolate at
+       */
+      LagrangeBasis(const double *times, int numTimes, int index, double time) {
+        int halfSize = std::min(std::min(index + 1, numTimes - index - 1), Order / 2);
+        m_start = index - halfSize + 1;
+        m_size = 2 * halfSize;
+        lagrangeBasis(times + m_start, m_size, time, m_values.data(), m_derivatives.data());
+      }
+
+      /** The index of the first time in the window **/
+      int start() const {
+        return m_start;
+      }
+
+      /** The number of times in the window **/
+      int size() const {
+        return m_size;
+      }
+
+      /** The value of the basis polynomial of the ith time in the window **/
+      double value(int i) const {
+        return m_values[i];
+      }
+
+      /** The first derivative of the basis polynomial of the ith time in the window **/
+      double derivative(int i) const {
+        return m_derivatives[i];
+      }
+
+      /**
+       * Interpolate a set of samples and their first derivative.
+       *
+       * @param samples The samples, one per time. Can be doubles or Vec3ds.
+       * @param value The output interpolated value
+       * @param derivative The output interpolated first derivative
+       */
+      template<typename T>
+      void interpolate(const T *samples, T &value, T &derivative) const {
+        value = T();
+        derivative = T();
+        for (int i = 0; i < m_size; i++) {
+          value += m_values[i] * samples[m_start + i];
+          derivative += m_derivatives[i] * samples[m_start + i];
+        }
+      }
+
+    private:
+      int m_start; //!< The index of the first time in the window
+      int m_size; //!< The number of times in the window
+      std::array<double, Order> m_values; //!< The basis polynomial values
+      std::array<double, Order> m_derivatives; //!< The basis polynomial first derivatives
+  };
+
+  /**
+   * Evaluate a cubic hermite spline and its first derivative over an interval.
+   *
+   * @param x0 The time at the start of the interval
+   * @param x1 The time at the end of the interval
+   * @param y0 The value at the start of the interval. Can be a double or a Vec3d.
+   * @param y1 The value at the end of the interval
+   * @param m0 The derivative at the start of the interval
+   * @param m1 The derivative at the end of the interval
+   * @param time The time to interpolate at
+   * @param value The output interpolated value
+   * @param derivative The output interpolated first derivative
+   */
+  template<typename T>
+  void cubicHermite(double x0, double x1, const T &y0, const T &y1, const T &m0, const T &m1,
+                    double time, T &value, T &derivative) {
+    double h = x1 - x0;
+    if (h == 0.0) {
+      throw std::invalid_argument("Error in evaluating cubic hermite velocities, values at"
+                                  "lower and upper indicies are exactly equal.");
+    }
+    double t = (time - x0) / h;
+    double t2 = t * t;
+    double t3 = t2 * t;
+    value = (2 * t3 - 3 * t2 + 1) * y0 + ((t3 - 2 * t2 + t) * h) * m0
+            + (-2 * t3 + 3 * t2) * y1 + ((t3 - t2) * h) * m1;
+    derivative = (1 / h) * ((6 * t2 - 6 * t) * y0 + ((3 * t2 - 4 * t + 1) * h) * m0
+                            + (-6 * t2 + 6 * t) * y1 + ((3 * t2 - 2 * t) * h) * m1);
+  }
 }
 
 #endif
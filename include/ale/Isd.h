@@ -1,7 +1,11 @@
 #ifndef ALE_ISD_H
 #define ALE_ISD_H
 
+#include <istream>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <utility>
 #include <vector>
 #include <map>
 
@@ -11,13 +15,70 @@
 #include "ale/Rotation.h"
 #include "ale/States.h"
 #include "ale/Orientations.h"
+#include "ale/Stats.h"
 
 namespace ale {
 
+  class BinaryIsd;
+  class LazyIsd;
+
+  /**
+   * The metadata, positions, and rotations of an image.
+   *
+   * An Isd is not changed after it is constructed, so any number of threads
+   * may read the same Isd, and call the const methods of its States and
+   * Orientations, at once.
+   */
   class Isd {
     public:
 
-    Isd(std::string);
+    class GeometryCursor;
+
+    /**
+     * Every time dependent quantity of the ISD at one time. See geometryAt().
+     */
+    struct Geometry {
+      double time; //!< The time the geometry is at
+      State instrumentState; //!< The instrument position and velocity, from inst_pos
+      Vec3d sunPosition; //!< The sun position, from sun_pos
+      Rotation instrumentPointing; //!< The instrument pointing rotation, from inst_pointing
+      Vec3d instrumentAngularVelocity; //!< The instrument angular velocity, zero if there is none
+      Rotation bodyRotation; //!< The body rotation, from body_rotation
+      Vec3d bodyAngularVelocity; //!< The body angular velocity, zero if there is none
+    };
+
+    /**
+     * Create an ISD from a JSON string.
+     *
+     * The ISD is read in a single pass. The position and rotation arrays
+     * are read directly into the States and Orientations without building
+     * a JSON document for them.
+     *
+     * If stats is given, the parse, the metadata, and each of the position
+     * and rotation sections are recorded in it as isd.parse, isd.metadata,
+     * and isd.<section name>. The parse size is the length of the string and
+     * the section sizes are their number of times.
+     */
+    Isd(std::string, Stats *stats=nullptr);
+
+    /**
+     * Create an ISD from a stream of JSON. Operates the same way as Isd(std::string),
+     * except that the parse size is not recorded.
+     */
+    Isd(std::istream &, Stats *stats=nullptr);
+
+    /**
+     * Create an ISD from a binary ISD file. The positions and rotations are
+     * copied directly out of the mapped arrays. If stats is given, the same
+     * stages as Isd(std::string) are recorded, except for isd.parse.
+     */
+    Isd(const BinaryIsd &, Stats *stats=nullptr);
+
+    /**
+     * Create an ISD from a lazy ISD, reading any positions and rotations it
+     * has not read yet.
+     */
+    Isd(const LazyIsd &);
 
     std::string usgscsm_name_model;
     std::string name_platform;
@@ -67,6 +128,147 @@ namespace ale {
 
     Orientations inst_pointing;
     Orientations body_rotation;
+
+    /**
+     * Get every time dependent quantity at a time. The positions are
+     * interpolated with interpMethod and the rotations with SLERP, with the
+     * same results as calling getState(), getPosition(), interpolate(), and
+     * interpolateAV() on each of them. Quantities whose positions or
+     * rotations are empty are left at zero or the identity rotation.
+     *
+     * @throws std::invalid_argument If the time can not be interpolated
+     */
+    Geometry geometryAt(double time) const;
+
+    /**
+     * Get every time dependent quantity at a set of times. The same as
+     * calling geometryAt() at each time, with a GeometryCursor. Times in
+     * order are the fastest.
+     */
+    std::vector<Geometry> geometryAt(const std::vector<double> &times) const;
+
+    private:
+    // Parse the ISD from a string or stream
+    template<typename InputType>
+    void load(InputType &&input, Stats *stats, size_t inputSize);
+
+    // Read everything except for the positions and rotations
+    void loadMetadata(const nlohmann::json &isd);
+  };
+
+  /**
+   * Gets the geometry of an ISD for a sequence of times, searching
+   * for interpolation indices once per time grid.
+   *
+   * The positions and rotations are searched with cursors, so sweeping
+   * through the times in order only searches when the time jumps. When two
+   * of them have the same number of times and the same first and last time,
+   * which is usual for line scan images, they are assumed to share a time
+   * grid and only one of them is searched. The others start from the index
+   * it found, which is only a hint, so the results are the same either way.
+   * The instrument pointing rotation and angular velocity are interpolated
+   * from a single index, as are the body rotation and its angular velocity.
+   *
+   * The cursor keeps a reference to the Isd, so the Isd must outlive it and
+   * must not change while it is in use. Cursors are not shared between
+   * threads; give each thread its own.
+   */
+  class Isd::GeometryCursor {
+    public:
+      /**
+       * Create a cursor for the geometry of an ISD.
+       */
+      GeometryCursor(const Isd &isd);
+
+      /** See Isd::geometryAt() **/
+      Geometry geometryAt(double time);
+
+    private:
+      const Isd &m_isd; //!< The ISD being interpolated
+      States::Cursor m_instPos; //!< Tracks the instrument position index
+      States::Cursor m_sunPos; //!< Tracks the sun position index
+      Orientations::Cursor m_instPointing; //!< Tracks the instrument pointing index
+      Orientations::Cursor m_bodyRotation; //!< Tracks the body rotation index
+      bool m_sunSharesGrid; //!< If the sun position shares the instrument position times
+      bool m_pointingSharesGrid; //!< If the instrument pointing shares the instrument position times
+      bool m_bodySharesGrid; //!< If the body rotation shares the instrument pointing times
+  };
+
+  /**
+   * An ISD whose positions and rotations are only read when they are first used.
+   *
+   * Constructing a LazyIsd finds where each top level entry of the JSON is
+   * and parses everything except for the instrument_position, sun_position,
+   * instrument_pointing, and body_rotation sections, which hold nearly all
+   * of the data. Those are parsed the first time they are requested. This
+   * makes reading metadata such as the image size and times much cheaper
+   * than constructing an Isd, which reads every section. Read the metadata
+   * with the getters in Util.h, such as getTotalLines(lazyIsd.getMetadata()).
+   *
+   * The ISD text is kept until every section has been read. Sections are
+   * read the same way Isd reads them, so they match it exactly.
+   *
+   * Any number of threads may use the same LazyIsd at once. A section is
+   * only read once, even if multiple threads request it at the same time.
+   */
+  class LazyIsd {
+    public:
+      /**
+       * Index an ISD from a JSON string.
+       *
+       * @throws nlohmann::json::parse_error If the metadata is not valid JSON
+       * @throws std::runtime_error If the ISD is not a JSON object
+       */
+      LazyIsd(std::string isd);
+
+      /**
+       * Index an ISD from a stream of JSON. The stream is read to the end.
+       */
+      LazyIsd(std::istream &isd);
+
+      /** Get everything except for the position and rotation sections **/
+      const nlohmann::json &getMetadata() const;
+
+      /** Returns true if the ISD has a position or rotation section **/
+      bool hasSection(const std::string &name) const;
+
+      /** Returns true if a position or rotation section has been read **/
+      bool isLoaded(const std::string &name) const;
+
+      /**
+       * Get the instrument position, reading it if it has not been read.
+       *
+       * @throws std::runtime_error If it is missing or could not be parsed
+       */
+      const States &getInstrumentPosition() const;
+
+      /** Get the sun position. See getInstrumentPosition() **/
+      const States &getSunPosition() const;
+
+      /** Get the instrument pointing. See getInstrumentPosition() **/
+      const Orientations &getInstrumentPointing() const;
+
+      /** Get the body rotation. See getInstrumentPosition() **/
+      const Orientations &getBodyRotation() const;
+
+    private:
+      LazyIsd(const LazyIsd &) = delete;
+      LazyIsd &operator=(const LazyIsd &) = delete;
+
+      // Find the top level entries and parse the metadata
+      void index();
+
+      // Release the ISD text once every section has been read. The mutex must be held.
+      void releaseSource() const;
+
+      mutable std::string m_source; //!< The ISD text, until every section has been read
+      nlohmann::json m_metadata; //!< Everything except for the position and rotation sections
+      std::map<std::string, std::pair<size_t, size_t>> m_sections; //!< The start and end of each section in the text
+      mutable std::mutex m_mutex; //!< Guards reading the sections
+      mutable std::unique_ptr<States> m_instPos; //!< The instrument position, once read
+      mutable std::unique_ptr<States> m_sunPos; //!< The sun position, once read
+      mutable std::unique_ptr<Orientations> m_instPointing; //!< The instrument pointing, once read
+      mutable std::unique_ptr<Orientations> m_bodyRotation; //!< The body rotation, once read
   };
 }
 
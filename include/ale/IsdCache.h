@@ -0,0 +1,151 @@
+#ifndef ALE_ISDCACHE_H
+#define ALE_ISDCACHE_H
+
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include <nlohmann/json.hpp>
+
+#include "ale/BinaryIsd.h"
+
+namespace ale {
+
+  /**
+   * A content addressed cache of ISDs in front of ale::load.
+   *
+   * ISDs are keyed on a hash of the label file contents, the props, the
+   * formatter, the onlyIsisSpice and onlyNaifSpice flags, and the path,
+   * size, and modification time of each kernel listed in the props. Changing
+   * any of these, including touching a kernel, results in a new key.
+   *
+   * The kernels a driver finds on its own, such as the kernels in an ISIS
+   * label, from the spice search path, or furnished by a metakernel, are
+   * only known once the ISD is loaded. The loader is asked to record them by
+   * adding record_kernels to the props, and the path, size, and
+   * modification time of each kernel it reports in the ISD's
+   * furnished_kernels are stored with the cached ISD. Every hit checks them
+   * again, and an ISD whose kernels changed is loaded again. The
+   * furnished_kernels are removed from the ISDs that the cache returns.
+   *
+   * ISDs are always kept in memory. If a directory is given, they are also
+   * written there as binary ISDs named after their key, with their kernels
+   * in a .kernels.json file next to them, so that other processes and later
+   * runs can re-use them. ISDs that BinaryIsd::write cannot store, such
+   * as those from some non-ale formatters, are only kept in memory.
+   *
+   * The cache is safe to use from multiple threads. Loads for different keys
+   * run concurrently. If multiple threads miss on the same key at the same
+   * time, each of them loads the ISD.
+   */
+  class IsdCache {
+    public:
+      /**
+       * The function used to load an ISD on a cache miss. It takes the
+       * same arguments as ale::loads, except for the indent, and returns the
+       * JSON formatted ISD string.
+       */
+      typedef std::function<std::string(const std::string &filename, const std::string &props,
+                                        const std::string &formatter, bool verbose,
+                                        bool onlyIsisSpice, bool onlyNaifSpice)> Loader;
+
+      /** Cache hit and miss counts **/
+      struct CacheStats {
+        size_t memoryHits; //!< The number of loads returned from memory
+        size_t diskHits; //!< The number of loads returned from the cache directory
+        size_t misses; //!< The number of loads that called the loader
+        size_t stale; //!< The number of loads that found a cached ISD whose kernels changed
+      };
+
+      /**
+       * Create an ISD cache.
+       *
+       * @param directory The directory to store binary ISDs in. If empty,
+       *                  ISDs are only cached in memory.
+       * @param loader The function used to load ISDs on a cache miss. If
+       *               empty, ale::loads is used.
+       */
+      IsdCache(const std::string &directory="", Loader loader=Loader());
+
+      /**
+       * Load an ISD, using the cached ISD if there is one.
+       * See ale::load for the parameters.
+       *
+       * @return A shared reference to the cached JSON ISD
+       */
+      std::shared_ptr<const nlohmann::json> load(const std::string &filename,
+                                                 const std::string &props="",
+                                                 const std::string &formatter="ale",
+                                                 bool verbose=true,
+                                                 bool onlyIsisSpice=false,
+                                                 bool onlyNaifSpice=false);
+
+      /**
+       * Load an ISD as a memory mapped binary ISD, using the cached ISD if
+       * there is one. The positions and rotations are read directly from the
+       * mapped file without parsing. Requires a cache directory.
+       * See ale::load for the parameters.
+       *
+       * @return The mapped binary ISD
+       */
+      std::shared_ptr<const BinaryIsd> loadBinary(const std::string &filename,
+                                                  const std::string &props="",
+                                                  const std::string &formatter="ale",
+                                                  bool verbose=true,
+                                                  bool onlyIsisSpice=false,
+                                                  bool onlyNaifSpice=false);
+
+      /**
+       * Compute the cache key for a load. See ale::load for the parameters.
+       *
+       * @return The key as a hexadecimal string
+       */
+      std::string key(const std::string &filename, const std::string &props="",
+                      const std::string &formatter="ale", bool onlyIsisSpice=false,
+                      bool onlyNaifSpice=false) const;
+
+      /** Get the hit and miss counts **/
+      CacheStats getStats() const;
+
+      /** Remove every ISD from memory. ISDs in the cache directory are kept. **/
+      void clear();
+
+    private:
+      /** A cached ISD and the kernels it was loaded from **/
+      struct Entry {
+        std::shared_ptr<const nlohmann::json> isd; //!< The ISD, without its furnished_kernels
+        nlohmann::json kernels; //!< The path, size, and modification time of each furnished kernel
+      };
+
+      /** Get the path to the binary ISD for a key in the cache directory **/
+      std::string binaryPath(const std::string &key) const;
+
+      /** Get the path to the kernels of a binary ISD in the cache directory **/
+      std::string kernelsPath(const std::string &key) const;
+
+      /** Find a current in memory ISD. Sets stale if there is one whose kernels changed. **/
+      bool findInMemory(const std::string &key, Entry &entry, bool &stale);
+
+      /** Check for a current binary ISD. Sets stale if there is one whose kernels changed. **/
+      bool diskCurrent(const std::string &key, bool &stale);
+
+      /** Call the loader and record the kernels it furnished **/
+      Entry generate(const std::string &filename, const std::string &props,
+                     const std::string &formatter, bool verbose,
+                     bool onlyIsisSpice, bool onlyNaifSpice);
+
+      /** Write an ISD and its kernels to the cache directory **/
+      void writeToDisk(const std::string &key, const Entry &entry) const;
+
+      std::string m_directory; //!< The cache directory, empty if only caching in memory
+      Loader m_loader; //!< The function used to load ISDs on a miss
+      mutable std::mutex m_mutex; //!< Guards the in memory ISDs and the stats
+      std::map<std::string, Entry> m_isds; //!< The in memory ISDs
+      CacheStats m_stats; //!< The hit and miss counts
+  };
+}
+
+#endif
@@ -0,0 +1,288 @@
+#ifndef ALE_KERNELS_H
+#define ALE_KERNELS_H
+
+#include <string>
+#include <vector>
+
+#include "ale/Orientations.h"
+#include "ale/Rotation.h"
+#include "ale/States.h"
+#include "ale/Vectors.h"
+
+namespace ale {
+
+  /** An array of data and its summary from a NAIF DAF file */
+  struct DafSegment {
+    std::string name; //!< The segment name
+    std::vector<double> doubleSummary; //!< The double precision components of the summary
+    /**
+     * The integer components of the summary. The array begin and end
+     * addresses that close every DAF summary are not included.
+     */
+    std::vector<int> intSummary;
+    std::vector<double> data; //!< The segment data
+  };
+
+
+  /**
+   * A NAIF Double precision Array File (DAF), such as an SPK or CK.
+   *
+   * Both binary files, in either byte order, and DAF encoded transfer files
+   * (DAFETF), such as the sliced kernels ale writes for its tests, can
+   * be read. The whole file is read into memory.
+   */
+  class DafFile {
+    public:
+      /**
+       * Read a DAF file. The file type is detected from its contents.
+       *
+       * @param path The path to the binary or transfer file
+       */
+      DafFile(const std::string &path);
+
+      /**
+       * Get the file type from the identification word, such as "SPK" or "CK".
+       */
+      const std::string &getType() const;
+
+      /**
+       * Get the segments in the order they are in the file.
+       */
+      const std::vector<DafSegment> &getSegments() const;
+
+    private:
+      void readBinary(const std::string &path, const std::vector<char> &contents);
+      void readTransfer(const std::string &path, const std::vector<char> &contents);
+
+      std::string m_type;
+      std::vector<DafSegment> m_segments;
+  };
+
+
+  /**
+   * An SPK segment that can be evaluated directly.
+   *
+   * Supported segment types are:
+   *   - 2: Chebyshev polynomials for position, velocity is the derivative.
+   *   - 3: Chebyshev polynomials for position and velocity.
+   *   - 13: Hermite interpolation of unequally spaced states.
+   *
+   * Segments of other types can be created, but throw when evaluated.
+   */
+  class SpkSegment {
+    public:
+      /**
+       * Create an SPK segment from a DAF segment.
+       *
+       * @param segment The segment from an SPK
+       */
+      SpkSegment(const DafSegment &segment);
+
+      int getTarget() const;
+      int getCenter() const;
+      int getReferenceFrame() const;
+      int getType() const;
+      double getStartTime() const;
+      double getStopTime() const;
+
+      /**
+       * Check if the segment covers an ephemeris time.
+       */
+      bool contains(double time) const;
+
+      /**
+       * Evaluate the segment.
+       *
+       * @param time The ephemeris time to evaluate at
+       *
+       * @return The state of the target relative to the center in km and km/s
+       */
+      State getState(double time) const;
+
+      /**
+       * Evaluate the segment at a set of times. The returned States is a
+       * sampled copy that interpolates between the times like any other
+       * States, not a view that evaluates the segment.
+       *
+       * @param times The ephemeris times to evaluate at
+       *
+       * @return The states at the times in the segment reference frame
+       */
+      States getStates(const std::vector<double> &times) const;
+
+    private:
+      State chebyshevState(double time) const;
+      State hermiteState(double time) const;
+
+      std::string m_name;
+      int m_target;
+      int m_center;
+      int m_frame;
+      int m_type;
+      double m_startTime;
+      double m_stopTime;
+      std::vector<double> m_data;
+  };
+
+
+  /**
+   * A CK segment that can be evaluated directly.
+   *
+   * CK segments are indexed by encoded spacecraft clock ticks instead of
+   * ephemeris time, so every time passed to a CkSegment is in ticks.
+   *
+   * Supported segment types are:
+   *   - 2: Constant angular velocity over each interval.
+   *   - 3: Linear interpolation between pointing instances.
+   *
+   * Segments of other types can be created, but throw when evaluated.
+   */
+  class CkSegment {
+    public:
+      /**
+       * Create a CK segment from a DAF segment.
+       *
+       * @param segment The segment from a CK
+       */
+      CkSegment(const DafSegment &segment);
+
+      int getInstrument() const;
+      int getReferenceFrame() const;
+      int getType() const;
+      bool hasAngularVelocity() const;
+      double getStartTime() const;
+      double getStopTime() const;
+
+      /**
+       * Check if the segment has pointing at a time. This is stricter than
+       * the segment bounds because of gaps between intervals.
+       *
+       * @param ticks The encoded spacecraft clock time
+       */
+      bool contains(double ticks) const;
+
+      /**
+       * Evaluate the segment.
+       *
+       * @param ticks The encoded spacecraft clock time to evaluate at
+       * @param av Set to the angular velocity in the reference frame, if not null
+       *
+       * @return The rotation from the reference frame to the instrument frame
+       */
+      Rotation getRotation(double ticks, Vec3d *av=nullptr) const;
+
+      /**
+       * Evaluate the segment at a set of times.
+       *
+       * @param times The ephemeris times of the rotations
+       * @param ticks The encoded spacecraft clock times of the rotations
+       *
+       * @return The rotations from the reference frame to the instrument
+       *         frame. The time dependent frames are the instrument ID and
+       *         the reference frame.
+       */
+      Orientations getOrientations(const std::vector<double> &times,
+                                   const std::vector<double> &ticks) const;
+
+    private:
+      // Find the type 2 interval or the type 3 record at or before ticks
+      size_t findRecord(double ticks) const;
+      Rotation recordRotation(size_t index) const;
+      Vec3d recordAngularVelocity(size_t index) const;
+
+      std::string m_name;
+      int m_instrument;
+      int m_frame;
+      int m_type;
+      bool m_hasAv;
+      double m_startTime;
+      double m_stopTime;
+      size_t m_recordSize;
+      size_t m_numRecords;
+      size_t m_numIntervals;
+      std::vector<double> m_data;
+  };
+
+
+  /**
+   * All of the segments in an SPK file.
+   */
+  class Spk {
+    public:
+      /**
+       * Read an SPK file.
+       *
+       * @param path The path to the binary or transfer SPK
+       */
+      Spk(const std::string &path);
+
+      const std::vector<SpkSegment> &getSegments() const;
+
+      /**
+       * Evaluate the highest priority segment for a target that covers a time.
+       * Segments later in the file have higher priority.
+       *
+       * @param target The NAIF ID of the target
+       * @param time The ephemeris time to evaluate at
+       */
+      State getState(int target, double time) const;
+
+      /**
+       * Evaluate a target at a set of times. All of the segments used must
+       * share a center and reference frame.
+       *
+       * @param target The NAIF ID of the target
+       * @param times The ephemeris times to evaluate at
+       */
+      States getStates(int target, const std::vector<double> &times) const;
+
+    private:
+      const SpkSegment &findSegment(int target, double time) const;
+
+      std::vector<SpkSegment> m_segments;
+  };
+
+
+  /**
+   * All of the segments in a CK file.
+   */
+  class Ck {
+    public:
+      /**
+       * Read a CK file.
+       *
+       * @param path The path to the binary or transfer CK
+       */
+      Ck(const std::string &path);
+
+      const std::vector<CkSegment> &getSegments() const;
+
+      /**
+       * Evaluate the highest priority segment for an instrument that has
+       * pointing at a time. Segments later in the file have higher priority.
+       *
+       * @param instrument The NAIF ID of the CK instrument
+       * @param ticks The encoded spacecraft clock time to evaluate at
+       * @param av Set to the angular velocity in the reference frame, if not null
+       */
+      Rotation getRotation(int instrument, double ticks, Vec3d *av=nullptr) const;
+
+      /**
+       * Evaluate an instrument at a set of times. All of the segments used
+       * must share a reference frame.
+       *
+       * @param instrument The NAIF ID of the CK instrument
+       * @param times The ephemeris times of the rotations
+       * @param ticks The encoded spacecraft clock times of the rotations
+       */
+      Orientations getOrientations(int instrument, const std::vector<double> &times,
+                                   const std::vector<double> &ticks) const;
+
+    private:
+      const CkSegment &findSegment(int instrument, double ticks) const;
+
+      std::vector<CkSegment> m_segments;
+  };
+}
+
+#endif
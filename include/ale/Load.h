@@ -3,9 +3,83 @@
 
 #include <nlohmann/json.hpp>
 
+#include <functional>
 #include <string>
+#include <vector>
+
+#include "ale/Stats.h"
+
+// Forward declaration of PyObject so that Python.h is not a public include
+struct _object;
 
 namespace ale {
+  /**
+   * Receives the result for one label of ale::loadMany.
+   *
+   * @param index The position of the label in the batch
+   * @param isd The ISD for the label, null if it could not be loaded
+   * @param error Why the label could not be loaded, empty if it was loaded
+   */
+  typedef std::function<void(size_t index, const nlohmann::json &isd,
+                             const std::string &error)> LoadCallback;
+
+  /**
+   * A persistent embedded Python session for loading ISDs.
+   *
+   * The first call to instance() initializes the Python interpreter, if it
+   * has not already been initialized, and looks up the ale.loads and
+   * ale.load_many functions. The functions are then cached for the lifetime of the process.
+   *
+   * The session is safe to use from multiple threads. Each call acquires the
+   * Python global interpreter lock only while it is running Python code, so
+   * Python code that releases the lock, such as reading SPICE kernels, can
+   * run concurrently.
+   */
+  class LoadSession {
+    public:
+      /**
+       * Get the session, initializing it on the first call.
+       *
+       * @throws std::runtime_error If the ale Python library could not be imported
+       */
+      static LoadSession &instance();
+
+      /**
+       * Load all of the metadata for an image into an ISD string.
+       * See ale::loads for the parameters.
+       */
+      std::string loads(const std::string &filename, const std::string &props="",
+                        const std::string &formatter="ale", int indent=2, bool verbose=true,
+                        bool onlyIsisSpice=false, bool onlyNaifSpice=false,
+                        Stats *stats=nullptr) const;
+
+      /**
+       * Load all of the metadata for an image into a JSON ISD.
+       * See ale::load for the parameters.
+       */
+      nlohmann::json load(const std::string &filename, const std::string &props="",
+                          const std::string &formatter="ale", bool verbose=true,
+                          bool onlyIsisSpice=false, bool onlyNaifSpice=false,
+                          Stats *stats=nullptr) const;
+
+      /**
+       * Load the metadata for a batch of images, passing each ISD to a
+       * callback as soon as it is done. See ale::loadMany for the parameters.
+       */
+      void loadMany(const std::vector<std::string> &labels, const LoadCallback &callback,
+                    const std::string &props="", const std::string &formatter="ale",
+                    bool verbose=true, bool onlyIsisSpice=false, bool onlyNaifSpice=false,
+                    Stats *stats=nullptr) const;
+
+    private:
+      LoadSession();
+      LoadSession(const LoadSession &) = delete;
+      LoadSession &operator=(const LoadSession &) = delete;
+
+      _object *m_loadsFunction; //!< The ale.loads Python function, never released
+      _object *m_loadManyFunction; //!< The ale.load_many Python function, never released
+  };
+
   /**
    * Load all of the metadata for an image into an ISD string.
    * This method calls the Python driver structure in ALE to load all
@@ -27,10 +101,20 @@ namespace ale {
    *                      drivers
    * @param onlyNaifSpice A flag the forces the load function to only use NaifSpice
    *                      drivers
+   * @param stats If given, the stages of the load are recorded in it. These
+   *              are load.session, getting the Python session, load.gil,
+   *              waiting for the Python global interpreter lock, load.python,
+   *              the call to the Python loads, and load.to_string, converting
+   *              the result to a string, with the ISD size in bytes. The
+   *              statistics that the Python loads records, such as each
+   *              driver attempt, are stored in stats->python, even if no
+   *              driver succeeds.
    *
    * @returns A string containing a JSON formatted ISD for the image.
+   *
+   * This forwards to LoadSession::instance().loads().
    */
-  std::string loads(std::string filename, std::string props="", std::string formatter="ale", int indent=2, bool verbose=true, bool onlyIsisSpice=false, bool onlyNaifSpice=false);
+  std::string loads(std::string filename, std::string props="", std::string formatter="ale", int indent=2, bool verbose=true, bool onlyIsisSpice=false, bool onlyNaifSpice=false, Stats *stats=nullptr);
 
   /**
    * Load all of the metadata for an image into a JSON ISD.
@@ -52,10 +136,56 @@ namespace ale {
    *                      drivers
    * @param onlyIsisSpice A flag the forces the load function to only use NaifSpice
    *                      drivers
+   * @param stats If given, the same stages as ale::loads are recorded in it,
+   *              followed by load.json_parse, parsing the ISD string.
    *
    * @returns A string containing a JSON formatted ISD for the image.
    */
-  nlohmann::json load(std::string filename, std::string props="", std::string formatter="ale", bool verbose=true, bool onlyIsisSpice=false, bool onlyNaifSpice=false);
+  nlohmann::json load(std::string filename, std::string props="", std::string formatter="ale", bool verbose=true, bool onlyIsisSpice=false, bool onlyNaifSpice=false, Stats *stats=nullptr);
+
+  /**
+   * Load all of the metadata for a batch of images into JSON ISDs.
+   * The whole batch is handed to the Python load_many function in one call,
+   * which finds the drivers once and keeps SPICE kernels furnished from one
+   * label to the next. Each ISD is converted directly from the Python
+   * objects the drivers produce, numeric arrays from their binary buffers,
+   * without formatting and parsing a JSON string.
+   *
+   * The callback runs without the Python global interpreter lock, so other
+   * threads can load while it processes an ISD, and the batch waits for it
+   * to return before loading the next label. A label that cannot be loaded
+   * does not stop the batch. If the callback throws, the batch stops and
+   * the exception is thrown from loadMany. The kernels the batch keeps
+   * furnished are tracked separately from those of loads on other threads,
+   * see load_many in ale/drivers/__init__.py.
+   *
+   * @param labels The filenames of the images to load metadata for
+   * @param callback Called with each ISD, in the order of the labels
+   * @param props See ale::load
+   * @param formatter See ale::load
+   * @param verbose See ale::load
+   * @param onlyIsisSpice See ale::load
+   * @param onlyNaifSpice See ale::load
+   * @param stats If given, the stages are recorded in it. These are
+   *              load.session, load.gil and load.python, the call to the
+   *              Python load_many, as in ale::loads, and a load.to_json stage
+   *              for each ISD that is converted. The statistics that the
+   *              Python load_many records are stored in stats->python.
+   *
+   * @throws std::runtime_error If the Python call fails for a reason other
+   *                            than a label that could not be loaded
+   */
+  void loadMany(const std::vector<std::string> &labels, const LoadCallback &callback, std::string props="", std::string formatter="ale", bool verbose=true, bool onlyIsisSpice=false, bool onlyNaifSpice=false, Stats *stats=nullptr);
+
+  /**
+   * Load all of the metadata for a batch of images into JSON ISDs.
+   * This is a convenience wrapper around loadMany with a callback that
+   * collects the ISDs.
+   *
+   * @returns The ISD for each label, in order, null for the labels that
+   *          could not be loaded
+   */
+  std::vector<nlohmann::json> loadMany(const std::vector<std::string> &labels, std::string props="", std::string formatter="ale", bool verbose=true, bool onlyIsisSpice=false, bool onlyNaifSpice=false, Stats *stats=nullptr);
 }
 
 #endif // ALE_H
@@ -6,8 +6,27 @@
 #include "ale/Rotation.h"
 
 namespace ale {
+  class ChebyshevOrientations;
+  class CompactOrientations;
+  class ThreadPool;
+
+  /**
+   * A set of rotations at a set of times, followed by a constant rotation.
+   *
+   * The times, rotations, and angular velocities are each stored in a
+   * contiguous column. A Rotation holds its quaternion inline, so the
+   * rotation column is a packed array of quaternions.
+   *
+   * Any number of threads may call the const methods of the same
+   * Orientations at once. Non-const methods, such as operator*=, must not
+   * run at the same time as any other method. Cursors are not shared
+   * between threads; give each thread its own.
+   */
   class Orientations {
   public:
+    class Cursor;
+    class View;
+
     /**
      * Construct a default empty orientation object
      */
@@ -40,17 +59,17 @@ namespace ale {
     ~Orientations() {};
 
     /**
-     * Get the vector of time dependent rotations
+     * Get the vector of time dependent rotations, without copying
      */
-    std::vector<Rotation> getRotations() const;
+    const std::vector<Rotation> &getRotations() const;
     /**
-     * Get the vector of angular velocities
+     * Get the vector of angular velocities, without copying
      */
-    std::vector<ale::Vec3d> getAngularVelocities() const;
+    const std::vector<ale::Vec3d> &getAngularVelocities() const;
     /**
-     * Get the vector of times
+     * Get the vector of times, without copying
      */
-    std::vector<double> getTimes() const;
+    const std::vector<double> &getTimes() const;
     /**
      * Get the frames that the constant rotation rotates through
      */
@@ -135,6 +154,108 @@ namespace ale {
       bool invert=false
     ) const;
 
+    /**
+     * Get the time dependent component of the interpolated rotations at a set of times.
+     *
+     * Operates the same way as interpolateTimeDep(time), but the times that
+     * fall between the same pair of rotations are interpolated together, so
+     * the angle between the rotations is only computed once per pair. The
+     * times do not need to be sorted, but sorted times are the fastest.
+     *
+     * @param times The times to interpolate at
+     * @param interpType The type of interpolation to use
+     *
+     * @return The time dependent rotations, one per time
+     */
+    std::vector<Rotation> interpolateTimeDep(
+      const std::vector<double> &times,
+      RotationInterpolation interpType=SLERP
+    ) const;
+
+    /**
+     * Get the interpolated rotations at a set of times.
+     * Operates the same way as interpolateTimeDep(times).
+     *
+     * @param times The times to interpolate at
+     * @param interpType The type of interpolation to use
+     *
+     * @return The full rotations, one per time
+     */
+    std::vector<Rotation> interpolate(
+      const std::vector<double> &times,
+      RotationInterpolation interpType=SLERP
+    ) const;
+
+    /**
+     * Rotate a set of 3d vectors, each at its own time
+     *
+     * @param times The times to rotate the vectors at
+     * @param vectors The input vectors to rotate, one per time
+     * @param interpType The interpolation type to use
+     * @param invert If the rotations should be inverted
+     *
+     * @return The rotated 3d vectors
+     */
+    std::vector<ale::Vec3d> rotateVectorsAt(
+      const std::vector<double> &times,
+      const std::vector<ale::Vec3d> &vectors,
+      RotationInterpolation interpType=SLERP,
+      bool invert=false
+    ) const;
+
+    /**
+     * Rotate a set of state vectors, each at its own time
+     *
+     * @param times The times to rotate the states at
+     * @param states The input states to rotate, one per time
+     * @param interpType The interpolation type to use
+     * @param invert If the rotations should be inverted
+     *
+     * @return The rotated states
+     */
+    std::vector<ale::State> rotateStatesAt(
+      const std::vector<double> &times,
+      const std::vector<ale::State> &states,
+      RotationInterpolation interpType=SLERP,
+      bool invert=false
+    ) const;
+
+    /**
+     * The batch methods above, with the times split into contiguous chunks
+     * across a thread pool. Results are the same as the methods without a
+     * pool.
+     */
+    std::vector<Rotation> interpolateTimeDep(
+      const std::vector<double> &times,
+      RotationInterpolation interpType,
+      ThreadPool &pool
+    ) const;
+
+    /** See interpolateTimeDep(times, interpType, pool) **/
+    std::vector<Rotation> interpolate(
+      const std::vector<double> &times,
+      RotationInterpolation interpType,
+      ThreadPool &pool
+    ) const;
+
+    /** See interpolateTimeDep(times, interpType, pool) **/
+    std::vector<ale::Vec3d> rotateVectorsAt(
+      const std::vector<double> &times,
+      const std::vector<ale::Vec3d> &vectors,
+      RotationInterpolation interpType,
+      bool invert,
+      ThreadPool &pool
+    ) const;
+
+    /** See interpolateTimeDep(times, interpType, pool) **/
+    std::vector<ale::State> rotateStatesAt(
+      const std::vector<double> &times,
+      const std::vector<ale::State> &states,
+      RotationInterpolation interpType,
+      bool invert,
+      ThreadPool &pool
+    ) const;
+
     /**
      * Add an additional constant rotation after this.
      * This is equivalent to left multiplication by a constant rotation.
@@ -183,7 +304,87 @@ namespace ale {
      */
      Orientations inverse() const;
 
+    /**
+     * Perform a cache reduction. The time dependent rotations are reduced
+     * to the subset that spherical linear interpolation reproduces within
+     * a tolerance, bisecting intervals the same way States::minimizeCache
+     * does. The angular velocities of the kept rotations are kept.
+     *
+     * @param angularTolerance Maximum angle, in radians, between an
+     *                         interpolated rotation and the original one.
+     * @param report Set to the size of the reduction and the largest angle
+     *               at a removed rotation, if not null.
+     *
+     * @return A new set of orientations that has been downsized.
+     */
+    Orientations minimizeCache(double angularTolerance=1e-6, CacheReduction *report=nullptr) const;
+
+    /**
+     * Fit piecewise Chebyshev polynomials to the time dependent quaternions
+     * and the angular velocities, if any. The constant rotation and frames
+     * are kept as they are.
+     *
+     * @param angularTolerance Maximum angle, in radians, between a fit and
+     *                         the original time dependent rotations.
+     * @param degree Maximum polynomial degree of each segment.
+     * @param angularVelocityTolerance Maximum error of each angular velocity
+     *                                 component, in radians per second.
+     *
+     * @return The fit polynomials. See ale/Chebyshev.h.
+     */
+    ChebyshevOrientations fitChebyshev(double angularTolerance=1e-6, size_t degree=10,
+                                       double angularVelocityTolerance=1e-6) const;
+
+    /**
+     * Get a view of the rotations needed to interpolate between two times.
+     * The view shares the storage of this Orientations, so nothing is
+     * copied. See Orientations::View.
+     *
+     * @param startTime The first time that will be interpolated
+     * @param stopTime The last time that will be interpolated
+     */
+    View slice(double startTime, double stopTime) const;
+
   private:
+    friend class CompactOrientations; //!< Shares rotateState in rotateStateAt
+
+    /**
+     * Get the time dependent component of the interpolated rotation given
+     * the interpolation index of the time.
+     */
+    Rotation interpolateTimeDep(
+      double time,
+      int interpIndex,
+      RotationInterpolation interpType
+    ) const;
+
+    /**
+     * Get the time dependent component of the interpolated rotations at a set
+     * of times and the interpolation index of each time.
+     */
+    void interpolateTimeDep(
+      const std::vector<double> &times,
+      RotationInterpolation interpType,
+      std::vector<Rotation> &rotations,
+      std::vector<int> &interpIndices
+    ) const;
+
+    /**
+     * Get the interpolated angular velocity given the interpolation index of
+     * the time. There must be angular velocities.
+     */
+    ale::Vec3d interpolateAV(double time, int interpIndex) const;
+
+    /**
+     * Rotate a state vector by an interpolated rotation and angular velocity
+     */
+    static ale::State rotateState(
+      Rotation interpRot,
+      ale::Vec3d av,
+      const ale::State &state,
+      bool invert
+    );
+
     std::vector<Rotation> m_rotations; //!< The set of time dependent rotations.
     std::vector<ale::Vec3d> m_avs; //!< The set of angular velocities. Empty if there are no angular velocities.
     std::vector<double> m_times; //!< The set of times
@@ -192,6 +393,161 @@ namespace ale {
     Rotation m_constRotation; //!< The constant rotation applied after the time dependent rotations.
   };
 
+  /**
+   * Interpolates an Orientations object at a sequence of times.
+   *
+   * The cursor remembers the last interpolation interval, so sweeping
+   * through the times in order only searches when the time jumps. Results
+   * are the same as the matching Orientations methods.
+   *
+   * The cursor keeps a reference to the Orientations, so the Orientations
+   * must outlive it.
+   */
+  class Orientations::Cursor {
+  public:
+    /**
+     * Create a cursor for a set of orientations.
+     */
+    Cursor(const Orientations &orientations);
+
+    /** See Orientations::interpolateTimeDep() **/
+    Rotation interpolateTimeDep(
+      double time,
+      RotationInterpolation interpType=SLERP
+    );
+
+    /** See Orientations::interpolate() **/
+    Rotation interpolate(
+      double time,
+      RotationInterpolation interpType=SLERP
+    );
+
+    /** See Orientations::interpolateAV() **/
+    ale::Vec3d interpolateAV(double time);
+
+    /**
+     * Get the rotation and the angular velocity at a time from a single
+     * interpolation index. The same as interpolate() and interpolateAV(),
+     * except that the angular velocity is zero if there are none.
+     *
+     * @param time The time to interpolate at
+     * @param av The output angular velocity
+     * @param interpType The rotation interpolation method
+     */
+    Rotation interpolate(
+      double time,
+      ale::Vec3d &av,
+      RotationInterpolation interpType=SLERP
+    );
+
+    /** See InterpolationCursor::getIndex() **/
+    int getIndex() const;
+
+    /** See InterpolationCursor::hint() **/
+    void hint(int index);
+
+    /** See Orientations::rotateVectorAt() **/
+    ale::Vec3d rotateVectorAt(
+      double time,
+      const ale::Vec3d &vector,
+      RotationInterpolation interpType=SLERP,
+      bool invert=false
+    );
+
+    /**
+     * See Orientations::rotateStateAt(). The interpolation index is shared
+     * by the rotation and the angular velocity.
+     */
+    ale::State rotateStateAt(
+      double time,
+      const ale::State &state,
+      RotationInterpolation interpType=SLERP,
+      bool invert=false
+    );
+
+  private:
+    const Orientations &m_orientations; //!< The orientations being interpolated
+    InterpolationCursor m_cursor; //!< Tracks the interpolation index
+  };
+
+  /**
+   * A non-owning view of the rotations around a time window.
+   *
+   * The view covers the rotations between two times and the rotation on
+   * either side of them. Between the two times, it interpolates exactly the
+   * same as the Orientations it views. Outside of them, it extrapolates
+   * from the ends of the view, the same as an Orientations made from only
+   * the viewed rotations would.
+   *
+   * The view keeps a reference to the Orientations, so the Orientations
+   * must outlive it and must not change while it is in use.
+   */
+  class Orientations::View {
+  public:
+    /**
+     * Create a view of the rotations needed to interpolate between two times.
+     *
+     * @param orientations The orientations to view. Must not be empty.
+     * @param startTime The first time that will be interpolated
+     * @param stopTime The last time that will be interpolated. Must be at least startTime.
+     */
+    View(const Orientations &orientations, double startTime, double stopTime);
+
+    /** See Orientations::interpolateTimeDep() **/
+    Rotation interpolateTimeDep(
+      double time,
+      RotationInterpolation interpType=SLERP
+    ) const;
+
+    /** See Orientations::interpolate() **/
+    Rotation interpolate(
+      double time,
+      RotationInterpolation interpType=SLERP
+    ) const;
+
+    /** See Orientations::interpolate(times) **/
+    std::vector<Rotation> interpolate(
+      const std::vector<double> &times,
+      RotationInterpolation interpType=SLERP
+    ) const;
+
+    /** See Orientations::interpolateAV() **/
+    ale::Vec3d interpolateAV(double time) const;
+
+    /** See Orientations::rotateVectorAt() **/
+    ale::Vec3d rotateVectorAt(
+      double time,
+      const ale::Vec3d &vector,
+      RotationInterpolation interpType=SLERP,
+      bool invert=false
+    ) const;
+
+    /** See Orientations::rotateStateAt() **/
+    ale::State rotateStateAt(
+      double time,
+      const ale::State &state,
+      RotationInterpolation interpType=SLERP,
+      bool invert=false
+    ) const;
+
+    /** Copy the viewed rotations into an Orientations **/
+    Orientations toOrientations() const;
+
+    std::vector<Rotation> getRotations() const; //!< Returns a copy of the viewed rotations
+    std::vector<ale::Vec3d> getAngularVelocities() const; //!< Returns a copy of the viewed angular velocities
+    std::vector<double> getTimes() const; //!< Returns a copy of the viewed times
+    size_t getStartIndex() const; //!< Returns the index of the first viewed rotation
+    size_t size() const; //!< Returns the number of viewed rotations
+
+  private:
+    /** The interpolation index of a time in the full orientations, limited to the view **/
+    int interpolationIndex(double time) const;
+
+    const Orientations &m_orientations; //!< The orientations being viewed
+    size_t m_start; //!< The index of the first viewed rotation
+    size_t m_size; //!< The number of viewed rotations
+  };
+
   /**
    * Apply a constant rotation before a set of Orientations
    *
@@ -1,7 +1,7 @@
 #ifndef ALE_ROTATION_H
 #define ALE_ROTATION_H
 
-#include <memory>
+#include <utility>
 #include <vector>
 
 #include "ale/States.h"
@@ -52,14 +52,6 @@ namespace ale {
        * @param theta The rotation about the axis in radians.
        */
       Rotation(const std::vector<double>& axis, double theta);
-      ~Rotation();
-
-      // Special member functions
-      Rotation(Rotation && other) noexcept;
-      Rotation& operator=(Rotation && other) noexcept;
-
-      Rotation(const Rotation& other);
-      Rotation& operator=(const Rotation& other);
 
       // Type specific accessors
       /**
@@ -85,6 +77,21 @@ namespace ale {
        */
       std::vector<double> toStateRotationMatrix(const Vec3d &av) const;
 
+      /**
+       * Write the rotation matrix into a caller provided buffer.
+       *
+       * @param matrix The output buffer for the 9 element matrix in row-major order.
+       */
+      void toRotationMatrix(double *matrix) const;
+
+      /**
+       * Write the state rotation matrix into a caller provided buffer.
+       *
+       * @param av The angular velocity vector.
+       * @param matrix The output buffer for the 36 element matrix in row-major order.
+       */
+      void toStateRotationMatrix(const Vec3d &av, double *matrix) const;
+
       /**
        * The rotation as Euler angles.
        *
@@ -114,6 +121,34 @@ namespace ale {
 
       State operator()(const State &state, const Vec3d& av = Vec3d(0.0, 0.0, 0.0)) const;
 
+      /**
+       * Rotate a set of vectors.
+       *
+       * Operates the same way as operator()(vector), but the rotation matrix
+       * is only built once for all of the vectors.
+       *
+       * @param vectors The vectors to rotate.
+       * @param numVectors The number of vectors.
+       * @param rotatedVectors The output buffer. Must have room for numVectors
+       *                       vectors. May be the same as vectors.
+       */
+      void rotateVectors(const Vec3d *vectors, size_t numVectors, Vec3d *rotatedVectors) const;
+
+      /**
+       * Rotate a set of state vectors with the same angular velocity.
+       *
+       * Operates the same way as operator()(state, av), but the rotation
+       * matrix and its derivative are only built once for all of the states.
+       *
+       * @param states The states to rotate.
+       * @param numStates The number of states.
+       * @param rotatedStates The output buffer. Must have room for numStates
+       *                      states. May be the same as states.
+       * @param av The angular velocity to use when rotating the states.
+       */
+      void rotateStates(const State *states, size_t numStates, State *rotatedStates,
+                        const Vec3d &av = Vec3d(0.0, 0.0, 0.0)) const;
+
       /**
        * Get the inverse rotation.
        */
@@ -126,6 +161,17 @@ namespace ale {
        */
       Rotation operator*(const Rotation& rightRotation) const;
 
+      /**
+       * The angle of the rotation from this rotation to another rotation.
+       * Unlike the arccosine of the quaternion dot product, this is accurate
+       * for small angles.
+       *
+       * @param other The other rotation.
+       *
+       * @return The angle in radians, between 0 and pi.
+       */
+      double angleTo(const Rotation& other) const;
+
       /**
        * Interpolate between this rotation and another rotation.
        *
@@ -136,11 +182,25 @@ namespace ale {
        */
       Rotation interpolate(const Rotation& nextRotation, double t, RotationInterpolation interpType) const;
 
+      /**
+       * Interpolate between this rotation and another rotation at a set of distances.
+       *
+       * Operates the same way as interpolate(), but the angle between the two
+       * rotations is only computed once for all of the distances.
+       *
+       * @param nextRotation The rotation to interpolate towards.
+       * @param t The distances to interpolate. 0 is this and 1 is the next rotation.
+       * @param numT The number of distances.
+       * @param interpType The type of rotation interpolation to use.
+       * @param interpRotations The output buffer. Must have room for numT rotations.
+       */
+      void interpolate(const Rotation& nextRotation, const double *t, size_t numT,
+                       RotationInterpolation interpType, Rotation *interpRotations) const;
+
     private:
-      // Implementation class
-      class Impl;
-      // Pointer to internal rotation implementation.
-      std::unique_ptr<Impl> m_impl;
+      // The quaternion stored inline in Eigen's coefficient order (x, y, z, w)
+      // so that rotations are plain values and can be mapped without copying.
+      double m_quat[4];
   };
 }
 
@@ -11,6 +11,9 @@
 #include "ale/InterpUtils.h"
 
 namespace ale {
+  class ChebyshevStates;
+  class ThreadPool;
+
   /** A state vector with position and velocity*/
   struct State {
     Vec3d position;
@@ -44,8 +47,31 @@ namespace ale {
     }
   };
 
+  /** A report on how much a cache reduction removed and the error it introduced */
+  struct CacheReduction {
+    size_t originalSize = 0; //!< The number of samples before the reduction
+    size_t reducedSize = 0; //!< The number of samples kept
+    double maxError = 0; //!< The largest error at a removed sample
+    double maxErrorTime = 0; //!< The time of the largest error
+  };
+
+  /**
+   * A set of state vectors at a set of times.
+   *
+   * The times and each component of the positions and velocities are
+   * stored in their own contiguous column, so interpolation reads each
+   * coordinate in place and the columns can be read without copying.
+   *
+   * Any number of threads may call the const methods of the same States at
+   * once. Non-const methods, such as prepareInterpolation, must not run at
+   * the same time as any other method. Cursors are not shared between
+   * threads; give each thread its own.
+   */
   class States {
     public:
+      class Cursor;
+      class View;
+
       // Constructors
       /**
        * Creates an empty States object
@@ -82,9 +108,24 @@ namespace ale {
       std::vector<State> getStates() const; //!< Returns state vectors (6-element positions&velocities)
       std::vector<Vec3d> getPositions() const; //!< Returns the current positions
       std::vector<Vec3d> getVelocities() const; //!< Returns the current velocities
-      std::vector<double> getTimes() const; //!< Returns the current times
+      const std::vector<double> &getTimes() const; //!< Returns the current times
       int getReferenceFrame() const; //!< Returns reference frame as NAIF ID
-      bool hasVelocity() const; //!< Returns true if any velocities have been provided
+      bool hasVelocity() const; //!< Returns true if every state has a velocity
+
+      /**
+       * Returns one component of every position, without copying.
+       *
+       * @param axis 0 for x, 1 for y, and 2 for z
+       */
+      const std::vector<double> &getPositionColumn(int axis) const;
+
+      /**
+       * Returns one component of every velocity, without copying. The
+       * column is empty if none of the states have a velocity.
+       *
+       * @param axis 0 for x, 1 for y, and 2 for z
+       */
+      const std::vector<double> &getVelocityColumn(int axis) const;
 
       /**
        * Returns a single state by interpolating state.
@@ -99,12 +140,83 @@ namespace ale {
        */
       State getState(double time, PositionInterpolation interp=LINEAR) const;
 
+      /**
+       * Returns the states interpolated at a set of times.
+       * Operates the same way as getState(), but the interpolation window search
+       * and the velocity check are shared by every time in the set. The times do not need to be sorted, but sorted times
+       * take the fewest searches.
+       *
+       * @param times The times to get values at
+       * @param interp Interpolation type to use.
+       *
+       * @return The interpolated states, one per time
+       */
+      std::vector<State> getStates(const std::vector<double> &times,
+                                   PositionInterpolation interp=LINEAR) const;
+
+      /**
+       * Interpolates states at a set of times into a caller provided buffer.
+       *
+       * @param times The times to get values at
+       * @param numTimes The number of times
+       * @param states The output buffer. Must have room for numTimes states.
+       * @param interp Interpolation type to use.
+       */
+      void getStates(const double *times, size_t numTimes, State *states,
+                     PositionInterpolation interp=LINEAR) const;
+
+      /**
+       * Returns the states interpolated at a set of times, with the times
+       * split into contiguous chunks across a thread pool. Results are the
+       * same as getStates(times, interp).
+       *
+       * @param times The times to get values at
+       * @param interp Interpolation type to use.
+       * @param pool The threads to split the times across
+       *
+       * @return The interpolated states, one per time
+       */
+      std::vector<State> getStates(const std::vector<double> &times,
+                                   PositionInterpolation interp, ThreadPool &pool) const;
+
+      /** Gets positions at a set of times. Operates the same way as getStates(times) **/
+      std::vector<Vec3d> getPositions(const std::vector<double> &times,
+                                      PositionInterpolation interp=LINEAR) const;
+
+      /** Gets positions at a set of times into a caller provided buffer. **/
+      void getPositions(const double *times, size_t numTimes, Vec3d *positions,
+                        PositionInterpolation interp=LINEAR) const;
+
+      /** Gets positions at a set of times. Operates the same way as getStates(times, interp, pool) **/
+      std::vector<Vec3d> getPositions(const std::vector<double> &times,
+                                      PositionInterpolation interp, ThreadPool &pool) const;
+
       /** Gets a position at a single time. Operates the same way as getState() **/
       Vec3d getPosition(double time, PositionInterpolation interp=LINEAR) const;
 
       /** Gets a velocity at a single time. Operates the same way as getState() **/
       Vec3d getVelocity(double time, PositionInterpolation interp=LINEAR) const;
 
+      /**
+       * Precompute the interpolation coefficients for an interpolation type.
+       *
+       * After this, getState(), getStates(), and the cursors use the tables
+       * when interpolating with the same type. For LINEAR, LAGRANGE, and SPLINE
+       * without velocities, the lagrange weights for the window in each interval
+       * are stored, so interpolating costs O(order) per coordinate instead of
+       * O(order^2). For SPLINE with velocities, the cubic hermite polynomial
+       * coefficients for each interval are stored. Only the last prepared
+       * interpolation type is kept.
+       *
+       * Results match the unprepared interpolation up to round off.
+       *
+       * @param interp Interpolation type to prepare
+       */
+      void prepareInterpolation(PositionInterpolation interp);
+
+      /** Returns true if the coefficients for an interpolation type have been precomputed **/
+      bool isPrepared(PositionInterpolation interp) const;
+
       /** Returns the first ephemeris time **/
       double getStartTime();
 
@@ -120,32 +232,206 @@ namespace ale {
        * Adapted from Isis::SpicePosition::reduceCache().
        *
        * @param tolerance Maximum error between hermite approximation and original value.
+       * @param report Set to the size of the reduction and the largest
+       *               position component error at a removed state, if not null.
        *
        * @return A new set of states that has been downsized.
        */
-      States minimizeCache(double tolerance=0.01);
+      States minimizeCache(double tolerance=0.01, CacheReduction *report=nullptr) const;
+
+      /**
+       * Fit piecewise Chebyshev polynomials to the states. This is an
+       * alternative to minimizeCache that stores a handful of coefficients
+       * per segment instead of a subset of the states. Velocities, if any,
+       * are fit as the derivatives of the positions.
+       *
+       * @param tolerance Maximum error of each position component at the states.
+       * @param degree Maximum polynomial degree of each segment.
+       *
+       * @return The fit polynomials. See ale/Chebyshev.h.
+       */
+      ChebyshevStates fitChebyshev(double tolerance=0.01, size_t degree=10) const;
+
+      /**
+       * Get a view of the states needed to interpolate between two times.
+       * The view shares the storage of this States, so nothing is copied.
+       * See States::View.
+       *
+       * @param startTime The first time that will be interpolated
+       * @param stopTime The last time that will be interpolated
+       */
+      View slice(double startTime, double stopTime) const;
 
     private:
 
+      /**
+       * Interpolate without precomputed coefficients. The columns around the
+       * interpolation index are read in place by fixed size kernels, so
+       * nothing is copied or allocated.
+       *
+       * @param first The index of the first state to interpolate over
+       * @param numStates The number of states to interpolate over
+       * @param time Time to get a value at
+       * @param lowerBound The interpolation index of time, relative to first
+       * @param interp Interpolation type to use
+       * @param hasVelocity If the states have velocities
+       *
+       * @return The interpolated state
+       */
+      State interpolateWindow(size_t first, int numStates, double time, int lowerBound,
+                              PositionInterpolation interp, bool hasVelocity) const;
+
+      /** Gather the state at an index from the columns **/
+      State stateAt(size_t index) const;
+
+      /** Returns true if every state in a range of indices has a velocity **/
+      bool rangeHasVelocity(size_t first, size_t count) const;
+
+      /** Replace the position columns **/
+      void storePositions(const std::vector<Vec3d> &positions);
+
+      /** Replace the velocity columns and update if every state has a velocity **/
+      void storeVelocities(const std::vector<Vec3d> &velocities);
+
       /**
        * Calculates the points (indicies) which need to be kept for the hermite spline to
        * interpolate between to mantain a maximum error of tolerance.
        *
-       * Adapted from Isis::SpicePosition::HermiteIndices.
+       * Adapted from Isis::SpicePosition::HermiteIndices. Instead of re-checking
+       * every kept interval on each pass, intervals are bisected depth first,
+       * so each interval is checked once and the indices come out sorted.
        *
        * @param tolerance Maximum error between hermite approximation and original value.
-       * @param indexList The list of indicies that need to be kept.
        * @param baseTime Scaled base time for fit
        * @param timeScale Time scale for fit.
+       * @param report Updated with the largest error at a removed state, if not null.
        *
        * @return The indices that should be kept to downsize the set of States
        */
-      std::vector<int> hermiteIndices(double tolerance, std::vector <int> indexList,
-                                      double baseTime, double timeScale);
-      std::vector<State> m_states; //!< The internal states cache
+      std::vector<int> hermiteIndices(double tolerance, double baseTime, double timeScale,
+                                      CacheReduction *report) const;
+
+      /**
+       * Interpolate using the precomputed coefficients.
+       *
+       * @param time Time to get a value at
+       * @param lowerBound The interpolation index of time
+       *
+       * @return The interpolated state
+       */
+      State interpolatePrepared(double time, int lowerBound) const;
+
       std::vector<double> m_ephemTimes; //!< The times for the states cache
+      std::vector<double> m_positions[3]; //!< The x, y, and z position columns
+      std::vector<double> m_velocities[3]; //!< The x, y, and z velocity columns, empty if no state has a velocity
+      bool m_hasVelocity; //!< If every state has a velocity
       int m_refFrame;  //!< Naif ID for the reference frame the states are in
+      int m_preparedInterp; //!< The prepared interpolation type, -1 if not prepared
+      int m_preparedOrder; //!< The lagrange order of the prepared interpolation
+      bool m_preparedHermite; //!< If the prepared tables are cubic hermite coefficients
+      std::vector<int> m_lagrangeStarts; //!< The first index of the lagrange window for each interval
+      std::vector<int> m_lagrangeSizes; //!< The size of the lagrange window for each interval
+      std::vector<double> m_lagrangeWeights; //!< The lagrange weights for each interval, m_preparedOrder per interval
+      std::vector<double> m_hermiteCoefficients; //!< The hermite coefficients, 12 per interval
     };
+
+
+  /**
+   * Interpolates a States object at a sequence of times.
+   *
+   * The cursor remembers the last interpolation interval, so sweeping
+   * through the times in order only searches when the time jumps.
+   * Results are the same as States::getState.
+   *
+   * The cursor keeps a reference to the States, so the States must outlive it.
+   */
+  class States::Cursor {
+    public:
+      /**
+       * Create a cursor for a set of states.
+       */
+      Cursor(const States &states);
+
+      /** Returns a single state by interpolating state. See States::getState() **/
+      State getState(double time, PositionInterpolation interp=LINEAR);
+
+      /** Gets a position at a single time. Operates the same way as getState() **/
+      Vec3d getPosition(double time, PositionInterpolation interp=LINEAR);
+
+      /** Gets a velocity at a single time. Operates the same way as getState() **/
+      Vec3d getVelocity(double time, PositionInterpolation interp=LINEAR);
+
+      /** See InterpolationCursor::getIndex() **/
+      int getIndex() const;
+
+      /** See InterpolationCursor::hint() **/
+      void hint(int index);
+
+    private:
+      const States &m_states; //!< The states being interpolated
+      InterpolationCursor m_cursor; //!< Tracks the interpolation index
+      bool m_hasVelocity; //!< If the states have velocities
+  };
+
+
+  /**
+   * A non-owning view of the states around a time window.
+   *
+   * The view covers the states between two times, plus the 3 states before
+   * and 4 states after that the widest lagrange window can reach. Between
+   * the two times, it interpolates exactly the same as the States it views.
+   * Outside of them, it extrapolates from the ends of the view, the same as
+   * a States made from only the viewed states would. Precomputed
+   * interpolation coefficients are not used, and only the viewed states are
+   * checked for velocities.
+   *
+   * The view keeps a reference to the States, so the States must outlive it
+   * and must not change while it is in use.
+   */
+  class States::View {
+    public:
+      /**
+       * Create a view of the states needed to interpolate between two times.
+       *
+       * @param states The states to view. Must not be empty.
+       * @param startTime The first time that will be interpolated
+       * @param stopTime The last time that will be interpolated. Must be at least startTime.
+       */
+      View(const States &states, double startTime, double stopTime);
+
+      /** Returns a single state by interpolating state. See States::getState() **/
+      State getState(double time, PositionInterpolation interp=LINEAR) const;
+
+      /** Returns the states interpolated at a set of times. See States::getStates() **/
+      std::vector<State> getStates(const std::vector<double> &times,
+                                   PositionInterpolation interp=LINEAR) const;
+
+      /** Gets positions at a set of times. Operates the same way as getStates(times) **/
+      std::vector<Vec3d> getPositions(const std::vector<double> &times,
+                                      PositionInterpolation interp=LINEAR) const;
+
+      /** Gets a position at a single time. Operates the same way as getState() **/
+      Vec3d getPosition(double time, PositionInterpolation interp=LINEAR) const;
+
+      /** Gets a velocity at a single time. Operates the same way as getState() **/
+      Vec3d getVelocity(double time, PositionInterpolation interp=LINEAR) const;
+
+      /** Copy the viewed states into a States **/
+      States toStates() const;
+
+      std::vector<State> getStates() const; //!< Returns a copy of the viewed states
+      std::vector<double> getTimes() const; //!< Returns a copy of the viewed times
+      int getReferenceFrame() const; //!< Returns reference frame as NAIF ID
+      bool hasVelocity() const; //!< Returns true if every viewed state has a velocity
+      size_t getStartIndex() const; //!< Returns the index of the first viewed state
+      size_t size() const; //!< Returns the number of viewed states
+
+    private:
+      const States &m_states; //!< The states being viewed
+      size_t m_start; //!< The index of the first viewed state
+      size_t m_size; //!< The number of viewed states
+      bool m_hasVelocity; //!< If the viewed states have velocities
+  };
 }
 
 #endif
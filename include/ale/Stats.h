@@ -0,0 +1,91 @@
+#ifndef ALE_STATS_H
+#define ALE_STATS_H
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+namespace ale {
+
+  /**
+   * Timings and sizes for the stages of loading an ISD.
+   *
+   * Pass a Stats to ale::load, ale::loads, or the Isd constructors to have
+   * each stage recorded as it finishes. Nothing is recorded, and nothing
+   * is timed, if no Stats is passed. Stages are recorded in the order they
+   * finish, and a stage that throws is still recorded before the exception
+   * leaves it.
+   *
+   * A Stats is not safe to record into from multiple threads at once. Use
+   * one per load.
+   */
+  class Stats {
+    public:
+      /** A finished stage **/
+      struct Stage {
+        std::string name; //!< The name of the stage
+        double seconds; //!< The wall clock time the stage took
+        size_t size; //!< The number of bytes or entries the stage produced, 0 if not applicable
+      };
+
+      /**
+       * Times a stage from construction until it is stopped or destroyed
+       * and records it in a Stats. If the Stats is null, the timer does nothing.
+       */
+      class Timer {
+        public:
+          Timer(Stats *stats, const std::string &name);
+          ~Timer();
+
+          /** Set the size recorded with the stage **/
+          void setSize(size_t size);
+
+          /** Record the stage now instead of when the timer is destroyed **/
+          void stop();
+
+        private:
+          Timer(const Timer &) = delete;
+          Timer &operator=(const Timer &) = delete;
+
+          Stats *m_stats; //!< The stats to record into, may be null
+          std::string m_name; //!< The name of the stage
+          size_t m_size; //!< The size recorded with the stage
+          std::chrono::steady_clock::time_point m_start; //!< When the stage started
+      };
+
+      /**
+       * Record a finished stage.
+       */
+      void addStage(const std::string &name, double seconds, size_t size=0);
+
+      /**
+       * Get the first recorded stage with a name.
+       *
+       * @throws std::invalid_argument If no stage has the name
+       */
+      const Stage &getStage(const std::string &name) const;
+
+      /** Returns true if a stage with a name has been recorded **/
+      bool hasStage(const std::string &name) const;
+
+      /** The total time of every stage with a name **/
+      double totalSeconds(const std::string &name) const;
+
+      /** Forget every recorded stage and the Python statistics **/
+      void clear();
+
+      /**
+       * Get the stages and Python statistics as JSON, in the form
+       * {"stages": [{"name": , "seconds": , "size": }, ...], "python": {...}}
+       */
+      nlohmann::json toJson() const;
+
+      std::vector<Stage> stages; //!< The recorded stages, in the order they finished
+      nlohmann::json python; //!< The statistics recorded by the ale Python library, if any
+  };
+}
+
+#endif
@@ -0,0 +1,84 @@
+#ifndef ALE_THREADPOOL_H
+#define ALE_THREADPOOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ale {
+
+  /**
+   * A fixed set of worker threads for evaluating batches of times in parallel.
+   *
+   * Work is split into contiguous chunks. The calling thread works on the
+   * batch as well, and while it waits for the last chunks it runs queued
+   * chunks from any batch, so a task can itself call parallelFor on the same
+   * pool without deadlocking.
+   *
+   * If ale is built with ALE_USE_THREADS off, no workers are started and
+   * every batch runs on the calling thread.
+   *
+   * It is safe to call parallelFor from multiple threads at once.
+   */
+  class ThreadPool {
+    public:
+      /**
+       * The function run on each chunk. It is given the first index in the
+       * chunk and one past the last index in the chunk.
+       */
+      typedef std::function<void(size_t begin, size_t end)> Task;
+
+      /**
+       * Create a thread pool.
+       *
+       * @param numThreads The number of threads to split work across,
+       *                   including the calling thread. If 0, the number of
+       *                   hardware threads is used.
+       */
+      explicit ThreadPool(size_t numThreads=0);
+
+      /**
+       * Stops the workers. Any parallelFor calls must have returned.
+       */
+      ~ThreadPool();
+
+      /** The number of threads work is split across, including the calling thread **/
+      size_t getNumThreads() const;
+
+      /**
+       * Run a task over [0, count) in parallel and wait for it to finish.
+       *
+       * @param count The number of indices
+       * @param task The function to run on each chunk of indices
+       * @param minChunkSize The smallest number of indices worth giving to a
+       *                     thread. Batches smaller than twice this are run
+       *                     on the calling thread.
+       *
+       * @throws The first exception thrown by the task, after every chunk has finished
+       */
+      void parallelFor(size_t count, const Task &task, size_t minChunkSize=256);
+
+    private:
+      ThreadPool(const ThreadPool &) = delete;
+      ThreadPool &operator=(const ThreadPool &) = delete;
+
+      /** Run queued jobs until stopping **/
+      void work();
+
+      /** Run one queued job, if there are any. Returns false if there were none. **/
+      bool runQueuedJob();
+
+      size_t m_numThreads; //!< The number of threads work is split across
+      std::vector<std::thread> m_workers; //!< The worker threads
+      std::deque<std::function<void()>> m_jobs; //!< The queued chunks
+      std::mutex m_mutex; //!< Guards the jobs and stopping
+      std::condition_variable m_jobAdded; //!< Signalled when a job is queued or stopping is set
+      bool m_stopping; //!< If the workers should exit
+  };
+}
+
+#endif
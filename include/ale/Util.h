@@ -13,7 +13,7 @@
 namespace ale {
 
   template<typename T>
-  std::vector<T> getJsonArray(nlohmann::json obj) {
+  std::vector<T> getJsonArray(const nlohmann::json &obj) {
     std::vector<T> positions;
     try {
       for (auto &location : obj) {
@@ -26,48 +26,48 @@ namespace ale {
   }
 
 
-  PositionInterpolation getInterpolationMethod(nlohmann::json isd);
-  double getMinHeight(nlohmann::json isd);
-  std::string getSensorModelName(nlohmann::json isd);
-  std::string getImageId(nlohmann::json isd);
-  std::string getSensorName(nlohmann::json isd);
-  std::string getPlatformName(nlohmann::json isd);
-  std::string getLogFile(nlohmann::json isd);
-  std::string getIsisCameraVersion(nlohmann::json isd);
-  std::string getProjection(nlohmann::json isd);
+  PositionInterpolation getInterpolationMethod(const nlohmann::json &isd);
+  double getMinHeight(const nlohmann::json &isd);
+  std::string getSensorModelName(const nlohmann::json &isd);
+  std::string getImageId(const nlohmann::json &isd);
+  std::string getSensorName(const nlohmann::json &isd);
+  std::string getPlatformName(const nlohmann::json &isd);
+  std::string getLogFile(const nlohmann::json &isd);
+  std::string getIsisCameraVersion(const nlohmann::json &isd);
+  std::string getProjection(const nlohmann::json &isd);
   
-  int getTotalLines(nlohmann::json isd);
-  int getTotalSamples(nlohmann::json isd);
-  double getStartingTime(nlohmann::json isd);
-  double getCenterTime(nlohmann::json isd);
-  std::vector<std::vector<double>> getLineScanRate(nlohmann::json isd);
-  int getSampleSumming(nlohmann::json isd);
-  int getLineSumming(nlohmann::json isd);
-  double getFocalLength(nlohmann::json isd);
-  double getFocalLengthUncertainty(nlohmann::json isd);
-  std::vector<double> getFocal2PixelLines(nlohmann::json isd);
-  std::vector<double> getFocal2PixelSamples(nlohmann::json isd);
-  std::vector<double> getGeoTransform(nlohmann::json isd);
-  double getDetectorCenterLine(nlohmann::json isd);
-  double getDetectorCenterSample(nlohmann::json isd);
-  double getDetectorStartingLine(nlohmann::json isd);
-  double getDetectorStartingSample(nlohmann::json isd);
-  double getMinHeight(nlohmann::json isd);
-  double getMaxHeight(nlohmann::json isd);
-  double getSemiMajorRadius(nlohmann::json isd);
-  double getSemiMinorRadius(nlohmann::json isd);
-  DistortionType getDistortionModel(nlohmann::json isd);
-  std::vector<double> getDistortionCoeffs(nlohmann::json isd);
+  int getTotalLines(const nlohmann::json &isd);
+  int getTotalSamples(const nlohmann::json &isd);
+  double getStartingTime(const nlohmann::json &isd);
+  double getCenterTime(const nlohmann::json &isd);
+  std::vector<std::vector<double>> getLineScanRate(const nlohmann::json &isd);
+  int getSampleSumming(const nlohmann::json &isd);
+  int getLineSumming(const nlohmann::json &isd);
+  double getFocalLength(const nlohmann::json &isd);
+  double getFocalLengthUncertainty(const nlohmann::json &isd);
+  std::vector<double> getFocal2PixelLines(const nlohmann::json &isd);
+  std::vector<double> getFocal2PixelSamples(const nlohmann::json &isd);
+  std::vector<double> getGeoTransform(const nlohmann::json &isd);
+  double getDetectorCenterLine(const nlohmann::json &isd);
+  double getDetectorCenterSample(const nlohmann::json &isd);
+  double getDetectorStartingLine(const nlohmann::json &isd);
+  double getDetectorStartingSample(const nlohmann::json &isd);
+  double getMinHeight(const nlohmann::json &isd);
+  double getMaxHeight(const nlohmann::json &isd);
+  double getSemiMajorRadius(const nlohmann::json &isd);
+  double getSemiMinorRadius(const nlohmann::json &isd);
+  DistortionType getDistortionModel(const nlohmann::json &isd);
+  std::vector<double> getDistortionCoeffs(const nlohmann::json &isd);
 
-  std::vector<double> getJsonDoubleArray(nlohmann::json obj);
-  std::vector<Vec3d> getJsonVec3dArray(nlohmann::json obj);
-  std::vector<Rotation> getJsonQuatArray(nlohmann::json obj);
+  std::vector<double> getJsonDoubleArray(const nlohmann::json &obj);
+  std::vector<Vec3d> getJsonVec3dArray(const nlohmann::json &obj);
+  std::vector<Rotation> getJsonQuatArray(const nlohmann::json &obj);
 
-  States getInstrumentPosition(nlohmann::json isd);
-  States getSunPosition(nlohmann::json isd);
+  States getInstrumentPosition(const nlohmann::json &isd);
+  States getSunPosition(const nlohmann::json &isd);
 
-  Orientations getBodyRotation(nlohmann::json isd);
-  Orientations getInstrumentPointing(nlohmann::json isd);
+  Orientations getBodyRotation(const nlohmann::json &isd);
+  Orientations getInstrumentPointing(const nlohmann::json &isd);
 }
 
 #endif
@@ -31,14 +31,14 @@ namespace ale {
       return *this;
     };
 
-    Vec3d &operator+=(Vec3d addend) {
+    Vec3d &operator+=(const Vec3d &addend) {
       x += addend.x;
       y += addend.y;
       z += addend.z;
       return *this;
     };
 
-    Vec3d &operator-=(Vec3d addend) {
+    Vec3d &operator-=(const Vec3d &addend) {
       x -= addend.x;
       y -= addend.y;
       z -= addend.z;
@@ -50,13 +50,21 @@ namespace ale {
     }
   };
 
-  Vec3d operator*(double scalar, Vec3d vec);
+  inline Vec3d operator*(double scalar, Vec3d vec) {
+    return vec *= scalar;
+  }
 
-  Vec3d operator*(Vec3d vec, double scalar);
+  inline Vec3d operator*(Vec3d vec, double scalar) {
+    return vec *= scalar;
+  }
 
-  Vec3d operator+(Vec3d leftVec, const Vec3d &rightVec);
+  inline Vec3d operator+(Vec3d leftVec, const Vec3d &rightVec) {
+    return leftVec += rightVec;
+  }
 
-  Vec3d operator-(Vec3d leftVec, const Vec3d &rightVec);
+  inline Vec3d operator-(Vec3d leftVec, const Vec3d &rightVec) {
+    return leftVec -= rightVec;
+  }
 }
 
 #endif
@@ -0,0 +1,560 @@
+#include "ale/BinaryIsd.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#if defined(_WIN32)
+#include <iterator>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "ale/Isd.h"
+#include "ale/Util.h"
+
+using json = nlohmann::json;
+
+namespace ale {
+
+  namespace {
+    const char MAGIC[8] = {'A', 'L', 'E', 'B', 'I', 'S', 'D', '\0'};
+    const size_t HEADER_SIZE = 32;
+    const size_t ENTRY_SIZE = 64;
+    const size_t NAME_SIZE = 24;
+    const size_t ALIGNMENT = 64;
+
+    // The arrays that are stored as raw doubles and their number of columns
+    struct ArrayColumns {
+      std::string section;
+      std::string name;
+      size_t columns;
+    };
+
+    const ArrayColumns ARRAY_COLUMNS[] = {
+      {"instrument_position", "ephemeris_times", 1},
+      {"instrument_position", "positions", 3},
+      {"instrument_position", "velocities", 3},
+      {"sun_position", "ephemeris_times", 1},
+      {"sun_position", "positions", 3},
+      {"sun_position", "velocities", 3},
+      {"instrument_pointing", "ephemeris_times", 1},
+      {"instrument_pointing", "quaternions", 4},
+      {"instrument_pointing", "angular_velocities", 3},
+      {"body_rotation", "ephemeris_times", 1},
+      {"body_rotation", "quaternions", 4},
+      {"body_rotation", "angular_velocities", 3}
+    };
+
+    // An array that is being written to a binary ISD
+    struct WriteArray {
+      std::string section;
+      std::string name;
+      std::vector<double> values;
+      size_t columns;
+    };
+
+    bool isLittleEndian() {
+      const uint16_t one = 1;
+      unsigned char firstByte;
+      std::memcpy(&firstByte, &one, 1);
+      return firstByte == 1;
+    }
+
+    template<typename T>
+    T readValue(const char *data) {
+      T value;
+      std::memcpy(&value, data, sizeof(T));
+      return value;
+    }
+
+    template<typename T>
+    void writeValue(std::vector<char> &buffer, size_t offset, T value) {
+      std::memcpy(&buffer[offset], &value, sizeof(T));
+    }
+
+    std::string readName(const char *data) {
+      return std::string(data, std::find(data, data + NAME_SIZE, '\0'));
+    }
+
+    size_t align(size_t offset) {
+      return (offset + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+    }
+
+    std::string distortionName(DistortionType distortion) {
+      switch (distortion) {
+        case DistortionType::TRANSVERSE:
+          return "transverse";
+        case DistortionType::RADIAL:
+          return "radial";
+        case DistortionType::KAGUYALISM:
+          return "kaguyalism";
+        case DistortionType::DAWNFC:
+          return "dawnfc";
+        case DistortionType::LROLROCNAC:
+          return "lrolrocnac";
+        case DistortionType::CAHVOR:
+          return "cahvor";
+        case DistortionType::LUNARORBITER:
+          return "lunarorbiter";
+        case DistortionType::RADTAN:
+          return "radtan";
+      }
+      throw std::invalid_argument("Unsupported distortion model.");
+    }
+
+    // The inverse of getDistortionCoeffs
+    json distortionJson(DistortionType distortion, const std::vector<double> &coeffs) {
+      json model;
+      switch (distortion) {
+        case DistortionType::TRANSVERSE:
+          if (coeffs.size() != 20) {
+            throw std::invalid_argument("Transverse distortion must have 20 coefficients.");
+          }
+          model["x"] = std::vector<double>(coeffs.begin(), coeffs.begin() + 10);
+          model["y"] = std::vector<double>(coeffs.begin() + 10, coeffs.end());
+          break;
+        case DistortionType::KAGUYALISM:
+          if (coeffs.size() != 10) {
+            throw std::invalid_argument("Kaguya LISM distortion must have 10 coefficients.");
+          }
+          model["boresight_x"] = coeffs[0];
+          model["x"] = std::vector<double>(coeffs.begin() + 1, coeffs.begin() + 5);
+          model["boresight_y"] = coeffs[5];
+          model["y"] = std::vector<double>(coeffs.begin() + 6, coeffs.end());
+          break;
+        case DistortionType::LUNARORBITER:
+          if (coeffs.size() != 4) {
+            throw std::invalid_argument("Lunar Orbiter distortion must have 4 coefficients.");
+          }
+          model["perspective_x"] = coeffs[0];
+          model["perspective_y"] = coeffs[1];
+          model["center_point_x"] = coeffs[2];
+          model["center_point_y"] = coeffs[3];
+          break;
+        default:
+          model["coefficients"] = coeffs;
+          break;
+      }
+      json optical;
+      optical[distortionName(distortion)] = model;
+      return optical;
+    }
+
+    std::string interpolationName(PositionInterpolation interp) {
+      switch (interp) {
+        case LINEAR:
+          return "linear";
+        case SPLINE:
+          return "spline";
+        case LAGRANGE:
+          return "lagrange";
+      }
+      throw std::invalid_argument("Unsupported interpolation method.");
+    }
+
+    json statesJson(const States &states, const std::string &section,
+                    std::vector<WriteArray> &arrays) {
+      std::vector<State> stateVec = states.getStates();
+      WriteArray times = {section, "ephemeris_times", states.getTimes(), 1};
+      WriteArray positions = {section, "positions", std::vector<double>(), 3};
+      WriteArray velocities = {section, "velocities", std::vector<double>(), 3};
+      positions.values.reserve(3 * stateVec.size());
+      velocities.values.reserve(3 * stateVec.size());
+      for (const State &state : stateVec) {
+        positions.values.insert(positions.values.end(),
+                                {state.position.x, state.position.y, state.position.z});
+        velocities.values.insert(velocities.values.end(),
+                                 {state.velocity.x, state.velocity.y, state.velocity.z});
+      }
+      arrays.push_back(times);
+      arrays.push_back(positions);
+      if (states.hasVelocity()) {
+        arrays.push_back(velocities);
+      }
+
+      json metadata;
+      metadata["reference_frame"] = states.getReferenceFrame();
+      return metadata;
+    }
+
+    json orientationsJson(const Orientations &orientations, const std::string &section,
+                          std::vector<WriteArray> &arrays) {
+      std::vector<Rotation> rotations = orientations.getRotations();
+      std::vector<Vec3d> avs = orientations.getAngularVelocities();
+      WriteArray times = {section, "ephemeris_times", orientations.getTimes(), 1};
+      WriteArray quaternions = {section, "quaternions", std::vector<double>(), 4};
+      WriteArray angularVelocities = {section, "angular_velocities", std::vector<double>(), 3};
+      quaternions.values.reserve(4 * rotations.size());
+      for (const Rotation &rotation : rotations) {
+        std::vector<double> quat = rotation.toQuaternion();
+        quaternions.values.insert(quaternions.values.end(), quat.begin(), quat.end());
+      }
+      angularVelocities.values.reserve(3 * avs.size());
+      for (const Vec3d &av : avs) {
+        angularVelocities.values.insert(angularVelocities.values.end(), {av.x, av.y, av.z});
+      }
+      arrays.push_back(times);
+      arrays.push_back(quaternions);
+      if (!avs.empty()) {
+        arrays.push_back(angularVelocities);
+      }
+
+      json metadata;
+      metadata["constant_frames"] = orientations.getConstantFrames();
+      metadata["time_dependent_frames"] = orientations.getTimeDependentFrames();
+      metadata["constant_rotation"] = orientations.getConstantRotation().toRotationMatrix();
+      return metadata;
+    }
+
+
+    // Write the metadata and arrays to a binary ISD file
+    void writeFile(const json &metadata, const std::vector<WriteArray> &arrays, const std::string &path) {
+      std::string metadataString = metadata.dump();
+
+      // Lay out the file
+      size_t metadataOffset = HEADER_SIZE + arrays.size() * ENTRY_SIZE;
+      size_t offset = align(metadataOffset + metadataString.size());
+      std::vector<size_t> arrayOffsets;
+      for (const WriteArray &array : arrays) {
+        arrayOffsets.push_back(offset);
+        offset = align(offset + array.values.size() * sizeof(double));
+      }
+
+      std::vector<char> buffer(offset, '\0');
+      std::memcpy(&buffer[0], MAGIC, sizeof(MAGIC));
+      writeValue<uint32_t>(buffer, 8, BinaryIsd::VERSION);
+      writeValue<uint32_t>(buffer, 12, static_cast<uint32_t>(arrays.size()));
+      writeValue<uint64_t>(buffer, 16, metadataOffset);
+      writeValue<uint64_t>(buffer, 24, metadataString.size());
+      for (size_t i = 0; i < arrays.size(); i++) {
+        const WriteArray &array = arrays[i];
+        size_t entry = HEADER_SIZE + i * ENTRY_SIZE;
+        std::memcpy(&buffer[entry], array.section.data(), std::min(array.section.size(), NAME_SIZE - 1));
+        std::memcpy(&buffer[entry + NAME_SIZE], array.name.data(), std::min(array.name.size(), NAME_SIZE - 1));
+        writeValue<uint64_t>(buffer, entry + 2 * NAME_SIZE, arrayOffsets[i]);
+        writeValue<uint32_t>(buffer, entry + 2 * NAME_SIZE + 8,
+                             static_cast<uint32_t>(array.values.size() / array.columns));
+        writeValue<uint32_t>(buffer, entry + 2 * NAME_SIZE + 12, static_cast<uint32_t>(array.columns));
+        if (!array.values.empty()) {
+          std::memcpy(&buffer[arrayOffsets[i]], array.values.data(), array.values.size() * sizeof(double));
+        }
+      }
+      std::memcpy(&buffer[metadataOffset], metadataString.data(), metadataString.size());
+
+      std::ofstream file(path, std::ios::binary | std::ios::trunc);
+      if (!file) {
+        throw std::runtime_error("Could not open " + path + " for writing.");
+      }
+      file.write(buffer.data(), buffer.size());
+      if (!file) {
+        throw std::runtime_error("Could not write the binary ISD " + path + ".");
+      }
+    }
+  }
+
+
+  BinaryIsd::BinaryIsd(const std::string &path) :
+    m_data(nullptr), m_size(0), m_mapped(false) {
+    if (!isLittleEndian()) {
+      throw std::runtime_error("Binary ISDs can only be read on little endian systems.");
+    }
+
+#if defined(_WIN32)
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+      throw std::runtime_error("Could not open the binary ISD " + path + ".");
+    }
+    m_buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    m_data = m_buffer.data();
+    m_size = m_buffer.size();
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+      throw std::runtime_error("Could not open the binary ISD " + path + ".");
+    }
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) != 0) {
+      close(fd);
+      throw std::runtime_error("Could not read the size of the binary ISD " + path + ".");
+    }
+    m_size = static_cast<size_t>(fileStat.st_size);
+    if (m_size > 0) {
+      void *mapped = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (mapped == MAP_FAILED) {
+        close(fd);
+        throw std::runtime_error("Could not map the binary ISD " + path + ".");
+      }
+      m_data = static_cast<const char *>(mapped);
+      m_mapped = true;
+    }
+    close(fd);
+#endif
+
+    try {
+      if (m_size < HEADER_SIZE || std::memcmp(m_data, MAGIC, sizeof(MAGIC)) != 0) {
+        throw std::runtime_error("The file " + path + " is not a binary ISD.");
+      }
+      uint32_t version = readValue<uint32_t>(m_data + 8);
+      if (version != VERSION) {
+        throw std::runtime_error("Unsupported binary ISD version " + std::to_string(version) + ".");
+      }
+      size_t numArrays = readValue<uint32_t>(m_data + 12);
+      size_t metadataOffset = readValue<uint64_t>(m_data + 16);
+      size_t metadataSize = readValue<uint64_t>(m_data + 24);
+      if (HEADER_SIZE + numArrays * ENTRY_SIZE > m_size
+          || metadataOffset > m_size || metadataSize > m_size - metadataOffset) {
+        throw std::runtime_error("The binary ISD " + path + " is truncated.");
+      }
+
+      for (size_t i = 0; i < numArrays; i++) {
+        const char *entry = m_data + HEADER_SIZE + i * ENTRY_SIZE;
+        Array array;
+        array.offset = readValue<uint64_t>(entry + 2 * NAME_SIZE);
+        array.rows = readValue<uint32_t>(entry + 2 * NAME_SIZE + 8);
+        array.columns = readValue<uint32_t>(entry + 2 * NAME_SIZE + 12);
+        if (array.offset % sizeof(double) != 0 || array.offset > m_size
+            || array.rows * array.columns > (m_size - array.offset) / sizeof(double)) {
+          throw std::runtime_error("The binary ISD " + path + " is truncated.");
+        }
+        m_arrays[readName(entry) + "/" + readName(entry + NAME_SIZE)] = array;
+      }
+
+      m_metadata = json::parse(m_data + metadataOffset, m_data + metadataOffset + metadataSize);
+    }
+    catch (...) {
+#if !defined(_WIN32)
+      if (m_mapped) {
+        munmap(const_cast<char *>(m_data), m_size);
+      }
+#endif
+      throw;
+    }
+  }
+
+
+  BinaryIsd::~BinaryIsd() {
+#if !defined(_WIN32)
+    if (m_mapped) {
+      munmap(const_cast<char *>(m_data), m_size);
+    }
+#endif
+  }
+
+
+  const json &BinaryIsd::getMetadata() const {
+    return m_metadata;
+  }
+
+
+  bool BinaryIsd::hasArray(const std::string &section, const std::string &name) const {
+    return m_arrays.find(section + "/" + name) != m_arrays.end();
+  }
+
+
+  const double *BinaryIsd::getArray(const std::string &section, const std::string &name,
+                                    size_t &rows, size_t &columns) const {
+    std::map<std::string, Array>::const_iterator it = m_arrays.find(section + "/" + name);
+    if (it == m_arrays.end()) {
+      throw std::invalid_argument("The binary ISD does not have a " + section + " " + name + " array.");
+    }
+    rows = it->second.rows;
+    columns = it->second.columns;
+    // The writer aligns arrays, so this is a valid double pointer on
+    // little endian systems
+    return reinterpret_cast<const double *>(m_data + it->second.offset);
+  }
+
+
+  States BinaryIsd::getStates(const std::string &section) const {
+    size_t rows, columns;
+    const double *timeData = getArray(section, "ephemeris_times", rows, columns);
+    std::vector<double> times(timeData, timeData + rows * columns);
+
+    const double *positionData = getArray(section, "positions", rows, columns);
+    if (columns != 3) {
+      throw std::runtime_error("The " + section + " positions must have 3 columns.");
+    }
+    std::vector<Vec3d> positions;
+    positions.reserve(rows);
+    for (size_t i = 0; i < rows; i++) {
+      positions.push_back(Vec3d(positionData[3 * i], positionData[3 * i + 1], positionData[3 * i + 2]));
+    }
+
+    int refFrame = m_metadata.at(section).at("reference_frame").get<int>();
+
+    if (hasArray(section, "velocities")) {
+      const double *velocityData = getArray(section, "velocities", rows, columns);
+      if (columns != 3) {
+        throw std::runtime_error("The " + section + " velocities must have 3 columns.");
+      }
+      std::vector<Vec3d> velocities;
+      velocities.reserve(rows);
+      for (size_t i = 0; i < rows; i++) {
+        velocities.push_back(Vec3d(velocityData[3 * i], velocityData[3 * i + 1], velocityData[3 * i + 2]));
+      }
+      return States(times, positions, velocities, refFrame);
+    }
+
+    return States(times, positions, refFrame);
+  }
+
+
+  Orientations BinaryIsd::getOrientations(const std::string &section) const {
+    size_t rows, columns;
+    const double *timeData = getArray(section, "ephemeris_times", rows, columns);
+    std::vector<double> times(timeData, timeData + rows * columns);
+
+    const double *quatData = getArray(section, "quaternions", rows, columns);
+    if (columns != 4) {
+      throw std::runtime_error("The " + section + " quaternions must have 4 columns.");
+    }
+    std::vector<Rotation> rotations;
+    rotations.reserve(rows);
+    for (size_t i = 0; i < rows; i++) {
+      rotations.push_back(Rotation(quatData[4 * i], quatData[4 * i + 1], quatData[4 * i + 2], quatData[4 * i + 3]));
+    }
+
+    std::vector<Vec3d> avs;
+    if (hasArray(section, "angular_velocities")) {
+      const double *avData = getArray(section, "angular_velocities", rows, columns);
+      if (columns != 3) {
+        throw std::runtime_error("The " + section + " angular velocities must have 3 columns.");
+      }
+      avs.reserve(rows);
+      for (size_t i = 0; i < rows; i++) {
+        avs.push_back(Vec3d(avData[3 * i], avData[3 * i + 1], avData[3 * i + 2]));
+      }
+    }
+
+    const json &rotationJson = m_metadata.at(section);
+    std::vector<int> constFrames;
+    if (rotationJson.find("constant_frames") != rotationJson.end()) {
+      constFrames = getJsonArray<int>(rotationJson.at("constant_frames"));
+    }
+
+    std::vector<int> timeDepFrames;
+    if (rotationJson.find("time_dependent_frames") != rotationJson.end()) {
+      timeDepFrames = getJsonArray<int>(rotationJson.at("time_dependent_frames"));
+    }
+
+    std::vector<double> rotArray = {1,0,0,0,1,0,0,0,1};
+    if (rotationJson.find("constant_rotation") != rotationJson.end()) {
+      rotArray = getJsonArray<double>(rotationJson.at("constant_rotation"));
+    }
+
+    return Orientations(rotations, times, avs, Rotation(rotArray), constFrames, timeDepFrames);
+  }
+
+
+  void BinaryIsd::write(const Isd &isd, const std::string &path) {
+    if (!isLittleEndian()) {
+      throw std::runtime_error("Binary ISDs can only be written on little endian systems.");
+    }
+    std::vector<WriteArray> arrays;
+
+    json metadata;
+    metadata["name_model"] = isd.usgscsm_name_model;
+    metadata["image_identifier"] = isd.image_id;
+    metadata["name_platform"] = isd.name_platform;
+    metadata["name_sensor"] = isd.name_sensor;
+    metadata["image_lines"] = isd.image_lines;
+    metadata["image_samples"] = isd.image_samples;
+    metadata["starting_ephemeris_time"] = isd.starting_ephemeris_time;
+    metadata["center_ephemeris_time"] = isd.center_ephemeris_time;
+    if (!isd.line_scan_rate.empty()) {
+      metadata["line_scan_rate"] = isd.line_scan_rate;
+    }
+    metadata["detector_sample_summing"] = isd.detector_sample_summing;
+    metadata["detector_line_summing"] = isd.detector_line_summing;
+    metadata["focal_length_model"]["focal_length"] = isd.focal_length;
+    metadata["focal_length_model"]["focal_uncertainty"] = isd.focal_uncertainty;
+    metadata["focal2pixel_lines"] = isd.focal2pixel_line;
+    metadata["focal2pixel_samples"] = isd.focal2pixel_sample;
+    metadata["detector_center"]["line"] = isd.detector_center_line;
+    metadata["detector_center"]["sample"] = isd.detector_center_sample;
+    metadata["starting_detector_line"] = isd.starting_detector_line;
+    metadata["starting_detector_sample"] = isd.starting_detector_sample;
+    metadata["reference_height"]["minheight"] = isd.min_reference_height;
+    metadata["reference_height"]["maxheight"] = isd.max_reference_height;
+    metadata["radii"]["semimajor"] = isd.semi_major;
+    metadata["radii"]["semiminor"] = isd.semi_minor;
+    metadata["optical_distortion"] = distortionJson(isd.distortion_model, isd.distortion_coefficients);
+    metadata["interpolation_method"] = interpolationName(isd.interpMethod);
+    if (!isd.naif_keywords.is_null()) {
+      metadata["naif_keywords"] = isd.naif_keywords;
+    }
+    metadata["instrument_position"] = statesJson(isd.inst_pos, "instrument_position", arrays);
+    metadata["sun_position"] = statesJson(isd.sun_pos, "sun_position", arrays);
+    metadata["instrument_pointing"] = orientationsJson(isd.inst_pointing, "instrument_pointing", arrays);
+    metadata["body_rotation"] = orientationsJson(isd.body_rotation, "body_rotation", arrays);
+
+    writeFile(metadata, arrays, path);
+  }
+
+
+  void BinaryIsd::write(const json &isd, const std::string &path) {
+    if (!isLittleEndian()) {
+      throw std::runtime_error("Binary ISDs can only be written on little endian systems.");
+    }
+    json metadata = isd;
+    std::vector<WriteArray> arrays;
+    for (const ArrayColumns &arrayColumns : ARRAY_COLUMNS) {
+      if (!metadata.contains(arrayColumns.section)
+          || !metadata[arrayColumns.section].is_object()
+          || !metadata[arrayColumns.section].contains(arrayColumns.name)) {
+        continue;
+      }
+      json &section = metadata[arrayColumns.section];
+      WriteArray array = {arrayColumns.section, arrayColumns.name, std::vector<double>(), arrayColumns.columns};
+      try {
+        for (const json &row : section.at(arrayColumns.name)) {
+          if (arrayColumns.columns == 1) {
+            array.values.push_back(row.get<double>());
+            continue;
+          }
+          if (row.size() < arrayColumns.columns) {
+            throw std::runtime_error("Row too short");
+          }
+          for (size_t i = 0; i < arrayColumns.columns; i++) {
+            array.values.push_back(row.at(i).get<double>());
+          }
+        }
+      }
+      catch (...) {
+        throw std::invalid_argument("Could not write the " + arrayColumns.section + " "
+                                    + arrayColumns.name + " array.");
+      }
+      section.erase(arrayColumns.name);
+      arrays.push_back(array);
+    }
+    writeFile(metadata, arrays, path);
+  }
+
+
+  json BinaryIsd::toJson() const {
+    json isd = m_metadata;
+    for (const std::pair<const std::string, Array> &entry : m_arrays) {
+      size_t separator = entry.first.find('/');
+      std::string section = entry.first.substr(0, separator);
+      std::string name = entry.first.substr(separator + 1);
+      const double *data = reinterpret_cast<const double *>(m_data + entry.second.offset);
+      json values = json::array();
+      for (size_t row = 0; row < entry.second.rows; row++) {
+        if (entry.second.columns == 1) {
+          values.push_back(data[row]);
+        }
+        else {
+          const double *rowData = data + row * entry.second.columns;
+          values.push_back(std::vector<double>(rowData, rowData + entry.second.columns));
+        }
+      }
+      isd[section][name] = values;
+    }
+    return isd;
+  }
+}
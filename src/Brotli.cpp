@@ -0,0 +1,95 @@
+#include "ale/Brotli.h"
+
+#include <brotli/decode.h>
+
+#include <stdexcept>
+
+namespace ale {
+
+  namespace {
+    std::unique_ptr<std::ifstream> openCompressedFile(const std::string &path) {
+      std::unique_ptr<std::ifstream> file(new std::ifstream(path, std::ios::binary));
+      if (!file->is_open()) {
+        throw std::runtime_error("Could not open the compressed file " + path + ".");
+      }
+      return file;
+    }
+  }
+
+
+  BrotliStreambuf::BrotliStreambuf(std::istream &source, size_t bufferSize) :
+    m_source(source), m_decoder(BrotliDecoderCreateInstance(NULL, NULL, NULL)),
+    m_input(bufferSize), m_nextIn(NULL), m_availableIn(0), m_output(bufferSize), m_finished(false) {
+    if (!m_decoder) {
+      throw std::runtime_error("Could not create a brotli decoder.");
+    }
+    setg(m_output.data(), m_output.data(), m_output.data());
+  }
+
+
+  BrotliStreambuf::~BrotliStreambuf() {
+    BrotliDecoderDestroyInstance(m_decoder);
+  }
+
+
+  BrotliStreambuf::int_type BrotliStreambuf::underflow() {
+    if (gptr() < egptr()) {
+      return traits_type::to_int_type(*gptr());
+    }
+
+    // The decoder may finish a chunk without producing output, so keep
+    // going until there is output or the stream ends
+    while (!m_finished) {
+      if (m_availableIn == 0) {
+        m_source.read(reinterpret_cast<char *>(m_input.data()), m_input.size());
+        m_availableIn = static_cast<size_t>(m_source.gcount());
+        m_nextIn = m_input.data();
+      }
+
+      uint8_t *nextOut = reinterpret_cast<uint8_t *>(m_output.data());
+      size_t availableOut = m_output.size();
+      BrotliDecoderResult result = BrotliDecoderDecompressStream(m_decoder, &m_availableIn, &m_nextIn,
+                                                                 &availableOut, &nextOut, NULL);
+      if (result == BROTLI_DECODER_RESULT_ERROR) {
+        throw std::runtime_error(std::string("Could not decompress the brotli stream: ")
+                                 + BrotliDecoderErrorString(BrotliDecoderGetErrorCode(m_decoder)));
+      }
+      if (result == BROTLI_DECODER_RESULT_NEEDS_MORE_INPUT && m_availableIn == 0 && !m_source) {
+        throw std::runtime_error("Could not decompress the brotli stream, it is truncated.");
+      }
+      m_finished = result == BROTLI_DECODER_RESULT_SUCCESS;
+
+      size_t produced = m_output.size() - availableOut;
+      if (produced > 0) {
+        setg(m_output.data(), m_output.data(), m_output.data() + produced);
+        return traits_type::to_int_type(*gptr());
+      }
+    }
+    return traits_type::eof();
+  }
+
+
+  BrotliIstream::BrotliIstream(std::istream &source) : std::istream(NULL), m_buffer(source) {
+    rdbuf(&m_buffer);
+  }
+
+
+  BrotliIstream::BrotliIstream(const std::string &path) :
+    std::istream(NULL), m_file(openCompressedFile(path)), m_buffer(*m_file) {
+    rdbuf(&m_buffer);
+  }
+
+
+  Isd readBrotliIsd(const std::string &path, Stats *stats) {
+    BrotliIstream stream(path);
+    // Let decompression errors through instead of only setting the bad bit
+    stream.exceptions(std::ios::badbit);
+    stream >> std::ws;
+    if (stream.peek() == '"') {
+      // An ISD compressed as a JSON string
+      std::string isd = nlohmann::json::parse(stream).get<std::string>();
+      return Isd(isd, stats);
+    }
+    return Isd(stream, stats);
+  }
+}
@@ -0,0 +1,492 @@
+#include "ale/Chebyshev.h"
+
+#include <Eigen/Dense>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+namespace ale {
+
+  namespace {
+    // Chebyshev polynomials and their derivatives with respect to s
+    void chebyshevBasis(double s, size_t numCoefficients, double *values, double *derivatives) {
+      values[0] = 1;
+      derivatives[0] = 0;
+      if (numCoefficients > 1) {
+        values[1] = s;
+        derivatives[1] = 1;
+      }
+      for (size_t i = 2; i < numCoefficients; i++) {
+        values[i] = 2 * s * values[i - 1] - values[i - 2];
+        derivatives[i] = 2 * values[i - 1] + 2 * s * derivatives[i - 1] - derivatives[i - 2];
+      }
+    }
+
+    // Fits the samples from first to last into one segment
+    class SegmentFitter {
+      public:
+        SegmentFitter(const std::vector<double> &times, const std::vector<double> &values,
+                      const std::vector<double> *derivatives, size_t numComponents,
+                      size_t numDerivatives, size_t degree, const std::vector<double> &tolerances) :
+          m_times(times), m_values(values), m_derivatives(derivatives),
+          m_numComponents(numComponents), m_numDerivatives(derivatives ? numDerivatives : 0),
+          m_degree(degree), m_tolerances(tolerances),
+          m_basis(degree + 1), m_basisDerivatives(degree + 1) {}
+
+        /**
+         * Fit the samples and check them against the tolerances.
+         *
+         * @param coefficients The output coefficients, (degree + 1) per component
+         *
+         * @return If every sample is within the tolerances
+         */
+        bool fit(size_t first, size_t last, std::vector<double> &coefficients) {
+          size_t count = last - first + 1;
+          double midpoint = (m_times[first] + m_times[last]) / 2;
+          double radius = (m_times[last] - m_times[first]) / 2;
+          coefficients.assign((m_degree + 1) * m_numComponents, 0);
+
+          size_t valueDegree = std::min(m_degree, count - 1);
+          size_t derivativeDegree = std::min(m_degree, 2 * count - 1);
+          if (radius == 0) {
+            valueDegree = derivativeDegree = 0;
+          }
+
+          // The value rows and then the derivative rows for the components with derivatives
+          Eigen::MatrixXd design(2 * count, m_degree + 1);
+          for (size_t i = 0; i < count; i++) {
+            double s = radius == 0 ? 0 : (m_times[first + i] - midpoint) / radius;
+            chebyshevBasis(s, m_degree + 1, m_basis.data(), m_basisDerivatives.data());
+            for (size_t k = 0; k <= m_degree; k++) {
+              design(i, k) = m_basis[k];
+              design(count + i, k) = m_basisDerivatives[k];
+            }
+          }
+
+          Eigen::ColPivHouseholderQR<Eigen::MatrixXd> valueQr(
+                design.topLeftCorner(count, valueDegree + 1));
+          Eigen::ColPivHouseholderQR<Eigen::MatrixXd> derivativeQr;
+          if (m_numDerivatives > 0) {
+            derivativeQr.compute(design.leftCols(derivativeDegree + 1));
+          }
+
+          Eigen::VectorXd rhs(2 * count);
+          for (size_t component = 0; component < m_numComponents; component++) {
+            for (size_t i = 0; i < count; i++) {
+              rhs(i) = m_values[(first + i) * m_numComponents + component];
+            }
+            Eigen::VectorXd solution;
+            if (component < m_numDerivatives) {
+              for (size_t i = 0; i < count; i++) {
+                // Derivatives with respect to s instead of time
+                rhs(count + i) = (*m_derivatives)[(first + i) * m_numDerivatives + component] * radius;
+              }
+              solution = derivativeQr.solve(rhs);
+            }
+            else {
+              solution = valueQr.solve(rhs.head(count));
+            }
+            for (Eigen::Index k = 0; k < solution.size(); k++) {
+              coefficients[component * (m_degree + 1) + k] = solution(k);
+            }
+          }
+
+          // Check the fit at every sample
+          for (size_t i = 0; i < count; i++) {
+            double s = radius == 0 ? 0 : (m_times[first + i] - midpoint) / radius;
+            chebyshevBasis(s, m_degree + 1, m_basis.data(), m_basisDerivatives.data());
+            for (size_t component = 0; component < m_numComponents; component++) {
+              const double *componentCoefficients = &coefficients[component * (m_degree + 1)];
+              double value = 0;
+              for (size_t k = 0; k <= m_degree; k++) {
+                value += componentCoefficients[k] * m_basis[k];
+              }
+              if (!(std::fabs(value - m_values[(first + i) * m_numComponents + component])
+                    <= m_tolerances[component])) {
+                return false;
+              }
+            }
+          }
+          return true;
+        }
+
+      private:
+        const std::vector<double> &m_times;
+        const std::vector<double> &m_values;
+        const std::vector<double> *m_derivatives;
+        size_t m_numComponents;
+        size_t m_numDerivatives;
+        size_t m_degree;
+        const std::vector<double> &m_tolerances;
+        std::vector<double> m_basis;
+        std::vector<double> m_basisDerivatives;
+    };
+  }
+
+
+  void chebyshevEvaluate(const double *coefficients, size_t numCoefficients, double s,
+                         double &value, double &derivative) {
+    double b1 = 0, b2 = 0;
+    double d1 = 0, d2 = 0;
+    for (size_t k = numCoefficients - 1; k > 0; k--) {
+      double d0 = 2 * b1 + 2 * s * d1 - d2;
+      double b0 = coefficients[k] + 2 * s * b1 - b2;
+      d2 = d1;
+      d1 = d0;
+      b2 = b1;
+      b1 = b0;
+    }
+    value = coefficients[0] + s * b1 - b2;
+    derivative = b1 + s * d1 - d2;
+  }
+
+
+  ChebyshevSeries::ChebyshevSeries() : m_numComponents(0), m_degree(0) {}
+
+
+  ChebyshevSeries::ChebyshevSeries(const std::vector<double> &boundaries,
+                                   const std::vector<double> &coefficients,
+                                   size_t numComponents, size_t degree) :
+    m_boundaries(boundaries), m_coefficients(coefficients),
+    m_numComponents(numComponents), m_degree(degree) {
+    if (m_boundaries.size() < 2) {
+      throw std::invalid_argument("There must be at least one segment.");
+    }
+    if (m_coefficients.size() != (m_boundaries.size() - 1) * m_numComponents * (m_degree + 1)) {
+      throw std::invalid_argument("The number of coefficients does not match the number of "
+                                  "segments, components, and the degree.");
+    }
+    if (!std::is_sorted(m_boundaries.begin(), m_boundaries.end())) {
+      throw std::invalid_argument("The segment boundaries must be sorted.");
+    }
+  }
+
+
+  ChebyshevSeries ChebyshevSeries::fit(const std::vector<double> &times,
+                                       const std::vector<double> &values,
+                                       const std::vector<double> *derivatives,
+                                       size_t numComponents, size_t numDerivatives,
+                                       size_t degree, const std::vector<double> &tolerances) {
+    size_t numTimes = times.size();
+    if (numTimes == 0) {
+      throw std::invalid_argument("There must be at least one time to fit.");
+    }
+    if (values.size() != numTimes * numComponents) {
+      throw std::invalid_argument("The number of values must be the number of times times the "
+                                  "number of components.");
+    }
+    if (derivatives && (numDerivatives > numComponents
+                        || derivatives->size() != numTimes * numDerivatives)) {
+      throw std::invalid_argument("The number of derivatives must be the number of times times "
+                                  "the number of components with derivatives.");
+    }
+    if (tolerances.size() != numComponents) {
+      throw std::invalid_argument("There must be a tolerance for every component.");
+    }
+    if (!std::is_sorted(times.begin(), times.end())) {
+      throw std::invalid_argument("The times to fit must be sorted.");
+    }
+
+    SegmentFitter fitter(times, values, derivatives, numComponents, numDerivatives,
+                         degree, tolerances);
+    std::vector<double> boundaries(1, times[0]);
+    std::vector<double> coefficients;
+    std::vector<double> segmentCoefficients;
+
+    if (numTimes == 1) {
+      fitter.fit(0, 0, segmentCoefficients);
+      boundaries.push_back(times[0]);
+      return ChebyshevSeries(boundaries, segmentCoefficients, numComponents, degree);
+    }
+
+    size_t first = 0;
+    while (first < numTimes - 1) {
+      // Grow the segment exponentially and then binary search for its end.
+      // A segment with two samples interpolates them, unless there are
+      // derivatives and the degree is too low for a cubic Hermite fit.
+      size_t good = first + 1;
+      size_t bad = numTimes;
+      size_t step = 2;
+      while (good < numTimes - 1) {
+        size_t candidate = std::min(first + step, numTimes - 1);
+        if (fitter.fit(first, candidate, segmentCoefficients)) {
+          good = candidate;
+          step *= 2;
+        }
+        else {
+          bad = candidate;
+          break;
+        }
+      }
+      while (bad != numTimes && bad - good > 1) {
+        size_t middle = good + (bad - good) / 2;
+        if (fitter.fit(first, middle, segmentCoefficients)) {
+          good = middle;
+        }
+        else {
+          bad = middle;
+        }
+      }
+
+      if (!fitter.fit(first, good, segmentCoefficients)) {
+        throw std::invalid_argument("The samples cannot be fit within the tolerances at degree "
+                                    + std::to_string(degree) + ". Increase the degree.");
+      }
+      coefficients.insert(coefficients.end(), segmentCoefficients.begin(), segmentCoefficients.end());
+      boundaries.push_back(times[good]);
+      first = good;
+    }
+    return ChebyshevSeries(boundaries, coefficients, numComponents, degree);
+  }
+
+
+  void ChebyshevSeries::evaluate(double time, double *values, double *derivatives) const {
+    if (m_boundaries.size() < 2) {
+      throw std::invalid_argument("Cannot evaluate an empty Chebyshev series.");
+    }
+    size_t segment = std::upper_bound(m_boundaries.begin() + 1, m_boundaries.end() - 1, time)
+                     - (m_boundaries.begin() + 1);
+    double start = m_boundaries[segment];
+    double stop = m_boundaries[segment + 1];
+    double midpoint = (start + stop) / 2;
+    double radius = (stop - start) / 2;
+    double s = radius == 0 ? 0 : (time - midpoint) / radius;
+
+    const double *segmentCoefficients = &m_coefficients[segment * m_numComponents * (m_degree + 1)];
+    for (size_t component = 0; component < m_numComponents; component++) {
+      double value, derivative;
+      chebyshevEvaluate(segmentCoefficients + component * (m_degree + 1), m_degree + 1, s, value, derivative);
+      values[component] = value;
+      if (derivatives) {
+        derivatives[component] = radius == 0 ? 0 : derivative / radius;
+      }
+    }
+  }
+
+
+  const std::vector<double> &ChebyshevSeries::getBoundaries() const {
+    return m_boundaries;
+  }
+
+
+  const std::vector<double> &ChebyshevSeries::getCoefficients() const {
+    return m_coefficients;
+  }
+
+
+  size_t ChebyshevSeries::getNumComponents() const {
+    return m_numComponents;
+  }
+
+
+  size_t ChebyshevSeries::getDegree() const {
+    return m_degree;
+  }
+
+
+  size_t ChebyshevSeries::getNumSegments() const {
+    return m_boundaries.empty() ? 0 : m_boundaries.size() - 1;
+  }
+
+
+  ChebyshevStates::ChebyshevStates() : m_refFrame(0) {}
+
+
+  ChebyshevStates::ChebyshevStates(const ChebyshevSeries &series, int refFrame) :
+    m_series(series), m_refFrame(refFrame) {
+    if (m_series.getNumComponents() != 3) {
+      throw std::invalid_argument("Chebyshev states must have 3 components.");
+    }
+  }
+
+
+  State ChebyshevStates::getState(double time) const {
+    double values[3];
+    double derivatives[3];
+    m_series.evaluate(time, values, derivatives);
+    return State(Vec3d(values[0], values[1], values[2]),
+                 Vec3d(derivatives[0], derivatives[1], derivatives[2]));
+  }
+
+
+  Vec3d ChebyshevStates::getPosition(double time) const {
+    double values[3];
+    m_series.evaluate(time, values);
+    return Vec3d(values[0], values[1], values[2]);
+  }
+
+
+  std::vector<State> ChebyshevStates::getStates(const std::vector<double> &times) const {
+    std::vector<State> states;
+    states.reserve(times.size());
+    for (double time : times) {
+      states.push_back(getState(time));
+    }
+    return states;
+  }
+
+
+  States ChebyshevStates::toStates(const std::vector<double> &times) const {
+    return States(times, getStates(times), m_refFrame);
+  }
+
+
+  const ChebyshevSeries &ChebyshevStates::getSeries() const {
+    return m_series;
+  }
+
+
+  int ChebyshevStates::getReferenceFrame() const {
+    return m_refFrame;
+  }
+
+
+  double ChebyshevStates::getStartTime() const {
+    return m_series.getBoundaries().front();
+  }
+
+
+  double ChebyshevStates::getStopTime() const {
+    return m_series.getBoundaries().back();
+  }
+
+
+  ChebyshevOrientations::ChebyshevOrientations() {}
+
+
+  ChebyshevOrientations::ChebyshevOrientations(const ChebyshevSeries &series,
+                                               const Rotation &constRot,
+                                               const std::vector<int> &constFrames,
+                                               const std::vector<int> &timeDepFrames) :
+    m_series(series), m_constRotation(constRot), m_constFrames(constFrames),
+    m_timeDepFrames(timeDepFrames) {
+    if (m_series.getNumComponents() != 4 && m_series.getNumComponents() != 7) {
+      throw std::invalid_argument("Chebyshev orientations must have 4 or 7 components.");
+    }
+  }
+
+
+  Rotation ChebyshevOrientations::interpolateTimeDep(double time) const {
+    double values[7];
+    m_series.evaluate(time, values);
+    // The rotation constructor normalizes the quaternion
+    return Rotation(values[0], values[1], values[2], values[3]);
+  }
+
+
+  Rotation ChebyshevOrientations::interpolate(double time) const {
+    return m_constRotation * interpolateTimeDep(time);
+  }
+
+
+  Vec3d ChebyshevOrientations::interpolateAV(double time) const {
+    if (!hasAngularVelocity()) {
+      throw std::invalid_argument("There are no angular velocities to interpolate.");
+    }
+    double values[7];
+    m_series.evaluate(time, values);
+    return Vec3d(values[4], values[5], values[6]);
+  }
+
+
+  bool ChebyshevOrientations::hasAngularVelocity() const {
+    return m_series.getNumComponents() == 7;
+  }
+
+
+  Orientations ChebyshevOrientations::toOrientations(const std::vector<double> &times) const {
+    std::vector<Rotation> rotations;
+    std::vector<Vec3d> avs;
+    rotations.reserve(times.size());
+    for (double time : times) {
+      rotations.push_back(interpolateTimeDep(time));
+      if (hasAngularVelocity()) {
+        avs.push_back(interpolateAV(time));
+      }
+    }
+    return Orientations(rotations, times, avs, m_constRotation, m_constFrames, m_timeDepFrames);
+  }
+
+
+  const ChebyshevSeries &ChebyshevOrientations::getSeries() const {
+    return m_series;
+  }
+
+
+  Rotation ChebyshevOrientations::getConstantRotation() const {
+    return m_constRotation;
+  }
+
+
+  std::vector<int> ChebyshevOrientations::getConstantFrames() const {
+    return m_constFrames;
+  }
+
+
+  std::vector<int> ChebyshevOrientations::getTimeDependentFrames() const {
+    return m_timeDepFrames;
+  }
+
+
+  double ChebyshevOrientations::getStartTime() const {
+    return m_series.getBoundaries().front();
+  }
+
+
+  double ChebyshevOrientations::getStopTime() const {
+    return m_series.getBoundaries().back();
+  }
+
+
+  ChebyshevStates States::fitChebyshev(double tolerance, size_t degree) const {
+    bool withVelocity = hasVelocity();
+    std::vector<double> positions;
+    std::vector<double> velocities;
+    positions.reserve(3 * m_ephemTimes.size());
+    for (size_t i = 0; i < m_ephemTimes.size(); i++) {
+      positions.insert(positions.end(), {m_positions[0][i], m_positions[1][i], m_positions[2][i]});
+      if (withVelocity) {
+        velocities.insert(velocities.end(), {m_velocities[0][i], m_velocities[1][i], m_velocities[2][i]});
+      }
+    }
+    ChebyshevSeries series = ChebyshevSeries::fit(m_ephemTimes, positions,
+                                                  withVelocity ? &velocities : nullptr,
+                                                  3, 3, degree,
+                                                  std::vector<double>(3, tolerance));
+    return ChebyshevStates(series, m_refFrame);
+  }
+
+
+  ChebyshevOrientations Orientations::fitChebyshev(double angularTolerance, size_t degree,
+                                                   double angularVelocityTolerance) const {
+    size_t numComponents = m_avs.empty() ? 4 : 7;
+    std::vector<double> values;
+    values.reserve(numComponents * m_rotations.size());
+    std::vector<double> previous;
+    for (size_t i = 0; i < m_rotations.size(); i++) {
+      std::vector<double> quat = m_rotations[i].toQuaternion();
+      // q and -q are the same rotation, so keep the components continuous
+      if (!previous.empty() && quat[0] * previous[0] + quat[1] * previous[1]
+                               + quat[2] * previous[2] + quat[3] * previous[3] < 0) {
+        for (double &component : quat) {
+          component = -component;
+        }
+      }
+      values.insert(values.end(), quat.begin(), quat.end());
+      if (!m_avs.empty()) {
+        values.insert(values.end(), {m_avs[i].x, m_avs[i].y, m_avs[i].z});
+      }
+      previous = quat;
+    }
+
+    // An error of e in each quaternion component rotates by at most about 4e
+    std::vector<double> tolerances(4, angularTolerance / 4);
+    tolerances.resize(numComponents, angularVelocityTolerance);
+    ChebyshevSeries series = ChebyshevSeries::fit(m_times, values, nullptr, numComponents, 0,
+                                                  degree, tolerances);
+    return ChebyshevOrientations(series, m_constRotation, m_constFrames, m_timeDepFrames);
+  }
+}
@@ -0,0 +1,518 @@
+#include "ale/Compact.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+
+#include "StateWindow.h"
+
+namespace ale {
+
+  namespace {
+    // Store each segment of values as single precision offsets from the middle of its range
+    void quantize(const std::vector<double> &values, size_t numComponents, size_t segmentSize,
+                  std::vector<double> &origins, std::vector<float> &offsets) {
+      size_t count = values.size() / numComponents;
+      origins.clear();
+      offsets.resize(values.size());
+      for (size_t first = 0; first < count; first += segmentSize) {
+        size_t last = std::min(first + segmentSize, count);
+        for (size_t component = 0; component < numComponents; component++) {
+          double minValue = std::numeric_limits<double>::infinity();
+          double maxValue = -std::numeric_limits<double>::infinity();
+          for (size_t i = first; i < last; i++) {
+            double value = values[i * numComponents + component];
+            // NaNs fail both comparisons, so they do not move the range
+            if (value < minValue) {
+              minValue = value;
+            }
+            if (value > maxValue) {
+              maxValue = value;
+            }
+          }
+          double origin = minValue <= maxValue ? (minValue + maxValue) / 2 : 0;
+          origins.push_back(origin);
+          for (size_t i = first; i < last; i++) {
+            offsets[i * numComponents + component] =
+                static_cast<float>(values[i * numComponents + component] - origin);
+          }
+        }
+      }
+    }
+
+
+    double dequantize(const std::vector<double> &origins, const std::vector<float> &offsets,
+                      size_t numComponents, size_t segmentSize, size_t index, size_t component) {
+      return origins[(index / segmentSize) * numComponents + component]
+             + offsets[index * numComponents + component];
+    }
+
+
+    // The largest component difference between the decoded and original values
+    double maxDifference(const std::vector<double> &origins, const std::vector<float> &offsets,
+                         size_t numComponents, size_t segmentSize, const std::vector<double> &values) {
+      double maxError = 0;
+      for (size_t i = 0; i < values.size() / numComponents; i++) {
+        for (size_t component = 0; component < numComponents; component++) {
+          double error = std::fabs(dequantize(origins, offsets, numComponents, segmentSize, i, component)
+                                   - values[i * numComponents + component]);
+          if (error > maxError) {
+            maxError = error;
+          }
+        }
+      }
+      return maxError;
+    }
+
+
+    /**
+     * Evaluate a set of times one segment at a time. The times are sorted,
+     * split by the segment of their interpolation index, and evaluate is
+     * called with the first and last interpolation index and the times of
+     * each segment. The results are returned in the order of the times.
+     */
+    template<typename Output, typename Evaluate>
+    std::vector<Output> evaluateBySegment(const std::vector<double> &knotTimes,
+                                          const std::vector<double> &times,
+                                          size_t segmentSize, Evaluate evaluate) {
+      std::vector<Output> outputs(times.size());
+      if (times.empty()) {
+        return outputs;
+      }
+
+      std::vector<size_t> order(times.size());
+      std::iota(order.begin(), order.end(), 0);
+      std::stable_sort(order.begin(), order.end(),
+                       [&times](size_t lhs, size_t rhs) { return times[lhs] < times[rhs]; });
+      InterpolationCursor cursor(knotTimes);
+      std::vector<int> indices(order.size());
+      for (size_t i = 0; i < order.size(); i++) {
+        indices[i] = cursor.index(times[order[i]]);
+      }
+
+      std::vector<double> segmentTimes;
+      size_t first = 0;
+      while (first < order.size()) {
+        size_t segment = indices[first] / segmentSize;
+        size_t last = first;
+        segmentTimes.clear();
+        while (last < order.size() && indices[last] / segmentSize == segment) {
+          segmentTimes.push_back(times[order[last]]);
+          last++;
+        }
+        std::vector<Output> segmentOutputs = evaluate(indices[first], indices[last - 1], segmentTimes);
+        for (size_t i = first; i < last; i++) {
+          outputs[order[i]] = segmentOutputs[i - first];
+        }
+        first = last;
+      }
+      return outputs;
+    }
+
+  }
+
+
+  CompactStates::CompactStates() :
+    m_segmentSize(1), m_refFrame(0), m_maxPositionError(0), m_maxVelocityError(0) {}
+
+
+  CompactStates::CompactStates(const States &states, size_t segmentSize) :
+    m_times(states.getTimes()), m_segmentSize(segmentSize), m_refFrame(states.getReferenceFrame()),
+    m_maxPositionError(0), m_maxVelocityError(0) {
+    if (segmentSize == 0) {
+      throw std::invalid_argument("The segment size must be at least 1.");
+    }
+
+    std::vector<State> original = states.getStates();
+    std::vector<double> positions;
+    positions.reserve(3 * original.size());
+    for (const State &state : original) {
+      positions.push_back(state.position.x);
+      positions.push_back(state.position.y);
+      positions.push_back(state.position.z);
+    }
+    quantize(positions, 3, m_segmentSize, m_positionOrigins, m_positionOffsets);
+    m_maxPositionError = maxDifference(m_positionOrigins, m_positionOffsets, 3, m_segmentSize, positions);
+
+    if (!original.empty() && states.hasVelocity()) {
+      std::vector<double> velocities;
+      velocities.reserve(3 * original.size());
+      for (const State &state : original) {
+        velocities.push_back(state.velocity.x);
+        velocities.push_back(state.velocity.y);
+        velocities.push_back(state.velocity.z);
+      }
+      quantize(velocities, 3, m_segmentSize, m_velocityOrigins, m_velocityOffsets);
+      m_maxVelocityError = maxDifference(m_velocityOrigins, m_velocityOffsets, 3, m_segmentSize, velocities);
+    }
+  }
+
+
+  State CompactStates::getState(double time, PositionInterpolation interp) const {
+    int index = interpolationIndex(m_times, time);
+    // The same states as window(index, index), decoded onto the stack
+    int start = std::max(0, index - 3);
+    int stop = std::min(index + 4, (int) m_times.size() - 1);
+    int numStates = stop - start + 1;
+    const double *times = m_times.data() + start;
+
+    double positions[3][8];
+    double velocities[3][8];
+    bool windowHasVelocity = hasVelocity();
+    for (int i = 0; i < numStates; i++) {
+      State state = decodeState(start + i);
+      positions[0][i] = state.position.x;
+      positions[1][i] = state.position.y;
+      positions[2][i] = state.position.z;
+      velocities[0][i] = state.velocity.x;
+      velocities[1][i] = state.velocity.y;
+      velocities[2][i] = state.velocity.z;
+      if (std::isnan(state.velocity.x) || std::isnan(state.velocity.y) || std::isnan(state.velocity.z)) {
+        windowHasVelocity = false;
+      }
+    }
+
+    const double *positionColumns[3] = {positions[0], positions[1], positions[2]};
+    const double *velocityColumns[3] = {velocities[0], velocities[1], velocities[2]};
+    return windowState(times, positionColumns, hasVelocity() ? velocityColumns : nullptr,
+                       numStates, index - start, time, interp, windowHasVelocity);
+  }
+
+
+  std::vector<State> CompactStates::getStates(const std::vector<double> &times,
+                                              PositionInterpolation interp) const {
+    return evaluateBySegment<State>(m_times, times, m_segmentSize,
+        [this, interp](int firstIndex, int lastIndex, const std::vector<double> &segmentTimes) {
+          return window(firstIndex, lastIndex).getStates(segmentTimes, interp);
+        });
+  }
+
+
+  std::vector<Vec3d> CompactStates::getPositions(const std::vector<double> &times,
+                                                 PositionInterpolation interp) const {
+    std::vector<State> states = getStates(times, interp);
+    std::vector<Vec3d> positions;
+    positions.reserve(states.size());
+    for (const State &state : states) {
+      positions.push_back(state.position);
+    }
+    return positions;
+  }
+
+
+  Vec3d CompactStates::getPosition(double time, PositionInterpolation interp) const {
+    return getState(time, interp).position;
+  }
+
+
+  Vec3d CompactStates::getVelocity(double time, PositionInterpolation interp) const {
+    return getState(time, interp).velocity;
+  }
+
+
+  States CompactStates::toStates() const {
+    if (m_times.empty()) {
+      return States();
+    }
+    return window(0, m_times.size() - 1);
+  }
+
+
+  const std::vector<double> &CompactStates::getTimes() const {
+    return m_times;
+  }
+
+
+  int CompactStates::getReferenceFrame() const {
+    return m_refFrame;
+  }
+
+
+  bool CompactStates::hasVelocity() const {
+    return !m_velocityOffsets.empty();
+  }
+
+
+  size_t CompactStates::getSegmentSize() const {
+    return m_segmentSize;
+  }
+
+
+  double CompactStates::getMaxPositionError() const {
+    return m_maxPositionError;
+  }
+
+
+  double CompactStates::getMaxVelocityError() const {
+    return m_maxVelocityError;
+  }
+
+
+  size_t CompactStates::getMemoryUsage() const {
+    return sizeof(double) * (m_times.size() + m_positionOrigins.size() + m_velocityOrigins.size())
+           + sizeof(float) * (m_positionOffsets.size() + m_velocityOffsets.size());
+  }
+
+
+  States CompactStates::window(int firstIndex, int lastIndex) const {
+    // The states that the largest lagrange window around the intervals can reach
+    int start = std::max(0, firstIndex - 3);
+    int stop = std::min(lastIndex + 4, (int) m_times.size() - 1);
+    std::vector<double> times(m_times.begin() + start, m_times.begin() + stop + 1);
+    std::vector<State> states;
+    states.reserve(times.size());
+    for (int i = start; i <= stop; i++) {
+      states.push_back(decodeState(i));
+    }
+    return States(times, states, m_refFrame);
+  }
+
+
+  State CompactStates::decodeState(int index) const {
+    Vec3d position(dequantize(m_positionOrigins, m_positionOffsets, 3, m_segmentSize, index, 0),
+                   dequantize(m_positionOrigins, m_positionOffsets, 3, m_segmentSize, index, 1),
+                   dequantize(m_positionOrigins, m_positionOffsets, 3, m_segmentSize, index, 2));
+    if (!hasVelocity()) {
+      return State(position);
+    }
+    return State(position,
+                 Vec3d(dequantize(m_velocityOrigins, m_velocityOffsets, 3, m_segmentSize, index, 0),
+                       dequantize(m_velocityOrigins, m_velocityOffsets, 3, m_segmentSize, index, 1),
+                       dequantize(m_velocityOrigins, m_velocityOffsets, 3, m_segmentSize, index, 2)));
+  }
+
+
+  CompactOrientations::CompactOrientations() :
+    m_segmentSize(1), m_maxAngularError(0), m_maxAvError(0) {}
+
+
+  CompactOrientations::CompactOrientations(const Orientations &orientations, size_t segmentSize) :
+    m_times(orientations.getTimes()), m_segmentSize(segmentSize),
+    m_constRotation(orientations.getConstantRotation()),
+    m_constFrames(orientations.getConstantFrames()),
+    m_timeDepFrames(orientations.getTimeDependentFrames()),
+    m_maxAngularError(0), m_maxAvError(0) {
+    if (segmentSize == 0) {
+      throw std::invalid_argument("The segment size must be at least 1.");
+    }
+
+    // Align the sign of each quaternion with the previous one so that they vary smoothly
+    std::vector<Rotation> rotations = orientations.getRotations();
+    std::vector<double> quats;
+    quats.reserve(4 * rotations.size());
+    m_quatFlipped.resize(rotations.size(), false);
+    for (size_t i = 0; i < rotations.size(); i++) {
+      std::vector<double> quat = rotations[i].toQuaternion();
+      if (i > 0) {
+        double dot = 0;
+        for (size_t component = 0; component < 4; component++) {
+          dot += quat[component] * quats[4 * (i - 1) + component];
+        }
+        if (dot < 0) {
+          for (double &value : quat) {
+            value = -value;
+          }
+          m_quatFlipped[i] = true;
+        }
+      }
+      quats.insert(quats.end(), quat.begin(), quat.end());
+    }
+    quantize(quats, 4, m_segmentSize, m_quatOrigins, m_quatOffsets);
+
+    std::vector<Vec3d> avs = orientations.getAngularVelocities();
+    if (!avs.empty()) {
+      std::vector<double> avValues;
+      avValues.reserve(3 * avs.size());
+      for (const Vec3d &av : avs) {
+        avValues.push_back(av.x);
+        avValues.push_back(av.y);
+        avValues.push_back(av.z);
+      }
+      quantize(avValues, 3, m_segmentSize, m_avOrigins, m_avOffsets);
+      m_maxAvError = maxDifference(m_avOrigins, m_avOffsets, 3, m_segmentSize, avValues);
+    }
+
+    if (!rotations.empty()) {
+      std::vector<Rotation> decoded = toOrientations().getRotations();
+      for (size_t i = 0; i < rotations.size(); i++) {
+        m_maxAngularError = std::max(m_maxAngularError, decoded[i].angleTo(rotations[i]));
+      }
+    }
+  }
+
+
+  Rotation CompactOrientations::interpolateTimeDep(double time, RotationInterpolation interpType) const {
+    int index = interpolationIndex(m_times, time);
+    if (m_times.size() > 1) {
+      double t = (time - m_times[index]) / (m_times[index + 1] - m_times[index]);
+      return decodeRotation(index).interpolate(decodeRotation(index + 1), t, interpType);
+    }
+
+    // Propagate a single rotation with its angular velocity, the same as Orientations
+    Rotation rotation = decodeRotation(0);
+    if (!hasAngularVelocity()) {
+      return rotation;
+    }
+    Vec3d av = decodeAv(0);
+    double rate = av.norm();
+    if (rate == 0) {
+      return rotation;
+    }
+    double halfAngle = (time - m_times[0]) * rate / 2;
+    double scale = std::sin(halfAngle) / rate;
+    return Rotation(std::cos(halfAngle), scale * av.x, scale * av.y, scale * av.z) * rotation;
+  }
+
+
+  Rotation CompactOrientations::interpolate(double time, RotationInterpolation interpType) const {
+    return m_constRotation * interpolateTimeDep(time, interpType);
+  }
+
+
+  Vec3d CompactOrientations::interpolateAV(double time) const {
+    if (!hasAngularVelocity()) {
+      throw std::invalid_argument("Cannot interpolate angular velocities for an orientation without them.");
+    }
+    int index = interpolationIndex(m_times, time);
+    if (m_times.size() == 1) {
+      return decodeAv(0);
+    }
+    double t = (time - m_times[index]) / (m_times[index + 1] - m_times[index]);
+    return linearInterpolate(decodeAv(index), decodeAv(index + 1), t);
+  }
+
+
+  Vec3d CompactOrientations::rotateVectorAt(double time, const Vec3d &vector,
+                                            RotationInterpolation interpType, bool invert) const {
+    Rotation rotation = interpolate(time, interpType);
+    if (invert) {
+      rotation = rotation.inverse();
+    }
+    return rotation(vector);
+  }
+
+
+  State CompactOrientations::rotateStateAt(double time, const State &state,
+                                           RotationInterpolation interpType, bool invert) const {
+    Vec3d av(0.0, 0.0, 0.0);
+    if (hasAngularVelocity()) {
+      av = interpolateAV(time);
+    }
+    return Orientations::rotateState(interpolate(time, interpType), av, state, invert);
+  }
+
+
+  std::vector<Rotation> CompactOrientations::interpolateTimeDep(const std::vector<double> &times,
+                                                                RotationInterpolation interpType) const {
+    return evaluateBySegment<Rotation>(m_times, times, m_segmentSize,
+        [this, interpType](int firstIndex, int lastIndex, const std::vector<double> &segmentTimes) {
+          return window(firstIndex, lastIndex).interpolateTimeDep(segmentTimes, interpType);
+        });
+  }
+
+
+  std::vector<Rotation> CompactOrientations::interpolate(const std::vector<double> &times,
+                                                         RotationInterpolation interpType) const {
+    std::vector<Rotation> rotations = interpolateTimeDep(times, interpType);
+    for (Rotation &rotation : rotations) {
+      rotation = m_constRotation * rotation;
+    }
+    return rotations;
+  }
+
+
+  Orientations CompactOrientations::toOrientations() const {
+    if (m_times.empty()) {
+      return Orientations();
+    }
+    return window(0, m_times.size() - 1);
+  }
+
+
+  const std::vector<double> &CompactOrientations::getTimes() const {
+    return m_times;
+  }
+
+
+  Rotation CompactOrientations::getConstantRotation() const {
+    return m_constRotation;
+  }
+
+
+  std::vector<int> CompactOrientations::getConstantFrames() const {
+    return m_constFrames;
+  }
+
+
+  std::vector<int> CompactOrientations::getTimeDependentFrames() const {
+    return m_timeDepFrames;
+  }
+
+
+  bool CompactOrientations::hasAngularVelocity() const {
+    return !m_avOffsets.empty();
+  }
+
+
+  size_t CompactOrientations::getSegmentSize() const {
+    return m_segmentSize;
+  }
+
+
+  double CompactOrientations::getMaxAngularError() const {
+    return m_maxAngularError;
+  }
+
+
+  double CompactOrientations::getMaxAngularVelocityError() const {
+    return m_maxAvError;
+  }
+
+
+  size_t CompactOrientations::getMemoryUsage() const {
+    return sizeof(double) * (m_times.size() + m_quatOrigins.size() + m_avOrigins.size())
+           + sizeof(float) * (m_quatOffsets.size() + m_avOffsets.size())
+           + (m_quatFlipped.size() + 7) / 8;
+  }
+
+
+  Orientations CompactOrientations::window(int firstIndex, int lastIndex) const {
+    // Interpolating only needs the rotations at the ends of each interval
+    int stop = std::min(lastIndex + 1, (int) m_times.size() - 1);
+    std::vector<double> times(m_times.begin() + firstIndex, m_times.begin() + stop + 1);
+    std::vector<Rotation> rotations;
+    std::vector<Vec3d> avs;
+    rotations.reserve(times.size());
+    for (int i = firstIndex; i <= stop; i++) {
+      rotations.push_back(decodeRotation(i));
+      if (hasAngularVelocity()) {
+        avs.push_back(decodeAv(i));
+      }
+    }
+    return Orientations(rotations, times, avs, m_constRotation, m_constFrames, m_timeDepFrames);
+  }
+
+
+  Rotation CompactOrientations::decodeRotation(int index) const {
+    double quat[4];
+    double norm = 0;
+    for (size_t component = 0; component < 4; component++) {
+      quat[component] = dequantize(m_quatOrigins, m_quatOffsets, 4, m_segmentSize, index, component);
+      norm += quat[component] * quat[component];
+    }
+    norm = std::sqrt(norm);
+    if (m_quatFlipped[index]) {
+      norm = -norm;
+    }
+    return Rotation(quat[0] / norm, quat[1] / norm, quat[2] / norm, quat[3] / norm);
+  }
+
+
+  Vec3d CompactOrientations::decodeAv(int index) const {
+    return Vec3d(dequantize(m_avOrigins, m_avOffsets, 3, m_segmentSize, index, 0),
+                 dequantize(m_avOrigins, m_avOffsets, 3, m_segmentSize, index, 1),
+                 dequantize(m_avOrigins, m_avOffsets, 3, m_segmentSize, index, 2));
+  }
+}
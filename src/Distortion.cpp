@@ -0,0 +1,483 @@
+#include "ale/Distortion.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+namespace ale {
+
+  namespace {
+    const int MAX_ITERATIONS = 30; //!< The most Newton steps taken per point
+    const double TOLERANCE = 1e-13; //!< The largest residual, relative to the target, of a solved point
+    const size_t BLOCK_SIZE = 64; //!< The number of points solved together
+
+    // The number of coefficients each model needs
+    size_t numCoefficients(DistortionType type) {
+      switch (type) {
+        case TRANSVERSE:
+          return 20;
+        case RADIAL:
+          return 3;
+        case KAGUYALISM:
+          return 10;
+        case DAWNFC:
+        case LROLROCNAC:
+          return 1;
+        case CAHVOR:
+        case RADTAN:
+          return 5;
+        case LUNARORBITER:
+          throw std::invalid_argument("The Lunar Orbiter distortion model is not supported, "
+                                      "its radial coefficients are not part of the ISD.");
+        default:
+          throw std::invalid_argument("Unknown distortion model.");
+      }
+    }
+
+
+    // Distorted points from cubic polynomials in the undistorted point
+    struct TransverseModel {
+      const double *xCoeffs;
+      const double *yCoeffs;
+
+      void apply(double x, double y, double &outX, double &outY) const {
+        double terms[10] = {1, x, y, x * x, x * y, y * y, x * x * x, x * x * y, x * y * y, y * y * y};
+        outX = 0;
+        outY = 0;
+        for (int i = 0; i < 10; i++) {
+          outX += xCoeffs[i] * terms[i];
+          outY += yCoeffs[i] * terms[i];
+        }
+      }
+
+      void jacobian(double x, double y, double *jac) const {
+        double dx[10] = {0, 1, 0, 2 * x, y, 0, 3 * x * x, 2 * x * y, y * y, 0};
+        double dy[10] = {0, 0, 1, 0, x, 2 * y, 0, x * x, 2 * x * y, 3 * y * y};
+        std::fill(jac, jac + 4, 0.0);
+        for (int i = 0; i < 10; i++) {
+          jac[0] += xCoeffs[i] * dx[i];
+          jac[1] += xCoeffs[i] * dy[i];
+          jac[2] += yCoeffs[i] * dx[i];
+          jac[3] += yCoeffs[i] * dy[i];
+        }
+      }
+    };
+
+
+    // Undistorted points from an even polynomial in the distance of the
+    // distorted point from a center, used by RADIAL and CAHVOR
+    struct RadialModel {
+      double k0, k1, k2;
+      double centerX, centerY;
+
+      void apply(double x, double y, double &outX, double &outY) const {
+        double shiftedX = x - centerX;
+        double shiftedY = y - centerY;
+        double rr = shiftedX * shiftedX + shiftedY * shiftedY;
+        double dr = k0 + rr * (k1 + rr * k2);
+        outX = shiftedX * (1.0 - dr) + centerX;
+        outY = shiftedY * (1.0 - dr) + centerY;
+      }
+
+      void jacobian(double x, double y, double *jac) const {
+        double shiftedX = x - centerX;
+        double shiftedY = y - centerY;
+        double rr = shiftedX * shiftedX + shiftedY * shiftedY;
+        double dr = k0 + rr * (k1 + rr * k2);
+        // d(dr)/dx = drPrime * x
+        double drPrime = 2 * (k1 + 2 * k2 * rr);
+        jac[0] = (1.0 - dr) - shiftedX * drPrime * shiftedX;
+        jac[1] = -shiftedX * drPrime * shiftedY;
+        jac[2] = -shiftedY * drPrime * shiftedX;
+        jac[3] = (1.0 - dr) - shiftedY * drPrime * shiftedY;
+      }
+    };
+
+
+    // Undistorted points from the boresight and cubic polynomials in the
+    // distance of the distorted point from the origin
+    struct KaguyaModel {
+      const double *xCoeffs; //!< The x boresight then 4 x coefficients
+      const double *yCoeffs; //!< The y boresight then 4 y coefficients
+
+      static double polynomial(const double *c, double r) {
+        return c[0] + c[1] + r * (c[2] + r * (c[3] + r * c[4]));
+      }
+
+      static double derivative(const double *c, double r) {
+        return c[2] + r * (2 * c[3] + r * 3 * c[4]);
+      }
+
+      void apply(double x, double y, double &outX, double &outY) const {
+        double r = std::sqrt(x * x + y * y);
+        outX = x + polynomial(xCoeffs, r);
+        outY = y + polynomial(yCoeffs, r);
+      }
+
+      void jacobian(double x, double y, double *jac) const {
+        double r = std::sqrt(x * x + y * y);
+        jac[0] = 1;
+        jac[1] = 0;
+        jac[2] = 0;
+        jac[3] = 1;
+        if (r > 0) {
+          double xPrime = derivative(xCoeffs, r);
+          double yPrime = derivative(yCoeffs, r);
+          jac[0] += xPrime * x / r;
+          jac[1] += xPrime * y / r;
+          jac[2] += yPrime * x / r;
+          jac[3] += yPrime * y / r;
+        }
+      }
+    };
+
+
+    // Distorted points from a single radial term in the undistorted point
+    struct DawnFcModel {
+      double k;
+
+      void apply(double x, double y, double &outX, double &outY) const {
+        double scale = 1 + k * (x * x + y * y);
+        outX = x * scale;
+        outY = y * scale;
+      }
+
+      void jacobian(double x, double y, double *jac) const {
+        double scale = 1 + k * (x * x + y * y);
+        jac[0] = scale + 2 * k * x * x;
+        jac[1] = 2 * k * x * y;
+        jac[2] = 2 * k * x * y;
+        jac[3] = scale + 2 * k * y * y;
+      }
+    };
+
+
+    // Undistorted points from a distortion along the line direction only
+    struct LroNacModel {
+      double k;
+
+      void apply(double x, double y, double &outX, double &outY) const {
+        outX = x;
+        outY = y / (1 + k * y * y);
+      }
+
+      void jacobian(double, double y, double *jac) const {
+        double denominator = 1 + k * y * y;
+        jac[0] = 1;
+        jac[1] = 0;
+        jac[2] = 0;
+        jac[3] = (1 - k * y * y) / (denominator * denominator);
+      }
+    };
+
+
+    // Distorted points from the radial and tangential terms of the undistorted point
+    struct RadTanModel {
+      double k1, k2, p1, p2, k3;
+
+      void apply(double x, double y, double &outX, double &outY) const {
+        double rr = x * x + y * y;
+        double radial = 1 + rr * (k1 + rr * (k2 + rr * k3));
+        outX = x * radial + 2 * p1 * x * y + p2 * (rr + 2 * x * x);
+        outY = y * radial + p1 * (rr + 2 * y * y) + 2 * p2 * x * y;
+      }
+
+      void jacobian(double x, double y, double *jac) const {
+        double rr = x * x + y * y;
+        double radial = 1 + rr * (k1 + rr * (k2 + rr * k3));
+        // d(radial)/dx = radialPrime * x
+        double radialPrime = 2 * k1 + rr * (4 * k2 + rr * 6 * k3);
+        jac[0] = radial + radialPrime * x * x + 2 * p1 * y + 6 * p2 * x;
+        jac[1] = radialPrime * x * y + 2 * p1 * x + 2 * p2 * y;
+        jac[2] = radialPrime * x * y + 2 * p1 * x + 2 * p2 * y;
+        jac[3] = radial + radialPrime * y * y + 6 * p1 * y + 2 * p2 * x;
+      }
+    };
+
+
+    template<typename Model>
+    void applyModel(const Model &model, const double *x, const double *y, size_t numPoints,
+                    double *outX, double *outY) {
+      for (size_t i = 0; i < numPoints; i++) {
+        double pointX = x[i];
+        double pointY = y[i];
+        model.apply(pointX, pointY, outX[i], outY[i]);
+      }
+    }
+
+
+    // Newton's method for the points that the model maps to the targets,
+    // starting from and updating x and y. Points that do not converge are
+    // set to NaN. Returns the number of Newton steps taken.
+    template<typename Model>
+    size_t solveModel(const Model &model, const double *targetX, const double *targetY,
+                      size_t numPoints, double *x, double *y) {
+      size_t numSteps = 0;
+      for (size_t i = 0; i < numPoints; i++) {
+        double tolerance = TOLERANCE * (1 + std::fabs(targetX[i]) + std::fabs(targetY[i]));
+        bool converged = false;
+        for (int iteration = 0; iteration <= MAX_ITERATIONS; iteration++) {
+          double modelX, modelY;
+          model.apply(x[i], y[i], modelX, modelY);
+          double residualX = modelX - targetX[i];
+          double residualY = modelY - targetY[i];
+          if (std::fabs(residualX) <= tolerance && std::fabs(residualY) <= tolerance) {
+            converged = true;
+            break;
+          }
+          double jac[4];
+          model.jacobian(x[i], y[i], jac);
+          double determinant = jac[0] * jac[3] - jac[1] * jac[2];
+          if (iteration == MAX_ITERATIONS || determinant == 0) {
+            break;
+          }
+          x[i] -= (jac[3] * residualX - jac[1] * residualY) / determinant;
+          y[i] -= (jac[0] * residualY - jac[2] * residualX) / determinant;
+          numSteps++;
+        }
+        if (!converged) {
+          x[i] = y[i] = std::numeric_limits<double>::quiet_NaN();
+        }
+      }
+      return numSteps;
+    }
+  }
+
+
+  Distortion::Distortion(DistortionType type, const std::vector<double> &coefficients) :
+    m_type(type), m_coefficients(coefficients), m_gridSize(0), m_gridMinX(0), m_gridMinY(0),
+    m_gridStepX(0), m_gridStepY(0) {
+    if (coefficients.size() != numCoefficients(type)) {
+      throw std::invalid_argument("The distortion model needs " + std::to_string(numCoefficients(type))
+                                  + " coefficients, got " + std::to_string(coefficients.size()) + ".");
+    }
+  }
+
+
+  DistortionType Distortion::getType() const {
+    return m_type;
+  }
+
+
+  const std::vector<double> &Distortion::getCoefficients() const {
+    return m_coefficients;
+  }
+
+
+  bool Distortion::isDistortIterative() const {
+    return m_type == RADIAL || m_type == KAGUYALISM || m_type == LROLROCNAC || m_type == CAHVOR;
+  }
+
+
+  void Distortion::distort(double x, double y, double &distortedX, double &distortedY) const {
+    distort(&x, &y, 1, &distortedX, &distortedY);
+  }
+
+
+  void Distortion::undistort(double x, double y, double &undistortedX, double &undistortedY) const {
+    undistort(&x, &y, 1, &undistortedX, &undistortedY);
+  }
+
+
+  void Distortion::distort(const double *x, const double *y, size_t numPoints,
+                           double *distortedX, double *distortedY) const {
+    if (isDistortIterative()) {
+      evaluateIterative(x, y, numPoints, distortedX, distortedY);
+    }
+    else {
+      evaluateClosed(x, y, numPoints, distortedX, distortedY);
+    }
+  }
+
+
+  void Distortion::undistort(const double *x, const double *y, size_t numPoints,
+                             double *undistortedX, double *undistortedY) const {
+    if (isDistortIterative()) {
+      evaluateClosed(x, y, numPoints, undistortedX, undistortedY);
+    }
+    else {
+      evaluateIterative(x, y, numPoints, undistortedX, undistortedY);
+    }
+  }
+
+
+  void Distortion::prepareGrid(double minX, double maxX, double minY, double maxY, size_t gridSize) {
+    if (gridSize < 1) {
+      throw std::invalid_argument("The distortion grid must have at least one cell.");
+    }
+    if (!(maxX > minX) || !(maxY > minY)) {
+      throw std::invalid_argument("The distortion grid must cover a non-empty region.");
+    }
+
+    // Solve at the grid nodes without the old grid
+    m_gridSize = 0;
+    m_gridX.clear();
+    m_gridY.clear();
+
+    size_t numNodes = (gridSize + 1) * (gridSize + 1);
+    double stepX = (maxX - minX) / gridSize;
+    double stepY = (maxY - minY) / gridSize;
+    std::vector<double> nodeX(numNodes);
+    std::vector<double> nodeY(numNodes);
+    for (size_t row = 0; row <= gridSize; row++) {
+      for (size_t column = 0; column <= gridSize; column++) {
+        nodeX[row * (gridSize + 1) + column] = minX + column * stepX;
+        nodeY[row * (gridSize + 1) + column] = minY + row * stepY;
+      }
+    }
+    std::vector<double> solvedX(numNodes);
+    std::vector<double> solvedY(numNodes);
+    evaluateIterative(nodeX.data(), nodeY.data(), numNodes, solvedX.data(), solvedY.data());
+
+    // The cell centers are where the bilinear guesses are worst
+    size_t numCells = gridSize * gridSize;
+    std::vector<double> centerX(numCells);
+    std::vector<double> centerY(numCells);
+    for (size_t row = 0; row < gridSize; row++) {
+      for (size_t column = 0; column < gridSize; column++) {
+        centerX[row * gridSize + column] = minX + (column + 0.5) * stepX;
+        centerY[row * gridSize + column] = minY + (row + 0.5) * stepY;
+      }
+    }
+    std::vector<double> centerSolvedX(numCells);
+    std::vector<double> centerSolvedY(numCells);
+    size_t unseededSteps = evaluateIterative(centerX.data(), centerY.data(), numCells,
+                                             centerSolvedX.data(), centerSolvedY.data());
+
+    m_gridMinX = minX;
+    m_gridMinY = minY;
+    m_gridStepX = stepX;
+    m_gridStepY = stepY;
+    m_gridX = solvedX;
+    m_gridY = solvedY;
+    m_gridSize = gridSize;
+
+    // Looking up a guess costs about as much as a Newton step of the cheaper
+    // models, and those already converge in about two steps from the input
+    // point, so the grid is only kept if it saves at least half a step per point
+    size_t seededSteps = evaluateIterative(centerX.data(), centerY.data(), numCells,
+                                           centerSolvedX.data(), centerSolvedY.data());
+    if (2 * (unseededSteps - std::min(unseededSteps, seededSteps)) < numCells) {
+      m_gridSize = 0;
+      m_gridX.clear();
+      m_gridY.clear();
+    }
+  }
+
+
+  bool Distortion::isGridPrepared() const {
+    return m_gridSize > 0;
+  }
+
+
+  void Distortion::evaluateClosed(const double *x, const double *y, size_t numPoints,
+                                  double *outX, double *outY) const {
+    const double *c = m_coefficients.data();
+    switch (m_type) {
+      case TRANSVERSE:
+        applyModel(TransverseModel{c, c + 10}, x, y, numPoints, outX, outY);
+        break;
+      case RADIAL:
+        applyModel(RadialModel{c[0], c[1], c[2], 0, 0}, x, y, numPoints, outX, outY);
+        break;
+      case KAGUYALISM:
+        applyModel(KaguyaModel{c, c + 5}, x, y, numPoints, outX, outY);
+        break;
+      case DAWNFC:
+        applyModel(DawnFcModel{c[0]}, x, y, numPoints, outX, outY);
+        break;
+      case LROLROCNAC:
+        applyModel(LroNacModel{c[0]}, x, y, numPoints, outX, outY);
+        break;
+      case CAHVOR:
+        applyModel(RadialModel{c[0], c[1], c[2], c[3], c[4]}, x, y, numPoints, outX, outY);
+        break;
+      case RADTAN:
+        applyModel(RadTanModel{c[0], c[1], c[2], c[3], c[4]}, x, y, numPoints, outX, outY);
+        break;
+      default:
+        throw std::invalid_argument("Unsupported distortion model.");
+    }
+  }
+
+
+  size_t Distortion::evaluateIterative(const double *x, const double *y, size_t numPoints,
+                                       double *outX, double *outY) const {
+    const double *c = m_coefficients.data();
+    // Copy each block of targets first, so the outputs can be the inputs
+    double targetX[BLOCK_SIZE], targetY[BLOCK_SIZE];
+    double solvedX[BLOCK_SIZE], solvedY[BLOCK_SIZE];
+    size_t numSteps = 0;
+    for (size_t blockStart = 0; blockStart < numPoints; blockStart += BLOCK_SIZE) {
+      size_t blockSize = std::min(BLOCK_SIZE, numPoints - blockStart);
+      for (size_t i = 0; i < blockSize; i++) {
+        targetX[i] = x[blockStart + i];
+        targetY[i] = y[blockStart + i];
+        if (!gridGuess(targetX[i], targetY[i], solvedX[i], solvedY[i])) {
+          solvedX[i] = targetX[i];
+          solvedY[i] = targetY[i];
+        }
+      }
+
+      switch (m_type) {
+        case TRANSVERSE:
+          numSteps += solveModel(TransverseModel{c, c + 10}, targetX, targetY, blockSize, solvedX, solvedY);
+          break;
+        case RADIAL:
+          numSteps += solveModel(RadialModel{c[0], c[1], c[2], 0, 0}, targetX, targetY, blockSize, solvedX, solvedY);
+          break;
+        case KAGUYALISM:
+          numSteps += solveModel(KaguyaModel{c, c + 5}, targetX, targetY, blockSize, solvedX, solvedY);
+          break;
+        case DAWNFC:
+          numSteps += solveModel(DawnFcModel{c[0]}, targetX, targetY, blockSize, solvedX, solvedY);
+          break;
+        case LROLROCNAC:
+          numSteps += solveModel(LroNacModel{c[0]}, targetX, targetY, blockSize, solvedX, solvedY);
+          break;
+        case CAHVOR:
+          numSteps += solveModel(RadialModel{c[0], c[1], c[2], c[3], c[4]}, targetX, targetY, blockSize,
+                     solvedX, solvedY);
+          break;
+        case RADTAN:
+          numSteps += solveModel(RadTanModel{c[0], c[1], c[2], c[3], c[4]}, targetX, targetY, blockSize,
+                     solvedX, solvedY);
+          break;
+        default:
+          throw std::invalid_argument("Unsupported distortion model.");
+      }
+
+      std::copy(solvedX, solvedX + blockSize, outX + blockStart);
+      std::copy(solvedY, solvedY + blockSize, outY + blockStart);
+    }
+    return numSteps;
+  }
+
+
+  bool Distortion::gridGuess(double x, double y, double &guessX, double &guessY) const {
+    if (m_gridSize == 0) {
+      return false;
+    }
+    double u = (x - m_gridMinX) / m_gridStepX;
+    double v = (y - m_gridMinY) / m_gridStepY;
+    if (!(u >= 0 && u <= m_gridSize && v >= 0 && v <= m_gridSize)) {
+      return false;
+    }
+
+    // Bilinear interpolation of the solved grid nodes around the point
+    size_t column = std::min((size_t) u, m_gridSize - 1);
+    size_t row = std::min((size_t) v, m_gridSize - 1);
+    double fracU = u - column;
+    double fracV = v - row;
+    size_t lower = row * (m_gridSize + 1) + column;
+    size_t upper = lower + m_gridSize + 1;
+    guessX = (1 - fracV) * ((1 - fracU) * m_gridX[lower] + fracU * m_gridX[lower + 1])
+             + fracV * ((1 - fracU) * m_gridX[upper] + fracU * m_gridX[upper + 1]);
+    guessY = (1 - fracV) * ((1 - fracU) * m_gridY[lower] + fracU * m_gridY[lower + 1])
+             + fracV * ((1 - fracU) * m_gridY[upper] + fracU * m_gridY[upper + 1]);
+    // Next to a node that did not converge, start from the point instead
+    return std::isfinite(guessX) && std::isfinite(guessY);
+  }
+}
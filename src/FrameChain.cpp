@@ -0,0 +1,198 @@
+#include "ale/FrameChain.h"
+
+#include <algorithm>
+#include <queue>
+#include <stdexcept>
+#include <string>
+
+namespace ale {
+
+  namespace {
+    // Fold the constant rotation of a set of orientations into its time dependent rotations
+    Orientations foldConstantRotation(const Orientations &orientations) {
+      Rotation constRot = orientations.getConstantRotation();
+      std::vector<Rotation> rotations = orientations.getRotations();
+      for (Rotation &rotation : rotations) {
+        rotation = constRot * rotation;
+      }
+      // Angular velocities are in the source frame, so the constant rotation does not change them
+      return Orientations(rotations, orientations.getTimes(), orientations.getAngularVelocities());
+    }
+  }
+
+
+  FrameChain::FrameChain() {}
+
+
+  void FrameChain::addRotation(int source, int destination, const Rotation &rotation) {
+    Edge edge;
+    edge.timeDependent = false;
+    edge.rotation = rotation;
+    addEdge(source, destination, edge);
+
+    Edge inverseEdge;
+    inverseEdge.timeDependent = false;
+    inverseEdge.rotation = rotation.inverse();
+    addEdge(destination, source, inverseEdge);
+  }
+
+
+  void FrameChain::addRotation(int source, int destination, const Orientations &orientations) {
+    Edge edge;
+    edge.timeDependent = true;
+    edge.orientations = foldConstantRotation(orientations);
+    addEdge(source, destination, edge);
+
+    Edge inverseEdge;
+    inverseEdge.timeDependent = true;
+    inverseEdge.orientations = foldConstantRotation(edge.orientations.inverse());
+    addEdge(destination, source, inverseEdge);
+  }
+
+
+  void FrameChain::addOrientations(const Orientations &orientations) {
+    std::vector<int> timeDepFrames = orientations.getTimeDependentFrames();
+    std::vector<int> constFrames = orientations.getConstantFrames();
+    if (timeDepFrames.empty()) {
+      throw std::invalid_argument("The orientations must have time dependent frames.");
+    }
+
+    addRotation(timeDepFrames.back(), timeDepFrames.front(),
+                Orientations(orientations.getRotations(), orientations.getTimes(),
+                             orientations.getAngularVelocities()));
+    if (!constFrames.empty() && constFrames.front() != timeDepFrames.front()) {
+      addRotation(timeDepFrames.front(), constFrames.front(), orientations.getConstantRotation());
+    }
+  }
+
+
+  bool FrameChain::hasFrame(int frame) const {
+    return m_adjacent.find(frame) != m_adjacent.end();
+  }
+
+
+  std::vector<int> FrameChain::path(int source, int destination) const {
+    if (!hasFrame(source) || !hasFrame(destination)) {
+      throw std::invalid_argument("Frame " + std::to_string(hasFrame(source) ? destination : source)
+                                  + " is not in the frame chain.");
+    }
+
+    // Breadth first search from the source, recording how each frame was reached
+    std::map<int, int> previous;
+    std::queue<int> frontier;
+    previous[source] = source;
+    frontier.push(source);
+    while (!frontier.empty() && previous.find(destination) == previous.end()) {
+      int frame = frontier.front();
+      frontier.pop();
+      for (int next : m_adjacent.at(frame)) {
+        if (previous.find(next) == previous.end()) {
+          previous[next] = frame;
+          frontier.push(next);
+        }
+      }
+    }
+
+    if (previous.find(destination) == previous.end()) {
+      throw std::invalid_argument("There is no path from frame " + std::to_string(source)
+                                  + " to frame " + std::to_string(destination) + ".");
+    }
+
+    std::vector<int> frames(1, destination);
+    while (frames.back() != source) {
+      frames.push_back(previous[frames.back()]);
+    }
+    std::reverse(frames.begin(), frames.end());
+    return frames;
+  }
+
+
+  int FrameChain::lastTimeDependentFrame(int source, int destination) const {
+    std::vector<int> frames = path(source, destination);
+    for (size_t i = frames.size() - 1; i > 0; i--) {
+      if (m_edges.at(std::make_pair(frames[i - 1], frames[i])).timeDependent) {
+        return frames[i];
+      }
+    }
+    return source;
+  }
+
+
+  const Orientations &FrameChain::compute(int source, int destination) {
+    std::pair<int, int> key = std::make_pair(source, destination);
+    std::map<std::pair<int, int>, Orientations>::const_iterator cached = m_cache.find(key);
+    if (cached != m_cache.end()) {
+      return cached->second;
+    }
+
+    std::vector<int> frames = path(source, destination);
+    std::vector<const Edge *> edges;
+    for (size_t i = 0; i + 1 < frames.size(); i++) {
+      edges.push_back(&m_edges.at(std::make_pair(frames[i], frames[i + 1])));
+    }
+
+    // The number of edges up to and including the last time dependent one
+    size_t numTimeDep = 0;
+    for (size_t i = 0; i < edges.size(); i++) {
+      if (edges[i]->timeDependent) {
+        numTimeDep = i + 1;
+      }
+    }
+
+    // Merge everything up to the last time dependent frame into the time dependent rotations
+    Rotation preceding;
+    Orientations timeDep({Rotation()}, {0.0});
+    bool haveTimeDep = false;
+    for (size_t i = 0; i < numTimeDep; i++) {
+      if (!haveTimeDep) {
+        if (edges[i]->timeDependent) {
+          timeDep = edges[i]->orientations * preceding;
+          haveTimeDep = true;
+        }
+        else {
+          preceding = edges[i]->rotation * preceding;
+        }
+      }
+      else if (edges[i]->timeDependent) {
+        timeDep = edges[i]->orientations * timeDep;
+      }
+      else {
+        timeDep = foldConstantRotation(edges[i]->rotation * timeDep);
+      }
+    }
+
+    // Then fold the rest into the constant rotation
+    Rotation constRot;
+    for (size_t i = numTimeDep; i < edges.size(); i++) {
+      constRot = edges[i]->rotation * constRot;
+    }
+
+    std::vector<int> constFrames(frames.rbegin(), frames.rend() - numTimeDep);
+    std::vector<int> timeDepFrames(frames.rend() - numTimeDep - 1, frames.rend());
+    Orientations composed(timeDep.getRotations(), timeDep.getTimes(),
+                          timeDep.getAngularVelocities(), constRot, constFrames, timeDepFrames);
+    return m_cache.insert(std::make_pair(key, composed)).first->second;
+  }
+
+
+  Rotation FrameChain::rotationAt(int source, int destination, double time) {
+    return compute(source, destination).interpolate(time);
+  }
+
+
+  void FrameChain::clearCache() {
+    m_cache.clear();
+  }
+
+
+  void FrameChain::addEdge(int source, int destination, const Edge &edge) {
+    std::pair<int, int> key = std::make_pair(source, destination);
+    if (m_edges.find(key) == m_edges.end()) {
+      m_adjacent[source].push_back(destination);
+      // Make sure the destination is a frame even if nothing rotates from it
+      m_adjacent[destination];
+    }
+    m_edges[key] = edge;
+    clearCache();
+  }
+}
@@ -4,7 +4,6 @@
 #include <stdexcept>
 
 #include <algorithm>
-#include <unordered_set>
 
 namespace ale {
 
@@ -37,31 +36,107 @@ namespace ale {
     if (times.empty()){
       throw std::invalid_argument("There must be at least one time.");
     }
-    auto nextTimeIt = std::upper_bound(times.begin(), times.end(), interpTime);
-    if (nextTimeIt == times.end()) {
+    return interpolationIndex(times.data(), times.size(), interpTime);
+  }
+
+  int interpolationIndex(const double *times, size_t numTimes, double interpTime) {
+    if (numTimes == 0){
+      throw std::invalid_argument("There must be at least one time.");
+    }
+    const double *nextTimeIt = std::upper_bound(times, times + numTimes, interpTime);
+    if (nextTimeIt == times + numTimes) {
       --nextTimeIt;
     }
-    if (nextTimeIt != times.begin()) {
+    if (nextTimeIt != times) {
       --nextTimeIt;
     }
-    return std::distance(times.begin(), nextTimeIt);
+    return nextTimeIt - times;
+  }
+
+  InterpolationCursor::InterpolationCursor(const std::vector<double> &times) :
+    m_times(&times), m_index(-1) { }
+
+
+  int InterpolationCursor::index(double interpTime) {
+    const std::vector<double> &times = *m_times;
+    if (times.empty()) {
+      throw std::invalid_argument("There must be at least one time.");
+    }
+    int lastIndex = std::max((int) times.size() - 2, 0);
+
+    // Walk to a neighboring interval for small steps
+    if (m_index >= 0 && m_index <= lastIndex) {
+      for (int step = 0; step < 8; step++) {
+        if (m_index < lastIndex && interpTime >= times[m_index + 1]) {
+          m_index++;
+        }
+        else if (m_index > 0 && interpTime < times[m_index]) {
+          m_index--;
+        }
+        else {
+          return m_index;
+        }
+      }
+    }
+
+    // Jumps fall back to a binary search
+    m_index = interpolationIndex(times, interpTime);
+    return m_index;
   }
 
+
+  int InterpolationCursor::getIndex() const {
+    return m_index;
+  }
+
+
+  void InterpolationCursor::hint(int index) {
+    m_index = index;
+  }
+
+
+  void InterpolationCursor::reset() {
+    m_index = -1;
+  }
+
+
   std::vector<double> orderedVecMerge(const std::vector<double> &x, const std::vector<double> &y) {
-    std::unordered_set<double> mergedSet;
-    for (double val: x) {
-      mergedSet.insert(val);
+    // Only sort copies of the inputs that are not already sorted
+    std::vector<double> sortedX;
+    std::vector<double> sortedY;
+    const std::vector<double> *first = &x;
+    const std::vector<double> *second = &y;
+    if (!std::is_sorted(x.begin(), x.end())) {
+      sortedX = x;
+      std::sort(sortedX.begin(), sortedX.end());
+      first = &sortedX;
     }
-    for (double val: y) {
-      mergedSet.insert(val);
+    if (!std::is_sorted(y.begin(), y.end())) {
+      sortedY = y;
+      std::sort(sortedY.begin(), sortedY.end());
+      second = &sortedY;
     }
+
+    // Walk both vectors in lockstep, skipping duplicates
     std::vector<double> merged;
-    merged.assign(mergedSet.begin(), mergedSet.end());
-    std::sort(merged.begin(), merged.end());
+    merged.reserve(first->size() + second->size());
+    size_t i = 0;
+    size_t j = 0;
+    while (i < first->size() || j < second->size()) {
+      double val;
+      if (j == second->size() || (i < first->size() && (*first)[i] <= (*second)[j])) {
+        val = (*first)[i++];
+      }
+      else {
+        val = (*second)[j++];
+      }
+      if (merged.empty() || merged.back() != val) {
+        merged.push_back(val);
+      }
+    }
     return merged;
   }
 
-
   /** The following helper functions are used to calculate the reduced states cache and cubic hermite
   to interpolate over it. They were migrated, with minor modifications, from
   Isis::NumericalApproximation **/
@@ -77,21 +152,10 @@ namespace ale {
     // Find the interval in which "a" exists
     int lowerIndex = interpolationIndex(x, interpTime);
 
-    double x0, x1, y0, y1, m0, m1;
-    // interpTime is contained within the interval (x0,x1)
-    x0 = x[lowerIndex];
-    x1 = x[lowerIndex+1];
-    // the corresponding known y-values for x0 and x1
-    y0 = y[lowerIndex];
-    y1 = y[lowerIndex+1];
-    // the corresponding known tangents (slopes) at (x0,y0) and (x1,y1)
-    m0 = derivs[lowerIndex];
-    m1 = derivs[lowerIndex+1];
-
-    double h, t;
-    h = x1 - x0;
-    t = (interpTime - x0) / h;
-    return (2 * t * t * t - 3 * t * t + 1) * y0 + (t * t * t - 2 * t * t + t) * h * m0 + (-2 * t * t * t + 3 * t * t) * y1 + (t * t * t - t * t) * h * m1;
+    double value, derivative;
+    cubicHermite(x[lowerIndex], x[lowerIndex + 1], y[lowerIndex], y[lowerIndex + 1],
+                 derivs[lowerIndex], derivs[lowerIndex + 1], interpTime, value, derivative);
+    return value;
   }
 
   /** Evaluate velocities using a Cubic Hermite Spline at a time a, within some interval in x, **/
@@ -104,100 +168,94 @@ namespace ale {
     // find the interval in which "interpTime" exists
     int lowerIndex = interpolationIndex(times, interpTime);
 
-    double x0, x1, y0, y1, m0, m1;
-
-    // interpTime is contained within the interval (x0,x1)
-    x0 = times[lowerIndex];
-    x1 = times[lowerIndex+1];
+    double value, derivative;
+    cubicHermite(times[lowerIndex], times[lowerIndex + 1], y[lowerIndex], y[lowerIndex + 1],
+                 deriv[lowerIndex], deriv[lowerIndex + 1], interpTime, value, derivative);
+    return derivative;
+  }
 
-    // the corresponding known y-values for x0 and x1
-    y0 = y[lowerIndex];
-    y1 = y[lowerIndex+1];
+  namespace {
+    template<int Order>
+    void fixedLagrange(const std::vector<double>& times, const std::vector<double>& values,
+                       double time, double &value, double &derivative) {
+      LagrangeBasis<Order> basis(times.data(), times.size(), interpolationIndex(times, time), time);
+      basis.interpolate(values.data(), value, derivative);
+    }
 
-    // the corresponding known tangents (slopes) at (x0,y0) and (x1,y1)
-    m0 = deriv[lowerIndex];
-    m1 = deriv[lowerIndex+1];
+    // Interpolate with the fixed window kernel for the order, if there is one
+    void lagrange(const std::vector<double>& times, const std::vector<double>& values,
+                  double time, int order, double &value, double &derivative) {
+      // Ensure the times and values have the same length
+      if (times.size() != values.size()) {
+        throw std::invalid_argument("Times and values must have the same length.");
+      }
 
-    double h, t;
-    h = x1 - x0;
-    t = (interpTime - x0) / h;
-    if(h != 0.0) {
-      return ((6 * t * t - 6 * t) * y0 + (3 * t * t - 4 * t + 1) * h * m0 + (-6 * t * t + 6 * t) * y1 + (3 * t * t - 2 * t) * h * m1) / h;
+      switch (order / 2) {
+        case 1:
+          fixedLagrange<2>(times, values, time, value, derivative);
+          return;
+        case 2:
+          fixedLagrange<4>(times, values, time, value, derivative);
+          return;
+        case 3:
+          fixedLagrange<6>(times, values, time, value, derivative);
+          return;
+        case 4:
+          fixedLagrange<8>(times, values, time, value, derivative);
+          return;
+        default:
+          break;
+      }
 
-    }
-    else {
-      throw std::invalid_argument("Error in evaluating cubic hermite velocities, values at"
-                                  "lower and upper indicies are exactly equal.");
+      // Get the correct interpolation window
+      int index = interpolationIndex(times, time);
+      int windowSize = std::min(index + 1, (int) times.size() - index - 1);
+      windowSize = std::max(std::min(windowSize, (int) order / 2), 0);
+      int startIndex = index - windowSize + 1;
+      int size = 2 * windowSize;
+
+      std::vector<double> basis(size), basisDerivatives(size);
+      lagrangeBasis(times.data() + startIndex, size, time, basis.data(), basisDerivatives.data());
+      value = 0;
+      derivative = 0;
+      for (int i = 0; i < size; i++) {
+        value += basis[i] * values[startIndex + i];
+        derivative += basisDerivatives[i] * values[startIndex + i];
+      }
     }
   }
 
   double lagrangeInterpolate(const std::vector<double>& times,
                              const std::vector<double>& values,
                              double time, int order) {
-    // Ensure the times and values have the same length
-    if (times.size() != values.size()) {
-      throw std::invalid_argument("Times and values must have the same length.");
-    }
-
-    // Get the correct interpolation window
-    int index = interpolationIndex(times, time);
-    int windowSize = std::min(index + 1, (int) times.size() - index - 1);
-    windowSize = std::min(windowSize, (int) order / 2);
-    int startIndex = index - windowSize + 1;
-    int endIndex = index + windowSize + 1;
-
-    // Interpolate
-    double result = 0;
-    for (int i = startIndex; i < endIndex; i++) {
-      double weight = 1;
-      double numerator = 1;
-      for (int j = startIndex; j < endIndex; j++) {
-        if (i == j) {
-          continue;
-        }
-        weight *= times[i] - times[j];
-        numerator *= time - times[j];
-      }
-      result += numerator * values[i] / weight;
-    }
-    return result;
+    double value, derivative;
+    lagrange(times, values, time, order, value, derivative);
+    return value;
   }
 
   double lagrangeInterpolateDerivative(const std::vector<double>& times,
                                        const std::vector<double>& values,
                                        double time, int order) {
-    // Ensure the times and values have the same length
-    if (times.size() != values.size()) {
-      throw std::invalid_argument("Times and values must have the same length.");
-    }
-
-    // Get the correct interpolation window
-    int index = interpolationIndex(times, time);
-    int windowSize = std::min(index + 1, (int) times.size() - index - 1);
-    windowSize = std::min(windowSize, (int) order / 2);
-    int startIndex = index - windowSize + 1;
-    int endIndex = index + windowSize + 1;
-
-    // Interpolate
-    double result = 0;
-    for (int i = startIndex; i < endIndex; i++) {
-      double weight = 1;
-      double derivativeWeight = 0;
-      double numerator = 1;
-      for (int j = startIndex; j < endIndex; j++) {
-        if (i == j) {
-          continue;
-        }
-        weight *= times[i] - times[j];
-        numerator *= time - times[j];
-        derivativeWeight += 1.0 / (time - times[j]);
-      }
-      result += numerator * values[i] * derivativeWeight / weight;
-    }
-    return result;
+    double value, derivative;
+    lagrange(times, values, time, order, value, derivative);
+    return derivative;
   }
 
- double interpolate(std::vector<double> points, std::vector<double> times, double time, PositionInterpolation interp, int d) {
+ int interpolationOrder(PositionInterpolation interp) {
+   switch(interp) {
+     case LINEAR:
+       return 2;
+     case SPLINE:
+       return 4;
+     case LAGRANGE:
+       return 8;
+     default:
+       throw std::invalid_argument("Invalid interpolation option, must be LINEAR, SPLINE, or LAGRANGE.");
+   }
+ }
+
+ double interpolate(const std::vector<double> &points, const std::vector<double> &times,
+                    double time, PositionInterpolation interp, int d) {
    size_t numPoints = points.size();
    if (numPoints < 2) {
      throw std::invalid_argument("At least two points must be input to interpolate over.");
@@ -206,20 +264,7 @@ namespace ale {
      throw std::invalid_argument("Must have the same number of points as times.");
    }
 
-   int order;
-   switch(interp) {
-     case LINEAR:
-       order = 2;
-       break;
-     case SPLINE:
-       order = 4;
-       break;
-     case LAGRANGE:
-       order = 8;
-       break;
-     default:
-       throw std::invalid_argument("Invalid interpolation option, must be LINEAR, SPLINE, or LAGRANGE.");
-   }
+   int order = interpolationOrder(interp);
 
    double result;
    switch(d) {
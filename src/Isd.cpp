@@ -1,12 +1,684 @@
 
 #include "ale/Isd.h"
+#include "ale/BinaryIsd.h"
 #include "ale/Util.h"
 
+#include <sstream>
+
 using json = nlohmann::json;
 
-ale::Isd::Isd(std::string isd_file) {
-  json isd = json::parse(isd_file);
+namespace {
+
+  /**
+   * An array of numbers streamed out of an ISD. Nested arrays such as
+   * positions are stored flattened with width entries per row.
+   */
+  struct StreamedArray {
+    StreamedArray(size_t width=0) : width(width), present(false), valid(true) {}
+
+    std::vector<double> values; //!< The flattened values
+    size_t width; //!< The number of values kept per row, 0 for a flat array
+    bool present; //!< If the array was in the ISD
+    bool valid; //!< If every entry could be read as a number
+  };
+
+
+  /**
+   * The arrays streamed out of one of the ephemeris or pointing sections.
+   */
+  struct StreamedSection {
+    std::map<std::string, StreamedArray> arrays;
+
+    // Get a flat array, throws if it is missing or could not be read
+    const StreamedArray &at(const std::string &key) const {
+      const StreamedArray &array = arrays.at(key);
+      if (!array.present || !array.valid) {
+        throw std::runtime_error("Could not parse the " + key + " array.");
+      }
+      return array;
+    }
+
+    bool has(const std::string &key) const {
+      return arrays.at(key).present;
+    }
+
+    std::vector<double> getDoubles(const std::string &key) const {
+      return at(key).values;
+    }
+
+    std::vector<ale::Vec3d> getVec3ds(const std::string &key) const {
+      const std::vector<double> &values = at(key).values;
+      std::vector<ale::Vec3d> vecs;
+      vecs.reserve(values.size() / 3);
+      for (size_t i = 0; i + 2 < values.size(); i += 3) {
+        vecs.push_back(ale::Vec3d(values[i], values[i + 1], values[i + 2]));
+      }
+      return vecs;
+    }
+
+    std::vector<ale::Rotation> getRotations(const std::string &key) const {
+      const std::vector<double> &values = at(key).values;
+      std::vector<ale::Rotation> rotations;
+      rotations.reserve(values.size() / 4);
+      for (size_t i = 0; i + 3 < values.size(); i += 4) {
+        rotations.push_back(ale::Rotation(values[i], values[i + 1], values[i + 2], values[i + 3]));
+      }
+      return rotations;
+    }
+  };
+
+
+  StreamedSection positionSection() {
+    StreamedSection section;
+    section.arrays["ephemeris_times"] = StreamedArray(0);
+    section.arrays["positions"] = StreamedArray(3);
+    section.arrays["velocities"] = StreamedArray(3);
+    return section;
+  }
+
+
+  StreamedSection rotationSection() {
+    StreamedSection section;
+    section.arrays["ephemeris_times"] = StreamedArray(0);
+    section.arrays["quaternions"] = StreamedArray(4);
+    section.arrays["angular_velocities"] = StreamedArray(3);
+    return section;
+  }
+
+
+  /**
+   * SAX handler that reads an ISD in a single pass.
+   *
+   * The large arrays in the instrument_position, sun_position,
+   * instrument_pointing, and body_rotation sections are streamed directly
+   * into flat buffers. Everything else is built into a json DOM, which is
+   * small enough to read with the getters in Util.h.
+   */
+  class IsdSaxHandler : public nlohmann::json_sax<json> {
+    public:
+      IsdSaxHandler(json &root, std::map<std::string, StreamedSection> &sections) :
+        m_root(root), m_sections(sections), m_section(sections.end()), m_depth(0), m_pendingArray(nullptr),
+        m_array(nullptr), m_arrayDepth(0), m_rowSize(0) {}
+
+      bool null() override {
+        if (streamScalar()) {
+          m_array->valid = false;
+          return true;
+        }
+        addValue(nullptr);
+        return true;
+      }
+
+      bool boolean(bool val) override {
+        if (streamScalar()) {
+          m_array->valid = false;
+          return true;
+        }
+        addValue(val);
+        return true;
+      }
+
+      bool number_integer(number_integer_t val) override {
+        if (streamScalar()) {
+          addNumber(static_cast<double>(val));
+          return true;
+        }
+        addValue(val);
+        return true;
+      }
+
+      bool number_unsigned(number_unsigned_t val) override {
+        if (streamScalar()) {
+          addNumber(static_cast<double>(val));
+          return true;
+        }
+        addValue(val);
+        return true;
+      }
+
+      bool number_float(number_float_t val, const string_t &) override {
+        if (streamScalar()) {
+          addNumber(val);
+          return true;
+        }
+        addValue(val);
+        return true;
+      }
+
+      bool string(string_t &val) override {
+        if (streamScalar()) {
+          m_array->valid = false;
+          return true;
+        }
+        addValue(val);
+        return true;
+      }
+
+      bool binary(binary_t &val) override {
+        if (streamScalar()) {
+          m_array->valid = false;
+          return true;
+        }
+        addValue(json::binary(val));
+        return true;
+      }
+
+      bool start_object(std::size_t) override {
+        m_depth++;
+        if (startStream()) {
+          // Only arrays can be streamed
+          m_array->valid = false;
+          return true;
+        }
+        if (m_array) {
+          m_array->valid = false;
+          return true;
+        }
+        m_domStack.push_back(addValue(json::object()));
+        return true;
+      }
+
+      bool end_object() override {
+        if (endStream()) {
+          return true;
+        }
+        if (m_array) {
+          m_depth--;
+          return true;
+        }
+        m_depth--;
+        m_domStack.pop_back();
+        return true;
+      }
+
+      bool start_array(std::size_t) override {
+        m_depth++;
+        if (startStream()) {
+          return true;
+        }
+        if (m_array) {
+          if (m_depth == m_arrayDepth + 1 && m_array->width > 0) {
+            m_rowSize = 0;
+          }
+          else {
+            m_array->valid = false;
+          }
+          return true;
+        }
+        m_domStack.push_back(addValue(json::array()));
+        return true;
+      }
+
+      bool end_array() override {
+        if (endStream()) {
+          return true;
+        }
+        if (m_array) {
+          if (m_depth == m_arrayDepth + 1 && m_array->width > 0 && m_rowSize < m_array->width) {
+            m_array->valid = false;
+          }
+          m_depth--;
+          return true;
+        }
+        m_depth--;
+        m_domStack.pop_back();
+        return true;
+      }
+
+      bool key(string_t &val) override {
+        if (m_array) {
+          return true;
+        }
+        m_key = val;
+        if (m_depth == 1) {
+          m_section = m_sections.find(val);
+        }
+        else if (m_depth == 2 && m_section != m_sections.end()) {
+          std::map<std::string, StreamedArray>::iterator it = m_section->second.arrays.find(val);
+          if (it != m_section->second.arrays.end()) {
+            m_pendingArray = &it->second;
+          }
+        }
+        return true;
+      }
+
+      bool parse_error(std::size_t, const std::string &, const nlohmann::detail::exception &ex) override {
+        if (const json::parse_error *parseError = dynamic_cast<const json::parse_error *>(&ex)) {
+          throw *parseError;
+        }
+        if (const json::out_of_range *outOfRange = dynamic_cast<const json::out_of_range *>(&ex)) {
+          throw *outOfRange;
+        }
+        throw std::runtime_error(ex.what());
+      }
+
+    private:
+      // Add a value to the DOM at the current position
+      json *addValue(json &&val) {
+        if (m_domStack.empty()) {
+          m_root = std::move(val);
+          return &m_root;
+        }
+        json &parent = *m_domStack.back();
+        if (parent.is_array()) {
+          parent.push_back(std::move(val));
+          return &parent.back();
+        }
+        json &child = parent[m_key];
+        child = std::move(val);
+        return &child;
+      }
+
+      // Start streaming if the current container is a streamed array
+      bool startStream() {
+        if (!m_pendingArray) {
+          return false;
+        }
+        m_array = m_pendingArray;
+        m_pendingArray = nullptr;
+        // Later duplicate keys overwrite earlier ones, like in a DOM
+        m_array->values.clear();
+        m_array->present = true;
+        m_array->valid = true;
+        m_arrayDepth = m_depth;
+        return true;
+      }
+
+      // Stop streaming if the current container is the streamed array
+      bool endStream() {
+        if (!m_array || m_depth != m_arrayDepth) {
+          return false;
+        }
+        m_array = nullptr;
+        m_depth--;
+        return true;
+      }
+
+      // Returns true if a scalar belongs to a streamed array
+      bool streamScalar() {
+        if (m_pendingArray) {
+          // A streamed key that is not a container
+          m_pendingArray->values.clear();
+          m_pendingArray->present = true;
+          m_pendingArray->valid = false;
+          m_pendingArray = nullptr;
+          return false;
+        }
+        return m_array != nullptr;
+      }
+
+      void addNumber(double val) {
+        if (m_array->width == 0) {
+          if (m_depth == m_arrayDepth) {
+            m_array->values.push_back(val);
+          }
+          else {
+            m_array->valid = false;
+          }
+        }
+        else if (m_depth == m_arrayDepth + 1) {
+          // Extra entries in a row are ignored
+          if (m_rowSize < m_array->width) {
+            m_array->values.push_back(val);
+          }
+          m_rowSize++;
+        }
+        else {
+          m_array->valid = false;
+        }
+      }
+
+      json &m_root; //!< The DOM for everything that is not streamed
+      std::map<std::string, StreamedSection> &m_sections; //!< The streamed sections
+      std::map<std::string, StreamedSection>::iterator m_section; //!< The section being read, if any
+      std::vector<json *> m_domStack; //!< The open DOM containers
+      std::string m_key; //!< The last object key
+      size_t m_depth; //!< The number of open containers
+      StreamedArray *m_pendingArray; //!< The streamed array whose value is next
+      StreamedArray *m_array; //!< The array being streamed, if any
+      size_t m_arrayDepth; //!< The depth of the array being streamed
+      size_t m_rowSize; //!< The number of values in the current row
+  };
+
+
+  ale::States getStreamedStates(const json &isd, const std::string &name,
+                                const StreamedSection &section) {
+    const json &pos = isd.at(name);
+    std::vector<ale::Vec3d> positions = section.getVec3ds("positions");
+    std::vector<double> times = section.getDoubles("ephemeris_times");
+    int refFrame = pos.at("reference_frame").get<int>();
+
+    if (section.has("velocities")) {
+      std::vector<ale::Vec3d> velocities = section.getVec3ds("velocities");
+      return ale::States(times, positions, velocities, refFrame);
+    }
+
+    return ale::States(times, positions, refFrame);
+  }
+
+
+  ale::Orientations getStreamedOrientations(const json &isd, const std::string &name,
+                                            const StreamedSection &section) {
+    const json &rot = isd.at(name);
+    std::vector<ale::Rotation> rotations = section.getRotations("quaternions");
+    std::vector<double> times = section.getDoubles("ephemeris_times");
+    std::vector<ale::Vec3d> velocities = section.getVec3ds("angular_velocities");
+
+    std::vector<int> constFrames;
+    if (rot.find("constant_frames") != rot.end()){
+      constFrames  = ale::getJsonArray<int>(rot.at("constant_frames"));
+    }
+
+    std::vector<int> timeDepFrames;
+    if (rot.find("time_dependent_frames") != rot.end()){
+      timeDepFrames = ale::getJsonArray<int>(rot.at("time_dependent_frames"));
+    }
+
+    std::vector<double> rotArray = {1,0,0,0,1,0,0,0,1};
+    if (rot.find("constant_rotation") != rot.end()){
+      rotArray = ale::getJsonArray<double>(rot.at("constant_rotation"));
+    }
+
+    ale::Rotation constRot(rotArray);
+
+    return ale::Orientations(rotations, times, velocities, constRot, constFrames, timeDepFrames);
+  }
+
+
+  // The top level entries that LazyIsd reads on demand
+  bool isLazySection(const std::string &key) {
+    return key == "instrument_position" || key == "sun_position" ||
+           key == "instrument_pointing" || key == "body_rotation";
+  }
+
+
+  bool isWhitespace(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+  }
+
+
+  size_t skipWhitespace(const std::string &text, size_t pos) {
+    while (pos < text.size() && isWhitespace(text[pos])) {
+      pos++;
+    }
+    return pos;
+  }
+
+
+  // Skip a string starting at its opening quote, returns the position after the closing quote
+  size_t skipString(const std::string &text, size_t pos) {
+    for (pos++; pos < text.size(); pos++) {
+      if (text[pos] == '\\') {
+        pos++;
+      }
+      else if (text[pos] == '"') {
+        return pos + 1;
+      }
+    }
+    throw std::runtime_error("Could not index the ISD, a string is not terminated.");
+  }
+
+
+  // Skip a JSON value without checking it, returns the position after it
+  size_t skipValue(const std::string &text, size_t pos) {
+    if (pos >= text.size()) {
+      throw std::runtime_error("Could not index the ISD, a value is missing.");
+    }
+    if (text[pos] == '"') {
+      return skipString(text, pos);
+    }
+    if (text[pos] == '{' || text[pos] == '[') {
+      size_t depth = 0;
+      while (pos < text.size()) {
+        char c = text[pos];
+        if (c == '"') {
+          pos = skipString(text, pos);
+          continue;
+        }
+        if (c == '{' || c == '[') {
+          depth++;
+        }
+        else if (c == '}' || c == ']') {
+          depth--;
+        }
+        pos++;
+        if (depth == 0) {
+          return pos;
+        }
+      }
+      throw std::runtime_error("Could not index the ISD, an object or array is not terminated.");
+    }
+    size_t start = pos;
+    while (pos < text.size() && text[pos] != ',' && text[pos] != '}' && text[pos] != ']'
+           && !isWhitespace(text[pos])) {
+      pos++;
+    }
+    if (pos == start) {
+      throw std::runtime_error("Could not index the ISD, a value is missing.");
+    }
+    return pos;
+  }
+
+
+  /**
+   * Find the start and end of the value of each top level entry in an ISD.
+   * Later duplicate keys replace earlier ones, like in a DOM.
+   */
+  std::map<std::string, std::pair<size_t, size_t>> indexTopLevel(const std::string &text) {
+    std::map<std::string, std::pair<size_t, size_t>> entries;
+    size_t pos = skipWhitespace(text, 0);
+    if (pos >= text.size() || text[pos] != '{') {
+      throw std::runtime_error("Could not index the ISD, it is not a JSON object.");
+    }
+    pos = skipWhitespace(text, pos + 1);
+    if (pos < text.size() && text[pos] == '}') {
+      return entries;
+    }
+    while (true) {
+      if (pos >= text.size() || text[pos] != '"') {
+        throw std::runtime_error("Could not index the ISD, expected a key.");
+      }
+      size_t keyStart = pos;
+      pos = skipString(text, pos);
+      std::string key = text.substr(keyStart + 1, pos - keyStart - 2);
+      if (key.find('\\') != std::string::npos) {
+        key = json::parse(text.begin() + keyStart, text.begin() + pos).get<std::string>();
+      }
+
+      pos = skipWhitespace(text, pos);
+      if (pos >= text.size() || text[pos] != ':') {
+        throw std::runtime_error("Could not index the ISD, expected a colon after " + key + ".");
+      }
+      pos = skipWhitespace(text, pos + 1);
+      size_t valueStart = pos;
+      pos = skipValue(text, pos);
+      entries[key] = std::make_pair(valueStart, pos);
+
+      pos = skipWhitespace(text, pos);
+      if (pos < text.size() && text[pos] == ',') {
+        pos = skipWhitespace(text, pos + 1);
+      }
+      else if (pos < text.size() && text[pos] == '}') {
+        return entries;
+      }
+      else {
+        throw std::runtime_error("Could not index the ISD, expected a comma or closing brace.");
+      }
+    }
+  }
+
+
+  // Read one position or rotation section out of the text of its value
+  json readLazySection(const std::string &source,
+                       const std::map<std::string, std::pair<size_t, size_t>> &ranges,
+                       const std::string &name, StreamedSection &section) {
+    std::map<std::string, std::pair<size_t, size_t>>::const_iterator range = ranges.find(name);
+    if (range == ranges.end()) {
+      throw std::runtime_error("The ISD has no " + name + ".");
+    }
+    std::string text = "{\"" + name + "\":"
+                     + source.substr(range->second.first, range->second.second - range->second.first)
+                     + "}";
+    json isd;
+    std::map<std::string, StreamedSection> sections;
+    sections[name] = section;
+    IsdSaxHandler handler(isd, sections);
+    json::sax_parse(text, &handler);
+    section = sections[name];
+    return isd;
+  }
+
+
+  ale::States readLazyStates(const std::string &source,
+                             const std::map<std::string, std::pair<size_t, size_t>> &ranges,
+                             const std::string &name, const std::string &error) {
+    try {
+      StreamedSection section = positionSection();
+      json isd = readLazySection(source, ranges, name, section);
+      return getStreamedStates(isd, name, section);
+    } catch (...) {
+      throw std::runtime_error(error);
+    }
+  }
+
 
+  ale::Orientations readLazyOrientations(const std::string &source,
+                                         const std::map<std::string, std::pair<size_t, size_t>> &ranges,
+                                         const std::string &name, const std::string &error) {
+    try {
+      StreamedSection section = rotationSection();
+      json isd = readLazySection(source, ranges, name, section);
+      return getStreamedOrientations(isd, name, section);
+    } catch (...) {
+      throw std::runtime_error(error);
+    }
+  }
+}
+
+ale::Isd::Isd(std::string isd_file, Stats *stats) {
+  load(isd_file, stats, isd_file.size());
+}
+
+ale::Isd::Isd(std::istream &isd_stream, Stats *stats) {
+  load(isd_stream, stats, 0);
+}
+
+ale::Isd::Isd(const BinaryIsd &binary_isd, Stats *stats) {
+  {
+    Stats::Timer timer(stats, "isd.metadata");
+    loadMetadata(binary_isd.getMetadata());
+  }
+
+  try {
+    Stats::Timer timer(stats, "isd.instrument_position");
+    inst_pos = binary_isd.getStates("instrument_position");
+    timer.setSize(inst_pos.getTimes().size());
+  } catch (...) {
+    throw std::runtime_error("Could not parse the instrument position");
+  }
+
+  try {
+    Stats::Timer timer(stats, "isd.sun_position");
+    sun_pos = binary_isd.getStates("sun_position");
+    timer.setSize(sun_pos.getTimes().size());
+  } catch (...) {
+    throw std::runtime_error("Could not parse the sun position");
+  }
+
+  try {
+    Stats::Timer timer(stats, "isd.instrument_pointing");
+    inst_pointing = binary_isd.getOrientations("instrument_pointing");
+    timer.setSize(inst_pointing.getTimes().size());
+  } catch (...) {
+    throw std::runtime_error("Could not parse the instrument pointing");
+  }
+
+  try {
+    Stats::Timer timer(stats, "isd.body_rotation");
+    body_rotation = binary_isd.getOrientations("body_rotation");
+    timer.setSize(body_rotation.getTimes().size());
+  } catch (...) {
+    throw std::runtime_error("Could not parse the body rotation");
+  }
+}
+
+ale::Isd::Isd(const LazyIsd &lazy_isd) {
+  loadMetadata(lazy_isd.getMetadata());
+  inst_pos = lazy_isd.getInstrumentPosition();
+  sun_pos = lazy_isd.getSunPosition();
+  inst_pointing = lazy_isd.getInstrumentPointing();
+  body_rotation = lazy_isd.getBodyRotation();
+}
+
+template<typename InputType>
+void ale::Isd::load(InputType &&input, Stats *stats, size_t inputSize) {
+  json isd;
+  std::map<std::string, StreamedSection> sections;
+  sections["instrument_position"] = positionSection();
+  sections["sun_position"] = positionSection();
+  sections["instrument_pointing"] = rotationSection();
+  sections["body_rotation"] = rotationSection();
+  {
+    Stats::Timer timer(stats, "isd.parse");
+    timer.setSize(inputSize);
+    IsdSaxHandler handler(isd, sections);
+    json::sax_parse(std::forward<InputType>(input), &handler);
+  }
+
+  {
+    Stats::Timer timer(stats, "isd.metadata");
+    loadMetadata(isd);
+  }
+
+  try {
+    Stats::Timer timer(stats, "isd.instrument_position");
+    inst_pos = getStreamedStates(isd, "instrument_position", sections["instrument_position"]);
+    timer.setSize(inst_pos.getTimes().size());
+  } catch (...) {
+    throw std::runtime_error("Could not parse the instrument position");
+  }
+
+  try {
+    Stats::Timer timer(stats, "isd.sun_position");
+    sun_pos = getStreamedStates(isd, "sun_position", sections["sun_position"]);
+    timer.setSize(sun_pos.getTimes().size());
+  } catch (...) {
+    throw std::runtime_error("Could not parse the sun position");
+  }
+
+  try {
+    Stats::Timer timer(stats, "isd.instrument_pointing");
+    inst_pointing = getStreamedOrientations(isd, "instrument_pointing", sections["instrument_pointing"]);
+    timer.setSize(inst_pointing.getTimes().size());
+  } catch (...) {
+    throw std::runtime_error("Could not parse the instrument pointing");
+  }
+
+  try {
+    Stats::Timer timer(stats, "isd.body_rotation");
+    body_rotation = getStreamedOrientations(isd, "body_rotation", sections["body_rotation"]);
+    timer.setSize(body_rotation.getTimes().size());
+  } catch (...) {
+    throw std::runtime_error("Could not parse the body rotation");
+  }
+}
+
+ale::Isd::Geometry ale::Isd::geometryAt(double time) const {
+  GeometryCursor cursor(*this);
+  return cursor.geometryAt(time);
+}
+
+std::vector<ale::Isd::Geometry> ale::Isd::geometryAt(const std::vector<double> &times) const {
+  std::vector<Geometry> geometries;
+  geometries.reserve(times.size());
+  GeometryCursor cursor(*this);
+  for (double time : times) {
+    geometries.push_back(cursor.geometryAt(time));
+  }
+  return geometries;
+}
+
+void ale::Isd::loadMetadata(const json &isd) {
   usgscsm_name_model = getSensorModelName(isd);
   image_id = getImageId(isd);
   name_platform = getPlatformName(isd);
@@ -52,10 +724,146 @@ ale::Isd::Isd(std::string isd_file) {
   distortion_coefficients = getDistortionCoeffs(isd);
 
   interpMethod = getInterpolationMethod(isd);
+}
+
+namespace {
+  // If two sets of times look like the same time grid
+  bool sameTimeGrid(const std::vector<double> &first, const std::vector<double> &second) {
+    return !first.empty() && first.size() == second.size() &&
+           first.front() == second.front() && first.back() == second.back();
+  }
+}
+
+ale::Isd::GeometryCursor::GeometryCursor(const Isd &isd) :
+  m_isd(isd), m_instPos(isd.inst_pos), m_sunPos(isd.sun_pos),
+  m_instPointing(isd.inst_pointing), m_bodyRotation(isd.body_rotation),
+  m_sunSharesGrid(sameTimeGrid(isd.inst_pos.getTimes(), isd.sun_pos.getTimes())),
+  m_pointingSharesGrid(sameTimeGrid(isd.inst_pos.getTimes(), isd.inst_pointing.getTimes())),
+  m_bodySharesGrid(sameTimeGrid(isd.inst_pointing.getTimes(), isd.body_rotation.getTimes())) { }
+
+ale::Isd::Geometry ale::Isd::GeometryCursor::geometryAt(double time) {
+  Geometry geometry;
+  geometry.time = time;
+
+  if (!m_isd.inst_pos.getTimes().empty()) {
+    geometry.instrumentState = m_instPos.getState(time, m_isd.interpMethod);
+  }
+
+  if (!m_isd.sun_pos.getTimes().empty()) {
+    if (m_sunSharesGrid) {
+      m_sunPos.hint(m_instPos.getIndex());
+    }
+    geometry.sunPosition = m_sunPos.getPosition(time, m_isd.interpMethod);
+  }
+
+  if (!m_isd.inst_pointing.getTimes().empty()) {
+    if (m_pointingSharesGrid) {
+      m_instPointing.hint(m_instPos.getIndex());
+    }
+    geometry.instrumentPointing = m_instPointing.interpolate(time, geometry.instrumentAngularVelocity);
+  }
+
+  if (!m_isd.body_rotation.getTimes().empty()) {
+    if (m_bodySharesGrid) {
+      m_bodyRotation.hint(m_instPointing.getIndex());
+    }
+    geometry.bodyRotation = m_bodyRotation.interpolate(time, geometry.bodyAngularVelocity);
+  }
+  return geometry;
+}
 
-  inst_pos = getInstrumentPosition(isd);
-  sun_pos = getSunPosition(isd);
+ale::LazyIsd::LazyIsd(std::string isd) : m_source(std::move(isd)) {
+  index();
+}
 
-  inst_pointing = getInstrumentPointing(isd);
-  body_rotation = getBodyRotation(isd);
- }
+ale::LazyIsd::LazyIsd(std::istream &isd) {
+  std::stringstream contents;
+  contents << isd.rdbuf();
+  m_source = contents.str();
+  index();
+}
+
+void ale::LazyIsd::index() {
+  m_metadata = json::object();
+  std::map<std::string, std::pair<size_t, size_t>> entries = indexTopLevel(m_source);
+  for (const std::pair<const std::string, std::pair<size_t, size_t>> &entry : entries) {
+    if (isLazySection(entry.first)) {
+      m_sections.insert(entry);
+    }
+    else {
+      m_metadata[entry.first] = json::parse(m_source.begin() + entry.second.first,
+                                            m_source.begin() + entry.second.second);
+    }
+  }
+}
+
+const json &ale::LazyIsd::getMetadata() const {
+  return m_metadata;
+}
+
+bool ale::LazyIsd::hasSection(const std::string &name) const {
+  return m_sections.find(name) != m_sections.end();
+}
+
+bool ale::LazyIsd::isLoaded(const std::string &name) const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (name == "instrument_position") {
+    return m_instPos != nullptr;
+  }
+  if (name == "sun_position") {
+    return m_sunPos != nullptr;
+  }
+  if (name == "instrument_pointing") {
+    return m_instPointing != nullptr;
+  }
+  if (name == "body_rotation") {
+    return m_bodyRotation != nullptr;
+  }
+  return false;
+}
+
+const ale::States &ale::LazyIsd::getInstrumentPosition() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (!m_instPos) {
+    m_instPos.reset(new States(readLazyStates(m_source, m_sections, "instrument_position",
+                                              "Could not parse the instrument position")));
+    releaseSource();
+  }
+  return *m_instPos;
+}
+
+const ale::States &ale::LazyIsd::getSunPosition() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (!m_sunPos) {
+    m_sunPos.reset(new States(readLazyStates(m_source, m_sections, "sun_position",
+                                             "Could not parse the sun position")));
+    releaseSource();
+  }
+  return *m_sunPos;
+}
+
+const ale::Orientations &ale::LazyIsd::getInstrumentPointing() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (!m_instPointing) {
+    m_instPointing.reset(new Orientations(readLazyOrientations(m_source, m_sections, "instrument_pointing",
+                                                               "Could not parse the instrument pointing")));
+    releaseSource();
+  }
+  return *m_instPointing;
+}
+
+const ale::Orientations &ale::LazyIsd::getBodyRotation() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (!m_bodyRotation) {
+    m_bodyRotation.reset(new Orientations(readLazyOrientations(m_source, m_sections, "body_rotation",
+                                                               "Could not parse the body rotation")));
+    releaseSource();
+  }
+  return *m_bodyRotation;
+}
+
+void ale::LazyIsd::releaseSource() const {
+  if (m_instPos && m_sunPos && m_instPointing && m_bodyRotation) {
+    std::string().swap(m_source);
+  }
+}
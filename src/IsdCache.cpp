@@ -0,0 +1,396 @@
+#include "ale/IsdCache.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "ale/Load.h"
+
+using json = nlohmann::json;
+
+namespace ale {
+
+  namespace {
+    // 64 bit FNV-1a hash
+    class Fnv1a {
+      public:
+        Fnv1a() : m_hash(14695981039346656037ULL) {}
+
+        void add(const char *data, size_t size) {
+          for (size_t i = 0; i < size; i++) {
+            m_hash ^= static_cast<unsigned char>(data[i]);
+            m_hash *= 1099511628211ULL;
+          }
+        }
+
+        // Add a field with its size so that adjacent fields cannot run together
+        void addField(const std::string &field) {
+          uint64_t size = field.size();
+          add(reinterpret_cast<const char *>(&size), sizeof(size));
+          add(field.data(), field.size());
+        }
+
+        std::string hex() const {
+          std::ostringstream stream;
+          stream << std::hex << std::setw(16) << std::setfill('0') << m_hash;
+          return stream.str();
+        }
+
+      private:
+        uint64_t m_hash;
+    };
+
+    bool fileExists(const std::string &path) {
+      struct stat fileStat;
+      return stat(path.c_str(), &fileStat) == 0;
+    }
+
+    // Get the kernel paths out of a props string
+    std::vector<std::string> propsKernels(const std::string &props) {
+      std::vector<std::string> kernels;
+      if (props.empty()) {
+        return kernels;
+      }
+      json propsJson = json::parse(props, nullptr, false);
+      if (!propsJson.is_object() || !propsJson.contains("kernels")) {
+        return kernels;
+      }
+      const json &kernelsJson = propsJson["kernels"];
+      if (kernelsJson.is_string()) {
+        kernels.push_back(kernelsJson.get<std::string>());
+      }
+      else if (kernelsJson.is_array()) {
+        for (const json &kernel : kernelsJson) {
+          if (kernel.is_string()) {
+            kernels.push_back(kernel.get<std::string>());
+          }
+        }
+      }
+      return kernels;
+    }
+
+    std::string defaultLoader(const std::string &filename, const std::string &props,
+                              const std::string &formatter, bool verbose,
+                              bool onlyIsisSpice, bool onlyNaifSpice) {
+      return loads(filename, props, formatter, 0, verbose, onlyIsisSpice, onlyNaifSpice);
+    }
+
+    // Add record_kernels to a props string so that the loader reports the kernels it furnished
+    std::string recordKernelsProps(const std::string &props) {
+      json propsJson = props.empty() ? json::object() : json::parse(props, nullptr, false);
+      if (!propsJson.is_object()) {
+        // Let the loader report the invalid props
+        return props;
+      }
+      propsJson["record_kernels"] = true;
+      return propsJson.dump();
+    }
+
+    // Get the path, size, and modification time of a kernel
+    json stampKernel(const std::string &path) {
+      json stamp;
+      stamp["path"] = path;
+      struct stat kernelStat;
+      if (stat(path.c_str(), &kernelStat) == 0) {
+        stamp["size"] = static_cast<long long>(kernelStat.st_size);
+        stamp["mtime"] = static_cast<long long>(kernelStat.st_mtime);
+      }
+      else {
+        stamp["size"] = -1;
+        stamp["mtime"] = -1;
+      }
+      return stamp;
+    }
+
+    // Check that none of the stamped kernels changed
+    bool kernelsCurrent(const json &kernels) {
+      for (const json &kernel : kernels) {
+        if (!kernel.contains("path") || !kernel["path"].is_string() ||
+            stampKernel(kernel["path"].get<std::string>()) != kernel) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    // Write a file so that readers never see it partially written
+    template <typename Writer>
+    void writeAtomically(const std::string &path, Writer writer) {
+      // The directory can be shared between processes, so the temporary
+      // name includes the process ID as well as the thread
+      std::ostringstream tempPath;
+      tempPath << path << ".tmp" << getpid() << "_"
+               << std::hash<std::thread::id>()(std::this_thread::get_id());
+      try {
+        writer(tempPath.str());
+      }
+      catch (...) {
+        std::remove(tempPath.str().c_str());
+        throw;
+      }
+      if (std::rename(tempPath.str().c_str(), path.c_str()) != 0) {
+        // Another writer may have won the race, which is fine since the
+        // contents are the same
+        std::remove(tempPath.str().c_str());
+        if (!fileExists(path)) {
+          throw std::runtime_error("Could not write the cached ISD " + path + ".");
+        }
+      }
+    }
+  }
+
+
+  IsdCache::IsdCache(const std::string &directory, Loader loader) :
+    m_directory(directory), m_loader(loader), m_stats() {
+    if (!m_loader) {
+      m_loader = defaultLoader;
+    }
+  }
+
+
+  std::shared_ptr<const json> IsdCache::load(const std::string &filename,
+                                             const std::string &props,
+                                             const std::string &formatter,
+                                             bool verbose,
+                                             bool onlyIsisSpice,
+                                             bool onlyNaifSpice) {
+    std::string isdKey = key(filename, props, formatter, onlyIsisSpice, onlyNaifSpice);
+    bool stale = false;
+    Entry entry;
+    if (findInMemory(isdKey, entry, stale)) {
+      return entry.isd;
+    }
+
+    if (!m_directory.empty() && diskCurrent(isdKey, stale)) {
+      try {
+        entry.isd = std::make_shared<const json>(BinaryIsd(binaryPath(isdKey)).toJson());
+        std::ifstream kernelsFile(kernelsPath(isdKey));
+        entry.kernels = json::parse(kernelsFile);
+      }
+      catch (...) {
+        // An unreadable cached ISD is treated as a miss and re-written
+        entry.isd.reset();
+      }
+      if (entry.isd) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.diskHits++;
+        m_stats.stale += stale;
+        m_isds[isdKey] = entry;
+        return entry.isd;
+      }
+    }
+
+    entry = generate(filename, props, formatter, verbose, onlyIsisSpice, onlyNaifSpice);
+    if (!m_directory.empty()) {
+      try {
+        writeToDisk(isdKey, entry);
+      }
+      catch (...) {
+        // ISDs that do not fit the binary layout, such as some non-ale
+        // formatters, are only cached in memory
+      }
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats.misses++;
+    m_stats.stale += stale;
+    m_isds[isdKey] = entry;
+    return entry.isd;
+  }
+
+
+  std::shared_ptr<const BinaryIsd> IsdCache::loadBinary(const std::string &filename,
+                                                        const std::string &props,
+                                                        const std::string &formatter,
+                                                        bool verbose,
+                                                        bool onlyIsisSpice,
+                                                        bool onlyNaifSpice) {
+    if (m_directory.empty()) {
+      throw std::invalid_argument("Binary ISDs can only be loaded from a cache with a directory.");
+    }
+    std::string isdKey = key(filename, props, formatter, onlyIsisSpice, onlyNaifSpice);
+    std::string path = binaryPath(isdKey);
+
+    bool stale = false;
+    if (diskCurrent(isdKey, stale)) {
+      std::shared_ptr<const BinaryIsd> binaryIsd;
+      try {
+        binaryIsd = std::make_shared<const BinaryIsd>(path);
+      }
+      catch (...) {
+        // An unreadable cached ISD is treated as a miss and re-written
+      }
+      if (binaryIsd) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.diskHits++;
+        return binaryIsd;
+      }
+    }
+
+    Entry entry;
+    if (!findInMemory(isdKey, entry, stale)) {
+      entry = generate(filename, props, formatter, verbose, onlyIsisSpice, onlyNaifSpice);
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_stats.misses++;
+      m_stats.stale += stale;
+      m_isds[isdKey] = entry;
+    }
+
+    writeToDisk(isdKey, entry);
+    return std::make_shared<const BinaryIsd>(path);
+  }
+
+
+  std::string IsdCache::key(const std::string &filename, const std::string &props,
+                            const std::string &formatter, bool onlyIsisSpice,
+                            bool onlyNaifSpice) const {
+    Fnv1a hash;
+    hash.addField("ale isd cache " + std::to_string(BinaryIsd::VERSION));
+
+    std::ifstream label(filename, std::ios::binary);
+    if (label) {
+      std::vector<char> buffer(1 << 16);
+      hash.addField("label");
+      while (label.read(buffer.data(), buffer.size()) || label.gcount() > 0) {
+        hash.add(buffer.data(), static_cast<size_t>(label.gcount()));
+      }
+    }
+    else {
+      // ale.loads also accepts label strings
+      hash.addField("label string");
+      hash.addField(filename);
+    }
+
+    hash.addField(props);
+    hash.addField(formatter);
+    hash.addField(onlyIsisSpice ? "isis" : "");
+    hash.addField(onlyNaifSpice ? "naif" : "");
+
+    for (const std::string &kernel : propsKernels(props)) {
+      hash.addField(kernel);
+      struct stat kernelStat;
+      if (stat(kernel.c_str(), &kernelStat) == 0) {
+        hash.addField(std::to_string(static_cast<long long>(kernelStat.st_size)));
+        hash.addField(std::to_string(static_cast<long long>(kernelStat.st_mtime)));
+      }
+      else {
+        hash.addField("missing");
+      }
+    }
+
+    return hash.hex();
+  }
+
+
+  IsdCache::CacheStats IsdCache::getStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+  }
+
+
+  void IsdCache::clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_isds.clear();
+  }
+
+
+  std::string IsdCache::binaryPath(const std::string &key) const {
+    return m_directory + "/" + key + ".bisd";
+  }
+
+
+  std::string IsdCache::kernelsPath(const std::string &key) const {
+    return m_directory + "/" + key + ".kernels.json";
+  }
+
+
+  bool IsdCache::findInMemory(const std::string &key, Entry &entry, bool &stale) {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      std::map<std::string, Entry>::const_iterator it = m_isds.find(key);
+      if (it == m_isds.end()) {
+        return false;
+      }
+      entry = it->second;
+    }
+
+    // Check the kernels without holding the lock
+    if (!kernelsCurrent(entry.kernels)) {
+      stale = true;
+      return false;
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats.memoryHits++;
+    return true;
+  }
+
+
+  bool IsdCache::diskCurrent(const std::string &key, bool &stale) {
+    if (!fileExists(binaryPath(key))) {
+      return false;
+    }
+    std::ifstream kernelsFile(kernelsPath(key));
+    json kernels = json::parse(kernelsFile, nullptr, false);
+    if (!kernels.is_array()) {
+      // Without its kernels a cached ISD cannot be checked, so it is a miss
+      return false;
+    }
+    if (!kernelsCurrent(kernels)) {
+      stale = true;
+      return false;
+    }
+    return true;
+  }
+
+
+  IsdCache::Entry IsdCache::generate(const std::string &filename, const std::string &props,
+                                     const std::string &formatter, bool verbose,
+                                     bool onlyIsisSpice, bool onlyNaifSpice) {
+    json isd = json::parse(m_loader(filename, recordKernelsProps(props), formatter, verbose,
+                                    onlyIsisSpice, onlyNaifSpice));
+    Entry entry;
+    entry.kernels = json::array();
+    if (isd.is_object() && isd.contains("furnished_kernels")) {
+      for (const json &kernel : isd["furnished_kernels"]) {
+        if (kernel.is_string()) {
+          entry.kernels.push_back(stampKernel(kernel.get<std::string>()));
+        }
+      }
+      isd.erase("furnished_kernels");
+    }
+    entry.isd = std::make_shared<const json>(std::move(isd));
+    return entry;
+  }
+
+
+  void IsdCache::writeToDisk(const std::string &key, const Entry &entry) const {
+    // The kernels go first so that a binary ISD is never seen without them
+    writeAtomically(kernelsPath(key), [&entry](const std::string &path) {
+      std::ofstream kernelsFile(path);
+      kernelsFile << entry.kernels.dump();
+      if (!kernelsFile) {
+        throw std::runtime_error("Could not write the cached ISD kernels " + path + ".");
+      }
+    });
+    try {
+      writeAtomically(binaryPath(key), [&entry](const std::string &path) {
+        BinaryIsd::write(*entry.isd, path);
+      });
+    }
+    catch (...) {
+      // Every writer of this key fails the same way, so the kernels are
+      // not needed
+      std::remove(kernelsPath(key).c_str());
+      throw;
+    }
+  }
+}
@@ -0,0 +1,844 @@
+#include "ale/Kernels.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+
+#include "ale/Chebyshev.h"
+
+namespace ale {
+
+  namespace {
+    const size_t RECORD_SIZE = 1024; //!< The size of a binary DAF record in bytes
+
+    bool isLittleEndian() {
+      const uint16_t value = 1;
+      return *reinterpret_cast<const char *>(&value) == 1;
+    }
+
+    template<typename T>
+    T readValue(const std::vector<char> &contents, size_t offset, bool swap) {
+      if (offset + sizeof(T) > contents.size()) {
+        throw std::runtime_error("Unexpected end of the DAF file.");
+      }
+      char bytes[sizeof(T)];
+      std::memcpy(bytes, &contents[offset], sizeof(T));
+      if (swap) {
+        std::reverse(bytes, bytes + sizeof(T));
+      }
+      T value;
+      std::memcpy(&value, bytes, sizeof(T));
+      return value;
+    }
+
+    std::string trimmed(const std::string &value) {
+      size_t start = value.find_first_not_of(" \t\r\n'");
+      if (start == std::string::npos) {
+        return "";
+      }
+      size_t end = value.find_last_not_of(" \t\r\n'");
+      return value.substr(start, end - start + 1);
+    }
+
+    // The file type from a DAF identification word such as "DAF/SPK "
+    std::string dafType(const std::string &idWord) {
+      std::string word = trimmed(idWord);
+      if (word.compare(0, 4, "DAF/") != 0) {
+        return "";
+      }
+      return word.substr(4);
+    }
+
+    int hexDigit(char digit) {
+      if (digit >= '0' && digit <= '9') {
+        return digit - '0';
+      }
+      if (digit >= 'A' && digit <= 'F') {
+        return digit - 'A' + 10;
+      }
+      if (digit >= 'a' && digit <= 'f') {
+        return digit - 'a' + 10;
+      }
+      return -1;
+    }
+
+    // Decode a signed hexadecimal integer such as -16F30
+    long decodeHexInt(const std::string &token, size_t start, size_t end) {
+      bool negative = false;
+      if (start < end && (token[start] == '-' || token[start] == '+')) {
+        negative = token[start] == '-';
+        start++;
+      }
+      if (start == end) {
+        throw std::invalid_argument("Invalid DAF transfer number " + token + ".");
+      }
+      long value = 0;
+      for (size_t i = start; i < end; i++) {
+        int digit = hexDigit(token[i]);
+        if (digit < 0) {
+          throw std::invalid_argument("Invalid DAF transfer number " + token + ".");
+        }
+        value = value * 16 + digit;
+      }
+      return negative ? -value : value;
+    }
+
+    /**
+     * Decode a DAF transfer file double. These are signed hexadecimal
+     * mantissas and exponents, so -1A^2 is -0x0.1A * 16^2.
+     */
+    double decodeDouble(const std::string &token) {
+      size_t caret = token.find('^');
+      if (caret == std::string::npos) {
+        throw std::invalid_argument("Invalid DAF transfer number " + token + ".");
+      }
+      size_t start = 0;
+      bool negative = false;
+      if (token[0] == '-' || token[0] == '+') {
+        negative = token[0] == '-';
+        start = 1;
+      }
+      double mantissa = 0;
+      double scale = 1.0 / 16.0;
+      for (size_t i = start; i < caret; i++) {
+        int digit = hexDigit(token[i]);
+        if (digit < 0) {
+          throw std::invalid_argument("Invalid DAF transfer number " + token + ".");
+        }
+        mantissa += digit * scale;
+        scale /= 16.0;
+      }
+      long exponent = decodeHexInt(token, caret + 1, token.size());
+      double value = std::ldexp(mantissa, static_cast<int>(4 * exponent));
+      return negative ? -value : value;
+    }
+
+    // Reads the lines of a DAF transfer file
+    class TransferReader {
+      public:
+        TransferReader(const std::string &path, const std::vector<char> &contents) :
+          m_path(path), m_stream(std::string(contents.begin(), contents.end())) {}
+
+        bool nextLine(std::string &line) {
+          while (std::getline(m_stream, line)) {
+            if (!line.empty() && line[line.size() - 1] == '\r') {
+              line.erase(line.size() - 1);
+            }
+            if (line.find_first_not_of(" \t") != std::string::npos) {
+              return true;
+            }
+          }
+          return false;
+        }
+
+        std::string requireLine() {
+          std::string line;
+          if (!nextLine(line)) {
+            throw std::runtime_error("Unexpected end of the DAF transfer file " + m_path + ".");
+          }
+          return line;
+        }
+
+        double nextDouble() {
+          return decodeDouble(trimmed(requireLine()));
+        }
+
+        int nextInt() {
+          std::string token = trimmed(requireLine());
+          return static_cast<int>(decodeHexInt(token, 0, token.size()));
+        }
+
+      private:
+        std::string m_path;
+        std::istringstream m_stream;
+    };
+
+    // The index of the last value in a sorted range that is at most value
+    size_t lastAtOrBefore(const double *begin, size_t size, double value) {
+      const double *it = std::upper_bound(begin, begin + size, value);
+      if (it == begin) {
+        return 0;
+      }
+      return static_cast<size_t>(it - begin) - 1;
+    }
+
+    void requireSize(const std::vector<double> &data, size_t size, const std::string &name) {
+      if (data.size() < size) {
+        throw std::invalid_argument("The data in segment " + name + " is too short.");
+      }
+    }
+  }
+
+
+  DafFile::DafFile(const std::string &path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+      throw std::runtime_error("Could not open the DAF file " + path + ".");
+    }
+    std::vector<char> contents((std::istreambuf_iterator<char>(file)),
+                               std::istreambuf_iterator<char>());
+
+    const std::string transferId = "DAFETF NAIF DAF ENCODED TRANSFER FILE";
+    if (contents.size() >= transferId.size()
+        && std::equal(transferId.begin(), transferId.end(), contents.begin())) {
+      readTransfer(path, contents);
+    }
+    else {
+      readBinary(path, contents);
+    }
+  }
+
+
+  const std::string &DafFile::getType() const {
+    return m_type;
+  }
+
+
+  const std::vector<DafSegment> &DafFile::getSegments() const {
+    return m_segments;
+  }
+
+
+  void DafFile::readBinary(const std::string &path, const std::vector<char> &contents) {
+    if (contents.size() < RECORD_SIZE) {
+      throw std::runtime_error("The file " + path + " is not a DAF file.");
+    }
+    m_type = dafType(std::string(&contents[0], 8));
+    if (m_type.empty()) {
+      throw std::runtime_error("The file " + path + " is not a DAF file.");
+    }
+
+    std::string format(&contents[88], 8);
+    bool swap;
+    if (format == "LTL-IEEE") {
+      swap = !isLittleEndian();
+    }
+    else if (format == "BIG-IEEE") {
+      swap = isLittleEndian();
+    }
+    else {
+      // Files from before the format string were always native
+      swap = false;
+    }
+
+    int nd = readValue<int32_t>(contents, 8, swap);
+    int ni = readValue<int32_t>(contents, 12, swap);
+    if (nd < 0 || ni < 2 || nd + (ni + 1) / 2 > 125) {
+      throw std::runtime_error("The DAF file " + path + " has an invalid summary format.");
+    }
+    size_t summarySize = nd + (ni + 1) / 2;
+    size_t nameSize = 8 * summarySize;
+
+    // Follow the linked list of summary records
+    int record = readValue<int32_t>(contents, 76, swap);
+    size_t numRecords = contents.size() / RECORD_SIZE;
+    size_t visited = 0;
+    while (record > 0) {
+      if (static_cast<size_t>(record) >= numRecords || ++visited > numRecords) {
+        throw std::runtime_error("The DAF file " + path + " has an invalid summary record.");
+      }
+      size_t summaryOffset = (record - 1) * RECORD_SIZE;
+      size_t nameOffset = record * RECORD_SIZE;
+      int next = static_cast<int>(readValue<double>(contents, summaryOffset, swap));
+      int numSummaries = static_cast<int>(readValue<double>(contents, summaryOffset + 16, swap));
+      if (numSummaries < 0 || 3 + numSummaries * summarySize > RECORD_SIZE / 8) {
+        throw std::runtime_error("The DAF file " + path + " has an invalid summary record.");
+      }
+
+      for (int i = 0; i < numSummaries; i++) {
+        size_t offset = summaryOffset + 24 + i * summarySize * 8;
+        DafSegment segment;
+        segment.name = trimmed(std::string(&contents[nameOffset + i * nameSize], nameSize).c_str());
+        for (int j = 0; j < nd; j++) {
+          segment.doubleSummary.push_back(readValue<double>(contents, offset + j * 8, swap));
+        }
+        for (int j = 0; j < ni - 2; j++) {
+          segment.intSummary.push_back(readValue<int32_t>(contents, offset + nd * 8 + j * 4, swap));
+        }
+        int begin = readValue<int32_t>(contents, offset + nd * 8 + (ni - 2) * 4, swap);
+        int end = readValue<int32_t>(contents, offset + nd * 8 + (ni - 1) * 4, swap);
+        if (begin < 1 || end < begin || static_cast<size_t>(end) * 8 > contents.size()) {
+          throw std::runtime_error("The DAF file " + path + " has an invalid segment address.");
+        }
+        segment.data.reserve(end - begin + 1);
+        for (int address = begin; address <= end; address++) {
+          segment.data.push_back(readValue<double>(contents, (address - 1) * 8, swap));
+        }
+        m_segments.push_back(segment);
+      }
+      record = next;
+    }
+  }
+
+
+  void DafFile::readTransfer(const std::string &path, const std::vector<char> &contents) {
+    TransferReader reader(path, contents);
+    reader.requireLine();
+    m_type = dafType(trimmed(reader.requireLine()));
+    if (m_type.empty()) {
+      throw std::runtime_error("The file " + path + " is not a DAF transfer file.");
+    }
+    int nd = reader.nextInt();
+    int ni = reader.nextInt();
+    if (nd < 0 || ni < 2) {
+      throw std::runtime_error("The DAF file " + path + " has an invalid summary format.");
+    }
+    // The internal file name
+    reader.requireLine();
+
+    std::string line;
+    while (reader.nextLine(line)) {
+      std::istringstream tokens(line);
+      std::string keyword;
+      tokens >> keyword;
+      if (keyword == "TOTAL_ARRAYS") {
+        break;
+      }
+      if (keyword != "BEGIN_ARRAY") {
+        throw std::runtime_error("Expected BEGIN_ARRAY in the DAF transfer file " + path
+                                 + " but found " + trimmed(line) + ".");
+      }
+      size_t index, count;
+      tokens >> index >> count;
+
+      DafSegment segment;
+      segment.name = trimmed(reader.requireLine());
+      for (int i = 0; i < nd; i++) {
+        segment.doubleSummary.push_back(reader.nextDouble());
+      }
+      // The addresses are not in transfer files
+      for (int i = 0; i < ni - 2; i++) {
+        segment.intSummary.push_back(reader.nextInt());
+      }
+      segment.data.reserve(count);
+
+      // The data is written in blocks that each start with their size
+      while (true) {
+        std::string blockLine = trimmed(reader.requireLine());
+        if (blockLine.compare(0, 9, "END_ARRAY") == 0) {
+          break;
+        }
+        size_t blockSize = std::stoul(blockLine);
+        for (size_t i = 0; i < blockSize; i++) {
+          segment.data.push_back(reader.nextDouble());
+        }
+      }
+      if (segment.data.size() != count) {
+        throw std::runtime_error("Array " + std::to_string(index) + " in the DAF transfer file "
+                                 + path + " has the wrong number of values.");
+      }
+      m_segments.push_back(segment);
+    }
+  }
+
+
+  SpkSegment::SpkSegment(const DafSegment &segment) : m_name(segment.name), m_data(segment.data) {
+    if (segment.doubleSummary.size() != 2 || segment.intSummary.size() != 4) {
+      throw std::invalid_argument("Segment " + m_name + " does not have an SPK summary.");
+    }
+    m_startTime = segment.doubleSummary[0];
+    m_stopTime = segment.doubleSummary[1];
+    m_target = segment.intSummary[0];
+    m_center = segment.intSummary[1];
+    m_frame = segment.intSummary[2];
+    m_type = segment.intSummary[3];
+
+    if (m_type == 2 || m_type == 3) {
+      requireSize(m_data, 4, m_name);
+      size_t recordSize = static_cast<size_t>(m_data[m_data.size() - 2]);
+      size_t numRecords = static_cast<size_t>(m_data[m_data.size() - 1]);
+      size_t components = m_type == 2 ? 3 : 6;
+      if (recordSize < 2 + components || (recordSize - 2) % components != 0
+          || m_data[m_data.size() - 3] <= 0) {
+        throw std::invalid_argument("Segment " + m_name + " has an invalid record size.");
+      }
+      requireSize(m_data, recordSize * numRecords + 4, m_name);
+    }
+    else if (m_type == 13) {
+      requireSize(m_data, 2, m_name);
+      size_t windowSize = static_cast<size_t>(m_data[m_data.size() - 2]) + 1;
+      size_t numStates = static_cast<size_t>(m_data[m_data.size() - 1]);
+      if (numStates < 2 || windowSize < 2) {
+        throw std::invalid_argument("Segment " + m_name + " has too few states.");
+      }
+      requireSize(m_data, 7 * numStates + (numStates - 1) / 100 + 2, m_name);
+    }
+    // Other types can be read but not evaluated, so that they still take
+    // priority over lower segments
+  }
+
+
+  int SpkSegment::getTarget() const {
+    return m_target;
+  }
+
+
+  int SpkSegment::getCenter() const {
+    return m_center;
+  }
+
+
+  int SpkSegment::getReferenceFrame() const {
+    return m_frame;
+  }
+
+
+  int SpkSegment::getType() const {
+    return m_type;
+  }
+
+
+  double SpkSegment::getStartTime() const {
+    return m_startTime;
+  }
+
+
+  double SpkSegment::getStopTime() const {
+    return m_stopTime;
+  }
+
+
+  bool SpkSegment::contains(double time) const {
+    return time >= m_startTime && time <= m_stopTime;
+  }
+
+
+  State SpkSegment::getState(double time) const {
+    if (!contains(time)) {
+      throw std::invalid_argument("Time " + std::to_string(time) + " is outside of SPK segment "
+                                  + m_name + ".");
+    }
+    if (m_type == 2 || m_type == 3) {
+      return chebyshevState(time);
+    }
+    if (m_type == 13) {
+      return hermiteState(time);
+    }
+    throw std::invalid_argument("SPK segment " + m_name + " has unsupported type "
+                                + std::to_string(m_type) + ".");
+  }
+
+
+  States SpkSegment::getStates(const std::vector<double> &times) const {
+    std::vector<State> states;
+    states.reserve(times.size());
+    for (double time : times) {
+      states.push_back(getState(time));
+    }
+    return States(times, states, m_frame);
+  }
+
+
+  State SpkSegment::chebyshevState(double time) const {
+    size_t size = m_data.size();
+    double initialTime = m_data[size - 4];
+    double intervalLength = m_data[size - 3];
+    size_t recordSize = static_cast<size_t>(m_data[size - 2]);
+    size_t numRecords = static_cast<size_t>(m_data[size - 1]);
+    size_t components = m_type == 2 ? 3 : 6;
+    size_t numCoefficients = (recordSize - 2) / components;
+
+    double recordIndex = std::floor((time - initialTime) / intervalLength);
+    size_t index = recordIndex < 0 ? 0 : std::min(static_cast<size_t>(recordIndex), numRecords - 1);
+    const double *record = &m_data[index * recordSize];
+    double midpoint = record[0];
+    double radius = record[1];
+    double s = (time - midpoint) / radius;
+
+    double position[3], velocity[3];
+    for (size_t component = 0; component < 3; component++) {
+      const double *coefficients = record + 2 + component * numCoefficients;
+      double derivative;
+      chebyshevEvaluate(coefficients, numCoefficients, s, position[component], derivative);
+      if (m_type == 2) {
+        velocity[component] = derivative / radius;
+      }
+      else {
+        // Type 3 records have their own velocity coefficients after the positions
+        chebyshevEvaluate(coefficients + 3 * numCoefficients, numCoefficients, s,
+                          velocity[component], derivative);
+      }
+    }
+    return State(Vec3d(position[0], position[1], position[2]),
+                 Vec3d(velocity[0], velocity[1], velocity[2]));
+  }
+
+
+  State SpkSegment::hermiteState(double time) const {
+    size_t size = m_data.size();
+    size_t numStates = static_cast<size_t>(m_data[size - 1]);
+    size_t windowSize = std::min(static_cast<size_t>(m_data[size - 2]) + 1, numStates);
+    const double *states = &m_data[0];
+    const double *epochs = &m_data[6 * numStates];
+
+    // Center the window on the interval containing the time when it is even
+    // and on the nearest epoch when it is odd
+    size_t index = lastAtOrBefore(epochs, numStates, time);
+    size_t first;
+    if (windowSize % 2 == 0) {
+      first = index + 1 < windowSize / 2 ? 0 : index + 1 - windowSize / 2;
+    }
+    else {
+      if (index + 1 < numStates && epochs[index + 1] - time < time - epochs[index]) {
+        index++;
+      }
+      first = index < windowSize / 2 ? 0 : index - windowSize / 2;
+    }
+    first = std::min(first, numStates - windowSize);
+
+    // Hermite interpolation with divided differences. Each epoch is a
+    // repeated node whose first divided difference is the velocity.
+    size_t numNodes = 2 * windowSize;
+    std::vector<double> nodes(numNodes);
+    std::vector<double> differences(numNodes);
+    double result[6];
+    for (size_t component = 0; component < 3; component++) {
+      for (size_t i = 0; i < windowSize; i++) {
+        // Offset times from the interpolation time for precision
+        nodes[2 * i] = nodes[2 * i + 1] = epochs[first + i] - time;
+        differences[2 * i] = differences[2 * i + 1] = states[6 * (first + i) + component];
+      }
+      std::vector<double> coefficients(numNodes);
+      coefficients[0] = differences[0];
+      for (size_t order = 1; order < numNodes; order++) {
+        for (size_t i = numNodes - 1; i >= order; i--) {
+          double spacing = nodes[i] - nodes[i - order];
+          if (spacing == 0) {
+            differences[i] = states[6 * (first + i / 2) + component + 3];
+          }
+          else {
+            differences[i] = (differences[i] - differences[i - 1]) / spacing;
+          }
+        }
+        coefficients[order] = differences[order];
+      }
+
+      // Evaluate the Newton form and its derivative at zero
+      double value = coefficients[numNodes - 1];
+      double derivative = 0;
+      for (size_t i = numNodes - 1; i-- > 0;) {
+        derivative = derivative * -nodes[i] + value;
+        value = value * -nodes[i] + coefficients[i];
+      }
+      result[component] = value;
+      result[component + 3] = derivative;
+    }
+    return State(Vec3d(result[0], result[1], result[2]),
+                 Vec3d(result[3], result[4], result[5]));
+  }
+
+
+  CkSegment::CkSegment(const DafSegment &segment) : m_name(segment.name), m_data(segment.data) {
+    if (segment.doubleSummary.size() != 2 || segment.intSummary.size() != 4) {
+      throw std::invalid_argument("Segment " + m_name + " does not have a CK summary.");
+    }
+    m_startTime = segment.doubleSummary[0];
+    m_stopTime = segment.doubleSummary[1];
+    m_instrument = segment.intSummary[0];
+    m_frame = segment.intSummary[1];
+    m_type = segment.intSummary[2];
+    m_hasAv = segment.intSummary[3] != 0;
+
+    if (m_type == 2) {
+      // Records, interval starts, interval stops, and the start directory
+      m_hasAv = true;
+      m_recordSize = 8;
+      m_numRecords = m_data.size() / 10;
+      while (m_numRecords > 0 && 10 * m_numRecords + (m_numRecords - 1) / 100 > m_data.size()) {
+        m_numRecords--;
+      }
+      m_numIntervals = m_numRecords;
+      if (m_numRecords == 0
+          || 10 * m_numRecords + (m_numRecords - 1) / 100 != m_data.size()) {
+        throw std::invalid_argument("The data in segment " + m_name + " has the wrong size.");
+      }
+    }
+    else if (m_type == 3) {
+      // Records, epochs, the epoch directory, interval starts, the start
+      // directory, the number of intervals, and the number of records
+      requireSize(m_data, 2, m_name);
+      m_recordSize = m_hasAv ? 7 : 4;
+      m_numIntervals = static_cast<size_t>(m_data[m_data.size() - 2]);
+      m_numRecords = static_cast<size_t>(m_data[m_data.size() - 1]);
+      if (m_numRecords == 0 || m_numIntervals == 0) {
+        throw std::invalid_argument("Segment " + m_name + " has no pointing.");
+      }
+      requireSize(m_data, (m_recordSize + 1) * m_numRecords + (m_numRecords - 1) / 100
+                          + m_numIntervals + (m_numIntervals - 1) / 100 + 2, m_name);
+    }
+    else {
+      // Other types can be read but not evaluated, so that they still take
+      // priority over lower segments
+      m_recordSize = 0;
+      m_numRecords = 0;
+      m_numIntervals = 0;
+    }
+  }
+
+
+  int CkSegment::getInstrument() const {
+    return m_instrument;
+  }
+
+
+  int CkSegment::getReferenceFrame() const {
+    return m_frame;
+  }
+
+
+  int CkSegment::getType() const {
+    return m_type;
+  }
+
+
+  bool CkSegment::hasAngularVelocity() const {
+    return m_hasAv;
+  }
+
+
+  double CkSegment::getStartTime() const {
+    return m_startTime;
+  }
+
+
+  double CkSegment::getStopTime() const {
+    return m_stopTime;
+  }
+
+
+  size_t CkSegment::findRecord(double ticks) const {
+    // Both types have the record starts right after the records
+    return lastAtOrBefore(&m_data[m_recordSize * m_numRecords], m_numRecords, ticks);
+  }
+
+
+  bool CkSegment::contains(double ticks) const {
+    if (ticks < m_startTime || ticks > m_stopTime) {
+      return false;
+    }
+    if (m_type != 2 && m_type != 3) {
+      return true;
+    }
+    const double *epochs = &m_data[m_recordSize * m_numRecords];
+    size_t index = findRecord(ticks);
+    if (ticks < epochs[index]) {
+      return false;
+    }
+    if (m_type == 2) {
+      const double *stops = epochs + m_numRecords;
+      return ticks <= stops[index];
+    }
+
+    if (ticks == epochs[index]) {
+      return true;
+    }
+    if (index + 1 >= m_numRecords) {
+      return false;
+    }
+    // Both pointing instances must be in the same interpolation interval
+    const double *starts = epochs + m_numRecords + (m_numRecords - 1) / 100;
+    size_t interval = lastAtOrBefore(starts, m_numIntervals, epochs[index]);
+    return interval + 1 >= m_numIntervals || epochs[index + 1] < starts[interval + 1];
+  }
+
+
+  Rotation CkSegment::recordRotation(size_t index) const {
+    const double *record = &m_data[index * m_recordSize];
+    return Rotation(record[0], record[1], record[2], record[3]);
+  }
+
+
+  Vec3d CkSegment::recordAngularVelocity(size_t index) const {
+    const double *record = &m_data[index * m_recordSize];
+    return Vec3d(record[4], record[5], record[6]);
+  }
+
+
+  Rotation CkSegment::getRotation(double ticks, Vec3d *av) const {
+    if (m_type != 2 && m_type != 3) {
+      throw std::invalid_argument("CK segment " + m_name + " has unsupported type "
+                                  + std::to_string(m_type) + ".");
+    }
+    if (!contains(ticks)) {
+      throw std::invalid_argument("CK segment " + m_name + " has no pointing at "
+                                  + std::to_string(ticks) + " ticks.");
+    }
+    size_t index = findRecord(ticks);
+    const double *epochs = &m_data[m_recordSize * m_numRecords];
+
+    if (m_type == 2) {
+      Vec3d angularVelocity = recordAngularVelocity(index);
+      if (av) {
+        *av = angularVelocity;
+      }
+      double rate = m_data[index * m_recordSize + 7];
+      double angle = angularVelocity.norm() * (ticks - epochs[index]) * rate;
+      if (angle == 0) {
+        return recordRotation(index);
+      }
+      // The instrument rotates about the angular velocity in the reference frame
+      return recordRotation(index) *
+             Rotation({angularVelocity.x, angularVelocity.y, angularVelocity.z}, -angle);
+    }
+
+    if (ticks == epochs[index]) {
+      if (av) {
+        *av = m_hasAv ? recordAngularVelocity(index) : Vec3d(0.0, 0.0, 0.0);
+      }
+      return recordRotation(index);
+    }
+
+    double t = (ticks - epochs[index]) / (epochs[index + 1] - epochs[index]);
+    if (av) {
+      if (m_hasAv) {
+        *av = recordAngularVelocity(index) * (1 - t) + recordAngularVelocity(index + 1) * t;
+      }
+      else {
+        *av = Vec3d(0.0, 0.0, 0.0);
+      }
+    }
+    return recordRotation(index).interpolate(recordRotation(index + 1), t, SLERP);
+  }
+
+
+  Orientations CkSegment::getOrientations(const std::vector<double> &times,
+                                          const std::vector<double> &ticks) const {
+    if (times.size() != ticks.size()) {
+      throw std::invalid_argument("The number of times and ticks must be the same.");
+    }
+    std::vector<Rotation> rotations;
+    std::vector<Vec3d> avs;
+    rotations.reserve(ticks.size());
+    avs.reserve(ticks.size());
+    for (double tick : ticks) {
+      Vec3d av;
+      rotations.push_back(getRotation(tick, &av));
+      avs.push_back(av);
+    }
+    if (!m_hasAv) {
+      avs.clear();
+    }
+    return Orientations(rotations, times, avs, Rotation(1, 0, 0, 0),
+                        std::vector<int>(), {m_instrument, m_frame});
+  }
+
+
+  Spk::Spk(const std::string &path) {
+    DafFile daf(path);
+    if (daf.getType() != "SPK") {
+      throw std::invalid_argument("The file " + path + " is not an SPK.");
+    }
+    for (const DafSegment &segment : daf.getSegments()) {
+      m_segments.push_back(SpkSegment(segment));
+    }
+  }
+
+
+  const std::vector<SpkSegment> &Spk::getSegments() const {
+    return m_segments;
+  }
+
+
+  const SpkSegment &Spk::findSegment(int target, double time) const {
+    for (size_t i = m_segments.size(); i-- > 0;) {
+      if (m_segments[i].getTarget() == target && m_segments[i].contains(time)) {
+        return m_segments[i];
+      }
+    }
+    throw std::invalid_argument("No SPK segment for target " + std::to_string(target)
+                                + " covers time " + std::to_string(time) + ".");
+  }
+
+
+  State Spk::getState(int target, double time) const {
+    return findSegment(target, time).getState(time);
+  }
+
+
+  States Spk::getStates(int target, const std::vector<double> &times) const {
+    std::vector<State> states;
+    states.reserve(times.size());
+    const SpkSegment *previous = nullptr;
+    for (double time : times) {
+      const SpkSegment &segment = findSegment(target, time);
+      if (previous && (segment.getCenter() != previous->getCenter()
+                       || segment.getReferenceFrame() != previous->getReferenceFrame())) {
+        throw std::invalid_argument("The SPK segments for target " + std::to_string(target)
+                                    + " do not share a center and reference frame.");
+      }
+      previous = &segment;
+      states.push_back(segment.getState(time));
+    }
+    return States(times, states, previous ? previous->getReferenceFrame() : 1);
+  }
+
+
+  Ck::Ck(const std::string &path) {
+    DafFile daf(path);
+    if (daf.getType() != "CK") {
+      throw std::invalid_argument("The file " + path + " is not a CK.");
+    }
+    for (const DafSegment &segment : daf.getSegments()) {
+      m_segments.push_back(CkSegment(segment));
+    }
+  }
+
+
+  const std::vector<CkSegment> &Ck::getSegments() const {
+    return m_segments;
+  }
+
+
+  const CkSegment &Ck::findSegment(int instrument, double ticks) const {
+    for (size_t i = m_segments.size(); i-- > 0;) {
+      if (m_segments[i].getInstrument() == instrument && m_segments[i].contains(ticks)) {
+        return m_segments[i];
+      }
+    }
+    throw std::invalid_argument("No CK segment for instrument " + std::to_string(instrument)
+                                + " has pointing at " + std::to_string(ticks) + " ticks.");
+  }
+
+
+  Rotation Ck::getRotation(int instrument, double ticks, Vec3d *av) const {
+    return findSegment(instrument, ticks).getRotation(ticks, av);
+  }
+
+
+  Orientations Ck::getOrientations(int instrument, const std::vector<double> &times,
+                                   const std::vector<double> &ticks) const {
+    if (times.size() != ticks.size()) {
+      throw std::invalid_argument("The number of times and ticks must be the same.");
+    }
+    std::vector<Rotation> rotations;
+    std::vector<Vec3d> avs;
+    rotations.reserve(ticks.size());
+    avs.reserve(ticks.size());
+    const CkSegment *previous = nullptr;
+    bool hasAv = true;
+    for (double tick : ticks) {
+      const CkSegment &segment = findSegment(instrument, tick);
+      if (previous && segment.getReferenceFrame() != previous->getReferenceFrame()) {
+        throw std::invalid_argument("The CK segments for instrument " + std::to_string(instrument)
+                                    + " do not share a reference frame.");
+      }
+      previous = &segment;
+      hasAv = hasAv && segment.hasAngularVelocity();
+      Vec3d av;
+      rotations.push_back(segment.getRotation(tick, &av));
+      avs.push_back(av);
+    }
+    if (!hasAv) {
+      avs.clear();
+    }
+    int frame = previous ? previous->getReferenceFrame() : 1;
+    return Orientations(rotations, times, avs, Rotation(1, 0, 0, 0),
+                        std::vector<int>(), {instrument, frame});
+  }
+}
@@ -4,6 +4,7 @@
 
 #include <Python.h>
 
+#include <exception>
 #include <string>
 #include <iostream>
 #include <stdexcept>
@@ -12,158 +13,500 @@ using json = nlohmann::json;
 using namespace std;
 
 namespace ale {
-  std::string getPyTraceback() {
-    PyObject* err = PyErr_Occurred();
-    if (err != NULL) {
-        PyObject *ptype, *pvalue, *ptraceback;
-        PyObject *pystr, *module_name, *pyth_module, *pyth_func;
-        char *str;
-        char *full_backtrace;
-        char *error_description;
-
-        PyErr_Fetch(&ptype, &pvalue, &ptraceback);
-        pystr = PyObject_Str(pvalue);
-        str = PyBytes_AS_STRING(PyUnicode_AsUTF8String(pystr));
-        error_description = strdup(str);
-
-        // See if we can get a full traceback
-        module_name = PyUnicode_FromString("traceback");
-        pyth_module = PyImport_Import(module_name);
-        Py_DECREF(module_name);
-
-        if (pyth_module == NULL) {
-            throw runtime_error("getPyTraceback - Failed to import Python traceback Library");
+  namespace {
+    // Holds the Python global interpreter lock for the lifetime of the guard
+    class GilGuard {
+      public:
+        GilGuard() : m_state(PyGILState_Ensure()) {}
+        ~GilGuard() { PyGILState_Release(m_state); }
+
+      private:
+        GilGuard(const GilGuard &) = delete;
+        GilGuard &operator=(const GilGuard &) = delete;
+
+        PyGILState_STATE m_state;
+    };
+
+    // Owns a reference to a Python object. The GIL must be held when it is released.
+    class PyRef {
+      public:
+        explicit PyRef(PyObject *object=NULL) : m_object(object) {}
+        ~PyRef() { Py_XDECREF(m_object); }
+
+        PyObject *get() const { return m_object; }
+        explicit operator bool() const { return m_object != NULL; }
+
+      private:
+        PyRef(const PyRef &) = delete;
+        PyRef &operator=(const PyRef &) = delete;
+
+        PyObject *m_object;
+    };
+
+    // Convert a Python object to a string with str(), returns an empty string on failure
+    std::string pyToString(PyObject *object) {
+      if (!object) {
+        return "";
+      }
+      PyRef pyStr(PyObject_Str(object));
+      PyRef bytes(pyStr ? PyUnicode_AsUTF8String(pyStr.get()) : NULL);
+      if (!bytes) {
+        PyErr_Clear();
+        return "";
+      }
+      return std::string(PyBytes_AS_STRING(bytes.get()), PyBytes_GET_SIZE(bytes.get()));
+    }
+
+    // Nesting deeper than this is assumed to be a reference cycle
+    const int MAX_JSON_DEPTH = 256;
+
+    // Get the UTF-8 contents of a Python string
+    std::string pyUnicodeToString(PyObject *object) {
+      Py_ssize_t size;
+      const char *data = PyUnicode_AsUTF8AndSize(object, &size);
+      if (!data) {
+        PyErr_Clear();
+        throw invalid_argument("Failed to convert a Python string to UTF-8.");
+      }
+      return std::string(data, size);
+    }
+
+    // Convert a dictionary key to a string the same way json.dumps does
+    std::string pyKeyToString(PyObject *key) {
+      if (PyUnicode_Check(key)) {
+        return pyUnicodeToString(key);
+      }
+      if (key == Py_None) {
+        return "null";
+      }
+      if (PyBool_Check(key)) {
+        return key == Py_True ? "true" : "false";
+      }
+      return pyToString(key);
+    }
+
+    // Build nested JSON arrays from the doubles in a C contiguous buffer
+    json bufferDoublesToJson(const double *&data, const Py_ssize_t *shape, int ndim) {
+      if (ndim == 0) {
+        return json(*data++);
+      }
+      json result = json::array();
+      result.get_ref<json::array_t &>().reserve(shape[0]);
+      for (Py_ssize_t i = 0; i < shape[0]; i++) {
+        result.push_back(bufferDoublesToJson(data, shape + 1, ndim - 1));
+      }
+      return result;
+    }
+
+    // Convert an object with a buffer of doubles, such as a numpy array,
+    // without going through Python lists. Returns false for other buffers.
+    bool bufferToJson(PyObject *object, json &result) {
+      Py_buffer view;
+      if (PyObject_GetBuffer(object, &view, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT) != 0) {
+        PyErr_Clear();
+        return false;
+      }
+      std::string format = view.format ? view.format : "B";
+      bool isDouble = view.itemsize == sizeof(double) &&
+                      (format == "d" || format == "@d" || format == "=d");
+      if (isDouble) {
+        const double *data = static_cast<const double *>(view.buf);
+        result = bufferDoublesToJson(data, view.shape, view.ndim);
+      }
+      PyBuffer_Release(&view);
+      return isDouble;
+    }
+
+    // Convert a Python object to JSON directly, the same way json.dumps with
+    // the AleJsonEncoder would
+    json pyObjectToJson(PyObject *object, int depth=0) {
+      if (depth > MAX_JSON_DEPTH) {
+        throw invalid_argument("Python object is nested too deeply to convert to JSON.");
+      }
+      if (object == Py_None) {
+        return json();
+      }
+      // bool is a subclass of int so it has to be checked first
+      if (PyBool_Check(object)) {
+        return json(object == Py_True);
+      }
+      if (PyLong_Check(object)) {
+        int overflow = 0;
+        long long value = PyLong_AsLongLongAndOverflow(object, &overflow);
+        if (!overflow && !(value == -1 && PyErr_Occurred())) {
+          return json(value);
+        }
+        PyErr_Clear();
+        if (overflow > 0) {
+          unsigned long long unsignedValue = PyLong_AsUnsignedLongLong(object);
+          if (!PyErr_Occurred()) {
+            return json(unsignedValue);
+          }
+          PyErr_Clear();
+        }
+        return json(PyLong_AsDouble(object));
+      }
+      if (PyFloat_Check(object)) {
+        return json(PyFloat_AS_DOUBLE(object));
+      }
+      if (PyUnicode_Check(object)) {
+        return json(pyUnicodeToString(object));
+      }
+      if (PyDict_Check(object)) {
+        json result = json::object();
+        PyObject *key, *value;
+        Py_ssize_t position = 0;
+        while (PyDict_Next(object, &position, &key, &value)) {
+          result[pyKeyToString(key)] = pyObjectToJson(value, depth + 1);
+        }
+        return result;
+      }
+      if (PyList_Check(object) || PyTuple_Check(object)) {
+        bool isList = PyList_Check(object);
+        Py_ssize_t size = isList ? PyList_GET_SIZE(object) : PyTuple_GET_SIZE(object);
+        json result = json::array();
+        result.get_ref<json::array_t &>().reserve(size);
+        for (Py_ssize_t i = 0; i < size; i++) {
+          PyObject *item = isList ? PyList_GET_ITEM(object, i) : PyTuple_GET_ITEM(object, i);
+          result.push_back(pyObjectToJson(item, depth + 1));
+        }
+        return result;
+      }
+      if (PyAnySet_Check(object)) {
+        json result = json::array();
+        PyRef iterator(PyObject_GetIter(object));
+        while (PyObject *item = iterator ? PyIter_Next(iterator.get()) : NULL) {
+          PyRef itemRef(item);
+          result.push_back(pyObjectToJson(item, depth + 1));
+        }
+        if (PyErr_Occurred()) {
+          PyErr_Clear();
+          throw invalid_argument("Failed to iterate over a Python set.");
         }
+        return result;
+      }
+
+      json result;
+      if (!PyBytes_Check(object) && !PyByteArray_Check(object) &&
+          PyObject_CheckBuffer(object) && bufferToJson(object, result)) {
+        return result;
+      }
+      // Other numpy arrays and numpy scalars
+      if (PyObject_HasAttrString(object, "tolist")) {
+        PyRef list(PyObject_CallMethod(object, "tolist", NULL));
+        if (list) {
+          return pyObjectToJson(list.get(), depth + 1);
+        }
+        PyErr_Clear();
+      }
+      // Dates and times
+      else if (PyObject_HasAttrString(object, "isoformat")) {
+        PyRef isoformat(PyObject_CallMethod(object, "isoformat", NULL));
+        if (isoformat && PyUnicode_Check(isoformat.get())) {
+          return json(pyUnicodeToString(isoformat.get()));
+        }
+        PyErr_Clear();
+      }
+      throw invalid_argument("Cannot convert a Python " + std::string(Py_TYPE(object)->tp_name) + " to JSON.");
+    }
 
-        pyth_func = PyObject_GetAttrString(pyth_module, "format_exception");
-        PyObject *pyth_val;
-        pyth_val = PyObject_CallFunctionObjArgs(pyth_func, ptype, pvalue, ptraceback, NULL);
+    // Convert a Python object to JSON, returns null on failure
+    json pyToJson(PyObject *object) {
+      try {
+        return object ? pyObjectToJson(object) : json();
+      }
+      catch (invalid_argument &e) {
+        return json();
+      }
+    }
 
-        pystr = PyObject_Str(pyth_val);
-        str = PyBytes_AS_STRING(PyUnicode_AsUTF8String(pystr));
-        full_backtrace = strdup(str);
-        Py_DECREF(pyth_val);
+    // The state of a loadMany call that its Python callback needs
+    struct LoadManyContext {
+      const LoadCallback *callback; //!< The callback to pass each ISD to
+      Stats *stats; //!< The stats to record into, may be null
+      std::exception_ptr exception; //!< The exception the callback threw, if any
+    };
+
+    // Called by the Python load_many with the result for each label
+    PyObject *loadManyCallback(PyObject *self, PyObject *args) {
+      LoadManyContext *context = static_cast<LoadManyContext *>(PyCapsule_GetPointer(self, NULL));
+      Py_ssize_t index;
+      PyObject *pyIsd, *pyError;
+      if (!context || !PyArg_ParseTuple(args, "nOO", &index, &pyIsd, &pyError)) {
+        return NULL;
+      }
+
+      json isd;
+      std::string error;
+      if (pyError == Py_None) {
+        Stats::Timer timer(context->stats, "load.to_json");
+        try {
+          isd = pyObjectToJson(pyIsd);
+        }
+        catch (invalid_argument &e) {
+          isd = json();
+          error = e.what();
+        }
+      }
+      else {
+        error = pyToString(pyError);
+      }
+
+      // Exceptions can not pass through the Python interpreter, so the
+      // exception is kept and thrown again once load_many has returned.
+      // The GIL is released while the callback runs so that other threads
+      // can load.
+      PyThreadState *threadState = PyEval_SaveThread();
+      try {
+        (*context->callback)(index, isd, error);
+      }
+      catch (...) {
+        context->exception = std::current_exception();
+      }
+      PyEval_RestoreThread(threadState);
+
+      if (context->exception) {
+        PyErr_SetString(PyExc_RuntimeError, "The loadMany callback threw an exception.");
+        return NULL;
+      }
+      Py_RETURN_NONE;
+    }
 
-        std::string join_cmd = "trace = ''.join(list(" + std::string(full_backtrace) + "))";
-        PyRun_SimpleString(join_cmd.c_str());
+    PyMethodDef LOAD_MANY_CALLBACK_DEF = {"load_many_callback", loadManyCallback, METH_VARARGS, NULL};
 
-        PyObject *evalModule = PyImport_AddModule( (char*)"__main__" );
-        PyObject *evalDict = PyModule_GetDict( evalModule );
-        PyObject *evalVal = PyDict_GetItemString( evalDict, "trace" );
-        full_backtrace = PyBytes_AS_STRING(PyUnicode_AsUTF8String(evalVal));
+    // Get the session, recording how long it took
+    LoadSession &timedInstance(Stats *stats) {
+      Stats::Timer timer(stats, "load.session");
+      return LoadSession::instance();
+    }
+  }
+
+  std::string getPyTraceback() {
+    if (PyErr_Occurred() == NULL) {
+      // no traceback to return
+      return "";
+    }
 
-        return std::string(error_description) + "\n" + std::string(full_backtrace);
+    PyObject *ptype, *pvalue, *ptraceback;
+    PyErr_Fetch(&ptype, &pvalue, &ptraceback);
+    PyErr_NormalizeException(&ptype, &pvalue, &ptraceback);
+    PyRef type(ptype);
+    PyRef value(pvalue);
+    PyRef traceback(ptraceback);
+
+    std::string errorDescription = pyToString(value.get());
+
+    // See if we can get a full traceback
+    PyRef tracebackModule(PyImport_ImportModule("traceback"));
+    PyRef formatException(tracebackModule ?
+                          PyObject_GetAttrString(tracebackModule.get(), "format_exception") : NULL);
+    PyRef lines(formatException ?
+                PyObject_CallFunctionObjArgs(formatException.get(),
+                                             type ? type.get() : Py_None,
+                                             value ? value.get() : Py_None,
+                                             traceback ? traceback.get() : Py_None,
+                                             NULL) : NULL);
+    PyRef separator(PyUnicode_FromString(""));
+    PyRef fullBacktrace(lines && separator ? PyUnicode_Join(separator.get(), lines.get()) : NULL);
+    if (!fullBacktrace) {
+      PyErr_Clear();
+      return errorDescription;
     }
 
-    // no traceback to return
-    return "";
+    return errorDescription + "\n" + pyToString(fullBacktrace.get());
   }
 
-  std::string loads(std::string filename, std::string props, std::string formatter, int indent, bool verbose, bool onlyIsisSpice, bool onlyNaifSpice) {
-    static bool first_run = true;
+  LoadSession &LoadSession::instance() {
+    // Function local statics are initialized exactly once, even when
+    // multiple threads get here at the same time. If the constructor
+    // throws, the next call tries again.
+    static LoadSession session;
+    return session;
+  }
 
-    if(first_run) {
-       // Initialize the Python interpreter but only once.
-       first_run = !first_run;
-       Py_Initialize();
+  LoadSession::LoadSession() : m_loadsFunction(NULL), m_loadManyFunction(NULL) {
+    if (!Py_IsInitialized()) {
+      Py_Initialize();
+#if PY_VERSION_HEX < 0x03070000
+      PyEval_InitThreads();
+#endif
+      // Py_Initialize leaves this thread holding the GIL. Release it so
+      // that every call, from any thread, acquires it the same way.
+      PyEval_SaveThread();
     }
 
-    // Import the file as a Python module.
-    PyObject *pModule = PyImport_Import(PyUnicode_FromString("ale"));
-    if(!pModule) {
-      throw runtime_error("Failed to import ale. Make sure the ale python library is correctly installed.");
+    GilGuard gil;
+
+    PyRef module(PyImport_ImportModule("ale"));
+    if (!module) {
+      std::string traceback = getPyTraceback();
+      throw runtime_error("Failed to import ale. Make sure the ale python library is correctly installed."
+                          + (traceback.empty() ? "" : "\n" + traceback));
     }
-    // Create a dictionary for the contents of the module.
-    PyObject *pDict = PyModule_GetDict(pModule);
 
-    // Get the add method from the dictionary.
-    PyObject *pFunc = PyDict_GetItemString(pDict, "loads");
-    if(!pFunc) {
+    PyObject *loadsFunction = PyObject_GetAttrString(module.get(), "loads");
+    if (!loadsFunction || !PyCallable_Check(loadsFunction)) {
+      Py_XDECREF(loadsFunction);
+      PyErr_Clear();
       // import errors do not set a PyError flag, need to use a custom
       // error message instead.
       throw runtime_error("Failed to import ale.loads function from Python."
                          "This Usually indicates an error in the Ale Python Library."
                          "Check if Installed correctly and the function ale.loads exists.");
     }
+    PyObject *loadManyFunction = PyObject_GetAttrString(module.get(), "load_many");
+    if (!loadManyFunction || !PyCallable_Check(loadManyFunction)) {
+      Py_XDECREF(loadManyFunction);
+      Py_DECREF(loadsFunction);
+      PyErr_Clear();
+      throw runtime_error("Failed to import ale.load_many function from Python."
+                         "This Usually indicates an error in the Ale Python Library."
+                         "Check if Installed correctly and the function ale.load_many exists.");
+    }
+    m_loadsFunction = loadsFunction;
+    m_loadManyFunction = loadManyFunction;
+  }
 
+  std::string LoadSession::loads(const std::string &filename, const std::string &props,
+                                 const std::string &formatter, int indent, bool verbose,
+                                 bool onlyIsisSpice, bool onlyNaifSpice, Stats *stats) const {
+    Stats::Timer gilTimer(stats, "load.gil");
+    GilGuard gil;
+    gilTimer.stop();
+
+    PyRef pArgs(Py_BuildValue("(sssiOOO)",
+                              filename.c_str(),
+                              props.c_str(),
+                              formatter.c_str(),
+                              indent,
+                              verbose ? Py_True : Py_False,
+                              onlyIsisSpice ? Py_True : Py_False,
+                              onlyNaifSpice ? Py_True : Py_False));
+    if (!pArgs) {
+      throw runtime_error(getPyTraceback());
+    }
 
-    // Create a Python tuple to hold the arguments to the method.
-    PyObject *pArgs = PyTuple_New(7);
-    if(!pArgs) {
+    // Only ask the Python side for statistics if they are wanted
+    PyRef pStats(stats ? PyDict_New() : NULL);
+    PyRef pKwargs(pStats ? Py_BuildValue("{s:O}", "stats", pStats.get()) : NULL);
+    if (stats && !pKwargs) {
       throw runtime_error(getPyTraceback());
     }
 
-    // Set the Python int as the first and second arguments to the method.
-    PyObject *pStringFileName = PyUnicode_FromString(filename.c_str());
-    PyTuple_SetItem(pArgs, 0, pStringFileName);
-    Py_INCREF(pStringFileName); // take ownership of reference
+    // Call the function with the arguments.
+    Stats::Timer callTimer(stats, "load.python");
+    PyRef pResult(PyObject_Call(m_loadsFunction, pArgs.get(), pKwargs.get()));
+    callTimer.stop();
+    if (!pResult) {
+      std::string traceback = getPyTraceback();
+      if (stats) {
+        stats->python = pyToJson(pStats.get());
+      }
+      throw invalid_argument("No Valid instrument found for label."
+                             + (traceback.empty() ? "" : "\n" + traceback));
+    }
+    if (stats) {
+      stats->python = pyToJson(pStats.get());
+    }
 
-    PyObject *pStringProps = PyUnicode_FromString(props.c_str());
-    PyTuple_SetItem(pArgs, 1, pStringProps);
-    Py_INCREF(pStringProps); // take ownership of reference
+    Stats::Timer stringTimer(stats, "load.to_string");
+    PyRef pResultStr(PyObject_Str(pResult.get()));
+    PyRef tempBytes(pResultStr ? PyUnicode_AsUTF8String(pResultStr.get()) : NULL);
+    if (!tempBytes) {
+      throw invalid_argument(getPyTraceback());
+    }
 
-    PyObject *pStringFormatter = PyUnicode_FromString(formatter.c_str());
-    PyTuple_SetItem(pArgs, 2, pStringFormatter);
-    Py_INCREF(pStringFormatter); // take ownership of reference
+    std::string isd(PyBytes_AS_STRING(tempBytes.get()), PyBytes_GET_SIZE(tempBytes.get()));
+    stringTimer.setSize(isd.size());
+    return isd;
+  }
 
-    PyObject *pIntIndent = PyLong_FromLong((long) indent);
-    PyTuple_SetItem(pArgs, 3, pIntIndent);
-    Py_INCREF(pIntIndent); // take ownership of reference
+  json LoadSession::load(const std::string &filename, const std::string &props,
+                         const std::string &formatter, bool verbose,
+                         bool onlyIsisSpice, bool onlyNaifSpice, Stats *stats) const {
+    std::string jsonstr = loads(filename, props, formatter, 0, verbose, onlyIsisSpice, onlyNaifSpice, stats);
+    // Parse after the GIL has been released
+    Stats::Timer timer(stats, "load.json_parse");
+    timer.setSize(jsonstr.size());
+    return json::parse(jsonstr);
+  }
 
-    PyObject *pBoolVerbose = Py_False;
-    if (verbose == true) {
-      pBoolVerbose = Py_True;
+  void LoadSession::loadMany(const std::vector<std::string> &labels, const LoadCallback &callback,
+                             const std::string &props, const std::string &formatter, bool verbose,
+                             bool onlyIsisSpice, bool onlyNaifSpice, Stats *stats) const {
+    if (!callback) {
+      throw invalid_argument("loadMany needs a callback.");
     }
-    PyTuple_SetItem(pArgs, 4, pBoolVerbose);
-    Py_INCREF(pBoolVerbose); // take ownership of reference
 
-    PyObject *pBoolOnlyIsisSpice = Py_False;
-    if (onlyIsisSpice == true) {
-      pBoolOnlyIsisSpice = Py_True;
-    }
-    PyTuple_SetItem(pArgs, 5, pBoolOnlyIsisSpice);
-    Py_INCREF(pBoolOnlyIsisSpice); // take ownership of reference
+    Stats::Timer gilTimer(stats, "load.gil");
+    GilGuard gil;
+    gilTimer.stop();
 
-    PyObject *pBoolOnlyNaifSpice = Py_False;
-    if (onlyNaifSpice == true) {
-      pBoolOnlyNaifSpice = Py_True;
+    PyRef pLabels(PyList_New(labels.size()));
+    if (!pLabels) {
+      throw runtime_error(getPyTraceback());
     }
-    PyTuple_SetItem(pArgs, 6, pBoolOnlyNaifSpice);
-    Py_INCREF(pBoolOnlyNaifSpice); // take ownership of reference
-
-    // Call the function with the arguments.
-    PyObject* pResult = PyObject_CallObject(pFunc, pArgs);
-    if(!pResult) {
-      throw invalid_argument("No Valid instrument found for label.");
+    for (size_t i = 0; i < labels.size(); i++) {
+      PyObject *pLabel = PyUnicode_FromStringAndSize(labels[i].data(), labels[i].size());
+      if (!pLabel) {
+        throw runtime_error(getPyTraceback());
+      }
+      // Steals the reference to the label
+      PyList_SET_ITEM(pLabels.get(), i, pLabel);
     }
 
-    PyObject *pResultStr = PyObject_Str(pResult);
-    PyObject *temp_bytes = PyUnicode_AsUTF8String(pResultStr); // Owned reference
-
-    if(!temp_bytes){
-      throw invalid_argument(getPyTraceback());
+    PyRef pArgs(Py_BuildValue("(OssOOO)",
+                              pLabels.get(),
+                              props.c_str(),
+                              formatter.c_str(),
+                              verbose ? Py_True : Py_False,
+                              onlyIsisSpice ? Py_True : Py_False,
+                              onlyNaifSpice ? Py_True : Py_False));
+    if (!pArgs) {
+      throw runtime_error(getPyTraceback());
     }
 
-    std::string cResult;
-
-    char *temp_str = PyBytes_AS_STRING(temp_bytes); // Borrowed pointer
-    cResult = temp_str; // copy into std::string
+    LoadManyContext context = {&callback, stats, std::exception_ptr()};
+    PyRef pContext(PyCapsule_New(&context, NULL, NULL));
+    PyRef pCallback(pContext ? PyCFunction_New(&LOAD_MANY_CALLBACK_DEF, pContext.get()) : NULL);
+    PyRef pStats(stats ? PyDict_New() : NULL);
+    PyRef pKwargs(pCallback ? Py_BuildValue("{s:O}", "callback", pCallback.get()) : NULL);
+    if (!pKwargs || (stats && (!pStats || PyDict_SetItemString(pKwargs.get(), "stats", pStats.get()) != 0))) {
+      throw runtime_error(getPyTraceback());
+    }
 
-    Py_DECREF(pResultStr);
+    Stats::Timer callTimer(stats, "load.python");
+    PyRef pResult(PyObject_Call(m_loadManyFunction, pArgs.get(), pKwargs.get()));
+    callTimer.stop();
+    if (stats) {
+      stats->python = pyToJson(pStats.get());
+    }
+    if (context.exception) {
+      PyErr_Clear();
+      std::rethrow_exception(context.exception);
+    }
+    if (!pResult) {
+      throw runtime_error(getPyTraceback());
+    }
+  }
 
-    Py_DECREF(pStringFileName);
-    Py_DECREF(pStringProps);
-    Py_DECREF(pStringFormatter);
-    Py_DECREF(pIntIndent);
-    Py_DECREF(pBoolVerbose);
+  std::string loads(std::string filename, std::string props, std::string formatter, int indent, bool verbose, bool onlyIsisSpice, bool onlyNaifSpice, Stats *stats) {
+    return timedInstance(stats).loads(filename, props, formatter, indent, verbose, onlyIsisSpice, onlyNaifSpice, stats);
+  }
 
-    Py_DECREF(pArgs);
+  json load(std::string filename, std::string props, std::string formatter, bool verbose, bool onlyIsisSpice, bool onlyNaifSpice, Stats *stats) {
+    return timedInstance(stats).load(filename, props, formatter, verbose, onlyIsisSpice, onlyNaifSpice, stats);
+  }
 
-    return cResult;
+  void loadMany(const std::vector<std::string> &labels, const LoadCallback &callback, std::string props, std::string formatter, bool verbose, bool onlyIsisSpice, bool onlyNaifSpice, Stats *stats) {
+    timedInstance(stats).loadMany(labels, callback, props, formatter, verbose, onlyIsisSpice, onlyNaifSpice, stats);
   }
 
-  json load(std::string filename, std::string props, std::string formatter, bool verbose, bool onlyIsisSpice, bool onlyNaifSpice) {
-    std::string jsonstr = loads(filename, props, formatter, 0, verbose, onlyIsisSpice, onlyNaifSpice);
-    return json::parse(jsonstr);
+  std::vector<json> loadMany(const std::vector<std::string> &labels, std::string props, std::string formatter, bool verbose, bool onlyIsisSpice, bool onlyNaifSpice, Stats *stats) {
+    std::vector<json> isds(labels.size());
+    loadMany(labels,
+             [&isds](size_t index, const json &isd, const std::string &) { isds[index] = isd; },
+             props, formatter, verbose, onlyIsisSpice, onlyNaifSpice, stats);
+    return isds;
   }
 }
@@ -1,6 +1,11 @@
 #include "ale/Orientations.h"
 
 #include "ale/InterpUtils.h"
+#include "ale/ThreadPool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
 
 namespace ale {
 
@@ -25,17 +30,17 @@ namespace ale {
   }
 
 
-  std::vector<Rotation> Orientations::getRotations() const {
+  const std::vector<Rotation> &Orientations::getRotations() const {
     return m_rotations;
   }
 
 
-  std::vector<Vec3d> Orientations::getAngularVelocities() const {
+  const std::vector<Vec3d> &Orientations::getAngularVelocities() const {
     return m_avs;
   }
 
 
-  std::vector<double> Orientations::getTimes() const {
+  const std::vector<double> &Orientations::getTimes() const {
     return m_times;
   }
 
@@ -55,23 +60,7 @@ namespace ale {
     double time,
     RotationInterpolation interpType
   ) const {
-    Rotation timeDepRotation;
-    if (m_times.size() > 1) {
-      int interpIndex = interpolationIndex(m_times, time);
-      double t = (time - m_times[interpIndex]) / (m_times[interpIndex + 1] - m_times[interpIndex]);
-      timeDepRotation = m_rotations[interpIndex].interpolate(m_rotations[interpIndex + 1], t, interpType);
-    }
-    else if (m_avs.empty()) {
-      timeDepRotation = m_rotations.front();
-    }
-    else {
-      double t = time - m_times.front();
-      std::vector<double> axis = {m_avs.front().x, m_avs.front().y, m_avs.front().z};
-      double angle = t * m_avs.front().norm();
-      Rotation newRotation(axis, angle);
-      timeDepRotation = newRotation * m_rotations.front();
-    }
-    return timeDepRotation;
+    return interpolateTimeDep(time, interpolationIndex(m_times, time), interpType);
   }
 
   Rotation Orientations::interpolate(
@@ -83,19 +72,10 @@ namespace ale {
 
 
   Vec3d Orientations::interpolateAV(double time) const {
-    Vec3d interpAv;
     if (m_avs.empty()) {
       throw std::invalid_argument("Cannot interpolate angular velocities for an orientation without them.");
     }
-    else if (m_avs.size() > 1) {
-      int interpIndex = interpolationIndex(m_times, time);
-      double t = (time - m_times[interpIndex]) / (m_times[interpIndex + 1] - m_times[interpIndex]);
-      interpAv = Vec3d(linearInterpolate(m_avs[interpIndex], m_avs[interpIndex + 1], t));
-    }
-    else {
-      interpAv = m_avs.front();
-    }
-    return interpAv;
+    return interpolateAV(time, interpolationIndex(m_times, time));
   }
 
   Vec3d Orientations::rotateVectorAt(
@@ -123,6 +103,239 @@ namespace ale {
     if (!m_avs.empty()) {
       av = interpolateAV(time);
     }
+    return rotateState(interpRot, av, state, invert);
+  }
+
+
+  std::vector<Rotation> Orientations::interpolateTimeDep(
+    const std::vector<double> &times,
+    RotationInterpolation interpType
+  ) const {
+    std::vector<Rotation> rotations;
+    std::vector<int> interpIndices;
+    interpolateTimeDep(times, interpType, rotations, interpIndices);
+    return rotations;
+  }
+
+
+  std::vector<Rotation> Orientations::interpolate(
+    const std::vector<double> &times,
+    RotationInterpolation interpType
+  ) const {
+    std::vector<Rotation> rotations = interpolateTimeDep(times, interpType);
+    for (Rotation &rotation : rotations) {
+      rotation = m_constRotation * rotation;
+    }
+    return rotations;
+  }
+
+
+  std::vector<Vec3d> Orientations::rotateVectorsAt(
+    const std::vector<double> &times,
+    const std::vector<Vec3d> &vectors,
+    RotationInterpolation interpType,
+    bool invert
+  ) const {
+    if (times.size() != vectors.size()) {
+      throw std::invalid_argument("The number of times and vectors must be the same.");
+    }
+    std::vector<Rotation> rotations = interpolate(times, interpType);
+    std::vector<Vec3d> rotatedVectors;
+    rotatedVectors.reserve(vectors.size());
+    for (size_t i = 0; i < vectors.size(); i++) {
+      if (invert) {
+        rotatedVectors.push_back(rotations[i].inverse()(vectors[i]));
+      }
+      else {
+        rotatedVectors.push_back(rotations[i](vectors[i]));
+      }
+    }
+    return rotatedVectors;
+  }
+
+
+  std::vector<State> Orientations::rotateStatesAt(
+    const std::vector<double> &times,
+    const std::vector<State> &states,
+    RotationInterpolation interpType,
+    bool invert
+  ) const {
+    if (times.size() != states.size()) {
+      throw std::invalid_argument("The number of times and states must be the same.");
+    }
+    std::vector<Rotation> rotations;
+    std::vector<int> interpIndices;
+    interpolateTimeDep(times, interpType, rotations, interpIndices);
+    std::vector<State> rotatedStates;
+    rotatedStates.reserve(states.size());
+    for (size_t i = 0; i < states.size(); i++) {
+      Vec3d av(0.0, 0.0, 0.0);
+      if (!m_avs.empty()) {
+        av = interpolateAV(times[i], interpIndices[i]);
+      }
+      rotatedStates.push_back(rotateState(m_constRotation * rotations[i], av, states[i], invert));
+    }
+    return rotatedStates;
+  }
+
+
+  std::vector<Rotation> Orientations::interpolateTimeDep(
+    const std::vector<double> &times,
+    RotationInterpolation interpType,
+    ThreadPool &pool
+  ) const {
+    std::vector<Rotation> rotations(times.size());
+    pool.parallelFor(times.size(), [&](size_t begin, size_t end) {
+      std::vector<Rotation> chunk = interpolateTimeDep(
+          std::vector<double>(times.begin() + begin, times.begin() + end), interpType);
+      std::copy(chunk.begin(), chunk.end(), rotations.begin() + begin);
+    });
+    return rotations;
+  }
+
+
+  std::vector<Rotation> Orientations::interpolate(
+    const std::vector<double> &times,
+    RotationInterpolation interpType,
+    ThreadPool &pool
+  ) const {
+    std::vector<Rotation> rotations = interpolateTimeDep(times, interpType, pool);
+    for (Rotation &rotation : rotations) {
+      rotation = m_constRotation * rotation;
+    }
+    return rotations;
+  }
+
+
+  std::vector<Vec3d> Orientations::rotateVectorsAt(
+    const std::vector<double> &times,
+    const std::vector<Vec3d> &vectors,
+    RotationInterpolation interpType,
+    bool invert,
+    ThreadPool &pool
+  ) const {
+    if (times.size() != vectors.size()) {
+      throw std::invalid_argument("The number of times and vectors must be the same.");
+    }
+    std::vector<Vec3d> rotatedVectors(vectors.size());
+    pool.parallelFor(times.size(), [&](size_t begin, size_t end) {
+      std::vector<Vec3d> chunk = rotateVectorsAt(
+          std::vector<double>(times.begin() + begin, times.begin() + end),
+          std::vector<Vec3d>(vectors.begin() + begin, vectors.begin() + end),
+          interpType, invert);
+      std::copy(chunk.begin(), chunk.end(), rotatedVectors.begin() + begin);
+    });
+    return rotatedVectors;
+  }
+
+
+  std::vector<State> Orientations::rotateStatesAt(
+    const std::vector<double> &times,
+    const std::vector<State> &states,
+    RotationInterpolation interpType,
+    bool invert,
+    ThreadPool &pool
+  ) const {
+    if (times.size() != states.size()) {
+      throw std::invalid_argument("The number of times and states must be the same.");
+    }
+    std::vector<State> rotatedStates(states.size());
+    pool.parallelFor(times.size(), [&](size_t begin, size_t end) {
+      std::vector<State> chunk = rotateStatesAt(
+          std::vector<double>(times.begin() + begin, times.begin() + end),
+          std::vector<State>(states.begin() + begin, states.begin() + end),
+          interpType, invert);
+      std::copy(chunk.begin(), chunk.end(), rotatedStates.begin() + begin);
+    });
+    return rotatedStates;
+  }
+
+
+  void Orientations::interpolateTimeDep(
+    const std::vector<double> &times,
+    RotationInterpolation interpType,
+    std::vector<Rotation> &rotations,
+    std::vector<int> &interpIndices
+  ) const {
+    rotations.resize(times.size());
+    interpIndices.resize(times.size());
+    InterpolationCursor cursor(m_times);
+    for (size_t i = 0; i < times.size(); i++) {
+      interpIndices[i] = cursor.index(times[i]);
+    }
+
+    if (m_times.size() < 2) {
+      for (size_t i = 0; i < times.size(); i++) {
+        rotations[i] = interpolateTimeDep(times[i], interpIndices[i], interpType);
+      }
+      return;
+    }
+
+    // Interpolate each run of times between the same pair of rotations together
+    std::vector<double> fractions;
+    size_t runStart = 0;
+    while (runStart < times.size()) {
+      int interpIndex = interpIndices[runStart];
+      size_t runStop = runStart + 1;
+      while (runStop < times.size() && interpIndices[runStop] == interpIndex) {
+        runStop++;
+      }
+      double startTime = m_times[interpIndex];
+      double duration = m_times[interpIndex + 1] - startTime;
+      fractions.resize(runStop - runStart);
+      for (size_t i = runStart; i < runStop; i++) {
+        fractions[i - runStart] = (times[i] - startTime) / duration;
+      }
+      m_rotations[interpIndex].interpolate(m_rotations[interpIndex + 1], fractions.data(),
+                                           fractions.size(), interpType, &rotations[runStart]);
+      runStart = runStop;
+    }
+  }
+
+
+  Rotation Orientations::interpolateTimeDep(
+    double time,
+    int interpIndex,
+    RotationInterpolation interpType
+  ) const {
+    Rotation timeDepRotation;
+    if (m_times.size() > 1) {
+      double t = (time - m_times[interpIndex]) / (m_times[interpIndex + 1] - m_times[interpIndex]);
+      timeDepRotation = m_rotations[interpIndex].interpolate(m_rotations[interpIndex + 1], t, interpType);
+    }
+    else if (m_avs.empty()) {
+      timeDepRotation = m_rotations.front();
+    }
+    else {
+      double t = time - m_times.front();
+      std::vector<double> axis = {m_avs.front().x, m_avs.front().y, m_avs.front().z};
+      double angle = t * m_avs.front().norm();
+      Rotation newRotation(axis, angle);
+      timeDepRotation = newRotation * m_rotations.front();
+    }
+    return timeDepRotation;
+  }
+
+
+  Vec3d Orientations::interpolateAV(double time, int interpIndex) const {
+    Vec3d interpAv;
+    if (m_avs.size() > 1) {
+      double t = (time - m_times[interpIndex]) / (m_times[interpIndex + 1] - m_times[interpIndex]);
+      interpAv = Vec3d(linearInterpolate(m_avs[interpIndex], m_avs[interpIndex + 1], t));
+    }
+    else {
+      interpAv = m_avs.front();
+    }
+    return interpAv;
+  }
+
+
+  State Orientations::rotateState(
+    Rotation interpRot,
+    Vec3d av,
+    const State &state,
+    bool invert
+  ) {
     if (invert) {
       Vec3d negAv = interpRot(av);
       av = {-negAv.x, -negAv.y, -negAv.z};
@@ -132,6 +345,90 @@ namespace ale {
   }
 
 
+  Orientations::Cursor::Cursor(const Orientations &orientations) :
+    m_orientations(orientations), m_cursor(orientations.m_times) { }
+
+
+  Rotation Orientations::Cursor::interpolateTimeDep(
+    double time,
+    RotationInterpolation interpType
+  ) {
+    return m_orientations.interpolateTimeDep(time, m_cursor.index(time), interpType);
+  }
+
+
+  Rotation Orientations::Cursor::interpolate(
+    double time,
+    RotationInterpolation interpType
+  ) {
+    return m_orientations.m_constRotation * interpolateTimeDep(time, interpType);
+  }
+
+
+  Vec3d Orientations::Cursor::interpolateAV(double time) {
+    if (m_orientations.m_avs.empty()) {
+      throw std::invalid_argument("Cannot interpolate angular velocities for an orientation without them.");
+    }
+    return m_orientations.interpolateAV(time, m_cursor.index(time));
+  }
+
+
+  Rotation Orientations::Cursor::interpolate(
+    double time,
+    Vec3d &av,
+    RotationInterpolation interpType
+  ) {
+    int interpIndex = m_cursor.index(time);
+    av = Vec3d(0.0, 0.0, 0.0);
+    if (!m_orientations.m_avs.empty()) {
+      av = m_orientations.interpolateAV(time, interpIndex);
+    }
+    return m_orientations.m_constRotation *
+           m_orientations.interpolateTimeDep(time, interpIndex, interpType);
+  }
+
+
+  int Orientations::Cursor::getIndex() const {
+    return m_cursor.getIndex();
+  }
+
+
+  void Orientations::Cursor::hint(int index) {
+    m_cursor.hint(index);
+  }
+
+
+  Vec3d Orientations::Cursor::rotateVectorAt(
+    double time,
+    const Vec3d &vector,
+    RotationInterpolation interpType,
+    bool invert
+  ) {
+    Rotation interpRot = interpolate(time, interpType);
+    if (invert) {
+      interpRot = interpRot.inverse();
+    }
+    return interpRot(vector);
+  }
+
+
+  State Orientations::Cursor::rotateStateAt(
+    double time,
+    const State &state,
+    RotationInterpolation interpType,
+    bool invert
+  ) {
+    int interpIndex = m_cursor.index(time);
+    Rotation interpRot = m_orientations.m_constRotation *
+                         m_orientations.interpolateTimeDep(time, interpIndex, interpType);
+    Vec3d av(0.0, 0.0, 0.0);
+    if (!m_orientations.m_avs.empty()) {
+      av = m_orientations.interpolateAV(time, interpIndex);
+    }
+    return rotateState(interpRot, av, state, invert);
+  }
+
+
   Orientations &Orientations::addConstantRotation(const Rotation &addedConst) {
     m_constRotation = addedConst * m_constRotation;
     return *this;
@@ -142,22 +439,30 @@ namespace ale {
     std::vector<double> mergedTimes = orderedVecMerge(m_times, rhs.m_times);
     std::vector<Rotation> mergedRotations;
     std::vector<Vec3d> mergedAvs;
+    mergedRotations.reserve(mergedTimes.size());
+    bool mergeAvs = !m_avs.empty() && !rhs.m_avs.empty();
+    if (mergeAvs) {
+      mergedAvs.reserve(mergedTimes.size());
+    }
+
+    // The merged times are sorted, so cursors find each interpolation index
+    // in constant time instead of a binary search.
+    Cursor lhsCursor(*this);
+    Cursor rhsCursor(rhs);
     for (double time: mergedTimes) {
-      // interpolate includes the constant rotation, so invert it to undo that
-      Rotation inverseConst = m_constRotation.inverse();
-      Rotation rhsRot = rhs.interpolate(time);
-      mergedRotations.push_back(inverseConst*interpolate(time)*rhsRot);
-      if (!getAngularVelocities().empty() && !rhs.getAngularVelocities().empty()) {
-        Vec3d combinedAv = rhsRot.inverse()(interpolateAV(time));
-        Vec3d rhsAv = rhs.interpolateAV(time);
+      Rotation rhsRot = rhsCursor.interpolate(time);
+      mergedRotations.push_back(lhsCursor.interpolateTimeDep(time)*rhsRot);
+      if (mergeAvs) {
+        Vec3d combinedAv = rhsRot.inverse()(lhsCursor.interpolateAV(time));
+        Vec3d rhsAv = rhsCursor.interpolateAV(time);
         combinedAv += rhsAv;
         mergedAvs.push_back(combinedAv);
       }
     }
 
-    m_times = mergedTimes;
-    m_rotations = mergedRotations;
-    m_avs = mergedAvs;
+    m_times = std::move(mergedTimes);
+    m_rotations = std::move(mergedRotations);
+    m_avs = std::move(mergedAvs);
 
     return *this;
   }
@@ -165,12 +470,14 @@ namespace ale {
 
   Orientations &Orientations::operator*=(const Rotation &rhs) {
     std::vector<Rotation> updatedRotations;
+    updatedRotations.reserve(m_rotations.size());
     for (size_t i = 0; i < m_rotations.size(); i++) {
       updatedRotations.push_back(m_rotations[i]*rhs);
     }
 
     Rotation inverseRhs = rhs.inverse();
     std::vector<Vec3d> updatedAvs;
+    updatedAvs.reserve(m_avs.size());
     for (size_t i = 0; i < m_avs.size(); i++) {
       updatedAvs.push_back(inverseRhs(m_avs[i]));
     }
@@ -188,11 +495,13 @@ namespace ale {
     // so we have to subsume the constant rotations into the time dependent rotations
     // in the inverse.
     Rotation constInverseRotation = m_constRotation.inverse();
+    newRotations.reserve(m_rotations.size());
     for (size_t i = 0; i < m_rotations.size(); i++) {
       newRotations.push_back(m_rotations[i].inverse() * constInverseRotation);
     }
 
     std::vector<Vec3d> rotatedAvs;
+    rotatedAvs.reserve(m_avs.size());
     for (size_t i = 0; i < m_avs.size(); i++) {
       Vec3d rotatedAv = -1.0 * (m_constRotation * m_rotations[i])(m_avs[i]);
       rotatedAvs.push_back(rotatedAv);
@@ -220,6 +529,81 @@ namespace ale {
   }
 
 
+  Orientations Orientations::minimizeCache(double angularTolerance, CacheReduction *report) const {
+    if (m_rotations.size() <= 2) {
+      throw std::invalid_argument("Cache size is 2, cannot minimize.");
+    }
+
+    if (report) {
+      *report = CacheReduction();
+    }
+
+    // Start from the first, middle, and last rotations
+    int lastIndex = m_rotations.size() - 1;
+    std::vector<int> indexList = {0};
+    std::vector<std::pair<int, int>> intervals;
+    intervals.push_back(std::make_pair(lastIndex / 2, lastIndex));
+    intervals.push_back(std::make_pair(0, lastIndex / 2));
+
+    while (!intervals.empty()) {
+      int start = intervals.back().first;
+      int stop = intervals.back().second;
+      intervals.pop_back();
+
+      bool withinTolerance = true;
+      double maxError = 0;
+      double maxErrorTime = 0;
+      double duration = m_times[stop] - m_times[start];
+      for (int index = start + 1; index < stop; index++) {
+        double t = duration == 0 ? 0 : (m_times[index] - m_times[start]) / duration;
+        double error = m_rotations[start].interpolate(m_rotations[stop], t, SLERP)
+                       .angleTo(m_rotations[index]);
+        if (!(error < angularTolerance)) {
+          withinTolerance = false;
+          break;
+        }
+        if (error > maxError) {
+          maxError = error;
+          maxErrorTime = m_times[index];
+        }
+      }
+
+      if (withinTolerance) {
+        indexList.push_back(stop);
+        if (report && maxError > report->maxError) {
+          report->maxError = maxError;
+          report->maxErrorTime = maxErrorTime;
+        }
+      }
+      else {
+        int middle = (start + stop) / 2;
+        intervals.push_back(std::make_pair(middle, stop));
+        intervals.push_back(std::make_pair(start, middle));
+      }
+    }
+
+    std::vector<Rotation> reducedRotations;
+    std::vector<double> reducedTimes;
+    std::vector<Vec3d> reducedAvs;
+    reducedRotations.reserve(indexList.size());
+    reducedTimes.reserve(indexList.size());
+    for (int index : indexList) {
+      reducedRotations.push_back(m_rotations[index]);
+      reducedTimes.push_back(m_times[index]);
+      if (!m_avs.empty()) {
+        reducedAvs.push_back(m_avs[index]);
+      }
+    }
+
+    if (report) {
+      report->originalSize = m_rotations.size();
+      report->reducedSize = indexList.size();
+    }
+    return Orientations(reducedRotations, reducedTimes, reducedAvs, m_constRotation,
+                        m_constFrames, m_timeDepFrames);
+  }
+
+
   Orientations operator*(Orientations lhs, const Rotation &rhs) {
     return lhs *= rhs;
   }
@@ -233,4 +617,137 @@ namespace ale {
   Orientations operator*(Orientations lhs, const Orientations &rhs) {
     return lhs *= rhs;
   }
+
+
+  Orientations::View Orientations::slice(double startTime, double stopTime) const {
+    return View(*this, startTime, stopTime);
+  }
+
+
+  Orientations::View::View(const Orientations &orientations, double startTime, double stopTime) :
+    m_orientations(orientations), m_start(0), m_size(0) {
+    const std::vector<double> &times = orientations.m_times;
+    if (times.empty()) {
+      throw std::invalid_argument("Cannot view an empty set of orientations.");
+    }
+    if (stopTime < startTime) {
+      throw std::invalid_argument("The stop time of a view must not be before its start time.");
+    }
+
+    int start = ale::interpolationIndex(times, startTime);
+    int stop = std::min(ale::interpolationIndex(times, stopTime) + 1, (int) times.size() - 1);
+    m_start = start;
+    m_size = stop - start + 1;
+  }
+
+
+  Rotation Orientations::View::interpolateTimeDep(
+    double time,
+    RotationInterpolation interpType
+  ) const {
+    return m_orientations.interpolateTimeDep(time, interpolationIndex(time), interpType);
+  }
+
+
+  Rotation Orientations::View::interpolate(
+    double time,
+    RotationInterpolation interpType
+  ) const {
+    return m_orientations.m_constRotation * interpolateTimeDep(time, interpType);
+  }
+
+
+  std::vector<Rotation> Orientations::View::interpolate(
+    const std::vector<double> &times,
+    RotationInterpolation interpType
+  ) const {
+    std::vector<Rotation> rotations;
+    rotations.reserve(times.size());
+    for (double time : times) {
+      rotations.push_back(interpolate(time, interpType));
+    }
+    return rotations;
+  }
+
+
+  Vec3d Orientations::View::interpolateAV(double time) const {
+    if (m_orientations.m_avs.empty()) {
+      throw std::invalid_argument("Cannot interpolate angular velocities for an orientation without them.");
+    }
+    return m_orientations.interpolateAV(time, interpolationIndex(time));
+  }
+
+
+  Vec3d Orientations::View::rotateVectorAt(
+    double time,
+    const Vec3d &vector,
+    RotationInterpolation interpType,
+    bool invert
+  ) const {
+    Rotation interpRot = interpolate(time, interpType);
+    if (invert) {
+      interpRot = interpRot.inverse();
+    }
+    return interpRot(vector);
+  }
+
+
+  State Orientations::View::rotateStateAt(
+    double time,
+    const State &state,
+    RotationInterpolation interpType,
+    bool invert
+  ) const {
+    int interpIndex = interpolationIndex(time);
+    Rotation interpRot = m_orientations.m_constRotation *
+                         m_orientations.interpolateTimeDep(time, interpIndex, interpType);
+    Vec3d av(0.0, 0.0, 0.0);
+    if (!m_orientations.m_avs.empty()) {
+      av = m_orientations.interpolateAV(time, interpIndex);
+    }
+    return rotateState(interpRot, av, state, invert);
+  }
+
+
+  Orientations Orientations::View::toOrientations() const {
+    return Orientations(getRotations(), getTimes(), getAngularVelocities(),
+                        m_orientations.m_constRotation, m_orientations.m_constFrames,
+                        m_orientations.m_timeDepFrames);
+  }
+
+
+  std::vector<Rotation> Orientations::View::getRotations() const {
+    return std::vector<Rotation>(m_orientations.m_rotations.begin() + m_start,
+                                 m_orientations.m_rotations.begin() + m_start + m_size);
+  }
+
+
+  std::vector<Vec3d> Orientations::View::getAngularVelocities() const {
+    if (m_orientations.m_avs.empty()) {
+      return std::vector<Vec3d>();
+    }
+    return std::vector<Vec3d>(m_orientations.m_avs.begin() + m_start,
+                              m_orientations.m_avs.begin() + m_start + m_size);
+  }
+
+
+  std::vector<double> Orientations::View::getTimes() const {
+    return std::vector<double>(m_orientations.m_times.begin() + m_start,
+                               m_orientations.m_times.begin() + m_start + m_size);
+  }
+
+
+  size_t Orientations::View::getStartIndex() const {
+    return m_start;
+  }
+
+
+  size_t Orientations::View::size() const {
+    return m_size;
+  }
+
+
+  int Orientations::View::interpolationIndex(double time) const {
+    return m_start + ale::interpolationIndex(m_orientations.m_times.data() + m_start, m_size, time);
+  }
 }
@@ -1,6 +1,8 @@
 #include "ale/Rotation.h"
 
+#include <cmath>
 #include <exception>
+#include <limits>
 
 #include <Eigen/Geometry>
 
@@ -47,126 +49,101 @@ namespace ale {
     return avMat;
   }
 
-  ///////////////////////////////////////////////////////////////////////////////
-  // Rotation Impl class
-  ///////////////////////////////////////////////////////////////////////////////
-
-  // Internal representation of the rotation as an Eigen Double Quaternion
-  class Rotation::Impl {
-    public:
-      Impl() : quat(Eigen::Quaterniond::Identity()) { }
-
-
-      Impl(double w, double x, double y, double z) : quat(w, x, y, z) { }
-
-
-      Impl(const std::vector<double>& matrix) {
-        if (matrix.size() != 9) {
-          throw std::invalid_argument("Rotation matrix must be 3 by 3.");
-        }
-        // The data is in row major order, so take the transpose to get column major order
-        quat = Eigen::Quaterniond(Eigen::Quaterniond::Matrix3(matrix.data()).transpose()).normalized();
-      }
+  // A 3 by 3 matrix with the same layout as the row-major matrices we output
+  typedef Eigen::Matrix<double, 3, 3, Eigen::RowMajor> RowMajorMatrix3;
 
-
-      Impl(const std::vector<double>& angles, const std::vector<int>& axes) {
-        if (angles.empty() || axes.empty()) {
-          throw std::invalid_argument("Angles and axes must be non-empty.");
-        }
-        if (angles.size() != axes.size()) {
-          throw std::invalid_argument("Number of angles and axes must be equal.");
-        }
-        quat = Eigen::Quaterniond::Identity();
-
-        for (size_t i = 0; i < angles.size(); i++) {
-          quat *= Eigen::Quaterniond(Eigen::AngleAxisd(angles[i], axis(axes[i])));
-        }
-        quat = quat.normalized();
-      }
-
-
-      Impl(const std::vector<double>& axis, double theta) {
-        if (axis.size() != 3) {
-          throw std::invalid_argument("Rotation axis must have 3 elements.");
-        }
-        Eigen::Vector3d eigenAxis((double *) axis.data());
-        quat = Eigen::Quaterniond(Eigen::AngleAxisd(theta, eigenAxis.normalized())).normalized();
-      }
+  // Map the inline quaternion storage of a rotation as an Eigen quaternion
+  Eigen::Map<Eigen::Quaterniond> quaternion(double *data) {
+    return Eigen::Map<Eigen::Quaterniond>(data);
+  }
 
 
-      Eigen::Quaterniond quat;
-  };
+  Eigen::Map<const Eigen::Quaterniond> quaternion(const double *data) {
+    return Eigen::Map<const Eigen::Quaterniond>(data);
+  }
 
   ///////////////////////////////////////////////////////////////////////////////
   // Rotation Class
   ///////////////////////////////////////////////////////////////////////////////
 
-  Rotation::Rotation() :
-        m_impl(new Impl()) { }
-
-
-  Rotation::Rotation(double w, double x, double y, double z) :
-        m_impl(new Impl(w, x, y, z)) { }
-
-
-  Rotation::Rotation(const std::vector<double>& matrix) :
-        m_impl(new Impl(matrix)) { }
-
-
-  Rotation::Rotation(const std::vector<double>& angles, const std::vector<int>& axes) :
-        m_impl(new Impl(angles, axes)) { }
-
-
-  Rotation::Rotation(const std::vector<double>& axis, double theta) :
-        m_impl(new Impl(axis, theta)) { }
-
+  Rotation::Rotation() {
+    quaternion(m_quat) = Eigen::Quaterniond::Identity();
+  }
 
-  Rotation::~Rotation() = default;
 
+  Rotation::Rotation(double w, double x, double y, double z) {
+    quaternion(m_quat) = Eigen::Quaterniond(w, x, y, z);
+  }
 
-  Rotation::Rotation(Rotation && other) noexcept = default;
 
+  Rotation::Rotation(const std::vector<double>& matrix) {
+    if (matrix.size() != 9) {
+      throw std::invalid_argument("Rotation matrix must be 3 by 3.");
+    }
+    // The data is in row major order, so take the transpose to get column major order
+    quaternion(m_quat) = Eigen::Quaterniond(Eigen::Quaterniond::Matrix3(matrix.data()).transpose()).normalized();
+  }
 
-  Rotation& Rotation::operator=(Rotation && other) noexcept = default;
 
+  Rotation::Rotation(const std::vector<double>& angles, const std::vector<int>& axes) {
+    if (angles.empty() || axes.empty()) {
+      throw std::invalid_argument("Angles and axes must be non-empty.");
+    }
+    if (angles.size() != axes.size()) {
+      throw std::invalid_argument("Number of angles and axes must be equal.");
+    }
+    Eigen::Quaterniond quat = Eigen::Quaterniond::Identity();
 
-  // unique_ptr doesn't have a copy constructor so we have to define one
-  Rotation::Rotation(const Rotation& other) : m_impl(new Impl(*other.m_impl)) { }
+    for (size_t i = 0; i < angles.size(); i++) {
+      quat *= Eigen::Quaterniond(Eigen::AngleAxisd(angles[i], axis(axes[i])));
+    }
+    quaternion(m_quat) = quat.normalized();
+  }
 
 
-  // unique_ptr doesn't have an assignment operator so we have to define one
-  Rotation& Rotation::operator=(const Rotation& other) {
-    if (this != &other) {
-      m_impl.reset(new Impl(*other.m_impl));
+  Rotation::Rotation(const std::vector<double>& axis, double theta) {
+    if (axis.size() != 3) {
+      throw std::invalid_argument("Rotation axis must have 3 elements.");
     }
-    return *this;
+    Eigen::Vector3d eigenAxis((double *) axis.data());
+    quaternion(m_quat) = Eigen::Quaterniond(Eigen::AngleAxisd(theta, eigenAxis.normalized())).normalized();
   }
 
 
   std::vector<double> Rotation::toQuaternion() const {
-    Eigen::Quaterniond normalized = m_impl->quat.normalized();
+    Eigen::Quaterniond normalized = quaternion(m_quat).normalized();
     return {normalized.w(), normalized.x(), normalized.y(), normalized.z()};
   }
 
 
   std::vector<double> Rotation::toRotationMatrix() const {
-    // The matrix is stored in column major, but we want to output in row semiMajor
-    // so take the transpose
-    Eigen::Quaterniond::RotationMatrixType mat = m_impl->quat.toRotationMatrix().transpose();
-    return std::vector<double>(mat.data(), mat.data() + mat.size());
+    std::vector<double> matrix(9);
+    toRotationMatrix(matrix.data());
+    return matrix;
   }
 
 
   std::vector<double> Rotation::toStateRotationMatrix(const Vec3d &av) const {
-    Eigen::Quaterniond::Matrix3 rotMat = m_impl->quat.toRotationMatrix();
-    Eigen::Quaterniond::Matrix3 avMat = avSkewMatrix(av);
-    Eigen::Quaterniond::Matrix3 dtMat = rotMat * avMat;
-    return {rotMat(0,0), rotMat(0,1), rotMat(0,2), 0.0,         0.0,         0.0,
-            rotMat(1,0), rotMat(1,1), rotMat(1,2), 0.0,         0.0,         0.0,
-            rotMat(2,0), rotMat(2,1), rotMat(2,2), 0.0,         0.0,         0.0,
-            dtMat(0,0),  dtMat(0,1),  dtMat(0,2),  rotMat(0,0), rotMat(0,1), rotMat(0,2),
-            dtMat(1,0),  dtMat(1,1),  dtMat(1,2),  rotMat(1,0), rotMat(1,1), rotMat(1,2),
-            dtMat(2,0),  dtMat(2,1),  dtMat(2,2),  rotMat(2,0), rotMat(2,1), rotMat(2,2)};
+    std::vector<double> matrix(36);
+    toStateRotationMatrix(av, matrix.data());
+    return matrix;
+  }
+
+
+  void Rotation::toRotationMatrix(double *matrix) const {
+    Eigen::Map<RowMajorMatrix3> mat(matrix);
+    mat = quaternion(m_quat).toRotationMatrix();
+  }
+
+
+  void Rotation::toStateRotationMatrix(const Vec3d &av, double *matrix) const {
+    Eigen::Quaterniond::Matrix3 rotMat = quaternion(m_quat).toRotationMatrix();
+    Eigen::Quaterniond::Matrix3 dtMat = rotMat * avSkewMatrix(av);
+    Eigen::Map<Eigen::Matrix<double, 6, 6, Eigen::RowMajor>> stateMat(matrix);
+    stateMat.topLeftCorner<3, 3>() = rotMat;
+    stateMat.topRightCorner<3, 3>().setZero();
+    stateMat.bottomLeftCorner<3, 3>() = dtMat;
+    stateMat.bottomRightCorner<3, 3>() = rotMat;
   }
 
 
@@ -179,7 +156,7 @@ namespace ale {
         axes[2] < 0 || axes[2] > 2) {
       throw std::invalid_argument("Invalid axis number.");
     }
-    Eigen::Vector3d angles = m_impl->quat.toRotationMatrix().eulerAngles(
+    Eigen::Vector3d angles = quaternion(m_quat).toRotationMatrix().eulerAngles(
           axes[0],
           axes[1],
           axes[2]);
@@ -188,7 +165,7 @@ namespace ale {
 
 
   std::pair<std::vector<double>, double> Rotation::toAxisAngle() const {
-    Eigen::AngleAxisd eigenAxisAngle(m_impl->quat);
+    Eigen::AngleAxisd eigenAxisAngle(quaternion(m_quat));
     std::pair<std::vector<double>, double> axisAngle;
     axisAngle.first = std::vector<double>(
           eigenAxisAngle.axis().data(),
@@ -201,7 +178,7 @@ namespace ale {
 
   Vec3d Rotation::operator()(const Vec3d &vector) const {
     Eigen::Vector3d eigenVector(vector.x, vector.y, vector.z);
-    Eigen::Vector3d rotatedVector = m_impl->quat._transformVector(eigenVector);
+    Eigen::Vector3d rotatedVector = quaternion(m_quat)._transformVector(eigenVector);
     return Vec3d(rotatedVector[0], rotatedVector[1], rotatedVector[2]);
   }
 
@@ -214,45 +191,93 @@ namespace ale {
 
     Eigen::Vector3d positionVector(position.x, position.y, position.z);
     Eigen::Vector3d velocityVector(velocity.x, velocity.y, velocity.z);
-    Eigen::Quaterniond::Matrix3 rotMat = m_impl->quat.toRotationMatrix();
+    Eigen::Quaterniond::Matrix3 rotMat = quaternion(m_quat).toRotationMatrix();
     Eigen::Quaterniond::Matrix3 avMat = avSkewMatrix(av);
     Eigen::Quaterniond::Matrix3 rotationDerivative = rotMat * avMat;
     Eigen::Vector3d rotatedPosition = rotMat * positionVector;
     Eigen::Vector3d rotatedVelocity = rotMat * velocityVector + rotationDerivative * positionVector;
 
-    return State({rotatedPosition(0), rotatedPosition(1), rotatedPosition(2),
-                  rotatedVelocity(0), rotatedVelocity(1), rotatedVelocity(2)});
+    return State(Vec3d(rotatedPosition(0), rotatedPosition(1), rotatedPosition(2)),
+                 Vec3d(rotatedVelocity(0), rotatedVelocity(1), rotatedVelocity(2)));
+  }
+
+
+  void Rotation::rotateVectors(const Vec3d *vectors, size_t numVectors, Vec3d *rotatedVectors) const {
+    double m[9];
+    toRotationMatrix(m);
+    // Plain loads and stores so the loop has no aliasing or allocation in it
+    for (size_t i = 0; i < numVectors; i++) {
+      double x = vectors[i].x;
+      double y = vectors[i].y;
+      double z = vectors[i].z;
+      rotatedVectors[i].x = m[0] * x + m[1] * y + m[2] * z;
+      rotatedVectors[i].y = m[3] * x + m[4] * y + m[5] * z;
+      rotatedVectors[i].z = m[6] * x + m[7] * y + m[8] * z;
+    }
+  }
+
+
+  void Rotation::rotateStates(const State *states, size_t numStates, State *rotatedStates,
+                              const Vec3d &av) const {
+    double m[9];
+    toRotationMatrix(m);
+    // The derivative of the rotation matrix
+    double d[9];
+    Eigen::Map<RowMajorMatrix3> derivative(d);
+    derivative = Eigen::Map<const RowMajorMatrix3>(m) * avSkewMatrix(av);
+    for (size_t i = 0; i < numStates; i++) {
+      double x = states[i].position.x;
+      double y = states[i].position.y;
+      double z = states[i].position.z;
+      double vx = states[i].velocity.x;
+      double vy = states[i].velocity.y;
+      double vz = states[i].velocity.z;
+      rotatedStates[i].position.x = m[0] * x + m[1] * y + m[2] * z;
+      rotatedStates[i].position.y = m[3] * x + m[4] * y + m[5] * z;
+      rotatedStates[i].position.z = m[6] * x + m[7] * y + m[8] * z;
+      rotatedStates[i].velocity.x = m[0] * vx + m[1] * vy + m[2] * vz + d[0] * x + d[1] * y + d[2] * z;
+      rotatedStates[i].velocity.y = m[3] * vx + m[4] * vy + m[5] * vz + d[3] * x + d[4] * y + d[5] * z;
+      rotatedStates[i].velocity.z = m[6] * vx + m[7] * vy + m[8] * vz + d[6] * x + d[7] * y + d[8] * z;
+    }
   }
 
 
   Rotation Rotation::inverse() const {
-    Eigen::Quaterniond inverseQuat = m_impl->quat.inverse();
+    Eigen::Quaterniond inverseQuat = quaternion(m_quat).inverse();
     return Rotation(inverseQuat.w(), inverseQuat.x(), inverseQuat.y(), inverseQuat.z());
   }
 
 
   Rotation Rotation::operator*(const Rotation& rightRotation) const {
-    Eigen::Quaterniond combinedQuat = m_impl->quat * rightRotation.m_impl->quat;
+    Eigen::Quaterniond combinedQuat = quaternion(m_quat) * quaternion(rightRotation.m_quat);
     return Rotation(combinedQuat.w(), combinedQuat.x(), combinedQuat.y(), combinedQuat.z());
   }
 
 
+  double Rotation::angleTo(const Rotation& other) const {
+    Eigen::Quaterniond difference = quaternion(m_quat).inverse() * quaternion(other.m_quat);
+    return 2 * std::atan2(difference.vec().norm(), std::fabs(difference.w()));
+  }
+
+
   Rotation Rotation::interpolate(
         const Rotation& nextRotation,
         double t,
         RotationInterpolation interpType
   ) const {
+    Eigen::Map<const Eigen::Quaterniond> quat = quaternion(m_quat);
+    Eigen::Map<const Eigen::Quaterniond> nextQuat = quaternion(nextRotation.m_quat);
     Eigen::Quaterniond interpQuat;
     switch (interpType) {
       case SLERP:
-        interpQuat = m_impl->quat.slerp(t, nextRotation.m_impl->quat);
+        interpQuat = quat.slerp(t, nextQuat);
         break;
       case NLERP:
         interpQuat = Eigen::Quaterniond(
-              linearInterpolate(m_impl->quat.w(), nextRotation.m_impl->quat.w(), t),
-              linearInterpolate(m_impl->quat.x(), nextRotation.m_impl->quat.x(), t),
-              linearInterpolate(m_impl->quat.y(), nextRotation.m_impl->quat.y(), t),
-              linearInterpolate(m_impl->quat.z(), nextRotation.m_impl->quat.z(), t)
+              linearInterpolate(quat.w(), nextQuat.w(), t),
+              linearInterpolate(quat.x(), nextQuat.x(), t),
+              linearInterpolate(quat.y(), nextQuat.y(), t),
+              linearInterpolate(quat.z(), nextQuat.z(), t)
         );
         interpQuat.normalize();
         break;
@@ -263,4 +288,61 @@ namespace ale {
     return Rotation(interpQuat.w(), interpQuat.x(), interpQuat.y(), interpQuat.z());
   }
 
+
+  void Rotation::interpolate(
+        const Rotation& nextRotation,
+        const double *t,
+        size_t numT,
+        RotationInterpolation interpType,
+        Rotation *interpRotations
+  ) const {
+    const double *quat = m_quat;
+    const double *nextQuat = nextRotation.m_quat;
+    switch (interpType) {
+      case SLERP: {
+        // Same as Eigen's slerp, with the angle terms hoisted out of the loop
+        double d = quat[0] * nextQuat[0] + quat[1] * nextQuat[1]
+                 + quat[2] * nextQuat[2] + quat[3] * nextQuat[3];
+        double absD = std::abs(d);
+        bool nearlyEqual = absD >= 1.0 - std::numeric_limits<double>::epsilon();
+        double theta = nearlyEqual ? 0.0 : std::acos(absD);
+        double sinTheta = nearlyEqual ? 1.0 : std::sin(theta);
+        double sign = d < 0.0 ? -1.0 : 1.0;
+        for (size_t i = 0; i < numT; i++) {
+          double scale0;
+          double scale1;
+          if (nearlyEqual) {
+            scale0 = 1.0 - t[i];
+            scale1 = t[i];
+          }
+          else {
+            scale0 = std::sin((1.0 - t[i]) * theta) / sinTheta;
+            scale1 = std::sin(t[i] * theta) / sinTheta;
+          }
+          scale1 *= sign;
+          interpRotations[i] = Rotation(scale0 * quat[3] + scale1 * nextQuat[3],
+                                        scale0 * quat[0] + scale1 * nextQuat[0],
+                                        scale0 * quat[1] + scale1 * nextQuat[1],
+                                        scale0 * quat[2] + scale1 * nextQuat[2]);
+        }
+        break;
+      }
+      case NLERP:
+        for (size_t i = 0; i < numT; i++) {
+          Eigen::Map<Eigen::Quaterniond> interpQuat = quaternion(interpRotations[i].m_quat);
+          interpQuat = Eigen::Quaterniond(
+                linearInterpolate(quat[3], nextQuat[3], t[i]),
+                linearInterpolate(quat[0], nextQuat[0], t[i]),
+                linearInterpolate(quat[1], nextQuat[1], t[i]),
+                linearInterpolate(quat[2], nextQuat[2], t[i])
+          );
+          interpQuat.normalize();
+        }
+        break;
+      default:
+        throw std::invalid_argument("Unsupported rotation interpolation type.");
+        break;
+    }
+  }
+
 }
@@ -0,0 +1,104 @@
+#ifndef ALE_STATEWINDOW_H
+#define ALE_STATEWINDOW_H
+
+#include <stdexcept>
+
+#include "ale/InterpUtils.h"
+#include "ale/States.h"
+#include "ale/Vectors.h"
+
+// Interpolation over a window of states shared by States and CompactStates.
+// This header is not installed.
+
+namespace ale {
+
+  // Propagates a single state to another time assuming constant velocity
+  // x_f = x_i + v * (t_f - t-i)
+  inline State extrapolateState(double stateTime, const State &state, double time) {
+    Vec3d position = state.position + state.velocity*(time - stateTime);
+    return State(position, state.velocity);
+  }
+
+
+  // Interpolate the position columns with lagrange polynomials and their derivatives for the velocities
+  template<int Order>
+  State lagrangeState(const double *times, const double *const *positions, int numStates,
+                      int index, double time) {
+    LagrangeBasis<Order> basis(times, numStates, index, time);
+    double position[3];
+    double velocity[3];
+    for (int axis = 0; axis < 3; axis++) {
+      basis.interpolate(positions[axis], position[axis], velocity[axis]);
+    }
+    return State(Vec3d(position[0], position[1], position[2]),
+                 Vec3d(velocity[0], velocity[1], velocity[2]));
+  }
+
+
+  /**
+   * Get the state at a time from a window of consecutive states stored as
+   * columns. A time on one of the states around the interpolation index
+   * returns that state. A single state is propagated with its velocity, if
+   * it has one. Otherwise the window is interpolated the same way as
+   * States::getState.
+   *
+   * @param times The times of the window
+   * @param positions The x, y, and z position columns of the window
+   * @param velocities The x, y, and z velocity columns of the window, or
+   *                   null if the states have no velocities
+   * @param numStates The number of states in the window
+   * @param lowerBound The interpolation index of time within the window
+   * @param time The time to get the state at
+   * @param interp The interpolation type
+   * @param hasVelocity If every velocity in the window can be used to interpolate
+   */
+  inline State windowState(const double *times, const double *const *positions,
+                           const double *const *velocities, int numStates, int lowerBound,
+                           double time, PositionInterpolation interp, bool hasVelocity) {
+    for (int index = lowerBound; index <= lowerBound + 1 && index < numStates; index++) {
+      if (times[index] == time) {
+        Vec3d position(positions[0][index], positions[1][index], positions[2][index]);
+        if (!velocities) {
+          return State(position);
+        }
+        return State(position, Vec3d(velocities[0][index], velocities[1][index], velocities[2][index]));
+      }
+    }
+
+    if (numStates == 1) {
+      State state(Vec3d(positions[0][0], positions[1][0], positions[2][0]));
+      if (!hasVelocity) {
+        return state;
+      }
+      state.velocity = Vec3d(velocities[0][0], velocities[1][0], velocities[2][0]);
+      return extrapolateState(times[0], state, time);
+    }
+
+    if (interp == SPLINE && hasVelocity) {
+      // Do hermite spline if velocities are available
+      double position[3];
+      double velocity[3];
+      for (int axis = 0; axis < 3; axis++) {
+        cubicHermite(times[lowerBound], times[lowerBound + 1],
+                     positions[axis][lowerBound], positions[axis][lowerBound + 1],
+                     velocities[axis][lowerBound], velocities[axis][lowerBound + 1],
+                     time, position[axis], velocity[axis]);
+      }
+      return State(Vec3d(position[0], position[1], position[2]),
+                   Vec3d(velocity[0], velocity[1], velocity[2]));
+    }
+
+    switch (interp) {
+      case LINEAR:
+        return lagrangeState<2>(times, positions, numStates, lowerBound, time);
+      case SPLINE:
+        return lagrangeState<4>(times, positions, numStates, lowerBound, time);
+      case LAGRANGE:
+        return lagrangeState<8>(times, positions, numStates, lowerBound, time);
+      default:
+        throw std::invalid_argument("Invalid interpolation option, must be LINEAR, SPLINE, or LAGRANGE.");
+    }
+  }
+}
+
+#endif
@@ -1,66 +1,79 @@
 #include "ale/States.h"
+#include "ale/ThreadPool.h"
 
 #include <iostream>
 #include <algorithm>
 #include <cmath>
 #include <float.h>
+#include <utility>
+
+#include "StateWindow.h"
 
 namespace ale {
 
   // Empty constructor
-  States::States() : m_refFrame(0) {
-    m_states = {};
+  States::States() : m_hasVelocity(false), m_refFrame(0), m_preparedInterp(-1), m_preparedOrder(0), m_preparedHermite(false) {
     m_ephemTimes = {};
   }
 
 
   States::States(const std::vector<double>& ephemTimes, const std::vector<Vec3d>& positions,
                  int refFrame) :
-    m_ephemTimes(ephemTimes), m_refFrame(refFrame) {
+    m_ephemTimes(ephemTimes), m_hasVelocity(false), m_refFrame(refFrame), m_preparedInterp(-1), m_preparedOrder(0), m_preparedHermite(false) {
     // Construct State vector from position and velocity vectors
     if (positions.size() != ephemTimes.size()) {
       throw std::invalid_argument("Length of times must match number of positions");
     }
 
-    for (Vec3d position : positions) {
-      m_states.push_back(State(position));
-    }
+    storePositions(positions);
   }
 
   States::States(const std::vector<double>& ephemTimes, const std::vector<std::vector<double>>& positions,
                  int refFrame) :
-    m_ephemTimes(ephemTimes), m_refFrame(refFrame) {
+    m_ephemTimes(ephemTimes), m_hasVelocity(false), m_refFrame(refFrame), m_preparedInterp(-1), m_preparedOrder(0), m_preparedHermite(false) {
 
     // Construct State vector from position and velocity vectors
     if (positions.size() != ephemTimes.size()) {
       throw std::invalid_argument("Length of times must match number of positions");
     }
 
-    for (Vec3d position : positions) {
-      m_states.push_back(State(position));
-    }
+    storePositions(std::vector<Vec3d>(positions.begin(), positions.end()));
   }
 
   States::States(const std::vector<double>& ephemTimes, const std::vector<Vec3d>& positions,
                  const std::vector<Vec3d>& velocities, int refFrame) :
-    m_ephemTimes(ephemTimes), m_refFrame(refFrame) {
+    m_ephemTimes(ephemTimes), m_hasVelocity(false), m_refFrame(refFrame), m_preparedInterp(-1), m_preparedOrder(0), m_preparedHermite(false) {
 
     if ((positions.size() != ephemTimes.size())||(ephemTimes.size() != velocities.size())) {
       throw std::invalid_argument("Length of times must match number of positions and velocities.");
     }
 
-    for (int i=0; i < positions.size() ;i++) {
-      m_states.push_back(State(positions[i], velocities[i]));
-    }
+    storePositions(positions);
+    storeVelocities(velocities);
   }
 
 
   States::States(const std::vector<double>& ephemTimes, const std::vector<State>& states,
                  int refFrame) :
-  m_ephemTimes(ephemTimes), m_states(states), m_refFrame(refFrame) {
+  m_ephemTimes(ephemTimes), m_hasVelocity(false), m_refFrame(refFrame), m_preparedInterp(-1), m_preparedOrder(0), m_preparedHermite(false) {
     if (states.size() != ephemTimes.size()) {
       throw std::invalid_argument("Length of times must match number of states.");
     }
+
+    std::vector<Vec3d> positions;
+    std::vector<Vec3d> velocities;
+    positions.reserve(states.size());
+    velocities.reserve(states.size());
+    bool anyVelocity = false;
+    for (const State &state : states) {
+      positions.push_back(state.position);
+      velocities.push_back(state.velocity);
+      anyVelocity = anyVelocity || state.hasVelocity();
+    }
+    storePositions(positions);
+    if (anyVelocity) {
+      storeVelocities(velocities);
+    }
   }
 
   // Default Destructor
@@ -68,45 +81,64 @@ namespace ale {
 
   // Getters
   std::vector<State> States::getStates() const {
-    return m_states;
+    std::vector<State> states;
+    states.reserve(m_ephemTimes.size());
+    for (size_t i = 0; i < m_ephemTimes.size(); i++) {
+      states.push_back(stateAt(i));
+    }
+    return states;
   }
 
   std::vector<Vec3d> States::getPositions() const {
-    // extract positions from state vector
+    // gather positions from the columns
     std::vector<Vec3d> positions;
-
-    for(State state : m_states) {
-        positions.push_back(state.position);
+    positions.reserve(m_ephemTimes.size());
+    for (size_t i = 0; i < m_ephemTimes.size(); i++) {
+      positions.push_back(Vec3d(m_positions[0][i], m_positions[1][i], m_positions[2][i]));
     }
     return positions;
   }
 
 
   std::vector<Vec3d> States::getVelocities() const {
-    // extract velocities from state vector
+    // gather velocities from the columns
     std::vector<Vec3d> velocities;
-
-    for(State state : m_states) {
-        velocities.push_back(state.velocity);
+    velocities.reserve(m_ephemTimes.size());
+    for (size_t i = 0; i < m_ephemTimes.size(); i++) {
+      velocities.push_back(stateAt(i).velocity);
     }
     return velocities;
   }
 
 
-  std::vector<double> States::getTimes() const {
+  const std::vector<double> &States::getTimes() const {
     return m_ephemTimes;
   }
 
 
+  const std::vector<double> &States::getPositionColumn(int axis) const {
+    if (axis < 0 || axis > 2) {
+      throw std::invalid_argument("Axis index must be 0, 1, or 2.");
+    }
+    return m_positions[axis];
+  }
+
+
+  const std::vector<double> &States::getVelocityColumn(int axis) const {
+    if (axis < 0 || axis > 2) {
+      throw std::invalid_argument("Axis index must be 0, 1, or 2.");
+    }
+    return m_velocities[axis];
+  }
+
+
   int States::getReferenceFrame() const {
     return m_refFrame;
   }
 
 
   bool States::hasVelocity() const {
-    bool allVelocity = std::all_of(m_states.begin(), m_states.end(), [](State vec)
-                                   { return vec.hasVelocity(); });
-    return allVelocity;
+    return m_hasVelocity;
   }
 
 
@@ -118,70 +150,89 @@ namespace ale {
 
     if ( (candidate_time != m_ephemTimes.end()) && (*candidate_time == time) ) {
       int index = std::distance(m_ephemTimes.begin(), candidate_time);
-      return m_states[index];
+      return stateAt(index);
     }
-  
+
     if (m_ephemTimes.size() > 1) {
-      int lowerBound = interpolationIndex(m_ephemTimes, time); 
-      // try to copy the surrounding 8 points as that's the most possibly needed
-      int interpStart = std::max(0, lowerBound - 3);
-      int interpStop = std::min(lowerBound + 4, (int) m_ephemTimes.size() - 1);
-
-      State state;
-      std::vector<double> xs, ys, zs, vxs, vys, vzs, interpTimes;
-
-      for (int i = interpStart; i <= interpStop; i++) {
-        state = m_states[i];
-        interpTimes.push_back(m_ephemTimes[i]);
-        xs.push_back(state.position.x);
-        ys.push_back(state.position.y);
-        zs.push_back(state.position.z);
-        vxs.push_back(state.velocity.x);
-        vys.push_back(state.velocity.y);
-        vzs.push_back(state.velocity.z);
+      int lowerBound = interpolationIndex(m_ephemTimes, time);
+      if (isPrepared(interp)) {
+        return interpolatePrepared(time, lowerBound);
       }
+      return interpolateWindow(0, m_ephemTimes.size(), time, lowerBound, interp, m_hasVelocity);
+    }
+    else if (m_hasVelocity) {
+      return extrapolateState(m_ephemTimes[0], stateAt(0), time);
+    }
+    else { // Here we have: only 1 time and 1 state, so just return the only state.
+      return stateAt(0);
+    }
+  }
 
-      Vec3d position, velocity;
-      if ( interp == LINEAR || (interp == SPLINE && !hasVelocity())) {
-        position = {interpolate(xs,  interpTimes, time, interp, 0),
-                    interpolate(ys,  interpTimes, time, interp, 0),
-                    interpolate(zs,  interpTimes, time, interp, 0)};
 
-        velocity = {interpolate(xs, interpTimes, time, interp, 1),
-                    interpolate(ys, interpTimes, time, interp, 1),
-                    interpolate(zs, interpTimes, time, interp, 1)};
-      }
-      else if (interp == SPLINE && hasVelocity()){
-        // Do hermite spline if velocities are available
-        double baseTime = (interpTimes.front() + interpTimes.back()) / 2;
-        std::vector<double> scaledEphemTimes;
-        for(unsigned int i = 0; i < interpTimes.size(); i++) {
-          scaledEphemTimes.push_back(interpTimes[i] - baseTime);
-        }
-        double sTime = time - baseTime;
-        position.x = evaluateCubicHermite(sTime, vxs, scaledEphemTimes, xs);
-        position.y = evaluateCubicHermite(sTime, vys, scaledEphemTimes, ys);
-        position.z = evaluateCubicHermite(sTime, vzs, scaledEphemTimes, zs);
-
-        velocity.x = evaluateCubicHermiteFirstDeriv(sTime, vxs, scaledEphemTimes, xs);
-        velocity.y = evaluateCubicHermiteFirstDeriv(sTime, vys, scaledEphemTimes, ys);
-        velocity.z = evaluateCubicHermiteFirstDeriv(sTime, vzs, scaledEphemTimes, zs);
-      }
-      return State(position, velocity);
+  std::vector<State> States::getStates(const std::vector<double> &times,
+                                       PositionInterpolation interp) const {
+    std::vector<State> states(times.size());
+    getStates(times.data(), times.size(), states.data(), interp);
+    return states;
+  }
+
+
+  void States::getStates(const double *times, size_t numTimes, State *states,
+                         PositionInterpolation interp) const {
+    if (numTimes == 0) {
+      return;
     }
-    else if (hasVelocity()) {
-      // Here we have: 1 state (1 time, 1 position, 1 velocity)
-      // x_f = x_i + v * (t_f - t-i)
-      Vec3d position = m_states[0].position + m_states[0].velocity*(time - m_ephemTimes[0]);
-      Vec3d velocity = m_states[0].velocity;
-      return State(position, velocity);
+
+    // The cursor checks for velocities once and re-uses its search results
+    // for every time in the batch
+    Cursor cursor(*this);
+    for (size_t i = 0; i < numTimes; i++) {
+      states[i] = cursor.getState(times[i], interp);
     }
-    else { // Here we have: only 1 time and 1 state, so just return the only state.
-      return m_states[0];
+  }
+
+
+  std::vector<State> States::getStates(const std::vector<double> &times,
+                                       PositionInterpolation interp, ThreadPool &pool) const {
+    std::vector<State> states(times.size());
+    pool.parallelFor(times.size(), [this, &times, &states, interp](size_t begin, size_t end) {
+      getStates(times.data() + begin, end - begin, states.data() + begin, interp);
+    });
+    return states;
+  }
+
+
+  std::vector<Vec3d> States::getPositions(const std::vector<double> &times,
+                                          PositionInterpolation interp) const {
+    std::vector<Vec3d> positions(times.size());
+    getPositions(times.data(), times.size(), positions.data(), interp);
+    return positions;
+  }
+
+
+  void States::getPositions(const double *times, size_t numTimes, Vec3d *positions,
+                            PositionInterpolation interp) const {
+    if (numTimes == 0) {
+      return;
+    }
+
+    Cursor cursor(*this);
+    for (size_t i = 0; i < numTimes; i++) {
+      positions[i] = cursor.getState(times[i], interp).position;
     }
   }
 
 
+  std::vector<Vec3d> States::getPositions(const std::vector<double> &times,
+                                          PositionInterpolation interp, ThreadPool &pool) const {
+    std::vector<Vec3d> positions(times.size());
+    pool.parallelFor(times.size(), [this, &times, &positions, interp](size_t begin, size_t end) {
+      getPositions(times.data() + begin, end - begin, positions.data() + begin, interp);
+    });
+    return positions;
+  }
+
+
   Vec3d States::getPosition(double time, PositionInterpolation interp) const {
     State interpState = getState(time, interp);
     return interpState.position;
@@ -205,8 +256,254 @@ namespace ale {
   }
 
 
-  States States::minimizeCache(double tolerance) {
-    if (m_states.size() <= 2) {
+  void States::prepareInterpolation(PositionInterpolation interp) {
+    int order = interpolationOrder(interp);
+
+    m_lagrangeStarts.clear();
+    m_lagrangeSizes.clear();
+    m_lagrangeWeights.clear();
+    m_hermiteCoefficients.clear();
+    m_preparedOrder = order;
+    m_preparedHermite = (interp == SPLINE && hasVelocity());
+    m_preparedInterp = interp;
+
+    int numIntervals = (int) m_ephemTimes.size() - 1;
+    if (numIntervals < 1) {
+      return;
+    }
+
+    if (m_preparedHermite) {
+      // Cubic polynomial coefficients in the scaled time s = (t - t0) / h for
+      // each interval, stored as {c0, c1, c2, c3} for x, then y, then z.
+      m_hermiteCoefficients.reserve(numIntervals * 12);
+      for (int index = 0; index < numIntervals; index++) {
+        double h = m_ephemTimes[index + 1] - m_ephemTimes[index];
+        if (h == 0.0) {
+          throw std::invalid_argument("Error in evaluating cubic hermite velocities, values at"
+                                      "lower and upper indicies are exactly equal.");
+        }
+        for (int axis = 0; axis < 3; axis++) {
+          double y0 = m_positions[axis][index], y1 = m_positions[axis][index + 1];
+          double m0 = h * m_velocities[axis][index], m1 = h * m_velocities[axis][index + 1];
+          m_hermiteCoefficients.push_back(y0);
+          m_hermiteCoefficients.push_back(m0);
+          m_hermiteCoefficients.push_back(-3 * y0 - 2 * m0 + 3 * y1 - m1);
+          m_hermiteCoefficients.push_back(2 * y0 + m0 - 2 * y1 + m1);
+        }
+      }
+    }
+    else {
+      // The lagrange weights, 1 / prod(t_i - t_j), for the window that
+      // lagrangeInterpolate uses in each interval
+      m_lagrangeStarts.reserve(numIntervals);
+      m_lagrangeSizes.reserve(numIntervals);
+      m_lagrangeWeights.reserve(numIntervals * order);
+      for (int index = 0; index < numIntervals; index++) {
+        int windowSize = std::min(index + 1, numIntervals - index);
+        windowSize = std::min(windowSize, order / 2);
+        int startIndex = index - windowSize + 1;
+        int endIndex = index + windowSize + 1;
+        m_lagrangeStarts.push_back(startIndex);
+        m_lagrangeSizes.push_back(endIndex - startIndex);
+        for (int i = startIndex; i < startIndex + order; i++) {
+          double weight = 1;
+          if (i < endIndex) {
+            for (int j = startIndex; j < endIndex; j++) {
+              if (i != j) {
+                weight *= m_ephemTimes[i] - m_ephemTimes[j];
+              }
+            }
+          }
+          m_lagrangeWeights.push_back(1.0 / weight);
+        }
+      }
+    }
+  }
+
+
+  bool States::isPrepared(PositionInterpolation interp) const {
+    return m_preparedInterp == interp;
+  }
+
+
+  State States::interpolatePrepared(double time, int lowerBound) const {
+    if (m_preparedHermite) {
+      double h = m_ephemTimes[lowerBound + 1] - m_ephemTimes[lowerBound];
+      double t = (time - m_ephemTimes[lowerBound]) / h;
+      const double *coeffs = &m_hermiteCoefficients[lowerBound * 12];
+      double values[3], derivs[3];
+      for (int axis = 0; axis < 3; axis++) {
+        const double *c = coeffs + axis * 4;
+        values[axis] = c[0] + t * (c[1] + t * (c[2] + t * c[3]));
+        derivs[axis] = (c[1] + t * (2 * c[2] + t * 3 * c[3])) / h;
+      }
+      return State(Vec3d(values[0], values[1], values[2]), Vec3d(derivs[0], derivs[1], derivs[2]));
+    }
+
+    // Evaluate the lagrange basis polynomials and their derivatives once,
+    // then each coordinate is a dot product with them.
+    // prod_{j != i}(t - t_j) and sum_{j != i} 1 / (t - t_j) are built from
+    // prefix and suffix products and sums of the differences and their
+    // reciprocals. Callers return the sample for times that hit one exactly,
+    // so none of the differences is zero.
+    int start = m_lagrangeStarts[lowerBound];
+    int size = m_lagrangeSizes[lowerBound];
+    const double *weights = &m_lagrangeWeights[lowerBound * m_preparedOrder];
+    double diffs[8], prefixProd[9], suffixProd[9], prefixSum[9], suffixSum[9];
+    for (int i = 0; i < size; i++) {
+      diffs[i] = time - m_ephemTimes[start + i];
+    }
+    prefixProd[0] = 1;
+    prefixSum[0] = 0;
+    for (int i = 0; i < size; i++) {
+      prefixProd[i + 1] = prefixProd[i] * diffs[i];
+      prefixSum[i + 1] = prefixSum[i] + 1.0 / diffs[i];
+    }
+    suffixProd[size] = 1;
+    suffixSum[size] = 0;
+    for (int i = size - 1; i >= 0; i--) {
+      suffixProd[i] = suffixProd[i + 1] * diffs[i];
+      suffixSum[i] = suffixSum[i + 1] + 1.0 / diffs[i];
+    }
+
+    double position[3] = {0, 0, 0};
+    double velocity[3] = {0, 0, 0};
+    for (int i = 0; i < size; i++) {
+      double basis = weights[i] * prefixProd[i] * suffixProd[i + 1];
+      double basisDeriv = basis * (prefixSum[i] + suffixSum[i + 1]);
+      for (int axis = 0; axis < 3; axis++) {
+        double sample = m_positions[axis][start + i];
+        position[axis] += basis * sample;
+        velocity[axis] += basisDeriv * sample;
+      }
+    }
+    return State(Vec3d(position[0], position[1], position[2]),
+                 Vec3d(velocity[0], velocity[1], velocity[2]));
+  }
+
+
+  State States::interpolateWindow(size_t first, int numStates, double time, int lowerBound,
+                                  PositionInterpolation interp, bool hasVelocity) const {
+    const double *positions[3] = {m_positions[0].data() + first,
+                                  m_positions[1].data() + first,
+                                  m_positions[2].data() + first};
+    const double *velocities[3] = {nullptr, nullptr, nullptr};
+    if (!m_velocities[0].empty()) {
+      for (int axis = 0; axis < 3; axis++) {
+        velocities[axis] = m_velocities[axis].data() + first;
+      }
+    }
+    return windowState(m_ephemTimes.data() + first, positions,
+                       m_velocities[0].empty() ? nullptr : velocities,
+                       numStates, lowerBound, time, interp, hasVelocity);
+  }
+
+
+
+  State States::stateAt(size_t index) const {
+    Vec3d position(m_positions[0][index], m_positions[1][index], m_positions[2][index]);
+    if (m_velocities[0].empty()) {
+      return State(position);
+    }
+    return State(position, Vec3d(m_velocities[0][index], m_velocities[1][index],
+                                 m_velocities[2][index]));
+  }
+
+
+  bool States::rangeHasVelocity(size_t first, size_t count) const {
+    if (m_velocities[0].empty()) {
+      return false;
+    }
+    for (size_t i = first; i < first + count; i++) {
+      if (std::isnan(m_velocities[0][i]) || std::isnan(m_velocities[1][i])
+          || std::isnan(m_velocities[2][i])) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+
+  void States::storePositions(const std::vector<Vec3d> &positions) {
+    for (int axis = 0; axis < 3; axis++) {
+      m_positions[axis].resize(positions.size());
+    }
+    for (size_t i = 0; i < positions.size(); i++) {
+      m_positions[0][i] = positions[i].x;
+      m_positions[1][i] = positions[i].y;
+      m_positions[2][i] = positions[i].z;
+    }
+  }
+
+
+  void States::storeVelocities(const std::vector<Vec3d> &velocities) {
+    for (int axis = 0; axis < 3; axis++) {
+      m_velocities[axis].resize(velocities.size());
+    }
+    for (size_t i = 0; i < velocities.size(); i++) {
+      m_velocities[0][i] = velocities[i].x;
+      m_velocities[1][i] = velocities[i].y;
+      m_velocities[2][i] = velocities[i].z;
+    }
+    m_hasVelocity = rangeHasVelocity(0, velocities.size());
+  }
+
+
+  States::Cursor::Cursor(const States &states) :
+    m_states(states), m_cursor(states.m_ephemTimes), m_hasVelocity(states.hasVelocity()) { }
+
+
+  State States::Cursor::getState(double time, PositionInterpolation interp) {
+    const std::vector<double> &ephemTimes = m_states.m_ephemTimes;
+    if (ephemTimes.empty()) {
+      throw std::invalid_argument("Cannot interpolate an empty set of states.");
+    }
+
+    if (ephemTimes.size() == 1) {
+      State state = m_states.stateAt(0);
+      return m_hasVelocity ? extrapolateState(ephemTimes[0], state, time) : state;
+    }
+
+    int lowerBound = m_cursor.index(time);
+
+    // If time is in times, don't need to interpolate!
+    if (ephemTimes[lowerBound] == time) {
+      return m_states.stateAt(lowerBound);
+    }
+    if (ephemTimes[lowerBound + 1] == time) {
+      return m_states.stateAt(lowerBound + 1);
+    }
+
+    if (m_states.isPrepared(interp)) {
+      return m_states.interpolatePrepared(time, lowerBound);
+    }
+
+    return m_states.interpolateWindow(0, ephemTimes.size(), time, lowerBound, interp, m_hasVelocity);
+  }
+
+
+  Vec3d States::Cursor::getPosition(double time, PositionInterpolation interp) {
+    return getState(time, interp).position;
+  }
+
+
+  Vec3d States::Cursor::getVelocity(double time, PositionInterpolation interp) {
+    return getState(time, interp).velocity;
+  }
+
+
+  int States::Cursor::getIndex() const {
+    return m_cursor.getIndex();
+  }
+
+
+  void States::Cursor::hint(int index) {
+    m_cursor.hint(index);
+  }
+
+
+  States States::minimizeCache(double tolerance, CacheReduction *report) const {
+    if (m_ephemTimes.size() <= 2) {
       throw std::invalid_argument("Cache size is 2, cannot minimize.");
     }
     if (!hasVelocity()) {
@@ -217,80 +514,221 @@ namespace ale {
     double baseTime = (m_ephemTimes.at(0) + m_ephemTimes.back())/ 2.0;
     double timeScale = 1.0;
 
-    // Find current size of m_states
-    int currentSize = m_ephemTimes.size() - 1;
-
-    // Create 3 starting values for the new size-minimized cache
-    std::vector <int> inputIndices;
-    inputIndices.push_back(0);
-    inputIndices.push_back(currentSize / 2);
-    inputIndices.push_back(currentSize);
+    if (report) {
+      *report = CacheReduction();
+    }
 
     // find all indices needed to make a hermite table within the appropriate tolerance
-    std::vector <int> indexList = hermiteIndices(tolerance, inputIndices, baseTime, timeScale);
+    std::vector <int> indexList = hermiteIndices(tolerance, baseTime, timeScale, report);
 
-    // Update m_states and m_ephemTimes to only save the necessary indicies in the index list
+    // Copy only the states and times at the indices in the index list
     std::vector<State> tempStates;
     std::vector<double> tempTimes;
+    tempStates.reserve(indexList.size());
+    tempTimes.reserve(indexList.size());
 
     for(int i : indexList) {
-      tempStates.push_back(m_states[i]);
+      tempStates.push_back(stateAt(i));
       tempTimes.push_back(m_ephemTimes[i]);
     }
+
+    if (report) {
+      report->originalSize = m_ephemTimes.size();
+      report->reducedSize = indexList.size();
+    }
     return States(tempTimes, tempStates, m_refFrame);
    }
 
-  std::vector<int> States::hermiteIndices(double tolerance, std::vector<int> indexList,
-                                                 double baseTime, double timeScale) {
-    unsigned int n = indexList.size();
-    double sTime;
+  std::vector<int> States::hermiteIndices(double tolerance, double baseTime, double timeScale,
+                                          CacheReduction *report) const {
+    // Start from the first, middle, and last states
+    int currentSize = m_ephemTimes.size() - 1;
+    std::vector<int> indexList = {0};
 
-    std::vector<double> x, y, z, vx, vy, vz, scaledEphemTimes;
-    for(unsigned int i = 0; i < indexList.size(); i++) {
-      scaledEphemTimes.push_back((m_ephemTimes[indexList[i]] - baseTime) / timeScale);
-      x.push_back(m_states[indexList[i]].position.x);
-      y.push_back(m_states[indexList[i]].position.y);
-      z.push_back(m_states[indexList[i]].position.z);
-      vx.push_back(m_states[i].velocity.x);
-      vy.push_back(m_states[i].velocity.y);
-      vz.push_back(m_states[i].velocity.z);
-    }
+    // The intervals still to check, the next interval on top
+    std::vector<std::pair<int, int>> intervals;
+    intervals.push_back(std::make_pair(currentSize / 2, currentSize));
+    intervals.push_back(std::make_pair(0, currentSize / 2));
 
-    // loop through the saved indices from the end
-    for(unsigned int i = indexList.size() - 1; i > 0; i--) {
-      double xerror = 0;
-      double yerror = 0;
-      double zerror = 0;
+    while (!intervals.empty()) {
+      int start = intervals.back().first;
+      int stop = intervals.back().second;
+      intervals.pop_back();
+
+      double startTime = (m_ephemTimes[start] - baseTime) / timeScale;
+      double stopTime = (m_ephemTimes[stop] - baseTime) / timeScale;
+      double h = stopTime - startTime;
+
+      bool withinTolerance = true;
+      double maxError = 0;
+      double maxErrorTime = 0;
 
       // check every value of the original kernel values within interval
-      for(int line = indexList[i-1] + 1; line < indexList[i]; line++) {
-        sTime = (m_ephemTimes[line] - baseTime) / timeScale;
+      for (int line = start + 1; line < stop; line++) {
+        double t = ((m_ephemTimes[line] - baseTime) / timeScale - startTime) / h;
+        double h00 = 2 * t * t * t - 3 * t * t + 1;
+        double h10 = t * t * t - 2 * t * t + t;
+        double h01 = -2 * t * t * t + 3 * t * t;
+        double h11 = t * t * t - t * t;
 
         // find the errors at each value
-        xerror = fabs(evaluateCubicHermite(sTime, vx, scaledEphemTimes, x) - m_states[line].position.x);
-        yerror = fabs(evaluateCubicHermite(sTime, vy, scaledEphemTimes, y) - m_states[line].position.y);
-        zerror = fabs(evaluateCubicHermite(sTime, vz, scaledEphemTimes, z) - m_states[line].position.z);
+        double errors[3];
+        for (int axis = 0; axis < 3; axis++) {
+          const std::vector<double> &positions = m_positions[axis];
+          const std::vector<double> &velocities = m_velocities[axis];
+          errors[axis] = fabs(h00 * positions[start] + h10 * h * velocities[start]
+                              + h01 * positions[stop] + h11 * h * velocities[stop]
+                              - positions[line]);
+        }
+        double xerror = errors[0];
+        double yerror = errors[1];
+        double zerror = errors[2];
 
-        if(xerror > tolerance || yerror > tolerance || zerror > tolerance) {
-          // if any error is greater than tolerance, no need to continue looking, break
+        if (!(xerror < tolerance && yerror < tolerance && zerror < tolerance)) {
+          // if any error is not less than tolerance, no need to continue looking, break
+          withinTolerance = false;
           break;
         }
+
+        double error = std::max(xerror, std::max(yerror, zerror));
+        if (error > maxError) {
+          maxError = error;
+          maxErrorTime = m_ephemTimes[line];
+        }
       }
 
-      if(xerror < tolerance && yerror < tolerance && zerror < tolerance) {
-        // if errors are less than tolerance after looping interval, no new point is necessary
-        continue;
+      if (withinTolerance) {
+        // no new point is necessary
+        indexList.push_back(stop);
+        if (report && maxError > report->maxError) {
+          report->maxError = maxError;
+          report->maxErrorTime = maxErrorTime;
+        }
       }
       else {
-        // if any error is greater than tolerance, add midpoint of interval to indexList vector
-        indexList.push_back((indexList[i] + indexList[i-1]) / 2);
+        // split the interval at its midpoint and check the first half next
+        int middle = (start + stop) / 2;
+        intervals.push_back(std::make_pair(middle, stop));
+        intervals.push_back(std::make_pair(start, middle));
       }
     }
+    return indexList;
+  }
+
+
+  States::View States::slice(double startTime, double stopTime) const {
+    return View(*this, startTime, stopTime);
+  }
+
 
-    if(indexList.size() > n) {
-      std::sort(indexList.begin(), indexList.end());
-      indexList = hermiteIndices(tolerance, indexList, baseTime, timeScale);
+  States::View::View(const States &states, double startTime, double stopTime) :
+    m_states(states), m_start(0), m_size(0), m_hasVelocity(false) {
+    const std::vector<double> &ephemTimes = states.m_ephemTimes;
+    if (ephemTimes.empty()) {
+      throw std::invalid_argument("Cannot view an empty set of states.");
     }
-    return indexList;
+    if (stopTime < startTime) {
+      throw std::invalid_argument("The stop time of a view must not be before its start time.");
+    }
+
+    // Pad the intervals the times fall in to the widest lagrange window
+    int start = std::max(0, interpolationIndex(ephemTimes, startTime) - 3);
+    int stop = std::min(interpolationIndex(ephemTimes, stopTime) + 4, (int) ephemTimes.size() - 1);
+    m_start = start;
+    m_size = stop - start + 1;
+    m_hasVelocity = states.rangeHasVelocity(m_start, m_size);
+  }
+
+
+  State States::View::getState(double time, PositionInterpolation interp) const {
+    const double *times = m_states.m_ephemTimes.data() + m_start;
+    if (m_size == 1) {
+      State state = m_states.stateAt(m_start);
+      return m_hasVelocity ? extrapolateState(times[0], state, time) : state;
+    }
+
+    int lowerBound = interpolationIndex(times, m_size, time);
+
+    // If time is in times, don't need to interpolate!
+    if (times[lowerBound] == time) {
+      return m_states.stateAt(m_start + lowerBound);
+    }
+    if (times[lowerBound + 1] == time) {
+      return m_states.stateAt(m_start + lowerBound + 1);
+    }
+    return m_states.interpolateWindow(m_start, m_size, time, lowerBound, interp, m_hasVelocity);
+  }
+
+
+  std::vector<State> States::View::getStates(const std::vector<double> &times,
+                                             PositionInterpolation interp) const {
+    std::vector<State> states;
+    states.reserve(times.size());
+    for (double time : times) {
+      states.push_back(getState(time, interp));
+    }
+    return states;
+  }
+
+
+  std::vector<Vec3d> States::View::getPositions(const std::vector<double> &times,
+                                                PositionInterpolation interp) const {
+    std::vector<Vec3d> positions;
+    positions.reserve(times.size());
+    for (double time : times) {
+      positions.push_back(getState(time, interp).position);
+    }
+    return positions;
+  }
+
+
+  Vec3d States::View::getPosition(double time, PositionInterpolation interp) const {
+    return getState(time, interp).position;
+  }
+
+
+  Vec3d States::View::getVelocity(double time, PositionInterpolation interp) const {
+    return getState(time, interp).velocity;
+  }
+
+
+  States States::View::toStates() const {
+    return States(getTimes(), getStates(), m_states.m_refFrame);
+  }
+
+
+  std::vector<State> States::View::getStates() const {
+    std::vector<State> states;
+    states.reserve(m_size);
+    for (size_t i = m_start; i < m_start + m_size; i++) {
+      states.push_back(m_states.stateAt(i));
+    }
+    return states;
+  }
+
+
+  std::vector<double> States::View::getTimes() const {
+    return std::vector<double>(m_states.m_ephemTimes.begin() + m_start,
+                               m_states.m_ephemTimes.begin() + m_start + m_size);
+  }
+
+
+  int States::View::getReferenceFrame() const {
+    return m_states.m_refFrame;
+  }
+
+
+  bool States::View::hasVelocity() const {
+    return m_hasVelocity;
+  }
+
+
+  size_t States::View::getStartIndex() const {
+    return m_start;
+  }
+
+
+  size_t States::View::size() const {
+    return m_size;
   }
 }
@@ -0,0 +1,91 @@
+#include "ale/Stats.h"
+
+#include <stdexcept>
+
+namespace ale {
+
+  Stats::Timer::Timer(Stats *stats, const std::string &name) : m_stats(stats), m_size(0) {
+    if (m_stats) {
+      m_name = name;
+      m_start = std::chrono::steady_clock::now();
+    }
+  }
+
+
+  Stats::Timer::~Timer() {
+    stop();
+  }
+
+
+  void Stats::Timer::setSize(size_t size) {
+    m_size = size;
+  }
+
+
+  void Stats::Timer::stop() {
+    if (m_stats) {
+      std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - m_start;
+      m_stats->addStage(m_name, elapsed.count(), m_size);
+      m_stats = nullptr;
+    }
+  }
+
+
+  void Stats::addStage(const std::string &name, double seconds, size_t size) {
+    Stage stage;
+    stage.name = name;
+    stage.seconds = seconds;
+    stage.size = size;
+    stages.push_back(stage);
+  }
+
+
+  const Stats::Stage &Stats::getStage(const std::string &name) const {
+    for (const Stage &stage : stages) {
+      if (stage.name == name) {
+        return stage;
+      }
+    }
+    throw std::invalid_argument("No stage named " + name + " has been recorded.");
+  }
+
+
+  bool Stats::hasStage(const std::string &name) const {
+    for (const Stage &stage : stages) {
+      if (stage.name == name) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+
+  double Stats::totalSeconds(const std::string &name) const {
+    double total = 0;
+    for (const Stage &stage : stages) {
+      if (stage.name == name) {
+        total += stage.seconds;
+      }
+    }
+    return total;
+  }
+
+
+  void Stats::clear() {
+    stages.clear();
+    python = nlohmann::json();
+  }
+
+
+  nlohmann::json Stats::toJson() const {
+    nlohmann::json stageArray = nlohmann::json::array();
+    for (const Stage &stage : stages) {
+      stageArray.push_back({{"name", stage.name}, {"seconds", stage.seconds}, {"size", stage.size}});
+    }
+    nlohmann::json result = {{"stages", stageArray}};
+    if (!python.is_null()) {
+      result["python"] = python;
+    }
+    return result;
+  }
+}
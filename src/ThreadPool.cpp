@@ -0,0 +1,150 @@
+#include "ale/ThreadPool.h"
+
+#include <algorithm>
+#include <exception>
+#include <memory>
+
+namespace ale {
+
+  namespace {
+    // The state shared by the chunks of one parallelFor call
+    struct Batch {
+      Batch(size_t numChunks) : remaining(numChunks) {}
+
+      // Run a chunk, keeping the first exception
+      void run(const ThreadPool::Task &task, size_t begin, size_t end) {
+        try {
+          task(begin, end);
+        }
+        catch (...) {
+          std::lock_guard<std::mutex> lock(mutex);
+          if (!error) {
+            error = std::current_exception();
+          }
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        remaining--;
+        if (remaining == 0) {
+          done.notify_all();
+        }
+      }
+
+      std::mutex mutex; //!< Guards remaining and error
+      std::condition_variable done; //!< Signalled when the last chunk finishes
+      size_t remaining; //!< The number of chunks that have not finished
+      std::exception_ptr error; //!< The first exception a chunk threw
+    };
+  }
+
+
+  ThreadPool::ThreadPool(size_t numThreads) : m_numThreads(numThreads), m_stopping(false) {
+#ifdef ALE_USE_THREADS
+    if (m_numThreads == 0) {
+      m_numThreads = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+    for (size_t i = 1; i < m_numThreads; i++) {
+      m_workers.push_back(std::thread(&ThreadPool::work, this));
+    }
+#else
+    m_numThreads = 1;
+#endif
+  }
+
+
+  ThreadPool::~ThreadPool() {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_stopping = true;
+    }
+    m_jobAdded.notify_all();
+    for (std::thread &worker : m_workers) {
+      worker.join();
+    }
+  }
+
+
+  size_t ThreadPool::getNumThreads() const {
+    return m_numThreads;
+  }
+
+
+  void ThreadPool::parallelFor(size_t count, const Task &task, size_t minChunkSize) {
+    size_t numChunks = std::min(m_numThreads, count / std::max(minChunkSize, size_t(1)));
+    if (numChunks <= 1) {
+      if (count > 0) {
+        task(0, count);
+      }
+      return;
+    }
+
+    // Split as evenly as possible, the first count % numChunks chunks get one extra
+    std::vector<size_t> bounds(1, 0);
+    for (size_t i = 0; i < numChunks; i++) {
+      bounds.push_back(bounds.back() + count / numChunks + (i < count % numChunks ? 1 : 0));
+    }
+
+    std::shared_ptr<Batch> batch = std::make_shared<Batch>(numChunks);
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      for (size_t i = 1; i < numChunks; i++) {
+        size_t begin = bounds[i];
+        size_t end = bounds[i + 1];
+        m_jobs.push_back([batch, &task, begin, end]() { batch->run(task, begin, end); });
+      }
+    }
+    m_jobAdded.notify_all();
+
+    batch->run(task, bounds[0], bounds[1]);
+
+    // Help with queued chunks instead of waiting for the workers to get to them
+    while (true) {
+      {
+        std::lock_guard<std::mutex> lock(batch->mutex);
+        if (batch->remaining == 0) {
+          break;
+        }
+      }
+      if (!runQueuedJob()) {
+        std::unique_lock<std::mutex> lock(batch->mutex);
+        batch->done.wait(lock, [&batch]() { return batch->remaining == 0; });
+        break;
+      }
+    }
+
+    if (batch->error) {
+      std::rethrow_exception(batch->error);
+    }
+  }
+
+
+  void ThreadPool::work() {
+    while (true) {
+      std::function<void()> job;
+      {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_jobAdded.wait(lock, [this]() { return m_stopping || !m_jobs.empty(); });
+        if (m_jobs.empty()) {
+          return;
+        }
+        job = std::move(m_jobs.front());
+        m_jobs.pop_front();
+      }
+      job();
+    }
+  }
+
+
+  bool ThreadPool::runQueuedJob() {
+    std::function<void()> job;
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      if (m_jobs.empty()) {
+        return false;
+      }
+      job = std::move(m_jobs.front());
+      m_jobs.pop_front();
+    }
+    job();
+    return true;
+  }
+}
@@ -17,7 +17,7 @@ bool iequals(const std::string& a, const std::string& b) {
 }
 
 
-std::string getSensorModelName(json isd) {
+std::string getSensorModelName(const json &isd) {
   std::string name = "";
   try {
     name = isd.at("name_model");
@@ -27,7 +27,7 @@ std::string getSensorModelName(json isd) {
   return name;
 }
 
-std::string getImageId(json isd) {
+std::string getImageId(const json &isd) {
   std::string id = "";
   try {
     id = isd.at("image_identifier");
@@ -38,7 +38,7 @@ std::string getImageId(json isd) {
 }
 
 
-std::vector<double> getGeoTransform(json isd) {
+std::vector<double> getGeoTransform(const json &isd) {
   std::vector<double> transform = {};
   try {
     transform = isd.at("geotransform").get<std::vector<double>>();
@@ -51,7 +51,7 @@ std::vector<double> getGeoTransform(json isd) {
 }
 
 
-std::string getProjection(json isd) {
+std::string getProjection(const json &isd) {
   std::string projection_string = "";
   try {
     projection_string = isd.at("projection");
@@ -62,7 +62,7 @@ std::string getProjection(json isd) {
 }
 
 
-std::string getSensorName(json isd) {
+std::string getSensorName(const json &isd) {
   std::string name = "";
   try {
     name = isd.at("name_sensor");
@@ -72,7 +72,7 @@ std::string getSensorName(json isd) {
   return name;
 }
 
-std::string getIsisCameraVersion(json isd) {
+std::string getIsisCameraVersion(const json &isd) {
   std::string name = "";
   try {
     name = isd.at("IsisCameraVersion");
@@ -83,7 +83,7 @@ std::string getIsisCameraVersion(json isd) {
 }
 
 
-std::string getPlatformName(json isd) {
+std::string getPlatformName(const json &isd) {
   std::string name = "";
   try {
     name = isd.at("name_platform");
@@ -93,7 +93,7 @@ std::string getPlatformName(json isd) {
   return name;
 }
 
-std::string getLogFile(json isd) {
+std::string getLogFile(const json &isd) {
   std::string file = "";
   try {
     file = isd.at("log_file");
@@ -103,7 +103,7 @@ std::string getLogFile(json isd) {
   return file;
 }
 
-int getTotalLines(json isd) {
+int getTotalLines(const json &isd) {
   int lines = 0;
   try {
     lines = isd.at("image_lines");
@@ -114,7 +114,7 @@ int getTotalLines(json isd) {
   return lines;
 }
 
-int getTotalSamples(json isd) {
+int getTotalSamples(const json &isd) {
   int samples = 0;
   try {
     samples = isd.at("image_samples");
@@ -125,7 +125,7 @@ int getTotalSamples(json isd) {
   return samples;
 }
 
-double getStartingTime(json isd) {
+double getStartingTime(const json &isd) {
   double time = 0.0;
   try {
     time = isd.at("starting_ephemeris_time");
@@ -135,7 +135,7 @@ double getStartingTime(json isd) {
   return time;
 }
 
-double getCenterTime(json isd) {
+double getCenterTime(const json &isd) {
   double time = 0.0;
   try {
     time = isd.at("center_ephemeris_time");
@@ -145,7 +145,7 @@ double getCenterTime(json isd) {
   return time;
 }
 
-PositionInterpolation getInterpolationMethod(json isd) {
+PositionInterpolation getInterpolationMethod(const json &isd) {
   std::string interpMethod = "linear";
   try {
     interpMethod = isd.at("interpolation_method");
@@ -166,7 +166,7 @@ PositionInterpolation getInterpolationMethod(json isd) {
   return PositionInterpolation::LINEAR;
 }
 
-std::vector<std::vector<double>> getLineScanRate(json isd) {
+std::vector<std::vector<double>> getLineScanRate(const json &isd) {
   std::vector<std::vector<double>> lines;
   try {
     for (auto &scanRate : isd.at("line_scan_rate")) {
@@ -179,7 +179,7 @@ std::vector<std::vector<double>> getLineScanRate(json isd) {
 }
 
 
-int getSampleSumming(json isd) {
+int getSampleSumming(const json &isd) {
   int summing = 0;
   try {
     summing = isd.at("detector_sample_summing");
@@ -190,7 +190,7 @@ int getSampleSumming(json isd) {
   return summing;
 }
 
-int getLineSumming(json isd) {
+int getLineSumming(const json &isd) {
   int summing = 0;
   try {
     summing = isd.at("detector_line_summing");
@@ -201,7 +201,7 @@ int getLineSumming(json isd) {
   return summing;
 }
 
-double getFocalLength(json isd) {
+double getFocalLength(const json &isd) {
   double length = 0.0;
   try {
     length = isd.at("focal_length_model").at("focal_length");
@@ -211,7 +211,7 @@ double getFocalLength(json isd) {
   return length;
 }
 
-double getFocalLengthUncertainty(json isd) {
+double getFocalLengthUncertainty(const json &isd) {
   double uncertainty = 1.0;
   try {
     uncertainty = isd.at("focal_length_model").value("focal_uncertainty", uncertainty);
@@ -221,7 +221,7 @@ double getFocalLengthUncertainty(json isd) {
   return uncertainty;
 }
 
-std::vector<double> getFocal2PixelLines(json isd) {
+std::vector<double> getFocal2PixelLines(const json &isd) {
   std::vector<double> transformation;
   try {
     transformation = isd.at("focal2pixel_lines").get<std::vector<double>>();
@@ -232,7 +232,7 @@ std::vector<double> getFocal2PixelLines(json isd) {
   return transformation;
 }
 
-std::vector<double> getFocal2PixelSamples(json isd) {
+std::vector<double> getFocal2PixelSamples(const json &isd) {
   std::vector<double> transformation;
   try {
     transformation = isd.at("focal2pixel_samples").get<std::vector<double>>();
@@ -243,7 +243,7 @@ std::vector<double> getFocal2PixelSamples(json isd) {
   return transformation;
 }
 
-double getDetectorCenterLine(json isd) {
+double getDetectorCenterLine(const json &isd) {
   double line;
   try {
     line = isd.at("detector_center").at("line");
@@ -253,7 +253,7 @@ double getDetectorCenterLine(json isd) {
   return line;
 }
 
-double getDetectorCenterSample(json isd) {
+double getDetectorCenterSample(const json &isd) {
   double sample;
   try {
     sample = isd.at("detector_center").at("sample");
@@ -263,7 +263,7 @@ double getDetectorCenterSample(json isd) {
   return sample;
 }
 
-double getDetectorStartingLine(json isd) {
+double getDetectorStartingLine(const json &isd) {
   double line;
   try {
     line = isd.at("starting_detector_line");
@@ -273,7 +273,7 @@ double getDetectorStartingLine(json isd) {
   return line;
 }
 
-double getDetectorStartingSample(json isd) {
+double getDetectorStartingSample(const json &isd) {
   double sample;
   try {
     sample = isd.at("starting_detector_sample");
@@ -283,11 +283,11 @@ double getDetectorStartingSample(json isd) {
   return sample;
 }
 
-double getMinHeight(json isd) {
+double getMinHeight(const json &isd) {
   double height = 0.0;
   try {
-    json referenceHeight = isd.at("reference_height");
-    json minHeight = referenceHeight.at("minheight");
+    const json &referenceHeight = isd.at("reference_height");
+    const json &minHeight = referenceHeight.at("minheight");
     height = minHeight.get<double>();
   } catch (...) {
     throw std::runtime_error(
@@ -296,11 +296,11 @@ double getMinHeight(json isd) {
   return height;
 }
 
-double getMaxHeight(json isd) {
+double getMaxHeight(const json &isd) {
   double height = 0.0;
   try {
-    json referenceHeight = isd.at("reference_height");
-    json maxHeight = referenceHeight.at("maxheight");
+    const json &referenceHeight = isd.at("reference_height");
+    const json &maxHeight = referenceHeight.at("maxheight");
 
     height = maxHeight.get<double>();
   } catch (...) {
@@ -310,11 +310,11 @@ double getMaxHeight(json isd) {
   return height;
 }
 
-double getSemiMajorRadius(json isd) {
+double getSemiMajorRadius(const json &isd) {
   double radius = 0.0;
   try {
-    json radii = isd.at("radii");
-    json semiMajor = radii.at("semimajor");
+    const json &radii = isd.at("radii");
+    const json &semiMajor = radii.at("semimajor");
     radius = semiMajor.get<double>();
 
   } catch (...) {
@@ -324,11 +324,11 @@ double getSemiMajorRadius(json isd) {
   return radius;
 }
 
-double getSemiMinorRadius(json isd) {
+double getSemiMinorRadius(const json &isd) {
   double radius = 0.0;
   try {
-    json radii = isd.at("radii");
-    json semiMinor = radii.at("semiminor");
+    const json &radii = isd.at("radii");
+    const json &semiMinor = radii.at("semiminor");
     radius = semiMinor.get<double>();
 
   } catch (...) {
@@ -340,11 +340,11 @@ double getSemiMinorRadius(json isd) {
 
 // Converts the distortion model name from the ISD (string) to the enumeration
 // type. Defaults to transverse
-DistortionType getDistortionModel(json isd) {
+DistortionType getDistortionModel(const json &isd) {
   try {
-    json distortion_subset = isd.at("optical_distortion");
+    const json &distortion_subset = isd.at("optical_distortion");
 
-    json::iterator it = distortion_subset.begin();
+    json::const_iterator it = distortion_subset.begin();
 
     std::string distortion = (std::string)it.key();
 
@@ -371,7 +371,7 @@ DistortionType getDistortionModel(json isd) {
   return DistortionType::TRANSVERSE;
 }
 
-std::vector<double> getDistortionCoeffs(json isd) {
+std::vector<double> getDistortionCoeffs(const json &isd) {
   std::vector<double> coefficients;
 
   DistortionType distortion = getDistortionModel(isd);
@@ -551,7 +551,7 @@ std::vector<double> getDistortionCoeffs(json isd) {
   return coefficients;
 }
 
-std::vector<Vec3d> getJsonVec3dArray(json obj) {
+std::vector<Vec3d> getJsonVec3dArray(const json &obj) {
   std::vector<Vec3d> positions;
   try {
     for (auto &location : obj) {
@@ -565,7 +565,7 @@ std::vector<Vec3d> getJsonVec3dArray(json obj) {
 }
 
 
-std::vector<Rotation> getJsonQuatArray(json obj) {
+std::vector<Rotation> getJsonQuatArray(const json &obj) {
   std::vector<Rotation> quats;
   try {
     for (auto &location : obj) {
@@ -579,9 +579,9 @@ std::vector<Rotation> getJsonQuatArray(json obj) {
 }
 
 
-States getInstrumentPosition(json isd) {
+States getInstrumentPosition(const json &isd) {
   try {
-    json ipos = isd.at("instrument_position");
+    const json &ipos = isd.at("instrument_position");
     std::vector<Vec3d> positions = getJsonVec3dArray(ipos.at("positions"));
     std::vector<double> times = getJsonArray<double>(ipos.at("ephemeris_times"));
     int refFrame = ipos.at("reference_frame").get<int>();
@@ -600,9 +600,9 @@ States getInstrumentPosition(json isd) {
 }
 
 
-States getSunPosition(json isd) {
+States getSunPosition(const json &isd) {
   try {
-    json spos = isd.at("sun_position");
+    const json &spos = isd.at("sun_position");
     std::vector<Vec3d> positions = getJsonVec3dArray(spos.at("positions"));
     std::vector<double> times = getJsonArray<double>(spos.at("ephemeris_times"));
     int refFrame = spos.at("reference_frame").get<int>();
@@ -620,9 +620,9 @@ States getSunPosition(json isd) {
   }
 }
 
-Orientations getInstrumentPointing(json isd) {
+Orientations getInstrumentPointing(const json &isd) {
   try {
-    json pointing = isd.at("instrument_pointing");
+    const json &pointing = isd.at("instrument_pointing");
 
     std::vector<Rotation> rotations = getJsonQuatArray(pointing.at("quaternions"));
     std::vector<double> times = getJsonArray<double>(pointing.at("ephemeris_times"));
@@ -639,7 +639,7 @@ Orientations getInstrumentPointing(json isd) {
     }
 
     std::vector<double> rotArray = {1,0,0,0,1,0,0,0,1};
-    if (pointing.find("time_dependent_frames") != pointing.end()){
+    if (pointing.find("constant_rotation") != pointing.end()){
       rotArray = getJsonArray<double>(pointing.at("constant_rotation"));
     }
 
@@ -654,9 +654,9 @@ Orientations getInstrumentPointing(json isd) {
   }
 }
 
-Orientations getBodyRotation(json isd) {
+Orientations getBodyRotation(const json &isd) {
   try {
-    json bodrot = isd.at("body_rotation");
+    const json &bodrot = isd.at("body_rotation");
     std::vector<Rotation> rotations = getJsonQuatArray(bodrot.at("quaternions"));
     std::vector<double> times = getJsonArray<double>(bodrot.at("ephemeris_times"));
     std::vector<Vec3d> velocities = getJsonVec3dArray(bodrot.at("angular_velocities"));
@@ -0,0 +1,60 @@
+#include <benchmark/benchmark.h>
+
+#include "ale/Distortion.h"
+
+#include <vector>
+
+using namespace ale;
+
+namespace {
+  // A line scanner's worth of focal plane points
+  void detectorPoints(size_t numPoints, std::vector<double> &x, std::vector<double> &y) {
+    x.resize(numPoints);
+    y.resize(numPoints);
+    for (size_t i = 0; i < numPoints; i++) {
+      x[i] = -10.0 + 20.0 * i / numPoints;
+      y[i] = 0.25 * (i % 16) - 2.0;
+    }
+  }
+}
+
+
+static void BM_DistortionTransverseUndistort(benchmark::State &state) {
+  std::vector<double> coeffs(20, 0.0);
+  coeffs[1] = 1.0;
+  coeffs[6] = 1e-5;
+  coeffs[8] = 2e-6;
+  coeffs[12] = 1.0;
+  coeffs[17] = -3e-6;
+  coeffs[19] = 1e-5;
+  Distortion distortion(TRANSVERSE, coeffs);
+  if (state.range(0)) {
+    distortion.prepareGrid(-10, 10, -10, 10);
+  }
+  std::vector<double> x, y;
+  detectorPoints(4096, x, y);
+  std::vector<double> outX(x.size()), outY(y.size());
+  for (auto _ : state) {
+    distortion.undistort(x.data(), y.data(), x.size(), outX.data(), outY.data());
+    benchmark::DoNotOptimize(outX.data());
+  }
+  state.SetItemsProcessed(state.iterations() * x.size());
+}
+BENCHMARK(BM_DistortionTransverseUndistort)->ArgNames({"grid"})->Arg(0)->Arg(1);
+
+
+static void BM_DistortionRadialDistort(benchmark::State &state) {
+  Distortion distortion(RADIAL, {0.0, 1e-4, -2e-8});
+  if (state.range(0)) {
+    distortion.prepareGrid(-10, 10, -10, 10);
+  }
+  std::vector<double> x, y;
+  detectorPoints(4096, x, y);
+  std::vector<double> outX(x.size()), outY(y.size());
+  for (auto _ : state) {
+    distortion.distort(x.data(), y.data(), x.size(), outX.data(), outY.data());
+    benchmark::DoNotOptimize(outX.data());
+  }
+  state.SetItemsProcessed(state.iterations() * x.size());
+}
+BENCHMARK(BM_DistortionRadialDistort)->ArgNames({"grid"})->Arg(0)->Arg(1);
@@ -0,0 +1,125 @@
+#include <benchmark/benchmark.h>
+
+#include "ale/Isd.h"
+
+#include <nlohmann/json.hpp>
+
+#include <exception>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace ale;
+
+namespace {
+  std::string readIsd(const std::string &name) {
+    std::ifstream file(std::string(ALE_BENCHMARK_DATA_DIR) + "/isds/" + name);
+    std::stringstream contents;
+    contents << file.rdbuf();
+    if (contents.str().empty()) {
+      return "";
+    }
+    // The python test ISDs do not have the identifier that ale::Isd requires
+    nlohmann::json isd = nlohmann::json::parse(contents.str());
+    if (!isd.contains("image_identifier")) {
+      isd["image_identifier"] = name;
+    }
+    return isd.dump();
+  }
+}
+
+
+static void BM_IsdConstruct(benchmark::State &state, const std::string &name) {
+  std::string contents = readIsd(name);
+  if (contents.empty()) {
+    state.SkipWithError(("Could not read " + name).c_str());
+    return;
+  }
+  try {
+    Isd isd(contents);
+  }
+  catch (const std::exception &e) {
+    state.SkipWithError(e.what());
+    return;
+  }
+  for (auto _ : state) {
+    Isd isd(contents);
+    benchmark::DoNotOptimize(isd);
+  }
+  state.SetBytesProcessed(state.iterations() * contents.size());
+}
+BENCHMARK_CAPTURE(BM_IsdConstruct, hirise, std::string("hirise_isd.json"));
+BENCHMARK_CAPTURE(BM_IsdConstruct, mgsmocna, std::string("mgsmocna_isd.json"));
+BENCHMARK_CAPTURE(BM_IsdConstruct, ctx, std::string("ctx_isd.json"));
+
+
+// Reading only the metadata, as a catalog indexer would
+static void BM_LazyIsdMetadata(benchmark::State &state, const std::string &name) {
+  std::string contents = readIsd(name);
+  if (contents.empty()) {
+    state.SkipWithError(("Could not read " + name).c_str());
+    return;
+  }
+  for (auto _ : state) {
+    LazyIsd isd(contents);
+    benchmark::DoNotOptimize(isd.getMetadata().at("image_lines"));
+  }
+  state.SetBytesProcessed(state.iterations() * contents.size());
+}
+BENCHMARK_CAPTURE(BM_LazyIsdMetadata, hirise, std::string("hirise_isd.json"));
+BENCHMARK_CAPTURE(BM_LazyIsdMetadata, mgsmocna, std::string("mgsmocna_isd.json"));
+BENCHMARK_CAPTURE(BM_LazyIsdMetadata, ctx, std::string("ctx_isd.json"));
+
+
+// Per line geometry of a line scan model, one call per table against one
+// fused call, and against a batch of every line
+enum GeometryCalls { SEPARATE, FUSED, BATCH };
+
+static void BM_IsdLineGeometry(benchmark::State &state, const std::string &name, GeometryCalls calls) {
+  std::string contents = readIsd(name);
+  if (contents.empty()) {
+    state.SkipWithError(("Could not read " + name).c_str());
+    return;
+  }
+  std::unique_ptr<Isd> isdPtr;
+  try {
+    isdPtr.reset(new Isd(contents));
+  }
+  catch (const std::exception &e) {
+    state.SkipWithError(e.what());
+    return;
+  }
+  const Isd &isd = *isdPtr;
+  const std::vector<double> &times = isd.inst_pos.getTimes();
+  double start = times.front();
+  double step = (times.back() - start) / 1000.0;
+  std::vector<double> lineTimes;
+  for (int line = 0; line < 1000; line++) {
+    lineTimes.push_back(start + line * step);
+  }
+  for (auto _ : state) {
+    if (calls == BATCH) {
+      benchmark::DoNotOptimize(isd.geometryAt(lineTimes));
+      continue;
+    }
+    for (double time : lineTimes) {
+      if (calls == FUSED) {
+        benchmark::DoNotOptimize(isd.geometryAt(time));
+      }
+      else {
+        benchmark::DoNotOptimize(isd.inst_pos.getState(time, isd.interpMethod));
+        benchmark::DoNotOptimize(isd.sun_pos.getPosition(time, isd.interpMethod));
+        benchmark::DoNotOptimize(isd.inst_pointing.interpolate(time));
+        benchmark::DoNotOptimize(isd.inst_pointing.interpolateAV(time));
+        benchmark::DoNotOptimize(isd.body_rotation.interpolate(time));
+        benchmark::DoNotOptimize(isd.body_rotation.interpolateAV(time));
+      }
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * 1000);
+}
+BENCHMARK_CAPTURE(BM_IsdLineGeometry, ctx_separate, std::string("ctx_isd.json"), SEPARATE);
+BENCHMARK_CAPTURE(BM_IsdLineGeometry, ctx_fused, std::string("ctx_isd.json"), FUSED);
+BENCHMARK_CAPTURE(BM_IsdLineGeometry, ctx_batch, std::string("ctx_isd.json"), BATCH);
@@ -0,0 +1,32 @@
+#include <benchmark/benchmark.h>
+
+#include "ale/Load.h"
+
+#include <exception>
+#include <string>
+
+using namespace ale;
+
+// A load of a path that does not exist, so every driver tries to parse it
+// and fails. The time is the interpreter call, every driver's failed
+// attempt, and formatting the error, not the call overhead alone. This is
+// the cost of a label that no driver accepts.
+static void BM_LoadsRejectedLabel(benchmark::State &state) {
+  std::string label = std::string(ALE_BENCHMARK_DATA_DIR) + "/not_a_label.lbl";
+  try {
+    LoadSession::instance();
+  }
+  catch (const std::exception &e) {
+    state.SkipWithError(e.what());
+    return;
+  }
+  for (auto _ : state) {
+    try {
+      benchmark::DoNotOptimize(loads(label, "", "ale", 2, false));
+    }
+    catch (const std::exception &e) {
+      benchmark::DoNotOptimize(e.what());
+    }
+  }
+}
+BENCHMARK(BM_LoadsRejectedLabel);
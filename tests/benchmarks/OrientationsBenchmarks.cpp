@@ -0,0 +1,98 @@
+#include <benchmark/benchmark.h>
+
+#include "ale/Orientations.h"
+
+#include <cmath>
+#include <vector>
+
+using namespace ale;
+
+namespace {
+  // A spin about z with a wobble about x, sampled every step seconds
+  Orientations spin(size_t numRotations, double step=1.0, double offset=0.0) {
+    std::vector<Rotation> rotations;
+    std::vector<double> times;
+    std::vector<Vec3d> avs;
+    for (size_t i = 0; i < numRotations; i++) {
+      double time = offset + step * i;
+      times.push_back(time);
+      rotations.push_back(Rotation({0, 0, 1}, 0.001 * time) * Rotation({1, 0, 0}, 0.01 * sin(0.01 * time)));
+      avs.push_back(Vec3d(0, 0, 0.001));
+    }
+    return Orientations(rotations, times, avs, Rotation({0, 1, 0}, 0.1));
+  }
+
+  std::vector<double> sampleTimes(size_t numRotations, size_t numTimes) {
+    std::vector<double> times;
+    for (size_t i = 0; i < numTimes; i++) {
+      times.push_back((numRotations - 1) * (i + 0.5) / numTimes);
+    }
+    return times;
+  }
+}
+
+
+static void BM_OrientationsInterpolate(benchmark::State &state) {
+  size_t numRotations = state.range(0);
+  Orientations orientations = spin(numRotations);
+  std::vector<double> times = sampleTimes(numRotations, 1024);
+  for (auto _ : state) {
+    for (double time : times) {
+      benchmark::DoNotOptimize(orientations.interpolate(time));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * times.size());
+}
+BENCHMARK(BM_OrientationsInterpolate)->ArgName("rotations")->Arg(64)->Arg(4096);
+
+
+static void BM_OrientationsRotateStateAt(benchmark::State &state) {
+  size_t numRotations = state.range(0);
+  Orientations orientations = spin(numRotations);
+  std::vector<double> times = sampleTimes(numRotations, 1024);
+  State input(Vec3d(1000, 2000, 3000), Vec3d(1, 2, 3));
+  for (auto _ : state) {
+    for (double time : times) {
+      benchmark::DoNotOptimize(orientations.rotateStateAt(time, input));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * times.size());
+}
+BENCHMARK(BM_OrientationsRotateStateAt)->ArgName("rotations")->Arg(64)->Arg(4096);
+
+
+static void BM_OrientationsCompose(benchmark::State &state) {
+  size_t numRotations = state.range(0);
+  // Interleaved times so that the merged grid has every sample of both
+  Orientations lhs = spin(numRotations);
+  Orientations rhs = spin(numRotations, 1.0, 0.5);
+  for (auto _ : state) {
+    Orientations composed = lhs;
+    composed *= rhs;
+    benchmark::DoNotOptimize(composed);
+  }
+  state.SetItemsProcessed(state.iterations() * 2 * numRotations);
+}
+BENCHMARK(BM_OrientationsCompose)->ArgName("rotations")->Arg(1024)->Arg(16384);
+
+
+static void BM_RotationRotateStates(benchmark::State &state) {
+  Rotation rotation({1, 2, 3}, 0.7);
+  Vec3d av(0, 0, 0.001);
+  std::vector<State> states(state.range(0), State(Vec3d(1000, 2000, 3000), Vec3d(1, 2, 3)));
+  std::vector<State> rotated(states.size());
+  bool batch = state.range(1);
+  for (auto _ : state) {
+    if (batch) {
+      rotation.rotateStates(states.data(), states.size(), rotated.data(), av);
+    }
+    else {
+      for (size_t i = 0; i < states.size(); i++) {
+        rotated[i] = rotation(states[i], av);
+      }
+    }
+    benchmark::DoNotOptimize(rotated.data());
+  }
+  state.SetItemsProcessed(state.iterations() * states.size());
+}
+BENCHMARK(BM_RotationRotateStates)->ArgNames({"states", "batch"})->ArgsProduct({{4096}, {0, 1}});
@@ -0,0 +1,89 @@
+#include <benchmark/benchmark.h>
+
+#include "ale/States.h"
+#include "ale/ThreadPool.h"
+
+#include <cmath>
+#include <vector>
+
+using namespace ale;
+
+namespace {
+  // A circular orbit sampled once a second
+  States orbit(size_t numStates) {
+    std::vector<double> times;
+    std::vector<State> states;
+    double rate = 2 * M_PI / 6000;
+    for (size_t i = 0; i < numStates; i++) {
+      double time = i;
+      times.push_back(time);
+      states.push_back(State(Vec3d(3000 * cos(rate * time), 3000 * sin(rate * time), 0.001 * time),
+                             Vec3d(-3000 * rate * sin(rate * time), 3000 * rate * cos(rate * time), 0.001)));
+    }
+    return States(times, states, 1);
+  }
+
+  // Times spread over the states, in the order a line scanner would request them
+  std::vector<double> sampleTimes(size_t numStates, size_t numTimes) {
+    std::vector<double> times;
+    for (size_t i = 0; i < numTimes; i++) {
+      times.push_back((numStates - 1) * (i + 0.5) / numTimes);
+    }
+    return times;
+  }
+}
+
+
+static void BM_StatesGetState(benchmark::State &state) {
+  PositionInterpolation interp = static_cast<PositionInterpolation>(state.range(0));
+  size_t numStates = state.range(1);
+  States states = orbit(numStates);
+  std::vector<double> times = sampleTimes(numStates, 1024);
+  for (auto _ : state) {
+    for (double time : times) {
+      benchmark::DoNotOptimize(states.getState(time, interp));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * times.size());
+}
+BENCHMARK(BM_StatesGetState)
+  ->ArgNames({"interp", "states"})
+  ->ArgsProduct({{LINEAR, SPLINE, LAGRANGE}, {64, 4096}});
+
+
+static void BM_StatesGetStatesBatch(benchmark::State &state) {
+  PositionInterpolation interp = static_cast<PositionInterpolation>(state.range(0));
+  size_t numStates = state.range(1);
+  States states = orbit(numStates);
+  std::vector<double> times = sampleTimes(numStates, 1024);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(states.getStates(times, interp));
+  }
+  state.SetItemsProcessed(state.iterations() * times.size());
+}
+BENCHMARK(BM_StatesGetStatesBatch)
+  ->ArgNames({"interp", "states"})
+  ->ArgsProduct({{LINEAR, SPLINE, LAGRANGE}, {64, 4096}});
+
+
+static void BM_StatesGetStatesThreadPool(benchmark::State &state) {
+  size_t numStates = 4096;
+  States states = orbit(numStates);
+  std::vector<double> times = sampleTimes(numStates, 1 << 18);
+  ThreadPool pool(state.range(0));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(states.getStates(times, LAGRANGE, pool));
+  }
+  state.SetItemsProcessed(state.iterations() * times.size());
+}
+BENCHMARK(BM_StatesGetStatesThreadPool)->ArgName("threads")->Arg(1)->Arg(2)->Arg(4)->UseRealTime();
+
+
+static void BM_StatesMinimizeCache(benchmark::State &state) {
+  States states = orbit(state.range(0));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(states.minimizeCache(0.01));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_StatesMinimizeCache)->ArgName("states")->Arg(1024)->Arg(16384);
@@ -0,0 +1,145 @@
+#include "gtest/gtest.h"
+
+#include "ale/Brotli.h"
+
+#include <brotli/encode.h>
+
+#include <nlohmann/json.hpp>
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace ale;
+
+namespace {
+  // A framing camera ISD with enough positions to span several decompression chunks
+  nlohmann::json testIsd() {
+    nlohmann::json isd;
+    isd["name_model"] = "USGS_ASTRO_FRAME_SENSOR_MODEL";
+    isd["image_identifier"] = "TEST_IMAGE";
+    isd["name_platform"] = "TEST_PLATFORM";
+    isd["name_sensor"] = "TEST_SENSOR";
+    isd["image_lines"] = 100;
+    isd["image_samples"] = 200;
+    isd["starting_ephemeris_time"] = 10.0;
+    isd["center_ephemeris_time"] = 11.0;
+    isd["detector_sample_summing"] = 1;
+    isd["detector_line_summing"] = 1;
+    isd["focal_length_model"]["focal_length"] = 50.0;
+    isd["focal2pixel_lines"] = {0.0, 100.0, 0.0};
+    isd["focal2pixel_samples"] = {0.0, 0.0, 100.0};
+    isd["detector_center"]["line"] = 50.0;
+    isd["detector_center"]["sample"] = 100.0;
+    isd["starting_detector_line"] = 0;
+    isd["starting_detector_sample"] = 0;
+    isd["reference_height"]["minheight"] = -1000;
+    isd["reference_height"]["maxheight"] = 1000;
+    isd["radii"]["semimajor"] = 3396.19;
+    isd["radii"]["semiminor"] = 3376.2;
+    isd["optical_distortion"]["radial"]["coefficients"] = {0.0, 0.0, 0.0};
+    isd["interpolation_method"] = "lagrange";
+
+    nlohmann::json position;
+    for (int i = 0; i < 5000; i++) {
+      position["ephemeris_times"].push_back(10.0 + 0.001 * i);
+      position["positions"].push_back({1000.0 + i, 2000.0 - 0.5 * i, 3000.0 + 0.001 * i * i});
+    }
+    position["reference_frame"] = 1;
+    isd["instrument_position"] = position;
+    isd["sun_position"] = position;
+
+    nlohmann::json rotation;
+    rotation["time_dependent_frames"] = {-74000, 1};
+    rotation["ephemeris_times"] = {10.0, 15.0};
+    rotation["quaternions"] = {{0.5, 0.5, 0.5, 0.5}, {-0.5, 0.5, 0.5, 0.5}};
+    rotation["angular_velocities"] = {{0.1, 0.2, 0.3}, {0.4, 0.5, 0.6}};
+    isd["instrument_pointing"] = rotation;
+    isd["body_rotation"] = rotation;
+    return isd;
+  }
+
+  std::string compress(const std::string &text) {
+    std::vector<uint8_t> compressed(BrotliEncoderMaxCompressedSize(text.size()));
+    size_t compressedSize = compressed.size();
+    if (!BrotliEncoderCompress(BROTLI_DEFAULT_QUALITY, BROTLI_DEFAULT_WINDOW, BROTLI_MODE_TEXT,
+                               text.size(), reinterpret_cast<const uint8_t *>(text.data()),
+                               &compressedSize, compressed.data())) {
+      throw runtime_error("Could not compress the test data.");
+    }
+    return std::string(compressed.begin(), compressed.begin() + compressedSize);
+  }
+
+  void writeFile(const std::string &path, const std::string &contents) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file << contents;
+  }
+}
+
+
+TEST(Brotli, StreambufSmallChunks) {
+  std::string text = testIsd().dump();
+  std::istringstream compressed(compress(text));
+  BrotliStreambuf buffer(compressed, 7);
+  std::istream stream(&buffer);
+  std::stringstream decompressed;
+  decompressed << stream.rdbuf();
+  EXPECT_EQ(decompressed.str(), text);
+}
+
+
+TEST(Brotli, ParseStream) {
+  std::string text = testIsd().dump();
+  std::istringstream compressed(compress(text));
+  BrotliIstream stream(compressed);
+  Isd isd(stream);
+  Isd expected(text);
+  EXPECT_EQ(isd.image_id, "TEST_IMAGE");
+  ASSERT_EQ(isd.inst_pos.getPositions().size(), 5000);
+  EXPECT_EQ(isd.inst_pos.getPositions().back().z, expected.inst_pos.getPositions().back().z);
+  EXPECT_EQ(isd.body_rotation.getTimes(), expected.body_rotation.getTimes());
+}
+
+
+TEST(Brotli, ReadFile) {
+  std::string path = "brotli_test_isd.br";
+  std::string text = testIsd().dump();
+  writeFile(path, compress(text));
+  Stats stats;
+  Isd isd = readBrotliIsd(path, &stats);
+  EXPECT_EQ(isd.image_lines, 100);
+  EXPECT_EQ(isd.sun_pos.getTimes().size(), 5000);
+  EXPECT_TRUE(stats.hasStage("isd.parse"));
+
+  // Older isd_generate versions compressed the ISD as a JSON string
+  writeFile(path, compress(nlohmann::json(text).dump()));
+  Isd legacyIsd = readBrotliIsd(path);
+  EXPECT_EQ(legacyIsd.image_id, "TEST_IMAGE");
+  EXPECT_EQ(legacyIsd.inst_pos.getTimes(), isd.inst_pos.getTimes());
+  std::remove(path.c_str());
+}
+
+
+TEST(Brotli, BadData) {
+  EXPECT_THROW(readBrotliIsd("does_not_exist.br"), runtime_error);
+  EXPECT_THROW(BrotliIstream stream("does_not_exist.br"), runtime_error);
+
+  std::string path = "bad_brotli_isd.br";
+  std::string compressed = compress(testIsd().dump());
+  writeFile(path, compressed.substr(0, compressed.size() / 2));
+  try {
+    readBrotliIsd(path);
+    FAIL() << "Expected an exception to be thrown";
+  }
+  catch(runtime_error &e) {
+    EXPECT_EQ(string(e.what()), "Could not decompress the brotli stream, it is truncated.");
+  }
+
+  writeFile(path, "this is not brotli data");
+  EXPECT_THROW(readBrotliIsd(path), runtime_error);
+  std::remove(path.c_str());
+}
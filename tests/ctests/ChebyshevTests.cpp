@@ -0,0 +1,189 @@
+#include "gtest/gtest.h"
+
+#include "ale/Chebyshev.h"
+
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+using namespace std;
+using namespace ale;
+
+namespace {
+  // A circular orbit with a 6000 second period
+  States circularOrbit(size_t numStates, bool withVelocity) {
+    double radius = 3000;
+    double rate = 2 * M_PI / 6000;
+    vector<double> times;
+    vector<State> states;
+    for (size_t i = 0; i < numStates; i++) {
+      double time = 100.0 * i;
+      times.push_back(time);
+      Vec3d position(radius * cos(rate * time), radius * sin(rate * time), 0.001 * time);
+      if (withVelocity) {
+        states.push_back(State(position, Vec3d(-radius * rate * sin(rate * time),
+                                               radius * rate * cos(rate * time), 0.001)));
+      }
+      else {
+        states.push_back(State(position));
+      }
+    }
+    return States(times, states, 10);
+  }
+}
+
+
+TEST(ChebyshevSeries, EvaluatePolynomial) {
+  // 1 + 2 T1 + 3 T2 = 1 + 2s + 3 (2s^2 - 1) over [0, 4]
+  ChebyshevSeries series({0, 4}, {1, 2, 3}, 1, 2);
+  double value;
+  double derivative;
+  series.evaluate(3, &value, &derivative);
+  // s = 0.5
+  EXPECT_DOUBLE_EQ(value, 1 + 1 + 3 * (0.5 - 1));
+  // (2 + 12s) ds/dt
+  EXPECT_DOUBLE_EQ(derivative, (2 + 6) / 2.0);
+  EXPECT_EQ(series.getNumSegments(), 1);
+}
+
+
+TEST(ChebyshevSeries, FitPolynomialExactly) {
+  vector<double> times;
+  vector<double> values;
+  for (int i = 0; i <= 20; i++) {
+    double time = 0.5 * i;
+    times.push_back(time);
+    values.push_back(2 - time + 0.25 * time * time * time);
+  }
+  ChebyshevSeries series = ChebyshevSeries::fit(times, values, nullptr, 1, 0, 5, {1e-9});
+  EXPECT_EQ(series.getNumSegments(), 1);
+  double value;
+  double derivative;
+  series.evaluate(3.25, &value, &derivative);
+  EXPECT_NEAR(value, 2 - 3.25 + 0.25 * pow(3.25, 3), 1e-9);
+  EXPECT_NEAR(derivative, -1 + 0.75 * 3.25 * 3.25, 1e-9);
+}
+
+
+TEST(ChebyshevSeries, InvalidInputs) {
+  EXPECT_THROW(ChebyshevSeries series({0}, {}, 1, 0), invalid_argument);
+  EXPECT_THROW(ChebyshevSeries series({0, 1}, {1, 2}, 1, 2), invalid_argument);
+  EXPECT_THROW(ChebyshevSeries::fit({}, {}, nullptr, 1, 0, 3, {1}), invalid_argument);
+  EXPECT_THROW(ChebyshevSeries::fit({0, 1}, {1}, nullptr, 1, 0, 3, {1}), invalid_argument);
+  EXPECT_THROW(ChebyshevSeries::fit({0, 1}, {1, 2}, nullptr, 1, 0, 3, {}), invalid_argument);
+  EXPECT_THROW(ChebyshevSeries::fit({1, 0}, {1, 2}, nullptr, 1, 0, 3, {1}), invalid_argument);
+}
+
+
+TEST(ChebyshevSeries, FitDegreeTooLowForDerivatives) {
+  // A line cannot match both the values and the derivatives of a cubic
+  vector<double> times = {0, 1, 2};
+  vector<double> values = {0, 1, 8};
+  vector<double> derivatives = {0, 3, 12};
+  EXPECT_THROW(ChebyshevSeries::fit(times, values, &derivatives, 1, 1, 1, {1e-6}),
+               invalid_argument);
+  ChebyshevSeries series = ChebyshevSeries::fit(times, values, &derivatives, 1, 1, 3, {1e-6});
+  double value;
+  series.evaluate(1.5, &value);
+  EXPECT_NEAR(value, 1.5 * 1.5 * 1.5, 1e-9);
+}
+
+
+TEST(ChebyshevStates, FitPositions) {
+  States states = circularOrbit(121, false);
+  ChebyshevStates fit = states.fitChebyshev(1e-3, 8);
+  EXPECT_EQ(fit.getReferenceFrame(), 10);
+  EXPECT_DOUBLE_EQ(fit.getStartTime(), 0);
+  EXPECT_DOUBLE_EQ(fit.getStopTime(), 12000);
+  EXPECT_LT(fit.getSeries().getNumSegments(), 20);
+
+  vector<double> times = states.getTimes();
+  vector<State> original = states.getStates();
+  for (size_t i = 0; i < times.size(); i++) {
+    State state = fit.getState(times[i]);
+    EXPECT_NEAR(state.position.x, original[i].position.x, 1e-3);
+    EXPECT_NEAR(state.position.y, original[i].position.y, 1e-3);
+    EXPECT_NEAR(state.position.z, original[i].position.z, 1e-3);
+  }
+
+  // Velocities are the derivatives of the positions
+  double rate = 2 * M_PI / 6000;
+  State state = fit.getState(1234);
+  EXPECT_NEAR(state.velocity.x, -3000 * rate * sin(rate * 1234), 1e-5);
+  EXPECT_NEAR(state.velocity.y, 3000 * rate * cos(rate * 1234), 1e-5);
+  EXPECT_NEAR(state.velocity.z, 0.001, 1e-5);
+}
+
+
+TEST(ChebyshevStates, FitPositionsAndVelocities) {
+  States states = circularOrbit(121, true);
+  ChebyshevStates fit = states.fitChebyshev(1e-6);
+
+  vector<double> times = {50, 4321, 11999};
+  States sampled = fit.toStates(times);
+  EXPECT_EQ(sampled.getReferenceFrame(), 10);
+  ASSERT_EQ(sampled.getStates().size(), 3);
+  for (size_t i = 0; i < times.size(); i++) {
+    State expected = states.getState(times[i], PositionInterpolation::LINEAR);
+    State actual = sampled.getStates()[i];
+    double rate = 2 * M_PI / 6000;
+    EXPECT_NEAR(actual.position.x, 3000 * cos(rate * times[i]), 1e-5);
+    EXPECT_NEAR(actual.position.y, 3000 * sin(rate * times[i]), 1e-5);
+    EXPECT_NEAR(actual.velocity.x, -3000 * rate * sin(rate * times[i]), 1e-7);
+    EXPECT_NEAR(actual.velocity.y, 3000 * rate * cos(rate * times[i]), 1e-7);
+    EXPECT_NEAR(actual.velocity.z, expected.velocity.z, 1e-7);
+  }
+}
+
+
+TEST(ChebyshevOrientations, FitRotations) {
+  vector<double> times;
+  vector<Rotation> rotations;
+  vector<Vec3d> avs;
+  double rate = 0.01;
+  for (int i = 0; i <= 200; i++) {
+    double time = 10.0 * i;
+    times.push_back(time);
+    // Spin about z, wobbling about x
+    rotations.push_back(Rotation({0, 0, 1}, rate * time) * Rotation({1, 0, 0}, 0.1 * sin(0.003 * time)));
+    avs.push_back(Vec3d(0, 0, rate));
+  }
+  Rotation constRot({0, 1, 0}, 0.5);
+  Orientations orientations(rotations, times, avs, constRot, {-100, -101}, {-101, 1});
+  double tolerance = 1e-7;
+  ChebyshevOrientations fit = orientations.fitChebyshev(tolerance, 10, 1e-9);
+
+  EXPECT_TRUE(fit.hasAngularVelocity());
+  EXPECT_EQ(fit.getConstantFrames(), vector<int>({-100, -101}));
+  EXPECT_EQ(fit.getTimeDependentFrames(), vector<int>({-101, 1}));
+  EXPECT_LT(fit.getSeries().getNumSegments(), times.size() / 4);
+
+  for (size_t i = 0; i < times.size(); i++) {
+    EXPECT_LE(fit.interpolateTimeDep(times[i]).angleTo(rotations[i]), tolerance);
+    EXPECT_LE(fit.interpolate(times[i]).angleTo(constRot * rotations[i]), tolerance);
+    EXPECT_NEAR(fit.interpolateAV(times[i]).z, rate, 1e-9);
+  }
+
+  Orientations sampled = fit.toOrientations({5, 1005});
+  EXPECT_EQ(sampled.getAngularVelocities().size(), 2);
+  Rotation expected = Rotation({0, 0, 1}, rate * 1005) * Rotation({1, 0, 0}, 0.1 * sin(0.003 * 1005));
+  EXPECT_LE(sampled.interpolate(1005).angleTo(constRot * expected), 1e-6);
+}
+
+
+TEST(ChebyshevOrientations, QuaternionSignFlips) {
+  // A full turn passes the quaternion through both signs
+  vector<double> times;
+  vector<Rotation> rotations;
+  for (int i = 0; i <= 100; i++) {
+    times.push_back(i);
+    rotations.push_back(Rotation({1, 0, 0}, 0.08 * i));
+  }
+  Orientations orientations(rotations, times);
+  ChebyshevOrientations fit = orientations.fitChebyshev(1e-8);
+  EXPECT_FALSE(fit.hasAngularVelocity());
+  EXPECT_THROW(fit.interpolateAV(10), invalid_argument);
+  for (size_t i = 0; i < times.size(); i++) {
+    EXPECT_LE(fit.interpolateTimeDep(times[i]).angleTo(rotations[i]), 1e-8);
+  }
+}
@@ -0,0 +1,210 @@
+#include "gtest/gtest.h"
+
+#include "ale/Compact.h"
+
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+using namespace std;
+using namespace ale;
+
+namespace {
+  // A low orbit sampled every 0.01 seconds, in km
+  States lowOrbit(size_t numStates, bool withVelocity) {
+    double radius = 3700;
+    double rate = 2 * M_PI / 6800;
+    vector<double> times;
+    vector<State> states;
+    for (size_t i = 0; i < numStates; i++) {
+      double time = 1e8 + 0.01 * i;
+      double angle = rate * (time - 1e8);
+      times.push_back(time);
+      Vec3d position(radius * cos(angle), radius * sin(angle), 0.5 * sin(3 * angle));
+      if (withVelocity) {
+        states.push_back(State(position, Vec3d(-radius * rate * sin(angle),
+                                               radius * rate * cos(angle),
+                                               1.5 * rate * cos(3 * angle))));
+      }
+      else {
+        states.push_back(State(position));
+      }
+    }
+    return States(times, states, 1);
+  }
+
+  // A slow spin with the quaternion signs alternating
+  Orientations spin(size_t numRotations) {
+    vector<double> times;
+    vector<Rotation> rotations;
+    vector<Vec3d> avs;
+    for (size_t i = 0; i < numRotations; i++) {
+      double time = 0.05 * i;
+      times.push_back(time);
+      vector<double> quat = (Rotation({0, 0, 1}, 0.001 * time) * Rotation({1, 0, 0}, 0.01 * sin(time))).toQuaternion();
+      double sign = i % 2 == 0 ? 1 : -1;
+      rotations.push_back(Rotation(sign * quat[0], sign * quat[1], sign * quat[2], sign * quat[3]));
+      avs.push_back(Vec3d(0.01 * cos(time), 0, 0.001));
+    }
+    return Orientations(rotations, times, avs, Rotation({0, 1, 0}, 0.25), {-74021, -74000}, {-74000, 1});
+  }
+}
+
+
+TEST(CompactStates, ErrorBound) {
+  States states = lowOrbit(2000, true);
+  CompactStates compact(states, 128);
+  EXPECT_EQ(compact.getReferenceFrame(), 1);
+  EXPECT_TRUE(compact.hasVelocity());
+  EXPECT_EQ(compact.getSegmentSize(), 128);
+  EXPECT_EQ(compact.getTimes(), states.getTimes());
+  EXPECT_LT(compact.getMemoryUsage(), 2000 * (sizeof(State) + sizeof(double)) * 6 / 10);
+
+  // Each segment covers about 45 km, so single precision offsets are within about a micrometer
+  EXPECT_GT(compact.getMaxPositionError(), 0);
+  EXPECT_LT(compact.getMaxPositionError(), 45 * pow(2.0, -25) * 1.01);
+  EXPECT_LT(compact.getMaxVelocityError(), 1e-9);
+
+  vector<State> original = states.getStates();
+  vector<State> decoded = compact.toStates().getStates();
+  ASSERT_EQ(decoded.size(), original.size());
+  for (size_t i = 0; i < original.size(); i++) {
+    EXPECT_NEAR(decoded[i].position.x, original[i].position.x, compact.getMaxPositionError());
+    EXPECT_NEAR(decoded[i].position.y, original[i].position.y, compact.getMaxPositionError());
+    EXPECT_NEAR(decoded[i].velocity.z, original[i].velocity.z, compact.getMaxVelocityError());
+  }
+}
+
+
+TEST(CompactStates, Interpolate) {
+  States states = lowOrbit(1000, false);
+  CompactStates compact(states, 100);
+  EXPECT_FALSE(compact.hasVelocity());
+  States decoded = compact.toStates();
+
+  vector<double> times;
+  for (int i = 0; i < 200; i++) {
+    times.push_back(1e8 - 0.1 + 0.0537 * i);
+  }
+  for (PositionInterpolation interp : {LINEAR, SPLINE, LAGRANGE}) {
+    vector<State> batch = compact.getStates(times, interp);
+    vector<Vec3d> positions = compact.getPositions(times, interp);
+    ASSERT_EQ(batch.size(), times.size());
+    for (size_t i = 0; i < times.size(); i++) {
+      State expected = decoded.getState(times[i], interp);
+      State single = compact.getState(times[i], interp);
+      EXPECT_DOUBLE_EQ(single.position.x, expected.position.x);
+      EXPECT_DOUBLE_EQ(single.position.y, expected.position.y);
+      EXPECT_DOUBLE_EQ(single.velocity.z, expected.velocity.z);
+      EXPECT_NEAR(batch[i].position.x, expected.position.x, 1e-9);
+      EXPECT_NEAR(positions[i].z, expected.position.z, 1e-9);
+      EXPECT_NEAR(single.position.x, states.getPosition(times[i], interp).x, 1e-5);
+    }
+  }
+}
+
+
+TEST(CompactStates, InterpolateWithVelocity) {
+  States states = lowOrbit(300, true);
+  CompactStates compact(states, 64);
+  States decoded = compact.toStates();
+
+  // Between states, on states, and past both ends
+  vector<double> times = {states.getTimes()[0], states.getTimes()[64], states.getTimes()[299],
+                          1e8 - 0.5, 1e8 + 0.637, 1e8 + 2.991, 1e8 + 5};
+  for (PositionInterpolation interp : {LINEAR, SPLINE, LAGRANGE}) {
+    for (double time : times) {
+      State expected = decoded.getState(time, interp);
+      State single = compact.getState(time, interp);
+      EXPECT_DOUBLE_EQ(single.position.x, expected.position.x);
+      EXPECT_DOUBLE_EQ(single.position.z, expected.position.z);
+      EXPECT_DOUBLE_EQ(single.velocity.y, expected.velocity.y);
+      EXPECT_DOUBLE_EQ(compact.getVelocity(time, interp).z, expected.velocity.z);
+    }
+  }
+
+  // A single state is propagated with its velocity
+  CompactStates one(lowOrbit(1, true));
+  State propagated = one.getState(1e8 + 2);
+  State expected = one.toStates().getState(1e8 + 2);
+  EXPECT_DOUBLE_EQ(propagated.position.y, expected.position.y);
+  EXPECT_DOUBLE_EQ(propagated.velocity.x, expected.velocity.x);
+}
+
+
+TEST(CompactStates, InvalidSegmentSize) {
+  EXPECT_THROW(CompactStates compact(lowOrbit(10, false), 0), invalid_argument);
+}
+
+
+TEST(CompactOrientations, ErrorBound) {
+  Orientations orientations = spin(1000);
+  CompactOrientations compact(orientations, 64);
+  EXPECT_TRUE(compact.hasAngularVelocity());
+  EXPECT_EQ(compact.getConstantFrames(), vector<int>({-74021, -74000}));
+  EXPECT_EQ(compact.getTimeDependentFrames(), vector<int>({-74000, 1}));
+  EXPECT_LT(compact.getMemoryUsage(), 1000 * 64 * 6 / 10);
+  EXPECT_LT(compact.getMaxAngularError(), 1e-9);
+  EXPECT_LT(compact.getMaxAngularVelocityError(), 1e-9);
+
+  // The signs of the quaternions are restored
+  vector<Rotation> original = orientations.getRotations();
+  vector<Rotation> decoded = compact.toOrientations().getRotations();
+  for (size_t i = 0; i < original.size(); i++) {
+    EXPECT_NEAR(decoded[i].toQuaternion()[0], original[i].toQuaternion()[0], 1e-9);
+    EXPECT_LE(decoded[i].angleTo(original[i]), compact.getMaxAngularError());
+  }
+}
+
+
+TEST(CompactOrientations, Interpolate) {
+  Orientations orientations = spin(500);
+  CompactOrientations compact(orientations, 50);
+  Orientations decoded = compact.toOrientations();
+
+  vector<double> times;
+  for (int i = 0; i < 150; i++) {
+    times.push_back(-0.1 + 0.171 * i);
+  }
+  for (RotationInterpolation interp : {SLERP, NLERP}) {
+    vector<Rotation> batch = compact.interpolate(times, interp);
+    ASSERT_EQ(batch.size(), times.size());
+    for (size_t i = 0; i < times.size(); i++) {
+      Rotation expected = decoded.interpolate(times[i], interp);
+      EXPECT_LE(compact.interpolate(times[i], interp).angleTo(expected), 1e-12);
+      EXPECT_LE(batch[i].angleTo(expected), 1e-12);
+    }
+  }
+
+  // SLERP takes the shorter path across the sign flips, so it stays close to the original
+  for (size_t i = 0; i < times.size(); i++) {
+    EXPECT_LE(compact.interpolate(times[i]).angleTo(orientations.interpolate(times[i])), 1e-8);
+  }
+
+  Vec3d av = compact.interpolateAV(3.33);
+  EXPECT_NEAR(av.x, orientations.interpolateAV(3.33).x, 1e-9);
+  Vec3d vector = compact.rotateVectorAt(3.33, Vec3d(1, 2, 3), SLERP, true);
+  Vec3d expectedVector = orientations.rotateVectorAt(3.33, Vec3d(1, 2, 3), SLERP, true);
+  EXPECT_NEAR(vector.x, expectedVector.x, 1e-8);
+  EXPECT_NEAR(vector.y, expectedVector.y, 1e-8);
+  State state = compact.rotateStateAt(3.33, State(Vec3d(1, 2, 3), Vec3d(0.1, 0.2, 0.3)));
+  State expectedState = orientations.rotateStateAt(3.33, State(Vec3d(1, 2, 3), Vec3d(0.1, 0.2, 0.3)));
+  EXPECT_NEAR(state.velocity.z, expectedState.velocity.z, 1e-8);
+}
+
+
+TEST(CompactOrientations, SingleRotation) {
+  Orientations orientations({Rotation({1, 0, 0}, 0.2)}, {5}, {Vec3d(0, 0.01, 0.02)});
+  CompactOrientations compact(orientations);
+  EXPECT_LE(compact.interpolateTimeDep(7.5).angleTo(orientations.interpolateTimeDep(7.5)), 1e-9);
+  EXPECT_NEAR(compact.interpolateAV(7.5).z, 0.02, 1e-12);
+}
+
+
+TEST(CompactOrientations, NoAngularVelocities) {
+  Orientations orientations({Rotation(1, 0, 0, 0), Rotation({0, 0, 1}, 0.1)}, {0, 1});
+  CompactOrientations compact(orientations);
+  EXPECT_FALSE(compact.hasAngularVelocity());
+  EXPECT_THROW(compact.interpolateAV(0.5), invalid_argument);
+  EXPECT_LE(compact.interpolate(0.5).angleTo(Rotation({0, 0, 1}, 0.05)), 1e-7);
+}
@@ -0,0 +1,183 @@
+#include "gtest/gtest.h"
+
+#include "ale/Distortion.h"
+
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+using namespace std;
+using namespace ale;
+
+namespace {
+  // A distortion model of each supported type with realistic focal plane magnitudes
+  vector<Distortion> allModels() {
+    vector<double> transverse(20, 0.0);
+    transverse[1] = 1.0;
+    transverse[6] = 1e-5;
+    transverse[8] = 2e-6;
+    transverse[12] = 1.0;
+    transverse[17] = -3e-6;
+    transverse[19] = 1e-5;
+    return {
+      Distortion(TRANSVERSE, transverse),
+      Distortion(RADIAL, {0.0, 1e-4, -2e-8}),
+      Distortion(KAGUYALISM, {0.01, -1e-4, 2e-3, 1e-5, -3e-6, -0.02, 2e-4, -1e-3, 3e-5, 1e-6}),
+      Distortion(DAWNFC, {8.4e-6}),
+      Distortion(LROLROCNAC, {1.81e-5}),
+      Distortion(CAHVOR, {1e-3, 2e-5, -1e-8, 0.5, -0.25}),
+      Distortion(RADTAN, {-1e-4, 1e-7, 1e-5, -2e-5, -1e-10})
+    };
+  }
+
+  // A grid of focal plane points
+  void focalPlanePoints(double extent, vector<double> &x, vector<double> &y) {
+    x.clear();
+    y.clear();
+    for (int i = -10; i <= 10; i++) {
+      for (int j = -10; j <= 10; j++) {
+        x.push_back(extent * i / 10.0);
+        y.push_back(extent * j / 10.0 + 0.001 * i);
+      }
+    }
+  }
+}
+
+
+TEST(Distortion, ClosedForms) {
+  double x, y;
+
+  Distortion radial(RADIAL, {0.0, 1e-3, 0.0});
+  EXPECT_TRUE(radial.isDistortIterative());
+  radial.undistort(2.0, 0.0, x, y);
+  EXPECT_DOUBLE_EQ(x, 2.0 * (1 - 4e-3));
+  EXPECT_DOUBLE_EQ(y, 0.0);
+
+  Distortion dawn(DAWNFC, {1e-3});
+  EXPECT_FALSE(dawn.isDistortIterative());
+  dawn.distort(1.0, 2.0, x, y);
+  EXPECT_DOUBLE_EQ(x, 1.0 * (1 + 5e-3));
+  EXPECT_DOUBLE_EQ(y, 2.0 * (1 + 5e-3));
+
+  Distortion lro(LROLROCNAC, {1e-2});
+  lro.undistort(3.0, 2.0, x, y);
+  EXPECT_DOUBLE_EQ(x, 3.0);
+  EXPECT_DOUBLE_EQ(y, 2.0 / 1.04);
+
+  vector<double> identity(20, 0.0);
+  identity[1] = 1.0;
+  identity[12] = 1.0;
+  Distortion transverse(TRANSVERSE, identity);
+  transverse.undistort(-4.0, 7.5, x, y);
+  EXPECT_DOUBLE_EQ(x, -4.0);
+  EXPECT_DOUBLE_EQ(y, 7.5);
+
+  Distortion kaguya(KAGUYALISM, {0.1, 0.01, 0.02, 0, 0, -0.1, 0, 0, 0.5, 0});
+  kaguya.undistort(3.0, 4.0, x, y);
+  EXPECT_DOUBLE_EQ(x, 3.0 + 0.1 + 0.01 + 0.02 * 5);
+  EXPECT_DOUBLE_EQ(y, 4.0 - 0.1 + 0.5 * 25);
+}
+
+
+TEST(Distortion, RoundTrip) {
+  vector<double> x, y;
+  focalPlanePoints(10.0, x, y);
+  for (const Distortion &model : allModels()) {
+    vector<double> distortedX(x.size()), distortedY(x.size());
+    vector<double> undistortedX(x.size()), undistortedY(x.size());
+    model.distort(x.data(), y.data(), x.size(), distortedX.data(), distortedY.data());
+    model.undistort(distortedX.data(), distortedY.data(), x.size(),
+                    undistortedX.data(), undistortedY.data());
+    for (size_t i = 0; i < x.size(); i++) {
+      EXPECT_NEAR(undistortedX[i], x[i], 1e-10) << "Model " << model.getType() << " point " << i;
+      EXPECT_NEAR(undistortedY[i], y[i], 1e-10) << "Model " << model.getType() << " point " << i;
+    }
+  }
+}
+
+
+TEST(Distortion, BatchMatchesSingle) {
+  vector<double> x, y;
+  focalPlanePoints(8.0, x, y);
+  for (const Distortion &model : allModels()) {
+    vector<double> batchX(x), batchY(y);
+    // In place
+    model.undistort(batchX.data(), batchY.data(), x.size(), batchX.data(), batchY.data());
+    for (size_t i = 0; i < x.size(); i++) {
+      double singleX, singleY;
+      model.undistort(x[i], y[i], singleX, singleY);
+      EXPECT_EQ(batchX[i], singleX);
+      EXPECT_EQ(batchY[i], singleY);
+    }
+  }
+}
+
+
+TEST(Distortion, PreparedGrid) {
+  vector<double> x, y;
+  focalPlanePoints(12.0, x, y);
+  for (Distortion model : allModels()) {
+    vector<double> expectedX(x.size()), expectedY(x.size());
+    vector<double> actualX(x.size()), actualY(x.size());
+    bool iterativeDistort = model.isDistortIterative();
+    if (iterativeDistort) {
+      model.distort(x.data(), y.data(), x.size(), expectedX.data(), expectedY.data());
+    }
+    else {
+      model.undistort(x.data(), y.data(), x.size(), expectedX.data(), expectedY.data());
+    }
+
+    EXPECT_FALSE(model.isGridPrepared());
+    // Part of the points fall outside of the grid
+    model.prepareGrid(-10, 10, -10, 10);
+    // Newton already converges in about two steps for these from the input point
+    bool keepsGrid = model.getType() != RADIAL &&
+                     model.getType() != CAHVOR &&
+                     model.getType() != RADTAN;
+    EXPECT_EQ(model.isGridPrepared(), keepsGrid) << "Model " << model.getType();
+    if (iterativeDistort) {
+      model.distort(x.data(), y.data(), x.size(), actualX.data(), actualY.data());
+    }
+    else {
+      model.undistort(x.data(), y.data(), x.size(), actualX.data(), actualY.data());
+    }
+    for (size_t i = 0; i < x.size(); i++) {
+      EXPECT_NEAR(actualX[i], expectedX[i], 1e-11) << "Model " << model.getType() << " point " << i;
+      EXPECT_NEAR(actualY[i], expectedY[i], 1e-11) << "Model " << model.getType() << " point " << i;
+    }
+  }
+}
+
+
+TEST(Distortion, UnsolvablePointsAreNaN) {
+  // The undistorted y of LROLROCNAC is at most 1 / (2 sqrt(k)), at the distorted y = 1 / sqrt(k)
+  Distortion lro(LROLROCNAC, {1e-2});
+  vector<double> x = {1.0, 1.0, 1.0};
+  vector<double> y = {2.0, 6.0, -8.0};
+  vector<double> distortedX(3), distortedY(3);
+  lro.distort(x.data(), y.data(), 3, distortedX.data(), distortedY.data());
+  EXPECT_FALSE(isnan(distortedX[0]));
+  EXPECT_NEAR(distortedY[0] / (1 + 1e-2 * distortedY[0] * distortedY[0]), 2.0, 1e-12);
+  EXPECT_TRUE(isnan(distortedX[1]));
+  EXPECT_TRUE(isnan(distortedY[1]));
+  EXPECT_TRUE(isnan(distortedX[2]));
+  EXPECT_TRUE(isnan(distortedY[2]));
+
+  // Grid nodes without a solution do not spoil the guesses next to them
+  lro.prepareGrid(-8, 8, -8, 8, 4);
+  lro.distort(x.data(), y.data(), 3, distortedX.data(), distortedY.data());
+  EXPECT_NEAR(distortedY[0] / (1 + 1e-2 * distortedY[0] * distortedY[0]), 2.0, 1e-12);
+  EXPECT_TRUE(isnan(distortedY[1]));
+}
+
+
+TEST(Distortion, InvalidInputs) {
+  EXPECT_THROW(Distortion model(RADIAL, {1e-3, 0}), invalid_argument);
+  EXPECT_THROW(Distortion model(TRANSVERSE, vector<double>(10, 0.0)), invalid_argument);
+  EXPECT_THROW(Distortion model(LUNARORBITER, {0, 0, 0, 0}), invalid_argument);
+
+  Distortion radial(RADIAL, {0, 1e-4, 0});
+  EXPECT_THROW(radial.prepareGrid(0, 0, -1, 1), invalid_argument);
+  EXPECT_THROW(radial.prepareGrid(-1, 1, -1, 1, 0), invalid_argument);
+  EXPECT_FALSE(radial.isGridPrepared());
+}
@@ -0,0 +1,113 @@
+#include "gtest/gtest.h"
+
+#include "ale/FrameChain.h"
+
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+using namespace std;
+using namespace ale;
+
+namespace {
+  void expectRotationNear(const Rotation &actual, const Rotation &expected, double tolerance) {
+    vector<double> actualQuat = actual.toQuaternion();
+    vector<double> expectedQuat = expected.toQuaternion();
+    // q and -q are the same rotation
+    double sign = actualQuat[0] * expectedQuat[0] + actualQuat[1] * expectedQuat[1]
+                + actualQuat[2] * expectedQuat[2] + actualQuat[3] * expectedQuat[3] < 0 ? -1 : 1;
+    for (size_t i = 0; i < 4; i++) {
+      EXPECT_NEAR(actualQuat[i], sign * expectedQuat[i], tolerance);
+    }
+  }
+}
+
+class FrameChainTest : public ::testing::Test {
+  protected:
+    void SetUp() override {
+      vector<double> times = {0, 1, 2, 3, 4};
+      vector<Rotation> instRotations;
+      vector<Rotation> bodyRotations;
+      for (double time : times) {
+        instRotations.push_back(Rotation({0, 0, 1}, 0.1 * time));
+        bodyRotations.push_back(Rotation({1, 0, 0}, 0.2 * time));
+      }
+      // J2000 to the spacecraft frame, then a constant rotation to the sensor
+      sensorRotation = Rotation({0, 1, 0}, 0.5);
+      instPointing = Orientations(instRotations, times, vector<Vec3d>(), sensorRotation,
+                                  {-74021, -74000}, {-74000, 1});
+      bodyRotation = Orientations(bodyRotations, times, vector<Vec3d>(), Rotation(),
+                                  vector<int>(), {10014, 1});
+      frameChain.addOrientations(instPointing);
+      frameChain.addOrientations(bodyRotation);
+    }
+
+    Rotation sensorRotation;
+    Orientations instPointing;
+    Orientations bodyRotation;
+    FrameChain frameChain;
+};
+
+TEST_F(FrameChainTest, Path) {
+  EXPECT_TRUE(frameChain.hasFrame(-74021));
+  EXPECT_TRUE(frameChain.hasFrame(10014));
+  EXPECT_FALSE(frameChain.hasFrame(499));
+  EXPECT_EQ(frameChain.path(-74021, 10014), vector<int>({-74021, -74000, 1, 10014}));
+  EXPECT_EQ(frameChain.path(1, 1), vector<int>({1}));
+  EXPECT_THROW(frameChain.path(1, 499), invalid_argument);
+}
+
+TEST_F(FrameChainTest, LastTimeDependentFrame) {
+  EXPECT_EQ(frameChain.lastTimeDependentFrame(1, -74021), -74000);
+  EXPECT_EQ(frameChain.lastTimeDependentFrame(-74021, 10014), 10014);
+  EXPECT_EQ(frameChain.lastTimeDependentFrame(-74000, -74021), -74000);
+}
+
+TEST_F(FrameChainTest, ComputeSingleOrientations) {
+  const Orientations &pointing = frameChain.compute(1, -74021);
+  EXPECT_EQ(pointing.getConstantFrames(), vector<int>({-74021, -74000}));
+  EXPECT_EQ(pointing.getTimeDependentFrames(), vector<int>({-74000, 1}));
+  for (double time : {0.0, 1.5, 3.25}) {
+    expectRotationNear(pointing.interpolate(time), instPointing.interpolate(time), 1e-12);
+  }
+  expectRotationNear(pointing.getConstantRotation(), sensorRotation, 1e-12);
+}
+
+TEST_F(FrameChainTest, ComputeSensorToBody) {
+  const Orientations &sensorToBody = frameChain.compute(-74021, 10014);
+  EXPECT_EQ(sensorToBody.getConstantFrames(), vector<int>({10014}));
+  EXPECT_EQ(sensorToBody.getTimeDependentFrames(), vector<int>({10014, 1, -74000, -74021}));
+  // Composed rotations are exact at the sample times and interpolated between them
+  for (double time : {0.0, 1.0, 2.0, 4.0}) {
+    Rotation expected = bodyRotation.interpolate(time) * instPointing.interpolate(time).inverse();
+    expectRotationNear(sensorToBody.interpolate(time), expected, 1e-12);
+    expectRotationNear(frameChain.rotationAt(-74021, 10014, time), expected, 1e-12);
+  }
+}
+
+TEST_F(FrameChainTest, ComputeConstant) {
+  const Orientations &constant = frameChain.compute(-74000, -74021);
+  EXPECT_EQ(constant.getConstantFrames(), vector<int>({-74021, -74000}));
+  EXPECT_EQ(constant.getTimeDependentFrames(), vector<int>({-74000}));
+  expectRotationNear(constant.interpolate(2.0), sensorRotation, 1e-12);
+  expectRotationNear(frameChain.rotationAt(-74021, -74000, 100.0), sensorRotation.inverse(), 1e-12);
+  expectRotationNear(frameChain.rotationAt(1, 1, 1.0), Rotation(), 1e-12);
+}
+
+TEST_F(FrameChainTest, Cache) {
+  const Orientations *first = &frameChain.compute(1, 10014);
+  EXPECT_EQ(first, &frameChain.compute(1, 10014));
+
+  // Adding a frame invalidates the cached rotations
+  Rotation fixedRotation({0, 0, 1}, 0.25);
+  frameChain.addRotation(10014, 10015, fixedRotation);
+  EXPECT_EQ(frameChain.path(1, 10015), vector<int>({1, 10014, 10015}));
+  expectRotationNear(frameChain.rotationAt(1, 10015, 2.0),
+                     fixedRotation * bodyRotation.interpolate(2.0), 1e-12);
+}
+
+TEST(FrameChain, AddOrientationsWithoutFrames) {
+  FrameChain frameChain;
+  Orientations orientations({Rotation()}, {0.0});
+  EXPECT_THROW(frameChain.addOrientations(orientations), invalid_argument);
+}
@@ -0,0 +1,290 @@
+#include "gtest/gtest.h"
+
+#include "ale/IsdCache.h"
+
+#include <nlohmann/json.hpp>
+
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <sys/stat.h>
+
+using json = nlohmann::json;
+
+namespace {
+  json cacheIsd() {
+    json isd;
+    isd["name_model"] = "USGS_ASTRO_FRAME_SENSOR_MODEL";
+    isd["image_identifier"] = "TEST_IMAGE";
+    isd["naif_keywords"]["BODY499_RADII"] = {3396.19, 3396.19, 3376.2};
+
+    json position;
+    position["ephemeris_times"] = {10.0, 11.0};
+    position["positions"] = {{1.0, 2.0, 3.0}, {4.0, 5.0, 6.0}};
+    position["velocities"] = {{0.1, 0.2, 0.3}, {0.4, 0.5, 0.6}};
+    position["reference_frame"] = 1;
+    isd["instrument_position"] = position;
+
+    json rotation;
+    rotation["time_dependent_frames"] = {-74000, 1};
+    rotation["ephemeris_times"] = {10.0, 11.0};
+    rotation["quaternions"] = {{0.5, 0.5, 0.5, 0.5}, {-0.5, 0.5, 0.5, 0.5}};
+    rotation["reference_frame"] = 1;
+    isd["instrument_pointing"] = rotation;
+    return isd;
+  }
+
+  // Loader that counts how many times it actually has to generate an ISD
+  // and reports a fixed set of furnished kernels
+  class CountingLoader {
+    public:
+      CountingLoader(int &calls, const std::vector<std::string> &kernels={}) :
+        m_calls(calls), m_kernels(kernels) {}
+
+      std::string operator()(const std::string &, const std::string &props,
+                             const std::string &, bool, bool, bool) {
+        m_calls++;
+        json isd = cacheIsd();
+        isd["props"] = props;
+        if (json::parse(props).value("record_kernels", false)) {
+          isd["furnished_kernels"] = m_kernels;
+        }
+        return isd.dump();
+      }
+
+    private:
+      int &m_calls;
+      std::vector<std::string> m_kernels;
+  };
+
+  class IsdCacheTest : public ::testing::Test {
+    protected:
+      void SetUp() override {
+        calls = 0;
+        directory = "isd_cache_test";
+        mkdir(directory.c_str(), 0755);
+        label = directory + "/test.lbl";
+        std::ofstream labelFile(label);
+        labelFile << "Object = IsisCube\nEnd_Object\nEnd";
+      }
+
+      void TearDown() override {
+        for (const std::string &path : created) {
+          std::remove(path.c_str());
+        }
+        std::remove(label.c_str());
+        rmdir(directory.c_str());
+      }
+
+      std::string binaryPath(const ale::IsdCache &cache, const std::string &props="") {
+        std::string path = directory + "/" + cache.key(label, props, "ale", false, false);
+        created.push_back(path + ".bisd");
+        created.push_back(path + ".kernels.json");
+        return path + ".bisd";
+      }
+
+      int calls;
+      std::string directory;
+      std::string label;
+      std::vector<std::string> created;
+  };
+}
+
+TEST_F(IsdCacheTest, MemoryHit) {
+  ale::IsdCache cache("", CountingLoader(calls));
+  std::shared_ptr<const json> first = cache.load(label);
+  std::shared_ptr<const json> second = cache.load(label);
+  EXPECT_EQ(calls, 1);
+  EXPECT_EQ(first.get(), second.get());
+  EXPECT_EQ((*first)["image_identifier"], "TEST_IMAGE");
+
+  ale::IsdCache::CacheStats stats = cache.getStats();
+  EXPECT_EQ(stats.memoryHits, 1);
+  EXPECT_EQ(stats.diskHits, 0);
+  EXPECT_EQ(stats.misses, 1);
+
+  cache.clear();
+  cache.load(label);
+  EXPECT_EQ(calls, 2);
+  EXPECT_EQ(cache.getStats().misses, 2);
+}
+
+TEST_F(IsdCacheTest, DiskHit) {
+  std::shared_ptr<const json> generated;
+  {
+    ale::IsdCache cache(directory, CountingLoader(calls));
+    generated = cache.load(label, "{\"kernels\": []}");
+  }
+  ale::IsdCache cache(directory, CountingLoader(calls));
+  std::string path = binaryPath(cache, "{\"kernels\": []}");
+  std::shared_ptr<const json> cached = cache.load(label, "{\"kernels\": []}");
+  EXPECT_EQ(calls, 1);
+  EXPECT_EQ(*cached, *generated);
+  EXPECT_EQ(cache.getStats().diskHits, 1);
+
+  std::shared_ptr<const ale::BinaryIsd> binaryIsd = cache.loadBinary(label, "{\"kernels\": []}");
+  EXPECT_EQ(calls, 1);
+  EXPECT_EQ(cache.getStats().diskHits, 2);
+  EXPECT_TRUE(binaryIsd->hasArray("instrument_position", "positions"));
+  std::ifstream file(path);
+  EXPECT_TRUE(file.good());
+}
+
+TEST_F(IsdCacheTest, CorruptFileIsAMiss) {
+  ale::IsdCache cache(directory, CountingLoader(calls));
+  std::string path = binaryPath(cache);
+  {
+    std::ofstream file(path);
+    file << "not a binary ISD";
+    std::ofstream kernelsFile(created.back());
+    kernelsFile << "[]";
+  }
+  cache.load(label);
+  EXPECT_EQ(calls, 1);
+  EXPECT_EQ(cache.getStats().misses, 1);
+  ale::BinaryIsd binaryIsd(path);
+  EXPECT_EQ(binaryIsd.toJson()["image_identifier"], "TEST_IMAGE");
+}
+
+TEST_F(IsdCacheTest, LoadBinary) {
+  ale::IsdCache cache(directory, CountingLoader(calls));
+  binaryPath(cache);
+  std::shared_ptr<const ale::BinaryIsd> binaryIsd = cache.loadBinary(label);
+  EXPECT_EQ(calls, 1);
+  EXPECT_EQ(cache.getStats().misses, 1);
+  size_t rows, columns;
+  const double *quaternions = binaryIsd->getArray("instrument_pointing", "quaternions", rows, columns);
+  EXPECT_EQ(rows, 2);
+  EXPECT_EQ(columns, 4);
+  EXPECT_DOUBLE_EQ(quaternions[4], -0.5);
+
+  // The JSON generated for the binary ISD is kept in memory
+  cache.load(label);
+  EXPECT_EQ(calls, 1);
+  EXPECT_EQ(cache.getStats().memoryHits, 1);
+}
+
+TEST_F(IsdCacheTest, FurnishedKernels) {
+  std::string kernel = directory + "/furnished.bsp";
+  {
+    std::ofstream kernelFile(kernel);
+    kernelFile << "DAF/SPK";
+  }
+  std::string path;
+  {
+    ale::IsdCache cache(directory, CountingLoader(calls, {kernel}));
+    path = binaryPath(cache);
+    std::shared_ptr<const json> isd = cache.load(label);
+    EXPECT_FALSE(isd->contains("furnished_kernels"));
+    EXPECT_EQ(json::parse((*isd)["props"].get<std::string>())["record_kernels"], true);
+    cache.load(label);
+    EXPECT_EQ(calls, 1);
+
+    // Changing a kernel that is not in the props is caught on a memory hit
+    {
+      std::ofstream kernelFile(kernel, std::ios::app);
+      kernelFile << "more data";
+    }
+    cache.load(label);
+    EXPECT_EQ(calls, 2);
+    ale::IsdCache::CacheStats stats = cache.getStats();
+    EXPECT_EQ(stats.memoryHits, 1);
+    EXPECT_EQ(stats.stale, 1);
+    EXPECT_EQ(stats.misses, 2);
+  }
+
+  // And on a disk hit
+  ale::IsdCache cache(directory, CountingLoader(calls, {kernel}));
+  cache.load(label);
+  EXPECT_EQ(calls, 2);
+  EXPECT_EQ(cache.getStats().diskHits, 1);
+  cache.clear();
+  std::remove(kernel.c_str());
+  cache.loadBinary(label);
+  EXPECT_EQ(calls, 3);
+  EXPECT_EQ(cache.getStats().stale, 1);
+
+  // Without its kernels a cached ISD is a miss
+  std::remove(created.back().c_str());
+  ale::IsdCache other(directory, CountingLoader(calls));
+  other.load(label);
+  EXPECT_EQ(calls, 4);
+  EXPECT_EQ(other.getStats().diskHits, 0);
+}
+
+TEST_F(IsdCacheTest, NotBinaryIsdIsKeptInMemory) {
+  // An ISIS style ISD whose position table does not fit the binary layout
+  ale::IsdCache::Loader isisLoader = [this](const std::string &, const std::string &,
+                                            const std::string &formatter, bool, bool, bool) {
+    calls++;
+    json isd;
+    isd["formatter"] = formatter;
+    isd["instrument_position"]["positions"] = {{"J2000X", 1.0}, {"J2000Y", 2.0}};
+    return isd.dump();
+  };
+  ale::IsdCache cache(directory, isisLoader);
+  std::string path = directory + "/" + cache.key(label, "", "isis", false, false);
+
+  std::shared_ptr<const json> isd = cache.load(label, "", "isis");
+  EXPECT_EQ((*isd)["formatter"], "isis");
+  EXPECT_EQ(cache.getStats().misses, 1);
+  EXPECT_FALSE(std::ifstream(path + ".bisd").good());
+  EXPECT_FALSE(std::ifstream(path + ".kernels.json").good());
+
+  cache.load(label, "", "isis");
+  EXPECT_EQ(calls, 1);
+  EXPECT_EQ(cache.getStats().memoryHits, 1);
+
+  EXPECT_THROW(cache.loadBinary(label, "", "isis"), std::invalid_argument);
+}
+
+TEST_F(IsdCacheTest, LoadBinaryNoDirectory) {
+  ale::IsdCache cache("", CountingLoader(calls));
+  EXPECT_THROW(cache.loadBinary(label), std::invalid_argument);
+  EXPECT_EQ(calls, 0);
+}
+
+TEST_F(IsdCacheTest, Key) {
+  ale::IsdCache cache("", CountingLoader(calls));
+  std::string key = cache.key(label, "", "ale", false, false);
+  EXPECT_EQ(key.size(), 16);
+  EXPECT_EQ(key, cache.key(label, "", "ale", false, false));
+  EXPECT_NE(key, cache.key(label, "{\"kernels\": []}", "ale", false, false));
+  EXPECT_NE(key, cache.key(label, "", "isis", false, false));
+  EXPECT_NE(key, cache.key(label, "", "ale", true, false));
+  EXPECT_NE(key, cache.key(label, "", "ale", false, true));
+
+  // The key depends on what is in the label, not where it is
+  std::string copy = directory + "/copy.lbl";
+  {
+    std::ofstream copyFile(copy);
+    copyFile << "Object = IsisCube\nEnd_Object\nEnd";
+  }
+  EXPECT_EQ(key, cache.key(copy, "", "ale", false, false));
+  {
+    std::ofstream labelFile(label, std::ios::trunc);
+    labelFile << "Object = IsisCube\nEnd_Object\nEnd\n";
+  }
+  EXPECT_NE(key, cache.key(label, "", "ale", false, false));
+  std::remove(copy.c_str());
+
+  // Kernels are keyed on their size and modification time
+  std::string kernel = directory + "/test.bsp";
+  std::string props = "{\"kernels\": [\"" + kernel + "\"]}";
+  std::string missingKey = cache.key(label, props, "ale", false, false);
+  {
+    std::ofstream kernelFile(kernel);
+    kernelFile << "DAF/SPK";
+  }
+  std::string kernelKey = cache.key(label, props, "ale", false, false);
+  EXPECT_NE(missingKey, kernelKey);
+  {
+    std::ofstream kernelFile(kernel, std::ios::app);
+    kernelFile << "more data";
+  }
+  EXPECT_NE(kernelKey, cache.key(label, props, "ale", false, false));
+  std::remove(kernel.c_str());
+}
@@ -1,9 +1,13 @@
+#include <cstdio>
 #include <string>
 #include <fstream>
+#include <sstream>
 #include <streambuf>
+#include <thread>
 
 #include "gtest/gtest.h"
 
+#include "ale/BinaryIsd.h"
 #include "ale/Isd.h"
 #include "ale/Util.h"
 #include "ale/Vectors.h"
@@ -828,3 +832,462 @@ TEST(Isd, BadEphemerisTimes) {
     FAIL() << "Expected an Excpetion with message: \"Could not parse the center image time.\"";
   }
 }
+
+nlohmann::json minimalIsd() {
+  nlohmann::json isd;
+  isd["name_model"] = "USGS_ASTRO_FRAME_SENSOR_MODEL";
+  isd["image_identifier"] = "TEST_IMAGE";
+  isd["name_platform"] = "TEST_PLATFORM";
+  isd["name_sensor"] = "TEST_SENSOR";
+  isd["image_lines"] = 100;
+  isd["image_samples"] = 200;
+  isd["starting_ephemeris_time"] = 10.0;
+  isd["center_ephemeris_time"] = 11.0;
+  isd["detector_sample_summing"] = 1;
+  isd["detector_line_summing"] = 1;
+  isd["focal_length_model"]["focal_length"] = 50.0;
+  isd["focal2pixel_lines"] = {0.0, 100.0, 0.0};
+  isd["focal2pixel_samples"] = {0.0, 0.0, 100.0};
+  isd["detector_center"]["line"] = 50.0;
+  isd["detector_center"]["sample"] = 100.0;
+  isd["starting_detector_line"] = 0;
+  isd["starting_detector_sample"] = 0;
+  isd["reference_height"]["minheight"] = -1000;
+  isd["reference_height"]["maxheight"] = 1000;
+  isd["radii"]["semimajor"] = 3396.19;
+  isd["radii"]["semiminor"] = 3376.2;
+  isd["optical_distortion"]["radial"]["coefficients"] = {0.1, 0.2, 0.3};
+  isd["interpolation_method"] = "lagrange";
+
+  nlohmann::json position;
+  position["ephemeris_times"] = {10, 11.0, 12.0};
+  position["positions"] = {{1.0, 2.0, 3.0}, {4.0, 5.0, 6.0}, {7, 8, 9}};
+  position["velocities"] = {{0.1, 0.2, 0.3}, {0.4, 0.5, 0.6}, {0.7, 0.8, 0.9}};
+  position["reference_frame"] = 1;
+  position["position_units"] = "KM";
+  isd["instrument_position"] = position;
+  position.erase("velocities");
+  isd["sun_position"] = position;
+
+  nlohmann::json rotation;
+  rotation["time_dependent_frames"] = {-74000, -74900, 1};
+  rotation["constant_frames"] = {-74021, -74020};
+  rotation["constant_rotation"] = {0, 1, 0, -1, 0, 0, 0, 0, 1};
+  rotation["ephemeris_times"] = {10.0, 12.0};
+  rotation["quaternions"] = {{0.5, 0.5, 0.5, 0.5}, {-0.5, 0.5, 0.5, 0.5}};
+  rotation["angular_velocities"] = {{0.1, 0.2, 0.3}, {0.4, 0.5, 0.6}};
+  rotation["reference_frame"] = 1;
+  isd["instrument_pointing"] = rotation;
+  rotation.erase("constant_frames");
+  rotation.erase("constant_rotation");
+  isd["body_rotation"] = rotation;
+  return isd;
+}
+
+void EXPECT_STATES_EQ(const ale::States &states, const ale::States &expected) {
+  ASSERT_DOUBLE_VECTOR_EQ(states.getTimes(), expected.getTimes());
+  EXPECT_EQ(states.getReferenceFrame(), expected.getReferenceFrame());
+  EXPECT_EQ(states.hasVelocity(), expected.hasVelocity());
+  std::vector<ale::State> stateVec = states.getStates();
+  std::vector<ale::State> expectedVec = expected.getStates();
+  ASSERT_EQ(stateVec.size(), expectedVec.size());
+  for (size_t i = 0; i < stateVec.size(); i++) {
+    EXPECT_DOUBLE_EQ(stateVec[i].position.x, expectedVec[i].position.x);
+    EXPECT_DOUBLE_EQ(stateVec[i].position.y, expectedVec[i].position.y);
+    EXPECT_DOUBLE_EQ(stateVec[i].position.z, expectedVec[i].position.z);
+    if (expected.hasVelocity()) {
+      EXPECT_DOUBLE_EQ(stateVec[i].velocity.x, expectedVec[i].velocity.x);
+      EXPECT_DOUBLE_EQ(stateVec[i].velocity.y, expectedVec[i].velocity.y);
+      EXPECT_DOUBLE_EQ(stateVec[i].velocity.z, expectedVec[i].velocity.z);
+    }
+  }
+}
+
+void EXPECT_ORIENTATIONS_EQ(const ale::Orientations &orientations, const ale::Orientations &expected) {
+  ASSERT_DOUBLE_VECTOR_EQ(orientations.getTimes(), expected.getTimes());
+  EXPECT_EQ(orientations.getConstantFrames(), expected.getConstantFrames());
+  EXPECT_EQ(orientations.getTimeDependentFrames(), expected.getTimeDependentFrames());
+  ASSERT_DOUBLE_VECTOR_EQ(orientations.getConstantRotation().toQuaternion(),
+                          expected.getConstantRotation().toQuaternion());
+  std::vector<ale::Rotation> rotations = orientations.getRotations();
+  std::vector<ale::Rotation> expectedRotations = expected.getRotations();
+  ASSERT_EQ(rotations.size(), expectedRotations.size());
+  for (size_t i = 0; i < rotations.size(); i++) {
+    ASSERT_DOUBLE_VECTOR_EQ(rotations[i].toQuaternion(), expectedRotations[i].toQuaternion());
+  }
+  std::vector<ale::Vec3d> avs = orientations.getAngularVelocities();
+  std::vector<ale::Vec3d> expectedAvs = expected.getAngularVelocities();
+  ASSERT_EQ(avs.size(), expectedAvs.size());
+  for (size_t i = 0; i < avs.size(); i++) {
+    EXPECT_DOUBLE_EQ(avs[i].x, expectedAvs[i].x);
+    EXPECT_DOUBLE_EQ(avs[i].y, expectedAvs[i].y);
+    EXPECT_DOUBLE_EQ(avs[i].z, expectedAvs[i].z);
+  }
+}
+
+TEST(Isd, StreamedMatchesGetters) {
+  nlohmann::json isdJson = minimalIsd();
+  std::string isdString = isdJson.dump();
+  std::istringstream isdStream(isdString);
+
+  ale::Isd isd(isdString);
+  ale::Isd streamedIsd(isdStream);
+
+  std::vector<ale::Isd *> isds = {&isd, &streamedIsd};
+  for (ale::Isd *testIsd : isds) {
+    EXPECT_EQ(testIsd->usgscsm_name_model, "USGS_ASTRO_FRAME_SENSOR_MODEL");
+    EXPECT_EQ(testIsd->image_lines, 100);
+    EXPECT_EQ(testIsd->interpMethod, ale::LAGRANGE);
+    ASSERT_DOUBLE_VECTOR_EQ(testIsd->distortion_coefficients, std::vector<double>({0.1, 0.2, 0.3}));
+    EXPECT_STATES_EQ(testIsd->inst_pos, ale::getInstrumentPosition(isdJson));
+    EXPECT_STATES_EQ(testIsd->sun_pos, ale::getSunPosition(isdJson));
+    EXPECT_ORIENTATIONS_EQ(testIsd->inst_pointing, ale::getInstrumentPointing(isdJson));
+    EXPECT_ORIENTATIONS_EQ(testIsd->body_rotation, ale::getBodyRotation(isdJson));
+  }
+  EXPECT_TRUE(isd.inst_pos.hasVelocity());
+  EXPECT_FALSE(isd.sun_pos.hasVelocity());
+}
+
+TEST(Isd, StreamedBadArrays) {
+  std::vector<std::pair<std::string, std::string>> badSections = {
+    {"instrument_position", "Could not parse the instrument position"},
+    {"sun_position", "Could not parse the sun position"},
+    {"instrument_pointing", "Could not parse the instrument pointing"},
+    {"body_rotation", "Could not parse the body rotation"}
+  };
+  std::vector<nlohmann::json> badArrays = {
+    {1.0, 2.0},
+    {{1.0, 2.0}, {3.0, 4.0}},
+    {{1.0, "two", 3.0, 4.0}},
+    {{1.0, {2.0}, 3.0, 4.0}},
+    "not an array"
+  };
+  for (const std::pair<std::string, std::string> &badSection : badSections) {
+    std::string arrayKey = "positions";
+    if (badSection.first == "instrument_pointing" || badSection.first == "body_rotation") {
+      arrayKey = "quaternions";
+    }
+    for (const nlohmann::json &badArray : badArrays) {
+      nlohmann::json isdJson = minimalIsd();
+      isdJson[badSection.first][arrayKey] = badArray;
+      try {
+        ale::Isd isd(isdJson.dump());
+        FAIL() << "Expected an exception to be thrown for " << badSection.first
+               << " with " << badArray.dump();
+      }
+      catch(std::exception &e) {
+        EXPECT_EQ(std::string(e.what()), badSection.second);
+      }
+    }
+
+    nlohmann::json isdJson = minimalIsd();
+    isdJson[badSection.first].erase("ephemeris_times");
+    EXPECT_THROW(ale::Isd(isdJson.dump()), std::runtime_error);
+  }
+}
+
+TEST(Isd, StreamedBadJson) {
+  std::string isdString = minimalIsd().dump();
+  isdString.pop_back();
+  EXPECT_THROW(ale::Isd isd(isdString), nlohmann::json::parse_error);
+}
+
+TEST(Isd, RecordsStats) {
+  nlohmann::json isdJson = minimalIsd();
+  std::string isdString = isdJson.dump();
+  ale::Stats stats;
+  ale::Isd isd(isdString, &stats);
+
+  std::vector<std::string> names;
+  for (const ale::Stats::Stage &stage : stats.stages) {
+    names.push_back(stage.name);
+    EXPECT_GE(stage.seconds, 0);
+  }
+  EXPECT_EQ(names, std::vector<std::string>({"isd.parse", "isd.metadata",
+                                             "isd.instrument_position", "isd.sun_position",
+                                             "isd.instrument_pointing", "isd.body_rotation"}));
+  EXPECT_EQ(stats.getStage("isd.parse").size, isdString.size());
+  EXPECT_EQ(stats.getStage("isd.instrument_position").size, isd.inst_pos.getTimes().size());
+  EXPECT_EQ(stats.getStage("isd.body_rotation").size, isd.body_rotation.getTimes().size());
+  EXPECT_EQ(stats.toJson()["stages"].size(), 6);
+}
+
+TEST(Isd, RecordsStatsOnFailure) {
+  nlohmann::json isdJson = minimalIsd();
+  isdJson["sun_position"]["positions"] = {1.0, 2.0};
+  ale::Stats stats;
+  EXPECT_THROW(ale::Isd isd(isdJson.dump(), &stats), std::runtime_error);
+  ASSERT_FALSE(stats.stages.empty());
+  EXPECT_EQ(stats.stages.back().name, "isd.sun_position");
+  EXPECT_FALSE(stats.hasStage("isd.instrument_pointing"));
+}
+
+TEST(LazyIsd, MatchesIsd) {
+  nlohmann::json isdJson = minimalIsd();
+  // Pretty printed, with escapes in a string, so the index sees whitespace and escapes
+  isdJson["name_sensor"] = "TEST \"SENSOR\" {]";
+  std::string isdString = isdJson.dump(2);
+  ale::Isd isd(isdString);
+  ale::LazyIsd lazyIsd(isdString);
+
+  EXPECT_EQ(lazyIsd.getMetadata().count("instrument_position"), 0);
+  EXPECT_EQ(ale::getTotalLines(lazyIsd.getMetadata()), 100);
+  EXPECT_EQ(ale::getSensorName(lazyIsd.getMetadata()), "TEST \"SENSOR\" {]");
+  EXPECT_DOUBLE_EQ(ale::getCenterTime(lazyIsd.getMetadata()), 11.0);
+
+  std::vector<std::string> sections = {"instrument_position", "sun_position",
+                                       "instrument_pointing", "body_rotation"};
+  for (const std::string &section : sections) {
+    EXPECT_TRUE(lazyIsd.hasSection(section));
+    EXPECT_FALSE(lazyIsd.isLoaded(section));
+  }
+  EXPECT_FALSE(lazyIsd.hasSection("image_lines"));
+
+  EXPECT_STATES_EQ(lazyIsd.getSunPosition(), isd.sun_pos);
+  EXPECT_TRUE(lazyIsd.isLoaded("sun_position"));
+  EXPECT_FALSE(lazyIsd.isLoaded("instrument_position"));
+  EXPECT_STATES_EQ(lazyIsd.getInstrumentPosition(), isd.inst_pos);
+  EXPECT_ORIENTATIONS_EQ(lazyIsd.getInstrumentPointing(), isd.inst_pointing);
+  EXPECT_ORIENTATIONS_EQ(lazyIsd.getBodyRotation(), isd.body_rotation);
+  // Sections are only read once
+  EXPECT_EQ(&lazyIsd.getBodyRotation(), &lazyIsd.getBodyRotation());
+
+  std::istringstream isdStream(isdString);
+  ale::LazyIsd streamedLazyIsd(isdStream);
+  ale::Isd fromLazy(streamedLazyIsd);
+  EXPECT_EQ(fromLazy.name_sensor, isd.name_sensor);
+  EXPECT_EQ(fromLazy.interpMethod, isd.interpMethod);
+  ASSERT_DOUBLE_VECTOR_EQ(fromLazy.distortion_coefficients, isd.distortion_coefficients);
+  EXPECT_STATES_EQ(fromLazy.inst_pos, isd.inst_pos);
+  EXPECT_ORIENTATIONS_EQ(fromLazy.body_rotation, isd.body_rotation);
+}
+
+TEST(LazyIsd, BadSections) {
+  nlohmann::json isdJson = minimalIsd();
+  isdJson.erase("sun_position");
+  isdJson["instrument_pointing"]["quaternions"] = {1.0, 2.0};
+  ale::LazyIsd lazyIsd(isdJson.dump());
+  EXPECT_FALSE(lazyIsd.hasSection("sun_position"));
+  try {
+    lazyIsd.getSunPosition();
+    FAIL() << "Expected an exception to be thrown";
+  }
+  catch(std::runtime_error &e) {
+    EXPECT_EQ(std::string(e.what()), "Could not parse the sun position");
+  }
+  EXPECT_THROW(lazyIsd.getInstrumentPointing(), std::runtime_error);
+  EXPECT_FALSE(lazyIsd.isLoaded("instrument_pointing"));
+  lazyIsd.getInstrumentPosition();
+  EXPECT_THROW(ale::Isd isd(lazyIsd), std::runtime_error);
+}
+
+TEST(LazyIsd, BadJson) {
+  std::string isdString = minimalIsd().dump();
+  EXPECT_THROW(ale::LazyIsd lazyIsd("[1, 2]"), std::runtime_error);
+  EXPECT_THROW(ale::LazyIsd lazyIsd(isdString.substr(0, isdString.size() - 1)), std::runtime_error);
+  EXPECT_THROW(ale::LazyIsd lazyIsd("{\"image_lines\": 1 2}"), std::runtime_error);
+  EXPECT_THROW(ale::LazyIsd lazyIsd("{\"image_lines\": tru}"), nlohmann::json::parse_error);
+  ale::LazyIsd empty(" {} ");
+  EXPECT_TRUE(empty.getMetadata().empty());
+}
+
+TEST(LazyIsd, Threads) {
+  std::string isdString = minimalIsd().dump();
+  ale::Isd isd(isdString);
+  ale::LazyIsd lazyIsd(isdString);
+  std::vector<const ale::Orientations *> pointings(4, nullptr);
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < pointings.size(); i++) {
+    threads.push_back(std::thread([&lazyIsd, &pointings, i]() {
+      pointings[i] = &lazyIsd.getInstrumentPointing();
+      lazyIsd.getBodyRotation();
+    }));
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+  for (const ale::Orientations *pointing : pointings) {
+    EXPECT_EQ(pointing, pointings[0]);
+  }
+  EXPECT_ORIENTATIONS_EQ(*pointings[0], isd.inst_pointing);
+}
+
+TEST(Isd, BinaryIsdRoundTrip) {
+  nlohmann::json isdJson = minimalIsd();
+  isdJson["naif_keywords"]["BODY499_RADII"] = {3396.19, 3396.19, 3376.2};
+  ale::Isd isd(isdJson.dump());
+  isd.naif_keywords = isdJson["naif_keywords"];
+  std::string path = "binary_isd_round_trip.bisd";
+  ale::BinaryIsd::write(isd, path);
+
+  {
+    ale::BinaryIsd binaryIsd(path);
+    EXPECT_EQ(binaryIsd.getMetadata().at("naif_keywords"), isdJson["naif_keywords"]);
+    EXPECT_TRUE(binaryIsd.hasArray("instrument_position", "velocities"));
+    EXPECT_FALSE(binaryIsd.hasArray("sun_position", "velocities"));
+
+    size_t rows, columns;
+    const double *positions = binaryIsd.getArray("instrument_position", "positions", rows, columns);
+    EXPECT_EQ(rows, 3);
+    EXPECT_EQ(columns, 3);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(positions) % alignof(double), 0);
+    EXPECT_DOUBLE_EQ(positions[0], 1.0);
+    EXPECT_DOUBLE_EQ(positions[8], 9.0);
+    EXPECT_THROW(binaryIsd.getArray("instrument_position", "quaternions", rows, columns),
+                 std::invalid_argument);
+
+    ale::Isd readIsd(binaryIsd);
+    EXPECT_EQ(readIsd.usgscsm_name_model, isd.usgscsm_name_model);
+    EXPECT_EQ(readIsd.image_id, isd.image_id);
+    EXPECT_EQ(readIsd.image_lines, isd.image_lines);
+    EXPECT_EQ(readIsd.image_samples, isd.image_samples);
+    EXPECT_DOUBLE_EQ(readIsd.focal_length, isd.focal_length);
+    EXPECT_DOUBLE_EQ(readIsd.detector_center_line, isd.detector_center_line);
+    EXPECT_DOUBLE_EQ(readIsd.semi_major, isd.semi_major);
+    EXPECT_DOUBLE_EQ(readIsd.min_reference_height, isd.min_reference_height);
+    EXPECT_EQ(readIsd.interpMethod, isd.interpMethod);
+    EXPECT_EQ(readIsd.distortion_model, isd.distortion_model);
+    ASSERT_DOUBLE_VECTOR_EQ(readIsd.distortion_coefficients, isd.distortion_coefficients);
+    EXPECT_STATES_EQ(readIsd.inst_pos, isd.inst_pos);
+    EXPECT_STATES_EQ(readIsd.sun_pos, isd.sun_pos);
+    EXPECT_ORIENTATIONS_EQ(readIsd.inst_pointing, isd.inst_pointing);
+    EXPECT_ORIENTATIONS_EQ(readIsd.body_rotation, isd.body_rotation);
+  }
+  std::remove(path.c_str());
+}
+
+TEST(Isd, BinaryIsdDistortion) {
+  std::vector<nlohmann::json> distortions = {
+    {{"transverse", {{"x", {0.0, 1.0, 2.0}}, {"y", {3.0, 4.0}}}}},
+    {{"kaguyalism", {{"x", {1.0, 2.0, 3.0, 4.0}}, {"y", {5.0, 6.0, 7.0, 8.0}},
+                     {"boresight_x", 0.5}, {"boresight_y", -0.5}}}},
+    {{"lunarorbiter", {{"perspective_x", 1.0}, {"perspective_y", 2.0},
+                       {"center_point_x", 3.0}, {"center_point_y", 4.0}}}},
+    {{"dawnfc", {{"coefficients", {1.0}}}}}
+  };
+  std::string path = "binary_isd_distortion.bisd";
+  for (const nlohmann::json &distortion : distortions) {
+    nlohmann::json isdJson = minimalIsd();
+    isdJson["optical_distortion"] = distortion;
+    ale::Isd isd(isdJson.dump());
+    ale::BinaryIsd::write(isd, path);
+    ale::BinaryIsd binaryIsd(path);
+    ale::Isd readIsd(binaryIsd);
+    EXPECT_EQ(readIsd.distortion_model, isd.distortion_model);
+    ASSERT_DOUBLE_VECTOR_EQ(readIsd.distortion_coefficients, isd.distortion_coefficients);
+  }
+  std::remove(path.c_str());
+}
+
+TEST(Isd, BinaryIsdJsonRoundTrip) {
+  nlohmann::json isdJson = minimalIsd();
+  isdJson["naif_keywords"]["BODY499_RADII"] = {3396.19, 3396.19, 3376.2};
+  std::string path = "binary_isd_json_round_trip.bisd";
+  ale::BinaryIsd::write(isdJson, path);
+  {
+    ale::BinaryIsd binaryIsd(path);
+    EXPECT_TRUE(binaryIsd.hasArray("body_rotation", "quaternions"));
+    EXPECT_FALSE(binaryIsd.getMetadata().at("body_rotation").contains("quaternions"));
+    EXPECT_EQ(binaryIsd.toJson(), isdJson);
+  }
+
+  isdJson["instrument_position"]["positions"] = {{1.0, 2.0}, {3.0, 4.0}, {5.0, 6.0}};
+  try {
+    ale::BinaryIsd::write(isdJson, path);
+    FAIL() << "Expected an exception to be thrown";
+  }
+  catch(std::exception &e) {
+    EXPECT_EQ(std::string(e.what()), "Could not write the instrument_position positions array.");
+  }
+  std::remove(path.c_str());
+}
+
+TEST(Isd, BadBinaryIsd) {
+  EXPECT_THROW(ale::BinaryIsd("does_not_exist.bisd"), std::runtime_error);
+
+  std::string path = "bad_binary_isd.bisd";
+  {
+    std::ofstream file(path, std::ios::binary);
+    file << minimalIsd().dump();
+  }
+  try {
+    ale::BinaryIsd binaryIsd(path);
+    FAIL() << "Expected an exception to be thrown";
+  }
+  catch(std::exception &e) {
+    EXPECT_EQ(std::string(e.what()), "The file " + path + " is not a binary ISD.");
+  }
+
+  ale::Isd isd(minimalIsd().dump());
+  ale::BinaryIsd::write(isd, path);
+  std::string contents;
+  {
+    std::ifstream file(path, std::ios::binary);
+    contents.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+  }
+  {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(contents.data(), contents.size() / 2);
+  }
+  EXPECT_THROW(ale::BinaryIsd binaryIsd(path), std::runtime_error);
+
+  contents[8] = 2;
+  {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(contents.data(), contents.size());
+  }
+  try {
+    ale::BinaryIsd binaryIsd(path);
+    FAIL() << "Expected an exception to be thrown";
+  }
+  catch(std::exception &e) {
+    EXPECT_EQ(std::string(e.what()), "Unsupported binary ISD version 2.");
+  }
+  std::remove(path.c_str());
+}
+
+void EXPECT_VEC3D_EQ(const ale::Vec3d &vector, const ale::Vec3d &expected) {
+  EXPECT_DOUBLE_EQ(vector.x, expected.x);
+  EXPECT_DOUBLE_EQ(vector.y, expected.y);
+  EXPECT_DOUBLE_EQ(vector.z, expected.z);
+}
+
+TEST(Isd, GeometryAt) {
+  ale::Isd isd(minimalIsd().dump());
+  // Jumps back and forth and extrapolation on both ends
+  std::vector<double> times = {9.0, 10.0, 10.25, 11.0, 11.5, 12.0, 13.0, 10.5, 11.75};
+
+  std::vector<ale::Isd::Geometry> geometries = isd.geometryAt(times);
+  ASSERT_EQ(geometries.size(), times.size());
+  for (size_t i = 0; i < times.size(); i++) {
+    double time = times[i];
+    const ale::Isd::Geometry &geometry = geometries[i];
+    EXPECT_EQ(geometry.time, time);
+
+    ale::State state = isd.inst_pos.getState(time, isd.interpMethod);
+    EXPECT_VEC3D_EQ(geometry.instrumentState.position, state.position);
+    EXPECT_VEC3D_EQ(geometry.instrumentState.velocity, state.velocity);
+    EXPECT_VEC3D_EQ(geometry.sunPosition, isd.sun_pos.getPosition(time, isd.interpMethod));
+    ASSERT_DOUBLE_VECTOR_EQ(geometry.instrumentPointing.toQuaternion(),
+                            isd.inst_pointing.interpolate(time).toQuaternion());
+    EXPECT_VEC3D_EQ(geometry.instrumentAngularVelocity, isd.inst_pointing.interpolateAV(time));
+    ASSERT_DOUBLE_VECTOR_EQ(geometry.bodyRotation.toQuaternion(),
+                            isd.body_rotation.interpolate(time).toQuaternion());
+    EXPECT_VEC3D_EQ(geometry.bodyAngularVelocity, isd.body_rotation.interpolateAV(time));
+
+    ale::Isd::Geometry single = isd.geometryAt(time);
+    EXPECT_EQ(single.instrumentState.position.x, geometry.instrumentState.position.x);
+    EXPECT_EQ(single.sunPosition.y, geometry.sunPosition.y);
+    EXPECT_EQ(single.bodyRotation.toQuaternion(), geometry.bodyRotation.toQuaternion());
+  }
+}
+
+TEST(Isd, GeometryAtMissingTables) {
+  ale::Isd isd(minimalIsd().dump());
+  isd.sun_pos = ale::States();
+  isd.body_rotation = ale::Orientations(isd.body_rotation.getRotations(), isd.body_rotation.getTimes());
+  ale::Isd::Geometry geometry = isd.geometryAt(11.0);
+  EXPECT_VEC3D_EQ(geometry.sunPosition, ale::Vec3d(0.0, 0.0, 0.0));
+  EXPECT_VEC3D_EQ(geometry.bodyAngularVelocity, ale::Vec3d(0.0, 0.0, 0.0));
+  EXPECT_VEC3D_EQ(geometry.instrumentState.position, isd.inst_pos.getPosition(11.0, isd.interpMethod));
+}
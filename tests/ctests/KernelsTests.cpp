@@ -0,0 +1,377 @@
+#include "gtest/gtest.h"
+
+#include "ale/Kernels.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace ale;
+
+namespace {
+  struct TestSegment {
+    string name;
+    vector<double> doubles;
+    vector<int> ints;
+    vector<double> data;
+  };
+
+  // Encode a double the way DAF transfer files do, as hexadecimal 0.MANTISSA^EXPONENT
+  string encodeDouble(double value) {
+    if (value == 0) {
+      return "'0^0'";
+    }
+    ostringstream stream;
+    stream << "'" << (value < 0 ? "-" : "");
+    int exponent;
+    double mantissa = frexp(fabs(value), &exponent);
+    int hexExponent = exponent >= 0 ? (exponent + 3) / 4 : -((-exponent) / 4);
+    mantissa = ldexp(mantissa, exponent - 4 * hexExponent);
+    const char *digits = "0123456789ABCDEF";
+    for (int i = 0; i < 14 && mantissa > 0; i++) {
+      mantissa *= 16;
+      int digit = static_cast<int>(mantissa);
+      stream << digits[digit];
+      mantissa -= digit;
+    }
+    stream << "^" << (hexExponent < 0 ? "-" : "") << hex << uppercase << abs(hexExponent) << "'";
+    return stream.str();
+  }
+
+  string encodeInt(int value) {
+    ostringstream stream;
+    stream << "'" << (value < 0 ? "-" : "") << hex << uppercase << abs(value) << "'";
+    return stream.str();
+  }
+
+  void writeTransfer(const string &path, const string &type, const vector<TestSegment> &segments) {
+    ofstream file(path);
+    file << "DAFETF NAIF DAF ENCODED TRANSFER FILE\n";
+    file << "'DAF/" << type << string(4 - type.size(), ' ') << "'\n";
+    file << "'2'\n'6'\n";
+    file << "'" << string(60, ' ') << "'\n";
+    for (size_t i = 0; i < segments.size(); i++) {
+      const TestSegment &segment = segments[i];
+      file << "BEGIN_ARRAY " << i + 1 << " " << segment.data.size() << "\n";
+      file << "'" << segment.name << "'\n";
+      for (double value : segment.doubles) {
+        file << encodeDouble(value) << "\n";
+      }
+      for (int value : segment.ints) {
+        file << encodeInt(value) << "\n";
+      }
+      // Use small blocks so that the data spans several of them
+      for (size_t start = 0; start < segment.data.size(); start += 5) {
+        size_t end = min(start + 5, segment.data.size());
+        file << end - start << "\n";
+        for (size_t j = start; j < end; j++) {
+          file << encodeDouble(segment.data[j]) << "\n";
+        }
+      }
+      file << "END_ARRAY " << i + 1 << " " << segment.data.size() << "\n";
+    }
+    file << "TOTAL_ARRAYS " << segments.size() << "\n";
+  }
+
+  void writeBinary(const string &path, const string &type, const vector<TestSegment> &segments) {
+    const size_t recordSize = 1024;
+    vector<char> contents(3 * recordSize, '\0');
+    const uint16_t endianTest = 1;
+    bool littleEndian = *reinterpret_cast<const char *>(&endianTest) == 1;
+
+    string idWord = "DAF/" + type + string(4 - type.size(), ' ');
+    memcpy(&contents[0], idWord.data(), 8);
+    int32_t header[] = {2, 6};
+    memcpy(&contents[8], header, sizeof(header));
+    memset(&contents[16], ' ', 60);
+    int32_t records[] = {2, 2, 0};
+    memcpy(&contents[76], records, sizeof(records));
+    memcpy(&contents[88], littleEndian ? "LTL-IEEE" : "BIG-IEEE", 8);
+
+    double summaryHeader[] = {0, 0, static_cast<double>(segments.size())};
+    memcpy(&contents[recordSize], summaryHeader, sizeof(summaryHeader));
+    for (size_t i = 0; i < segments.size(); i++) {
+      const TestSegment &segment = segments[i];
+      int32_t begin = static_cast<int32_t>(contents.size() / 8 + 1);
+      int32_t end = begin + static_cast<int32_t>(segment.data.size()) - 1;
+      size_t offset = recordSize + 24 + i * 40;
+      memcpy(&contents[offset], segment.doubles.data(), 16);
+      memcpy(&contents[offset + 16], segment.ints.data(), 16);
+      memcpy(&contents[offset + 32], &begin, 4);
+      memcpy(&contents[offset + 36], &end, 4);
+      string name = segment.name + string(40 - segment.name.size(), ' ');
+      memcpy(&contents[2 * recordSize + i * 40], name.data(), 40);
+
+      const char *data = reinterpret_cast<const char *>(segment.data.data());
+      contents.insert(contents.end(), data, data + 8 * segment.data.size());
+      contents.resize((contents.size() + recordSize - 1) / recordSize * recordSize, '\0');
+    }
+
+    ofstream file(path, ios::binary);
+    file.write(contents.data(), contents.size());
+  }
+
+  // x = 1 + 2s + 3T2(s), with the velocity from the derivative
+  vector<double> chebyshevRecord(double midpoint, double radius, double offset) {
+    return {midpoint, radius,
+            1 + offset, 2, 3,
+            -1 + offset, 0, 1,
+            4 + offset, 0.5, 0};
+  }
+
+  vector<TestSegment> spkSegments() {
+    TestSegment type2;
+    type2.name = "TYPE 2";
+    type2.doubles = {0, 200};
+    type2.ints = {-10, 399, 1, 2};
+    type2.data = chebyshevRecord(50, 50, 0);
+    vector<double> second = chebyshevRecord(150, 50, 10);
+    type2.data.insert(type2.data.end(), second.begin(), second.end());
+    type2.data.insert(type2.data.end(), {0, 100, 11, 2});
+
+    TestSegment type3;
+    type3.name = "TYPE 3";
+    type3.doubles = {0, 100};
+    type3.ints = {-20, 399, 1, 3};
+    type3.data = {50, 50,
+                  1, 2, 0,
+                  2, 0, 0,
+                  3, 0, 0,
+                  -1, 0, 0,
+                  -2, 0, 0,
+                  -3, 0, 4,
+                  0, 100, 20, 1};
+
+    // Cubic positions with analytic velocities so window size 2 is exact
+    TestSegment type13;
+    type13.name = "TYPE 13";
+    type13.doubles = {0, 6};
+    type13.ints = {-30, 399, 1, 13};
+    vector<double> epochs = {0, 1, 3, 4, 6};
+    for (double t : epochs) {
+      type13.data.insert(type13.data.end(), {t * t * t - 2 * t, t * t, 5,
+                                             3 * t * t - 2, 2 * t, 0});
+    }
+    type13.data.insert(type13.data.end(), epochs.begin(), epochs.end());
+    type13.data.insert(type13.data.end(), {1, 5});
+
+    // A higher priority segment for part of the type 2 coverage
+    TestSegment override;
+    override.name = "TYPE 2 OVERRIDE";
+    override.doubles = {100, 200};
+    override.ints = {-10, 399, 1, 2};
+    override.data = chebyshevRecord(150, 50, 100);
+    override.data.insert(override.data.end(), {100, 100, 11, 1});
+
+    return {type2, type3, type13, override};
+  }
+
+  vector<TestSegment> ckSegments() {
+    // Type 2 with identity pointing rotating about z at 0.01 radians per
+    // second and 0.5 seconds per tick
+    TestSegment type2;
+    type2.name = "CK TYPE 2";
+    type2.doubles = {0, 300};
+    type2.ints = {-1000, 1, 2, 1};
+    type2.data = {1, 0, 0, 0, 0, 0, 0.01, 0.5,
+                  1, 0, 0, 0, 0, 0, 0.01, 0.5,
+                  0, 200,
+                  100, 300};
+
+    // Type 3 rotating 90 degrees about z between 0 and 100 ticks with a
+    // gap before a second interval at 200 ticks
+    double c = sqrt(0.5);
+    TestSegment type3;
+    type3.name = "CK TYPE 3";
+    type3.doubles = {0, 300};
+    type3.ints = {-2000, 1, 3, 1};
+    type3.data = {1, 0, 0, 0, 0, 0, 0.01,
+                  c, 0, 0, c, 0, 0, 0.03,
+                  c, 0, 0, c, 0, 0, 0,
+                  0, 0, 0, 1, 0, 0, 0,
+                  0, 100, 200, 300,
+                  0, 200,
+                  2, 4};
+    return {type2, type3};
+  }
+
+  class KernelsTest : public ::testing::Test {
+    protected:
+      void SetUp() override {
+        writeTransfer(spkTransfer, "SPK", spkSegments());
+        writeBinary(spkBinary, "SPK", spkSegments());
+        writeTransfer(ckTransfer, "CK", ckSegments());
+        writeBinary(ckBinary, "CK", ckSegments());
+      }
+
+      void TearDown() override {
+        remove(spkTransfer.c_str());
+        remove(spkBinary.c_str());
+        remove(ckTransfer.c_str());
+        remove(ckBinary.c_str());
+      }
+
+      string spkTransfer = "kernels_test.xsp";
+      string spkBinary = "kernels_test.bsp";
+      string ckTransfer = "kernels_test.xc";
+      string ckBinary = "kernels_test.bc";
+  };
+}
+
+TEST_F(KernelsTest, ReadDaf) {
+  vector<TestSegment> expected = spkSegments();
+  for (const string &path : {spkTransfer, spkBinary}) {
+    DafFile daf(path);
+    EXPECT_EQ(daf.getType(), "SPK");
+    ASSERT_EQ(daf.getSegments().size(), expected.size());
+    for (size_t i = 0; i < expected.size(); i++) {
+      const DafSegment &segment = daf.getSegments()[i];
+      EXPECT_EQ(segment.name, expected[i].name);
+      EXPECT_EQ(segment.doubleSummary, expected[i].doubles);
+      EXPECT_EQ(segment.intSummary, expected[i].ints);
+      EXPECT_EQ(segment.data, expected[i].data);
+    }
+  }
+  EXPECT_EQ(DafFile(ckBinary).getType(), "CK");
+  EXPECT_THROW(DafFile("does_not_exist.bsp"), runtime_error);
+  EXPECT_THROW(Spk spk(ckTransfer), invalid_argument);
+}
+
+TEST_F(KernelsTest, SpkType2) {
+  Spk spk(spkBinary);
+  // s = 0.5 in the first record
+  State state = spk.getState(-10, 75);
+  EXPECT_DOUBLE_EQ(state.position.x, 0.5);
+  EXPECT_DOUBLE_EQ(state.position.y, -1.5);
+  EXPECT_DOUBLE_EQ(state.position.z, 4.25);
+  EXPECT_DOUBLE_EQ(state.velocity.x, 8.0 / 50);
+  EXPECT_DOUBLE_EQ(state.velocity.y, 2.0 / 50);
+  EXPECT_DOUBLE_EQ(state.velocity.z, 0.5 / 50);
+
+  // The override segment covers the second record
+  state = spk.getState(-10, 150);
+  EXPECT_DOUBLE_EQ(state.position.x, 98);
+  state = spk.getSegments()[0].getState(150);
+  EXPECT_DOUBLE_EQ(state.position.x, 8);
+  EXPECT_THROW(spk.getState(-10, 250), invalid_argument);
+  EXPECT_THROW(spk.getState(-99, 50), invalid_argument);
+
+  DafSegment unsupported;
+  unsupported.name = "TYPE 1";
+  unsupported.doubleSummary = {0, 100};
+  unsupported.intSummary = {-10, 399, 1, 1};
+  SpkSegment segment(unsupported);
+  EXPECT_THROW(segment.getState(50), invalid_argument);
+}
+
+TEST_F(KernelsTest, SpkType3) {
+  Spk spk(spkTransfer);
+  State state = spk.getState(-20, 75);
+  EXPECT_DOUBLE_EQ(state.position.x, 2);
+  EXPECT_DOUBLE_EQ(state.position.y, 2);
+  EXPECT_DOUBLE_EQ(state.position.z, 3);
+  EXPECT_DOUBLE_EQ(state.velocity.x, -1);
+  EXPECT_DOUBLE_EQ(state.velocity.y, -2);
+  EXPECT_DOUBLE_EQ(state.velocity.z, -3 + 4 * (2 * 0.25 - 1));
+}
+
+TEST_F(KernelsTest, SpkType13) {
+  Spk spk(spkTransfer);
+  for (double t : {0.0, 0.5, 2.0, 3.0, 4.5, 6.0}) {
+    State state = spk.getState(-30, t);
+    EXPECT_NEAR(state.position.x, t * t * t - 2 * t, 1e-12) << t;
+    EXPECT_NEAR(state.position.y, t * t, 1e-12) << t;
+    EXPECT_NEAR(state.position.z, 5, 1e-12) << t;
+    EXPECT_NEAR(state.velocity.x, 3 * t * t - 2, 1e-12) << t;
+    EXPECT_NEAR(state.velocity.y, 2 * t, 1e-12) << t;
+    EXPECT_NEAR(state.velocity.z, 0, 1e-12) << t;
+  }
+}
+
+TEST_F(KernelsTest, SpkGetStates) {
+  Spk spk(spkTransfer);
+  States states = spk.getStates(-30, {1.0, 2.0, 5.0});
+  EXPECT_EQ(states.getReferenceFrame(), 1);
+  EXPECT_TRUE(states.hasVelocity());
+  ASSERT_EQ(states.getStates().size(), 3);
+  EXPECT_NEAR(states.getPosition(2.0).x, 4, 1e-12);
+  EXPECT_NEAR(states.getStates()[2].position.y, 25, 1e-12);
+}
+
+TEST_F(KernelsTest, CkType2) {
+  Ck ck(ckTransfer);
+  const CkSegment &segment = ck.getSegments()[0];
+  EXPECT_EQ(segment.getType(), 2);
+  EXPECT_TRUE(segment.contains(50));
+  EXPECT_FALSE(segment.contains(150));
+  EXPECT_TRUE(segment.contains(250));
+
+  Vec3d av;
+  Rotation rotation = ck.getRotation(-1000, 60, &av);
+  EXPECT_DOUBLE_EQ(av.z, 0.01);
+  Vec3d rotated = rotation(Vec3d(1, 0, 0));
+  EXPECT_NEAR(rotated.x, cos(0.3), 1e-12);
+  EXPECT_NEAR(rotated.y, -sin(0.3), 1e-12);
+  EXPECT_NEAR(rotated.z, 0, 1e-12);
+
+  rotated = ck.getRotation(-1000, 210)(Vec3d(1, 0, 0));
+  EXPECT_NEAR(rotated.x, cos(0.05), 1e-12);
+  EXPECT_THROW(ck.getRotation(-1000, 150), invalid_argument);
+}
+
+TEST_F(KernelsTest, CkType3) {
+  Ck ck(ckBinary);
+  const CkSegment &segment = ck.getSegments()[1];
+  EXPECT_EQ(segment.getType(), 3);
+  EXPECT_TRUE(segment.hasAngularVelocity());
+  EXPECT_TRUE(segment.contains(100));
+  EXPECT_FALSE(segment.contains(150));
+  EXPECT_TRUE(segment.contains(200));
+
+  Vec3d av;
+  Rotation rotation = ck.getRotation(-2000, 50, &av);
+  EXPECT_NEAR(av.z, 0.02, 1e-12);
+  Vec3d rotated = rotation(Vec3d(1, 0, 0));
+  EXPECT_NEAR(rotated.x, cos(M_PI / 4), 1e-12);
+  EXPECT_NEAR(rotated.y, sin(M_PI / 4), 1e-12);
+  EXPECT_NEAR(rotated.z, 0, 1e-12);
+
+  rotated = ck.getRotation(-2000, 100)(Vec3d(1, 0, 0));
+  EXPECT_NEAR(rotated.y, 1, 1e-12);
+  EXPECT_THROW(ck.getRotation(-2000, 150), invalid_argument);
+}
+
+TEST_F(KernelsTest, CkGetOrientations) {
+  Ck ck(ckTransfer);
+  Orientations orientations = ck.getOrientations(-2000, {1000, 1025, 1050}, {0, 25, 50});
+  EXPECT_EQ(orientations.getTimeDependentFrames(), vector<int>({-2000, 1}));
+  ASSERT_EQ(orientations.getAngularVelocities().size(), 3);
+  EXPECT_NEAR(orientations.getAngularVelocities()[1].z, 0.015, 1e-12);
+  Vec3d rotated = orientations.interpolate(1025)(Vec3d(1, 0, 0));
+  EXPECT_NEAR(rotated.x, cos(M_PI / 8), 1e-12);
+  EXPECT_THROW(ck.getOrientations(-2000, {0, 1}, {0}), invalid_argument);
+}
+
+TEST(Kernels, SlicedTransferSpk) {
+  Spk spk("../pytests/data/PSP_001446_1790_BG12_0/PSP_001446_1790_BG12_0.spice_0.xsp");
+  ASSERT_EQ(spk.getSegments().size(), 4);
+  EXPECT_EQ(spk.getSegments()[0].getType(), 13);
+  for (const SpkSegment &segment : spk.getSegments()) {
+    if (segment.getType() != 2 && segment.getType() != 3 && segment.getType() != 13) {
+      continue;
+    }
+    double time = (segment.getStartTime() + segment.getStopTime()) / 2;
+    State before = segment.getState(time - 0.5);
+    State after = segment.getState(time + 0.5);
+    State state = segment.getState(time);
+    Vec3d difference = after.position - before.position - state.velocity;
+    EXPECT_LT(difference.norm(), 1e-6 * state.velocity.norm()) << segment.getTarget();
+  }
+}
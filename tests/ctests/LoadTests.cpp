@@ -6,6 +6,8 @@
 #include <nlohmann/json.hpp>
 
 #include <stdexcept>
+#include <thread>
+#include <vector>
 
 using json = nlohmann::json;
 using namespace std;
@@ -17,6 +19,19 @@ TEST(PyInterfaceTest, LoadInvalidLabel) {
 }
 
 
+TEST(PyInterfaceTest, LoadInvalidLabelStats) {
+  std::string label = "Not a Real Label";
+  ale::Stats stats;
+  EXPECT_THROW(ale::load(label, "", "ale", false, false, false, &stats), invalid_argument);
+  EXPECT_TRUE(stats.hasStage("load.session"));
+  EXPECT_TRUE(stats.hasStage("load.python"));
+  EXPECT_FALSE(stats.hasStage("load.json_parse"));
+  ASSERT_TRUE(stats.python.contains("drivers"));
+  EXPECT_FALSE(stats.python["drivers"].empty());
+  EXPECT_FALSE(stats.python["drivers"][0]["error"].is_null());
+}
+
+
 TEST(PyInterfaceTest, LoadValidLabel) {
   std::string label = "../pytests/data/EN1072174528M/EN1072174528M_spiceinit.lbl";
   ale::load(label, "", "isis");
@@ -36,4 +51,66 @@ TEST(PyInterfaceTest, LoadValidLabelOnlyNaifSpice) {
   catch (exception &e) {
     EXPECT_THAT(e.what(), HasSubstr("No Valid instrument found for label."));
   }
-}
\ No newline at end of file
+}
+
+TEST(PyInterfaceTest, LoadSessionThreads) {
+  std::string label = "Not a Real Label";
+  std::vector<int> invalidCounts(4, 0);
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < invalidCounts.size(); i++) {
+    threads.push_back(std::thread([&label, &invalidCounts, i]() {
+      for (int j = 0; j < 3; j++) {
+        try {
+          ale::LoadSession::instance().load(label);
+        }
+        catch (invalid_argument &e) {
+          invalidCounts[i]++;
+        }
+        catch (...) { }
+      }
+    }));
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+  for (int invalidCount : invalidCounts) {
+    EXPECT_EQ(invalidCount, 3);
+  }
+}
+
+TEST(PyInterfaceTest, LoadManyLabels) {
+  std::vector<std::string> labels = {"../pytests/data/EN1072174528M/EN1072174528M_spiceinit.lbl",
+                                     "Not a Real Label"};
+  std::vector<size_t> indices;
+  std::vector<std::string> errors;
+  ale::Stats stats;
+  ale::loadMany(labels, [&](size_t index, const json &isd, const std::string &error) {
+    indices.push_back(index);
+    errors.push_back(error);
+    EXPECT_EQ(isd.is_null(), !error.empty());
+  }, "", "isis", false, false, false, &stats);
+  ASSERT_EQ(indices, std::vector<size_t>({0, 1}));
+  EXPECT_TRUE(errors[0].empty());
+  EXPECT_FALSE(errors[1].empty());
+  EXPECT_TRUE(stats.hasStage("load.python"));
+  EXPECT_TRUE(stats.hasStage("load.to_json"));
+  ASSERT_TRUE(stats.python.contains("labels"));
+  EXPECT_EQ(stats.python["labels"].size(), 2);
+
+  json single = ale::load(labels[0], "", "isis", false);
+  std::vector<json> isds = ale::loadMany(labels, "", "isis", false);
+  ASSERT_EQ(isds.size(), 2);
+  EXPECT_EQ(isds[0], single);
+  EXPECT_TRUE(isds[1].is_null());
+}
+
+
+TEST(PyInterfaceTest, LoadManyCallbackThrows) {
+  std::vector<std::string> labels(3, "Not a Real Label");
+  int calls = 0;
+  EXPECT_THROW(ale::loadMany(labels, [&calls](size_t, const json &, const std::string &) {
+    calls++;
+    throw logic_error("Stop");
+  }, "", "ale", false), logic_error);
+  EXPECT_EQ(calls, 1);
+}
@@ -1,7 +1,9 @@
 #include "gtest/gtest.h"
 
 #include "ale/Orientations.h"
+#include "ale/ThreadPool.h"
 
+#include <algorithm>
 #include <cmath>
 #include <exception>
 
@@ -180,6 +182,96 @@ TEST_F(OrientationTest, RotateAt) {
   EXPECT_NEAR(rotatedZ.z, 0.0, 1e-10);
 }
 
+TEST_F(ConstOrientationTest, Cursor) {
+  Orientations::Cursor cursor(constOrientations);
+  vector<double> interpTimes = {-1.0, 0.25, 1.0, 2.0, 3.5, 5.0, 0.5};
+  Vec3d testVector(1.0, 2.0, 3.0);
+  State testState({1.0, 2.0, 3.0, 4.0, 5.0, 6.0});
+  for (double time : interpTimes) {
+    vector<double> quat = cursor.interpolate(time).toQuaternion();
+    vector<double> expectedQuat = constOrientations.interpolate(time).toQuaternion();
+    for (size_t i = 0; i < 4; i++) {
+      EXPECT_DOUBLE_EQ(quat[i], expectedQuat[i]);
+    }
+
+    Vec3d av = cursor.interpolateAV(time);
+    Vec3d expectedAv = constOrientations.interpolateAV(time);
+    EXPECT_DOUBLE_EQ(av.x, expectedAv.x);
+    EXPECT_DOUBLE_EQ(av.y, expectedAv.y);
+    EXPECT_DOUBLE_EQ(av.z, expectedAv.z);
+
+    Vec3d rotatedVector = cursor.rotateVectorAt(time, testVector, SLERP, true);
+    Vec3d expectedVector = constOrientations.rotateVectorAt(time, testVector, SLERP, true);
+    EXPECT_DOUBLE_EQ(rotatedVector.x, expectedVector.x);
+    EXPECT_DOUBLE_EQ(rotatedVector.y, expectedVector.y);
+    EXPECT_DOUBLE_EQ(rotatedVector.z, expectedVector.z);
+
+    State rotatedState = cursor.rotateStateAt(time, testState, NLERP);
+    State expectedState = constOrientations.rotateStateAt(time, testState, NLERP);
+    EXPECT_DOUBLE_EQ(rotatedState.position.x, expectedState.position.x);
+    EXPECT_DOUBLE_EQ(rotatedState.position.y, expectedState.position.y);
+    EXPECT_DOUBLE_EQ(rotatedState.position.z, expectedState.position.z);
+    EXPECT_DOUBLE_EQ(rotatedState.velocity.x, expectedState.velocity.x);
+    EXPECT_DOUBLE_EQ(rotatedState.velocity.y, expectedState.velocity.y);
+    EXPECT_DOUBLE_EQ(rotatedState.velocity.z, expectedState.velocity.z);
+  }
+}
+
+TEST_F(NoAVOrientationTest, CursorInterpolateAv) {
+  Orientations::Cursor cursor(noAvOrientations);
+  EXPECT_THROW(cursor.interpolateAV(0.25), invalid_argument);
+}
+
+TEST_F(ConstOrientationTest, InterpolateBatch) {
+  vector<double> interpTimes = {-1.0, 0.25, 0.5, 1.0, 2.0, 3.5, 5.0, 0.75};
+  vector<RotationInterpolation> interpTypes = {SLERP, NLERP};
+  for (RotationInterpolation interpType : interpTypes) {
+    vector<Rotation> interpRotations = constOrientations.interpolate(interpTimes, interpType);
+    ASSERT_EQ(interpRotations.size(), interpTimes.size());
+    for (size_t i = 0; i < interpTimes.size(); i++) {
+      vector<double> quat = interpRotations[i].toQuaternion();
+      vector<double> expectedQuat = constOrientations.interpolate(interpTimes[i], interpType).toQuaternion();
+      for (size_t j = 0; j < 4; j++) {
+        EXPECT_NEAR(quat[j], expectedQuat[j], 1e-14);
+      }
+    }
+  }
+}
+
+TEST_F(ConstOrientationTest, RotateAtBatch) {
+  vector<double> interpTimes = {-1.0, 0.25, 1.0, 2.0, 3.5, 5.0};
+  vector<Vec3d> testVectors;
+  vector<State> testStates;
+  for (size_t i = 0; i < interpTimes.size(); i++) {
+    testVectors.push_back(Vec3d(1.0 + i, 2.0, 3.0));
+    testStates.push_back(State(Vec3d(1.0, 2.0 + i, 3.0), Vec3d(4.0, 5.0, 6.0)));
+  }
+
+  vector<Vec3d> rotatedVectors = constOrientations.rotateVectorsAt(interpTimes, testVectors, SLERP, true);
+  vector<State> rotatedStates = constOrientations.rotateStatesAt(interpTimes, testStates);
+  ASSERT_EQ(rotatedVectors.size(), interpTimes.size());
+  ASSERT_EQ(rotatedStates.size(), interpTimes.size());
+  for (size_t i = 0; i < interpTimes.size(); i++) {
+    Vec3d expectedVector = constOrientations.rotateVectorAt(interpTimes[i], testVectors[i], SLERP, true);
+    EXPECT_NEAR(rotatedVectors[i].x, expectedVector.x, 1e-12);
+    EXPECT_NEAR(rotatedVectors[i].y, expectedVector.y, 1e-12);
+    EXPECT_NEAR(rotatedVectors[i].z, expectedVector.z, 1e-12);
+
+    State expectedState = constOrientations.rotateStateAt(interpTimes[i], testStates[i]);
+    EXPECT_NEAR(rotatedStates[i].position.x, expectedState.position.x, 1e-12);
+    EXPECT_NEAR(rotatedStates[i].position.y, expectedState.position.y, 1e-12);
+    EXPECT_NEAR(rotatedStates[i].position.z, expectedState.position.z, 1e-12);
+    EXPECT_NEAR(rotatedStates[i].velocity.x, expectedState.velocity.x, 1e-12);
+    EXPECT_NEAR(rotatedStates[i].velocity.y, expectedState.velocity.y, 1e-12);
+    EXPECT_NEAR(rotatedStates[i].velocity.z, expectedState.velocity.z, 1e-12);
+  }
+
+  vector<Vec3d> tooFewVectors(testVectors.begin(), testVectors.end() - 1);
+  EXPECT_THROW(constOrientations.rotateVectorsAt(interpTimes, tooFewVectors), invalid_argument);
+  vector<State> tooFewStates(testStates.begin(), testStates.end() - 1);
+  EXPECT_THROW(constOrientations.rotateStatesAt(interpTimes, tooFewStates), invalid_argument);
+}
+
 TEST_F(OrientationTest, RotationMultiplication) {
   vector<Rotation> originalRotations = orientations.getRotations();
   vector<double> originalConstQuats = orientations.getConstantRotation().toQuaternion();
@@ -375,3 +467,233 @@ TEST_F(SingleOrientationTest, extrapolate) {
     EXPECT_NEAR(quat[2], 0.5, 1e-10);
     EXPECT_NEAR(quat[3], 0.5, 1e-10);
 }
+
+TEST_F(SingleOrientationTest, extrapolateBatch) {
+  vector<double> interpTimes = {-1.0, 2.0};
+  vector<Rotation> interpRotations = orientations.interpolate(interpTimes);
+  ASSERT_EQ(interpRotations.size(), 2);
+  for (size_t i = 0; i < interpTimes.size(); i++) {
+    vector<double> quat = interpRotations[i].toQuaternion();
+    vector<double> expectedQuat = orientations.interpolate(interpTimes[i]).toQuaternion();
+    for (size_t j = 0; j < 4; j++) {
+      EXPECT_DOUBLE_EQ(quat[j], expectedQuat[j]);
+    }
+  }
+}
+
+TEST(Orientations, MinimizeCacheConstantRate) {
+  // A constant rate rotation is reproduced exactly by slerp between the end points
+  vector<Rotation> rotations;
+  vector<double> times;
+  vector<Vec3d> avs;
+  for (int i = 0; i <= 50; i++) {
+    rotations.push_back(Rotation({0, 0, 1}, 0.01 * i));
+    times.push_back(i);
+    avs.push_back(Vec3d(0, 0, 0.01));
+  }
+  Orientations orientations(rotations, times, avs, Rotation({1, 0, 0}, 0.5), {-100, -101}, {-101, 1});
+  CacheReduction report;
+  Orientations minimized = orientations.minimizeCache(1e-9, &report);
+
+  vector<double> minimizedTimes = minimized.getTimes();
+  ASSERT_EQ(minimizedTimes.size(), 3);
+  EXPECT_EQ(minimizedTimes[0], 0);
+  EXPECT_EQ(minimizedTimes[1], 25);
+  EXPECT_EQ(minimizedTimes[2], 50);
+  EXPECT_EQ(minimized.getAngularVelocities().size(), 3);
+  EXPECT_EQ(minimized.getConstantFrames(), orientations.getConstantFrames());
+  EXPECT_EQ(minimized.getTimeDependentFrames(), orientations.getTimeDependentFrames());
+  EXPECT_EQ(report.originalSize, 51);
+  EXPECT_EQ(report.reducedSize, 3);
+  EXPECT_LT(report.maxError, 1e-9);
+}
+
+TEST(Orientations, MinimizeCacheWithinTolerance) {
+  vector<Rotation> rotations;
+  vector<double> times;
+  for (int i = 0; i <= 200; i++) {
+    rotations.push_back(Rotation({0, 0, 1}, 0.0001 * i * i) * Rotation({1, 0, 0}, 0.2 * sin(0.01 * i)));
+    times.push_back(i);
+  }
+  Orientations orientations(rotations, times);
+  double tolerance = 1e-3;
+  CacheReduction report;
+  Orientations minimized = orientations.minimizeCache(tolerance, &report);
+
+  EXPECT_LT(report.reducedSize, report.originalSize);
+  EXPECT_EQ(minimized.getTimes().size(), report.reducedSize);
+  EXPECT_LT(report.maxError, tolerance);
+  for (size_t i = 0; i < times.size(); i++) {
+    vector<double> quat = (minimized.interpolate(times[i]).inverse() * rotations[i]).toQuaternion();
+    EXPECT_LT(2 * acos(min(1.0, fabs(quat[0]))), tolerance * 1.01);
+  }
+
+  Orientations tooSmall({Rotation(1, 0, 0, 0), Rotation(0, 1, 0, 0)}, {0, 1});
+  EXPECT_THROW(tooSmall.minimizeCache(), invalid_argument);
+}
+
+TEST(Orientations, MultiplicationInterleavedTimes) {
+  vector<Rotation> lhsRotations;
+  vector<double> lhsTimes;
+  vector<Vec3d> lhsAvs;
+  for (int i = 0; i <= 10; i++) {
+    lhsRotations.push_back(Rotation({0, 0, 1}, 0.1 * i));
+    lhsTimes.push_back(i);
+    lhsAvs.push_back(Vec3d(0, 0, 0.1));
+  }
+  vector<Rotation> rhsRotations;
+  vector<double> rhsTimes;
+  vector<Vec3d> rhsAvs;
+  for (int i = 0; i <= 8; i++) {
+    rhsRotations.push_back(Rotation({1, 0, 0}, 0.05 * i));
+    rhsTimes.push_back(-1.5 + 1.5 * i);
+    rhsAvs.push_back(Vec3d(0.05 / 1.5, 0, 0));
+  }
+  Rotation lhsConst({0, 1, 0}, 0.3);
+  Orientations lhs(lhsRotations, lhsTimes, lhsAvs, lhsConst);
+  Orientations rhs(rhsRotations, rhsTimes, rhsAvs);
+  Orientations combined = lhs * rhs;
+
+  vector<double> combinedTimes = combined.getTimes();
+  ASSERT_EQ(combinedTimes.size(), 16);
+  EXPECT_TRUE(std::is_sorted(combinedTimes.begin(), combinedTimes.end()));
+  EXPECT_EQ(combinedTimes.front(), -1.5);
+  EXPECT_EQ(combinedTimes.back(), 10.5);
+
+  vector<Rotation> combinedRotations = combined.getRotations();
+  vector<Vec3d> combinedAvs = combined.getAngularVelocities();
+  ASSERT_EQ(combinedAvs.size(), combinedTimes.size());
+  for (size_t i = 0; i < combinedTimes.size(); i++) {
+    double time = combinedTimes[i];
+    Rotation rhsRot = rhs.interpolate(time);
+    vector<double> expected = (lhsConst.inverse() * lhs.interpolate(time) * rhsRot).toQuaternion();
+    vector<double> actual = combinedRotations[i].toQuaternion();
+    for (size_t j = 0; j < 4; j++) {
+      EXPECT_NEAR(actual[j], expected[j], 1e-12) << "Time " << time;
+    }
+    Vec3d expectedAv = rhsRot.inverse()(lhs.interpolateAV(time)) + rhs.interpolateAV(time);
+    EXPECT_NEAR(combinedAvs[i].x, expectedAv.x, 1e-12) << "Time " << time;
+    EXPECT_NEAR(combinedAvs[i].y, expectedAv.y, 1e-12) << "Time " << time;
+    EXPECT_NEAR(combinedAvs[i].z, expectedAv.z, 1e-12) << "Time " << time;
+  }
+}
+
+
+TEST(Orientations, ThreadPoolMatchesSerial) {
+  vector<Rotation> rotations;
+  vector<double> times;
+  vector<Vec3d> avs;
+  for (int i = 0; i < 100; i++) {
+    times.push_back(i);
+    rotations.push_back(Rotation({0, 0, 1}, 0.02 * i) * Rotation({1, 0, 0}, 0.1 * sin(0.05 * i)));
+    avs.push_back(Vec3d(0, 0, 0.02));
+  }
+  Orientations orientations(rotations, times, avs, Rotation({0, 1, 0}, 0.3));
+
+  vector<double> sampleTimes;
+  vector<Vec3d> vectors;
+  vector<State> states;
+  for (int i = 0; i < 3000; i++) {
+    sampleTimes.push_back(99.0 * ((i * 7919) % 3000) / 3000.0);
+    vectors.push_back(Vec3d(1, 2, i));
+    states.push_back(State(Vec3d(1, 2, i), Vec3d(0.5, 0, -1)));
+  }
+
+  ThreadPool pool(4);
+  vector<Rotation> expectedRotations = orientations.interpolate(sampleTimes, SLERP);
+  vector<Rotation> actualRotations = orientations.interpolate(sampleTimes, SLERP, pool);
+  vector<Rotation> expectedTimeDep = orientations.interpolateTimeDep(sampleTimes, SLERP);
+  vector<Rotation> actualTimeDep = orientations.interpolateTimeDep(sampleTimes, SLERP, pool);
+  vector<Vec3d> expectedVectors = orientations.rotateVectorsAt(sampleTimes, vectors, SLERP, true);
+  vector<Vec3d> actualVectors = orientations.rotateVectorsAt(sampleTimes, vectors, SLERP, true, pool);
+  vector<State> expectedStates = orientations.rotateStatesAt(sampleTimes, states);
+  vector<State> actualStates = orientations.rotateStatesAt(sampleTimes, states, SLERP, false, pool);
+  ASSERT_EQ(actualRotations.size(), sampleTimes.size());
+  ASSERT_EQ(actualTimeDep.size(), sampleTimes.size());
+  ASSERT_EQ(actualVectors.size(), sampleTimes.size());
+  ASSERT_EQ(actualStates.size(), sampleTimes.size());
+  for (size_t i = 0; i < sampleTimes.size(); i++) {
+    EXPECT_EQ(actualRotations[i].toQuaternion(), expectedRotations[i].toQuaternion());
+    EXPECT_EQ(actualTimeDep[i].toQuaternion(), expectedTimeDep[i].toQuaternion());
+    EXPECT_EQ(actualVectors[i].x, expectedVectors[i].x);
+    EXPECT_EQ(actualStates[i].position.y, expectedStates[i].position.y);
+    EXPECT_EQ(actualStates[i].velocity.z, expectedStates[i].velocity.z);
+  }
+
+  EXPECT_THROW(orientations.rotateStatesAt(sampleTimes, vector<State>(1), SLERP, false, pool),
+               invalid_argument);
+}
+
+
+TEST(Orientations, SliceMatchesParent) {
+  vector<Rotation> rotations;
+  vector<double> times;
+  vector<Vec3d> avs;
+  for (int i = 0; i < 100; i++) {
+    times.push_back(i);
+    rotations.push_back(Rotation({0, 0, 1}, 0.02 * i) * Rotation({1, 0, 0}, 0.1 * sin(0.05 * i)));
+    avs.push_back(Vec3d(0, 0, 0.02 * i));
+  }
+  Orientations orientations(rotations, times, avs, Rotation({0, 1, 0}, 0.3), {-100, -101}, {-101, 1});
+
+  Orientations::View view = orientations.slice(40.5, 55.25);
+  EXPECT_EQ(view.getStartIndex(), 40);
+  EXPECT_EQ(view.size(), 17);
+  EXPECT_EQ(view.getTimes().front(), 40);
+  EXPECT_EQ(view.getTimes().back(), 56);
+  EXPECT_EQ(view.getAngularVelocities().size(), 17);
+
+  vector<double> sampleTimes;
+  for (int i = 0; i <= 60; i++) {
+    sampleTimes.push_back(40.5 + 0.25 * i);
+  }
+  vector<Rotation> actualRotations = view.interpolate(sampleTimes, SLERP);
+  ASSERT_EQ(actualRotations.size(), sampleTimes.size());
+  State state(Vec3d(1, 2, 3), Vec3d(0.5, 0, -1));
+  for (size_t i = 0; i < sampleTimes.size(); i++) {
+    double time = sampleTimes[i];
+    EXPECT_EQ(actualRotations[i].toQuaternion(), orientations.interpolate(time).toQuaternion());
+    EXPECT_EQ(view.interpolateTimeDep(time, NLERP).toQuaternion(),
+              orientations.interpolateTimeDep(time, NLERP).toQuaternion());
+    EXPECT_EQ(view.interpolateAV(time).z, orientations.interpolateAV(time).z);
+    EXPECT_EQ(view.rotateVectorAt(time, state.position, SLERP, true).x,
+              orientations.rotateVectorAt(time, state.position, SLERP, true).x);
+    State expectedState = orientations.rotateStateAt(time, state);
+    State actualState = view.rotateStateAt(time, state);
+    EXPECT_EQ(actualState.position.y, expectedState.position.y);
+    EXPECT_EQ(actualState.velocity.z, expectedState.velocity.z);
+  }
+
+  // Outside of the window the view extrapolates from its own ends
+  Orientations copy = view.toOrientations();
+  EXPECT_EQ(copy.getConstantFrames(), vector<int>({-100, -101}));
+  EXPECT_EQ(copy.getTimeDependentFrames(), vector<int>({-101, 1}));
+  EXPECT_EQ(view.interpolate(10).toQuaternion(), copy.interpolate(10).toQuaternion());
+  EXPECT_EQ(view.interpolateAV(90).z, copy.interpolateAV(90).z);
+}
+
+
+TEST(Orientations, SliceEdges) {
+  Orientations orientations({Rotation(), Rotation({1, 0, 0}, 0.5)}, {0, 1});
+  Orientations::View all = orientations.slice(-10, 10);
+  EXPECT_EQ(all.getStartIndex(), 0);
+  EXPECT_EQ(all.size(), 2);
+  EXPECT_TRUE(all.getAngularVelocities().empty());
+  EXPECT_THROW(all.interpolateAV(0.5), invalid_argument);
+
+  Orientations::View last = orientations.slice(1, 1);
+  EXPECT_EQ(last.getStartIndex(), 0);
+  EXPECT_EQ(last.size(), 2);
+
+  EXPECT_THROW(orientations.slice(1, 0), invalid_argument);
+  EXPECT_THROW(Orientations().slice(0, 1), invalid_argument);
+}
+
+
+TEST_F(OrientationTest, AccessorsDoNotCopy) {
+  EXPECT_EQ(&orientations.getTimes(), &orientations.getTimes());
+  EXPECT_EQ(&orientations.getRotations(), &orientations.getRotations());
+  EXPECT_EQ(&orientations.getAngularVelocities(), &orientations.getAngularVelocities());
+  EXPECT_EQ(orientations.getTimes(), times);
+  EXPECT_EQ(orientations.getRotations()[1].toQuaternion(), rotations[1].toQuaternion());
+}
@@ -373,6 +373,16 @@ TEST(RotationTest, MultiplyRotation) {
   EXPECT_NEAR(quat[3],  0.5, 1e-10);
 }
 
+TEST(RotationTest, AngleTo) {
+  Rotation rotation({1, 2, 3}, 0.3);
+  EXPECT_NEAR(rotation.angleTo(Rotation({1, 2, 3}, 0.8)), 0.5, 1e-12);
+  EXPECT_NEAR(Rotation().angleTo(Rotation({0, 0, 1}, 1e-9)), 1e-9, 1e-20);
+  // Negating the quaternion is the same rotation
+  vector<double> quat = rotation.toQuaternion();
+  EXPECT_NEAR(rotation.angleTo(Rotation(-quat[0], -quat[1], -quat[2], -quat[3])), 0, 1e-15);
+  EXPECT_NEAR(rotation.angleTo(rotation * Rotation({0, 1, 0}, M_PI)), M_PI, 1e-12);
+}
+
 TEST(RotationTest, Slerp) {
   Rotation rotationOne(0.5, 0.5, 0.5, 0.5);
   Rotation rotationTwo(-0.5, 0.5, 0.5, 0.5);
@@ -422,3 +432,106 @@ TEST(RotationTest, NlerpExtrapolate) {
   EXPECT_NEAR(quat[2], 1.0 / 2.0 * scaling, 1e-10);
   EXPECT_NEAR(quat[3], 1.0 / 2.0 * scaling, 1e-10);
 }
+
+TEST(RotationTest, ValueSemantics) {
+  Rotation rotation(0.5, 0.5, 0.5, 0.5);
+  Rotation copied(rotation);
+  Rotation assigned;
+  assigned = rotation;
+  rotation = Rotation(1.0, 0.0, 0.0, 0.0);
+
+  vector<double> copiedQuat = copied.toQuaternion();
+  vector<double> assignedQuat = assigned.toQuaternion();
+  ASSERT_EQ(copiedQuat.size(), 4);
+  ASSERT_EQ(assignedQuat.size(), 4);
+  for (size_t i = 0; i < 4; i++) {
+    EXPECT_NEAR(copiedQuat[i], 0.5, 1e-10);
+    EXPECT_NEAR(assignedQuat[i], 0.5, 1e-10);
+  }
+  EXPECT_NEAR(rotation.toQuaternion()[0], 1.0, 1e-10);
+
+  vector<Rotation> rotations(3, copied);
+  EXPECT_EQ(reinterpret_cast<const char *>(&rotations[1]) - reinterpret_cast<const char *>(&rotations[0]),
+            static_cast<ptrdiff_t>(sizeof(Rotation)));
+  EXPECT_EQ(sizeof(Rotation), 4 * sizeof(double));
+}
+
+TEST(RotationTest, InterpolateBatch) {
+  Rotation rotationOne(0.5, 0.5, 0.5, 0.5);
+  Rotation rotationTwo(-0.5, 0.5, 0.5, 0.5);
+  vector<double> t = {-0.5, 0.0, 0.125, 0.5, 1.0, 1.125};
+  vector<Rotation> interpRotations(t.size());
+  vector<RotationInterpolation> interpTypes = {SLERP, NLERP};
+  for (RotationInterpolation interpType : interpTypes) {
+    rotationOne.interpolate(rotationTwo, t.data(), t.size(), interpType, interpRotations.data());
+    for (size_t i = 0; i < t.size(); i++) {
+      vector<double> quat = interpRotations[i].toQuaternion();
+      vector<double> expectedQuat = rotationOne.interpolate(rotationTwo, t[i], interpType).toQuaternion();
+      for (size_t j = 0; j < 4; j++) {
+        EXPECT_NEAR(quat[j], expectedQuat[j], 1e-15);
+      }
+    }
+  }
+
+  // Interpolating between the same rotation
+  rotationOne.interpolate(rotationOne, t.data(), t.size(), SLERP, interpRotations.data());
+  for (size_t i = 0; i < t.size(); i++) {
+    vector<double> quat = interpRotations[i].toQuaternion();
+    EXPECT_NEAR(quat[0], 0.5, 1e-15);
+    EXPECT_NEAR(quat[1], 0.5, 1e-15);
+    EXPECT_NEAR(quat[2], 0.5, 1e-15);
+    EXPECT_NEAR(quat[3], 0.5, 1e-15);
+  }
+
+  EXPECT_THROW(rotationOne.interpolate(rotationTwo, t.data(), t.size(), (RotationInterpolation)1000,
+                                       interpRotations.data()),
+               invalid_argument);
+}
+
+TEST(RotationTest, RotateBatch) {
+  Rotation rotation(Rotation({1, 2, 3}, 0.7));
+  Vec3d av(0.01, -0.02, 0.5);
+  vector<State> states = {State(Vec3d(1, 0, 0), Vec3d(0, 1, 0)),
+                          State(Vec3d(-3, 2.5, 7), Vec3d(0.1, 0.2, -0.3)),
+                          State(Vec3d(1e4, -2e3, 5e2), Vec3d(-1, 3, 2))};
+  vector<Vec3d> vectors;
+  for (const State &state : states) {
+    vectors.push_back(state.position);
+  }
+
+  vector<Vec3d> rotatedVectors(vectors.size());
+  rotation.rotateVectors(vectors.data(), vectors.size(), rotatedVectors.data());
+  vector<State> rotatedStates(states.size());
+  rotation.rotateStates(states.data(), states.size(), rotatedStates.data(), av);
+  for (size_t i = 0; i < states.size(); i++) {
+    Vec3d expectedVector = rotation(vectors[i]);
+    EXPECT_NEAR(rotatedVectors[i].x, expectedVector.x, 1e-10);
+    EXPECT_NEAR(rotatedVectors[i].y, expectedVector.y, 1e-10);
+    EXPECT_NEAR(rotatedVectors[i].z, expectedVector.z, 1e-10);
+    State expectedState = rotation(states[i], av);
+    EXPECT_NEAR(rotatedStates[i].position.x, expectedState.position.x, 1e-10);
+    EXPECT_NEAR(rotatedStates[i].position.z, expectedState.position.z, 1e-10);
+    EXPECT_NEAR(rotatedStates[i].velocity.x, expectedState.velocity.x, 1e-10);
+    EXPECT_NEAR(rotatedStates[i].velocity.y, expectedState.velocity.y, 1e-10);
+    EXPECT_NEAR(rotatedStates[i].velocity.z, expectedState.velocity.z, 1e-10);
+  }
+
+  // Rotating in place
+  rotation.rotateStates(states.data(), states.size(), states.data(), av);
+  EXPECT_NEAR(states[1].velocity.y, rotatedStates[1].velocity.y, 1e-15);
+  rotation.rotateVectors(vectors.data(), vectors.size(), vectors.data());
+  EXPECT_NEAR(vectors[2].x, rotatedVectors[2].x, 1e-15);
+
+  double mat[36];
+  rotation.toStateRotationMatrix(av, mat);
+  vector<double> expectedMat = rotation.toStateRotationMatrix(av);
+  for (size_t i = 0; i < expectedMat.size(); i++) {
+    EXPECT_EQ(mat[i], expectedMat[i]);
+  }
+  rotation.toRotationMatrix(mat);
+  for (size_t row = 0; row < 3; row++) {
+    for (size_t column = 0; column < 3; column++) {
+      EXPECT_EQ(mat[3 * row + column], expectedMat[6 * row + column]);
+    }
+  }
+}
@@ -4,6 +4,7 @@
 #include <exception>
 
 #include "ale/States.h"
+#include "ale/ThreadPool.h"
 #include "ale/Vectors.h"
 
 using namespace std;
@@ -225,6 +226,164 @@ TEST_F(TestState, getVelocity) {
   EXPECT_NEAR(spline_no_vel_velocity.z, 0.432, 1e-10);
 }
 
+TEST_F(TestState, getPositionLagrange) {
+  double time = 1.5;
+  Vec3d lagrange_position = states->getPosition(time, LAGRANGE);
+  Vec3d lagrange_velocity = states->getVelocity(time, LAGRANGE);
+
+  // With 4 points, the lagrange polynomials exactly recover the cubic functions
+  EXPECT_NEAR(lagrange_position.x, 5.5, 1e-10);
+  EXPECT_NEAR(lagrange_position.y, 3.75, 1e-10);
+  EXPECT_NEAR(lagrange_position.z, 0.216, 1e-10);
+  EXPECT_NEAR(lagrange_velocity.x, 1, 1e-10);
+  EXPECT_NEAR(lagrange_velocity.y, 1, 1e-10);
+  EXPECT_NEAR(lagrange_velocity.z, 0.432, 1e-10);
+}
+
+TEST_F(TestState, getStatesBatch) {
+  // Unsorted with exact sample times and extrapolated times mixed in
+  std::vector<double> times = {-0.5, 0.25, 1.5, 1.0, 0.75, 2.9, 3.0, 3.5, 2.25};
+  std::vector<PositionInterpolation> interps = {LINEAR, SPLINE, LAGRANGE};
+
+  for (PositionInterpolation interp : interps) {
+    for (States *testStates : {states, statesNoVelocity}) {
+      std::vector<State> batch = testStates->getStates(times, interp);
+      std::vector<Vec3d> positions = testStates->getPositions(times, interp);
+      ASSERT_EQ(batch.size(), times.size());
+      ASSERT_EQ(positions.size(), times.size());
+      for (size_t i = 0; i < times.size(); i++) {
+        State expected = testStates->getState(times[i], interp);
+        EXPECT_DOUBLE_EQ(batch[i].position.x, expected.position.x);
+        EXPECT_DOUBLE_EQ(batch[i].position.y, expected.position.y);
+        EXPECT_DOUBLE_EQ(batch[i].position.z, expected.position.z);
+        EXPECT_DOUBLE_EQ(positions[i].x, expected.position.x);
+        EXPECT_DOUBLE_EQ(positions[i].y, expected.position.y);
+        EXPECT_DOUBLE_EQ(positions[i].z, expected.position.z);
+        if (expected.hasVelocity()) {
+          EXPECT_DOUBLE_EQ(batch[i].velocity.x, expected.velocity.x);
+          EXPECT_DOUBLE_EQ(batch[i].velocity.y, expected.velocity.y);
+          EXPECT_DOUBLE_EQ(batch[i].velocity.z, expected.velocity.z);
+        }
+      }
+    }
+  }
+}
+
+TEST_F(TestState, getStatesBuffer) {
+  std::vector<double> times = {0.5, 1.5, 2.5};
+  State output[3];
+  states->getStates(times.data(), times.size(), output, SPLINE);
+  EXPECT_NEAR(output[1].position.x, 5.5, 1e-10);
+  EXPECT_NEAR(output[1].position.y, 3.75, 1e-10);
+  EXPECT_NEAR(output[1].position.z, 0.108, 1e-10);
+  EXPECT_NEAR(output[1].velocity.z, 0.072, 1e-10);
+}
+
+TEST_F(TestState, Cursor) {
+  std::vector<double> times = {-0.5, 0.0, 0.25, 1.5, 1.75, 3.0, 3.5, 0.5, 2.25};
+  std::vector<PositionInterpolation> interps = {LINEAR, SPLINE, LAGRANGE};
+
+  for (PositionInterpolation interp : interps) {
+    States::Cursor cursor(*states);
+    for (double time : times) {
+      State result = cursor.getState(time, interp);
+      State expected = states->getState(time, interp);
+      EXPECT_DOUBLE_EQ(result.position.x, expected.position.x);
+      EXPECT_DOUBLE_EQ(result.position.y, expected.position.y);
+      EXPECT_DOUBLE_EQ(result.position.z, expected.position.z);
+      EXPECT_DOUBLE_EQ(result.velocity.x, expected.velocity.x);
+      EXPECT_DOUBLE_EQ(result.velocity.y, expected.velocity.y);
+      EXPECT_DOUBLE_EQ(result.velocity.z, expected.velocity.z);
+    }
+  }
+
+  States::Cursor noVelocityCursor(*statesNoVelocity);
+  Vec3d position = noVelocityCursor.getPosition(1.5, SPLINE);
+  Vec3d velocity = noVelocityCursor.getVelocity(1.5, SPLINE);
+  EXPECT_NEAR(position.z, 0.216, 1e-10);
+  EXPECT_NEAR(velocity.z, 0.432, 1e-10);
+}
+
+TEST(StatesTest, PrepareInterpolation) {
+  // Samples of a circular orbit with uneven time steps
+  std::vector<double> ephemTimes;
+  std::vector<Vec3d> positions, velocities;
+  for (int i = 0; i < 12; i++) {
+    double time = 100.0 + 0.5 * i + 0.05 * (i % 3);
+    ephemTimes.push_back(time);
+    positions.push_back(Vec3d(1000 * cos(time / 10), 1000 * sin(time / 10), 10 * time));
+    velocities.push_back(Vec3d(-100 * sin(time / 10), 100 * cos(time / 10), 10));
+  }
+  std::vector<double> times = {99.0, 100.0, 100.3, 101.7, 102.5, 103.26, 104.9, 105.6, 106.0, 107.2};
+
+  for (bool withVelocity : {true, false}) {
+    States original = withVelocity ? States(ephemTimes, positions, velocities) : States(ephemTimes, positions);
+    for (PositionInterpolation interp : {LINEAR, SPLINE, LAGRANGE}) {
+      States prepared = original;
+      EXPECT_FALSE(prepared.isPrepared(interp));
+      prepared.prepareInterpolation(interp);
+      EXPECT_TRUE(prepared.isPrepared(interp));
+
+      std::vector<State> batch = prepared.getStates(times, interp);
+      for (size_t i = 0; i < times.size(); i++) {
+        State expected = original.getState(times[i], interp);
+        State result = prepared.getState(times[i], interp);
+        EXPECT_NEAR(result.position.x, expected.position.x, 1e-8);
+        EXPECT_NEAR(result.position.y, expected.position.y, 1e-8);
+        EXPECT_NEAR(result.position.z, expected.position.z, 1e-8);
+        EXPECT_DOUBLE_EQ(batch[i].position.x, result.position.x);
+        // Sample times return the sample, which may not have a velocity
+        if (expected.hasVelocity()) {
+          EXPECT_NEAR(result.velocity.x, expected.velocity.x, 1e-8);
+          EXPECT_NEAR(result.velocity.y, expected.velocity.y, 1e-8);
+          EXPECT_NEAR(result.velocity.z, expected.velocity.z, 1e-8);
+          EXPECT_DOUBLE_EQ(batch[i].velocity.z, result.velocity.z);
+        }
+      }
+    }
+  }
+}
+
+TEST_F(TestState, PrepareInterpolationSwitch) {
+  states->prepareInterpolation(LAGRANGE);
+  EXPECT_TRUE(states->isPrepared(LAGRANGE));
+  EXPECT_FALSE(states->isPrepared(SPLINE));
+
+  // Other interpolation types still use the regular path
+  Vec3d spline_position = states->getPosition(1.5, SPLINE);
+  EXPECT_NEAR(spline_position.x, 5.5, 1e-10);
+  EXPECT_NEAR(spline_position.y, 3.75, 1e-10);
+  EXPECT_NEAR(spline_position.z, 0.108, 1e-10);
+
+  states->prepareInterpolation(SPLINE);
+  EXPECT_FALSE(states->isPrepared(LAGRANGE));
+  spline_position = states->getPosition(1.5, SPLINE);
+  EXPECT_NEAR(spline_position.z, 0.108, 1e-10);
+}
+
+TEST(StatesTest, getStatesEmpty) {
+  States emptyStates;
+  std::vector<double> times = {1.0};
+  EXPECT_TRUE(emptyStates.getStates(std::vector<double>()).empty());
+  EXPECT_THROW(emptyStates.getStates(times), std::invalid_argument);
+}
+
+TEST(StatesTest, getStatesOneState) {
+  std::vector<double> ephemTimes = {1.0};
+  std::vector<Vec3d> positions = {Vec3d(2.0, 3.0, 4.0)};
+  std::vector<Vec3d> velocities = {Vec3d(5.0, 6.0, -1.0)};
+
+  States testState(ephemTimes, positions, velocities);
+  std::vector<State> results = testState.getStates({2.0, -1.0});
+  ASSERT_EQ(results.size(), 2);
+  EXPECT_NEAR(results[0].position.x, 7.0, 1e-5);
+  EXPECT_NEAR(results[0].position.y, 9.0, 1e-4);
+  EXPECT_NEAR(results[0].position.z, 3.0, 1e-5);
+  EXPECT_NEAR(results[1].position.x, -8.0, 1e-5);
+  EXPECT_NEAR(results[1].position.y, -9.0, 1e-4);
+  EXPECT_NEAR(results[1].position.z, 6.0, 1e-5);
+}
+
 // getState() and interpolateState() are tested when testing getPosition and
 // getVelocity, because they are derived from those methods
 
@@ -277,9 +436,14 @@ TEST(StatesTest, minimizeCache_true) {
 
   vector<State> states = withVelocityState.getStates();
   EXPECT_EQ(states.size(), 5);
-  States minimizedStates = withVelocityState.minimizeCache(1);
+  CacheReduction report;
+  States minimizedStates = withVelocityState.minimizeCache(1.1, &report);
   vector<State> states_min = minimizedStates.getStates();
   EXPECT_EQ(states_min.size(), 4);
+  EXPECT_EQ(report.originalSize, 5);
+  EXPECT_EQ(report.reducedSize, 4);
+  EXPECT_NEAR(report.maxError, 1.025, 1e-12);
+  EXPECT_DOUBLE_EQ(report.maxErrorTime, 3.0);
 }
 
 // Creates a setup in which the cache cannot be minimized
@@ -537,3 +701,136 @@ EXPECT_NEAR(results[2].position.z, 16337.1866136653, 1e-8);
 EXPECT_EQ(results.size(), 3);
 
 }
+
+TEST(StatesTest, ThreadPoolMatchesSerial) {
+  std::vector<double> ephemTimes;
+  std::vector<Vec3d> positions;
+  std::vector<Vec3d> velocities;
+  for (int i = 0; i < 200; i++) {
+    ephemTimes.push_back(i);
+    positions.push_back(Vec3d(cos(0.01 * i), sin(0.01 * i), 0.1 * i));
+    velocities.push_back(Vec3d(-0.01 * sin(0.01 * i), 0.01 * cos(0.01 * i), 0.1));
+  }
+  States states(ephemTimes, positions, velocities);
+
+  std::vector<double> times;
+  for (int i = 0; i < 5000; i++) {
+    times.push_back(199.0 * ((i * 7919) % 5000) / 5000.0);
+  }
+
+  ThreadPool pool(4);
+  std::vector<PositionInterpolation> interps = {LINEAR, SPLINE, LAGRANGE};
+  for (PositionInterpolation interp : interps) {
+    std::vector<State> expected = states.getStates(times, interp);
+    std::vector<State> actual = states.getStates(times, interp, pool);
+    std::vector<Vec3d> actualPositions = states.getPositions(times, interp, pool);
+    ASSERT_EQ(actual.size(), times.size());
+    ASSERT_EQ(actualPositions.size(), times.size());
+    for (size_t i = 0; i < times.size(); i++) {
+      EXPECT_EQ(actual[i].position.x, expected[i].position.x);
+      EXPECT_EQ(actual[i].position.z, expected[i].position.z);
+      EXPECT_EQ(actual[i].velocity.y, expected[i].velocity.y);
+      EXPECT_EQ(actualPositions[i].y, expected[i].position.y);
+    }
+  }
+
+  States empty;
+  EXPECT_TRUE(empty.getStates(std::vector<double>(), LINEAR, pool).empty());
+}
+
+TEST(StatesTest, SliceMatchesParent) {
+  std::vector<double> ephemTimes;
+  std::vector<Vec3d> positions;
+  std::vector<Vec3d> velocities;
+  for (int i = 0; i < 100; i++) {
+    ephemTimes.push_back(i);
+    positions.push_back(Vec3d(cos(0.05 * i), sin(0.05 * i), 0.1 * i * i));
+    velocities.push_back(Vec3d(-0.05 * sin(0.05 * i), 0.05 * cos(0.05 * i), 0.2 * i));
+  }
+  States states(ephemTimes, positions, velocities, 1);
+
+  States::View view = states.slice(40.5, 55.25);
+  EXPECT_EQ(view.getStartIndex(), 37);
+  EXPECT_EQ(view.size(), 23);
+  EXPECT_EQ(view.getReferenceFrame(), 1);
+  EXPECT_TRUE(view.hasVelocity());
+  EXPECT_EQ(view.getTimes().front(), 37);
+  EXPECT_EQ(view.getTimes().back(), 59);
+
+  std::vector<double> times;
+  for (int i = 0; i <= 60; i++) {
+    times.push_back(40.5 + 0.25 * i);
+  }
+  std::vector<PositionInterpolation> interps = {LINEAR, SPLINE, LAGRANGE};
+  for (PositionInterpolation interp : interps) {
+    std::vector<State> expected = states.getStates(times, interp);
+    std::vector<State> actual = view.getStates(times, interp);
+    std::vector<Vec3d> actualPositions = view.getPositions(times, interp);
+    ASSERT_EQ(actual.size(), times.size());
+    for (size_t i = 0; i < times.size(); i++) {
+      EXPECT_EQ(actual[i].position.x, expected[i].position.x);
+      EXPECT_EQ(actual[i].position.z, expected[i].position.z);
+      EXPECT_EQ(actual[i].velocity.y, expected[i].velocity.y);
+      EXPECT_EQ(actualPositions[i].y, expected[i].position.y);
+    }
+
+    // Outside of the window the view extrapolates from its own ends
+    States copy = view.toStates();
+    State expectedState = copy.getState(20, interp);
+    State actualState = view.getState(20, interp);
+    EXPECT_EQ(actualState.position.z, expectedState.position.z);
+    EXPECT_EQ(actualState.velocity.x, expectedState.velocity.x);
+  }
+}
+
+
+TEST(StatesTest, SliceEdges) {
+  std::vector<double> ephemTimes = {0, 1, 2, 3};
+  std::vector<Vec3d> positions = {Vec3d(0, 0, 0), Vec3d(1, 1, 1), Vec3d(2, 2, 2), Vec3d(3, 3, 3)};
+  States states(ephemTimes, positions);
+
+  States::View all = states.slice(-10, 10);
+  EXPECT_EQ(all.getStartIndex(), 0);
+  EXPECT_EQ(all.size(), 4);
+  EXPECT_FALSE(all.hasVelocity());
+  EXPECT_DOUBLE_EQ(all.getPosition(1.5).x, 1.5);
+  EXPECT_DOUBLE_EQ(all.getVelocity(1.5).y, 1.0);
+
+  States single(std::vector<double>(1, 5.0), std::vector<Vec3d>(1, Vec3d(1, 2, 3)));
+  EXPECT_EQ(single.slice(0, 1).getPosition(10).z, 3);
+
+  EXPECT_THROW(states.slice(2, 1), invalid_argument);
+  EXPECT_THROW(States().slice(0, 1), invalid_argument);
+}
+
+
+TEST(StatesTest, Columns) {
+  std::vector<double> ephemTimes = {0.0, 1.0, 2.0};
+  std::vector<Vec3d> positions = {Vec3d(1, 2, 3), Vec3d(4, 5, 6), Vec3d(7, 8, 9)};
+  std::vector<Vec3d> velocities = {Vec3d(-1, -2, -3), Vec3d(-4, -5, -6), Vec3d(-7, -8, -9)};
+  States states(ephemTimes, positions, velocities);
+
+  EXPECT_EQ(&states.getTimes(), &states.getTimes());
+  EXPECT_EQ(states.getPositionColumn(0), std::vector<double>({1, 4, 7}));
+  EXPECT_EQ(states.getPositionColumn(1), std::vector<double>({2, 5, 8}));
+  EXPECT_EQ(states.getPositionColumn(2), std::vector<double>({3, 6, 9}));
+  EXPECT_EQ(states.getVelocityColumn(0), std::vector<double>({-1, -4, -7}));
+  EXPECT_EQ(states.getVelocityColumn(2), std::vector<double>({-3, -6, -9}));
+  EXPECT_THROW(states.getPositionColumn(3), invalid_argument);
+  EXPECT_THROW(states.getVelocityColumn(-1), invalid_argument);
+
+  States noVelocity(ephemTimes, positions);
+  EXPECT_FALSE(noVelocity.hasVelocity());
+  EXPECT_TRUE(noVelocity.getVelocityColumn(1).empty());
+  EXPECT_TRUE(std::isnan(noVelocity.getVelocities()[1].y));
+  EXPECT_TRUE(std::isnan(noVelocity.getStates()[2].velocity.z));
+
+  // Some states with velocities keep the columns, but do not count as having velocities
+  std::vector<State> mixed = {State(positions[0], velocities[0]), State(positions[1]),
+                              State(positions[2], velocities[2])};
+  States partial(ephemTimes, mixed);
+  EXPECT_FALSE(partial.hasVelocity());
+  EXPECT_EQ(partial.getVelocityColumn(0).size(), 3);
+  EXPECT_FALSE(partial.getStates()[1].hasVelocity());
+  EXPECT_DOUBLE_EQ(partial.getStates()[2].velocity.y, -8);
+}
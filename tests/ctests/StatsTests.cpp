@@ -0,0 +1,66 @@
+#include "gtest/gtest.h"
+
+#include "ale/Stats.h"
+
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+using namespace ale;
+
+TEST(Stats, Timer) {
+  Stats stats;
+  {
+    Stats::Timer timer(&stats, "outer");
+    timer.setSize(42);
+    Stats::Timer inner(&stats, "inner");
+    inner.stop();
+    inner.stop();
+  }
+  ASSERT_EQ(stats.stages.size(), 2);
+  EXPECT_EQ(stats.stages[0].name, "inner");
+  EXPECT_EQ(stats.stages[0].size, 0);
+  EXPECT_EQ(stats.stages[1].name, "outer");
+  EXPECT_EQ(stats.stages[1].size, 42);
+  EXPECT_GE(stats.stages[1].seconds, stats.stages[0].seconds);
+}
+
+
+TEST(Stats, NullTimer) {
+  Stats::Timer timer(nullptr, "nothing");
+  timer.setSize(1);
+  timer.stop();
+}
+
+
+TEST(Stats, Lookup) {
+  Stats stats;
+  stats.addStage("parse", 1.5, 10);
+  stats.addStage("section", 0.25);
+  stats.addStage("section", 0.5);
+  EXPECT_TRUE(stats.hasStage("parse"));
+  EXPECT_FALSE(stats.hasStage("missing"));
+  EXPECT_EQ(stats.getStage("parse").size, 10);
+  EXPECT_DOUBLE_EQ(stats.getStage("section").seconds, 0.25);
+  EXPECT_DOUBLE_EQ(stats.totalSeconds("section"), 0.75);
+  EXPECT_THROW(stats.getStage("missing"), invalid_argument);
+}
+
+
+TEST(Stats, ToJson) {
+  Stats stats;
+  EXPECT_EQ(stats.toJson(), nlohmann::json({{"stages", nlohmann::json::array()}}));
+
+  stats.addStage("parse", 1.5, 10);
+  stats.python = {{"drivers", nlohmann::json::array()}};
+  nlohmann::json statsJson = stats.toJson();
+  ASSERT_EQ(statsJson["stages"].size(), 1);
+  EXPECT_EQ(statsJson["stages"][0]["name"], "parse");
+  EXPECT_DOUBLE_EQ(statsJson["stages"][0]["seconds"].get<double>(), 1.5);
+  EXPECT_EQ(statsJson["stages"][0]["size"], 10);
+  EXPECT_EQ(statsJson["python"], stats.python);
+
+  stats.clear();
+  EXPECT_TRUE(stats.stages.empty());
+  EXPECT_TRUE(stats.python.is_null());
+}
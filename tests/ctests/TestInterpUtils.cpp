@@ -250,9 +250,114 @@ TEST(InterpUtilsTest, interpolationIndex) {
   ASSERT_THROW(interpolationIndex({}, 4), std::invalid_argument);
 }
 
+TEST(InterpUtilsTest, InterpolationCursor) {
+  vector<double> times = {1, 3, 5, 6, 8, 9, 12, 13, 14, 20, 21};
+  InterpolationCursor cursor(times);
+  // Forward sweep, backward steps, and jumps in both directions
+  vector<double> interpTimes = {0, 1, 2, 3, 3.5, 5.5, 6, 7, 12.5, 13, 20.5, 25,
+                                24, 2, 1.5, 14, 13.2, 12.1, 8.5, -3, 21};
+  for (double time : interpTimes) {
+    EXPECT_EQ(cursor.index(time), interpolationIndex(times, time)) << "Time " << time;
+  }
+  cursor.reset();
+  EXPECT_EQ(cursor.index(9.5), 5);
+}
+
+TEST(InterpUtilsTest, InterpolationCursorHint) {
+  vector<double> times = {1, 3, 5, 6, 8, 9, 12, 13, 14, 20, 21};
+  InterpolationCursor cursor(times);
+  EXPECT_EQ(cursor.getIndex(), -1);
+  // Good, wrong, and out of range hints all give the same index
+  vector<int> hints = {4, 0, 9, -1, 42};
+  for (int hint : hints) {
+    cursor.hint(hint);
+    EXPECT_EQ(cursor.index(8.5), 4) << "Hint " << hint;
+    EXPECT_EQ(cursor.getIndex(), 4);
+  }
+}
+
+TEST(InterpUtilsTest, InterpolationCursorSmallTimes) {
+  vector<double> oneTime = {1};
+  InterpolationCursor oneCursor(oneTime);
+  EXPECT_EQ(oneCursor.index(-2), 0);
+  EXPECT_EQ(oneCursor.index(8), 0);
+
+  vector<double> twoTimes = {1, 2};
+  InterpolationCursor twoCursor(twoTimes);
+  EXPECT_EQ(twoCursor.index(-2), 0);
+  EXPECT_EQ(twoCursor.index(1.5), 0);
+  EXPECT_EQ(twoCursor.index(8), 0);
+
+  vector<double> noTimes;
+  InterpolationCursor emptyCursor(noTimes);
+  ASSERT_THROW(emptyCursor.index(4), std::invalid_argument);
+}
+
 TEST(InterpUtilsTest, orderedVecMerge) {
   vector<double> vec1 = {0, 2, 4, 3, 5};
   vector<double> vec2 = {-10, 4, 5, 6, 0};
   vector<double> merged = orderedVecMerge(vec1, vec2);
   ASSERT_THAT(orderedVecMerge(vec1, vec2), testing::ElementsAre(-10, 0, 2, 3, 4, 5, 6));
 }
+
+TEST(InterpUtilsTest, orderedVecMergeSorted) {
+  vector<double> vec1 = {0, 1, 1, 3, 7};
+  vector<double> vec2 = {1, 2, 3, 8};
+  ASSERT_THAT(orderedVecMerge(vec1, vec2), testing::ElementsAre(0, 1, 2, 3, 7, 8));
+  ASSERT_THAT(orderedVecMerge(vec1, {}), testing::ElementsAre(0, 1, 3, 7));
+  ASSERT_THAT(orderedVecMerge({}, vec2), testing::ElementsAre(1, 2, 3, 8));
+}
+
+TEST(LagrangeBasis, MatchesLagrangeInterpolate) {
+  vector<double> times = {0, 1, 2.5, 3, 4.5, 5, 6, 8, 9, 10};
+  vector<double> values;
+  for (double time : times) {
+    values.push_back(sin(time) + 0.1 * time * time);
+  }
+  for (double time : {-0.5, 0.25, 2.75, 5.5, 9.9, 11.0}) {
+    int index = interpolationIndex(times, time);
+    LagrangeBasis<8> basis(times.data(), times.size(), index, time);
+    double value, derivative;
+    basis.interpolate(values.data(), value, derivative);
+    EXPECT_NEAR(value, lagrangeInterpolate(times, values, time, 8), 1e-12);
+    EXPECT_NEAR(derivative, lagrangeInterpolateDerivative(times, values, time, 8), 1e-12);
+    EXPECT_LE(basis.size(), 8);
+    EXPECT_GE(basis.start(), 0);
+    EXPECT_LE(basis.start() + basis.size(), (int) times.size());
+  }
+
+  // The window shrinks at the ends of the times
+  LagrangeBasis<8> edge(times.data(), times.size(), 0, 0.5);
+  EXPECT_EQ(edge.start(), 0);
+  EXPECT_EQ(edge.size(), 2);
+}
+
+TEST(LagrangeBasis, DerivativeAtTimes) {
+  // x^2 is reproduced exactly by 4 points, including its derivative at the points
+  vector<double> times = {0, 1, 2, 3};
+  vector<Vec3d> values;
+  for (double time : times) {
+    values.push_back(Vec3d(time * time, -time * time, 1));
+  }
+  LagrangeBasis<4> basis(times.data(), times.size(), 1, 1.0);
+  Vec3d value, derivative;
+  basis.interpolate(values.data(), value, derivative);
+  EXPECT_NEAR(value.x, 1.0, 1e-12);
+  EXPECT_NEAR(derivative.x, 2.0, 1e-12);
+  EXPECT_NEAR(derivative.y, -2.0, 1e-12);
+  EXPECT_NEAR(derivative.z, 0.0, 1e-12);
+  EXPECT_NEAR(lagrangeInterpolateDerivative({0, 1, 2, 3}, {0, 1, 4, 9}, 1.0, 4), 2.0, 1e-12);
+}
+
+TEST(CubicHermite, Vectors) {
+  Vec3d value, derivative;
+  cubicHermite(1.0, 3.0, Vec3d(0, 1, 2), Vec3d(2, 1, 0), Vec3d(1, 0, -1), Vec3d(1, 0, -1),
+               2.0, value, derivative);
+  EXPECT_NEAR(value.x, 1.0, 1e-12);
+  EXPECT_NEAR(value.y, 1.0, 1e-12);
+  EXPECT_NEAR(value.z, 1.0, 1e-12);
+  EXPECT_NEAR(derivative.x, 1.0, 1e-12);
+  EXPECT_NEAR(derivative.z, -1.0, 1e-12);
+  EXPECT_THROW(cubicHermite(1.0, 1.0, 0.0, 1.0, 0.0, 0.0, 1.0, value.x, derivative.x),
+               invalid_argument);
+}
@@ -0,0 +1,72 @@
+#include "gtest/gtest.h"
+
+#include "ale/ThreadPool.h"
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+using namespace std;
+using namespace ale;
+
+TEST(ThreadPool, CoversEveryIndexOnce) {
+  ThreadPool pool(4);
+  EXPECT_GE(pool.getNumThreads(), 1);
+  vector<int> counts(10007, 0);
+  pool.parallelFor(counts.size(), [&counts](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+      counts[i]++;
+    }
+  }, 16);
+  for (int count : counts) {
+    EXPECT_EQ(count, 1);
+  }
+}
+
+
+TEST(ThreadPool, SmallBatches) {
+  ThreadPool pool(4);
+  int calls = 0;
+  pool.parallelFor(0, [&calls](size_t, size_t) { calls++; });
+  EXPECT_EQ(calls, 0);
+
+  // Smaller than two chunks, so it runs in one call
+  size_t chunkBegin = 1;
+  size_t chunkEnd = 0;
+  pool.parallelFor(10, [&](size_t begin, size_t end) {
+    calls++;
+    chunkBegin = begin;
+    chunkEnd = end;
+  }, 8);
+  EXPECT_EQ(calls, 1);
+  EXPECT_EQ(chunkBegin, 0);
+  EXPECT_EQ(chunkEnd, 10);
+}
+
+
+TEST(ThreadPool, RethrowsAfterEveryChunk) {
+  ThreadPool pool(4);
+  atomic<size_t> finished(0);
+  EXPECT_THROW(pool.parallelFor(4000, [&finished](size_t begin, size_t end) {
+    if (begin == 0) {
+      throw runtime_error("First chunk failed");
+    }
+    finished += end - begin;
+  }, 10), runtime_error);
+  // Every chunk but the first still ran
+  EXPECT_EQ(finished.load(), 4000 - 4000 / pool.getNumThreads());
+}
+
+
+TEST(ThreadPool, Nested) {
+  ThreadPool pool(3);
+  atomic<size_t> total(0);
+  pool.parallelFor(30, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+      pool.parallelFor(100, [&total](size_t innerBegin, size_t innerEnd) {
+        total += innerEnd - innerBegin;
+      }, 10);
+    }
+  }, 1);
+  EXPECT_EQ(total.load(), 3000);
+}
@@ -26,3 +26,37 @@ def test_compress_decompress():
     assert comparison == []
 
 
+
+
+def test_binary_isd_round_trip(tmpdir):
+    isd_str = get_isd("messmdis_isis")
+
+    binary_file = str(tmpdir.join("messmdis_isis.bisd"))
+
+    isdg.write_binary_isd(isd_str, binary_file)
+
+    binary_dict = isdg.read_binary_isd(binary_file)
+
+    comparison = compare_dicts(binary_dict, isd_str)
+    assert comparison == []
+
+
+def test_binary_isd_bad_extension(tmpdir):
+    with pytest.raises(ValueError):
+        isdg.write_binary_isd({}, str(tmpdir.join("isd.json")))
+
+
+def test_compress_json_string(tmpdir):
+    isd_dict = get_isd("messmdis_isis")
+
+    compressed_file = str(tmpdir.join("messmdis_isis.br"))
+
+    isdg.compress_json(json.dumps(isd_dict), compressed_file)
+
+    decompressed_file = isdg.decompress_json(compressed_file)
+
+    with open(decompressed_file, 'r') as fp:
+        isis_dict = json.load(fp)
+
+    comparison = compare_dicts(isis_dict, isd_dict)
+    assert comparison == []
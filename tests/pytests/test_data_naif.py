@@ -1,6 +1,7 @@
 import os
 
 import pytest
+import threading
 import unittest
 from unittest.mock import patch, PropertyMock
 
@@ -11,7 +12,7 @@ from conftest import get_image_kernels, convert_kernels
 
 from unittest.mock import patch, call
 
-from ale.base.data_naif import NaifSpice
+from ale.base.data_naif import NaifSpice, KernelPool, kernel_pool, active_kernel_pool, use_kernel_pool
 
 class test_data_naif(unittest.TestCase):
 
@@ -115,6 +116,37 @@ class test_data_naif(unittest.TestCase):
         np.testing.assert_allclose(velocities[0], [-3386.49396159, 411.4392769, 564.95648816])
         np.testing.assert_allclose(times[0], 297088762.61698407)
 
+    def test_sensor_position_many_times(self):
+        times = [297088762.61698407, 297088763.61698407, 297088765.11698407]
+        self.driver.ephemeris_time = times
+        positions, velocities, _ = self.driver.sensor_position
+        assert len(positions) == 3
+        assert len(velocities) == 3
+        for time, position, velocity in zip(times, positions, velocities):
+            state, _ = spice.spkezr('MRO', time, self.driver.reference_frame,
+                                    self.driver.light_time_correction, 'Mars')
+            np.testing.assert_allclose(position, 1000 * np.asarray(state[:3]))
+            np.testing.assert_allclose(velocity, 1000 * np.asarray(state[3:]))
+
+    def test_sensor_position_lt_to_surface(self):
+        times = [297088762.61698407, 297088765.11698407]
+        self.driver.ephemeris_time = times
+        with patch('ale.base.data_naif.NaifSpice.correct_lt_to_surface', new_callable=PropertyMock) as correct_lt, \
+             patch('ale.base.data_naif.NaifSpice.light_time_correction', new_callable=PropertyMock) as lt_correction:
+            correct_lt.return_value = True
+            lt_correction.return_value = 'LT+S'
+            positions, velocities, _ = self.driver.sensor_position
+            radii = self.driver.target_body_radii
+            radius_lt = (radii[2] + radii[0]) / 2 / 299792.458
+            for time, position, velocity in zip(times, positions, velocities):
+                _, obs_tar_lt = spice.spkezr('MRO', time, 'J2000', 'LT+S', 'Mars')
+                ssb_obs_state, _ = spice.spkezr('Mars', time, 'J2000', 'NONE', 'SSB')
+                ssb_tar_state, _ = spice.spkezr('MRO', time - obs_tar_lt + radius_lt, 'J2000', 'NONE', 'SSB')
+                matrix = spice.sxform('J2000', self.driver.reference_frame, time)
+                state = spice.mxvg(matrix, np.asarray(ssb_tar_state) - np.asarray(ssb_obs_state))
+                np.testing.assert_allclose(position, 1000 * np.asarray(state[:3]))
+                np.testing.assert_allclose(velocity, 1000 * np.asarray(state[3:]))
+
     def test_nadir_sensor_orientation(self):
         self.driver.ephemeris_time = [297088762.61698407]
         self.driver._props = {'nadir': True}
@@ -143,3 +175,67 @@ def test_correct_lt_to_surface_keyword(key_val, return_val):
         ikid.return_value = -12345
         assert NaifSpice().correct_lt_to_surface == return_val
         gcpool.assert_called_with('INS-12345_LT_SURFACE_CORRECT', 0, 1)
+
+def test_kernel_pool_cold():
+    pool = KernelPool()
+    with patch('ale.base.data_naif.spice.furnsh') as furnsh, \
+         patch('ale.base.data_naif.spice.unload') as unload:
+        pool.furnish(['a.tls', 'b.bsp'])
+        pool.release(['a.tls', 'b.bsp'])
+        assert furnsh.call_args_list == [call('a.tls'), call('b.bsp')]
+        assert unload.call_args_list == [call('a.tls'), call('b.bsp')]
+        assert pool.loaded == []
+
+def test_kernel_pool_warm():
+    pool = KernelPool()
+    pool.warm = True
+    with patch('ale.base.data_naif.spice.furnsh') as furnsh, \
+         patch('ale.base.data_naif.spice.unload') as unload:
+        pool.furnish(['a.tls', 'b.bsp', 'c.bc'])
+        pool.release(['a.tls', 'b.bsp', 'c.bc'])
+        assert unload.call_count == 0
+
+        # The same kernels are not loaded again
+        furnsh.reset_mock()
+        pool.furnish(['a.tls', 'b.bsp', 'c.bc'])
+        pool.release(['a.tls', 'b.bsp', 'c.bc'])
+        assert furnsh.call_count == 0
+
+        # Only the kernels after the shared start are swapped
+        pool.furnish(['a.tls', 'd.bsp', 'c.bc'])
+        assert unload.call_args_list == [call('c.bc'), call('b.bsp')]
+        assert furnsh.call_args_list == [call('d.bsp'), call('c.bc')]
+        assert pool.loaded == ['a.tls', 'd.bsp', 'c.bc']
+
+        # Kernels in use are not unloaded for a nested driver
+        furnsh.reset_mock()
+        unload.reset_mock()
+        pool.furnish(['e.bsp'])
+        assert unload.call_count == 0
+        assert furnsh.call_args_list == [call('e.bsp')]
+        pool.release(['e.bsp'])
+        pool.release(['a.tls', 'd.bsp', 'c.bc'])
+
+        pool.clear()
+        assert unload.call_args_list == [call('e.bsp'), call('c.bc'), call('d.bsp'), call('a.tls')]
+        assert pool.loaded == []
+
+def test_use_kernel_pool():
+    pool = KernelPool()
+    with use_kernel_pool(pool):
+        assert active_kernel_pool() is pool
+        other = []
+        thread = threading.Thread(target=lambda: other.append(active_kernel_pool()))
+        thread.start()
+        thread.join()
+        assert other == [kernel_pool]
+    assert active_kernel_pool() is kernel_pool
+
+def test_kernel_pool_metakernel_cache():
+    pool = KernelPool()
+    pool.warm = True
+    with patch('ale.base.data_naif.util.get_metakernels', return_value={'count': 0, 'data': []}) as get_metakernels:
+        pool.get_metakernels('/spice', 'mro', 2010, 'latest')
+        pool.get_metakernels('/spice', 'mro', 2010, 'latest')
+        pool.get_metakernels('/spice', 'mro', 2011, 'latest')
+        assert get_metakernels.call_count == 2
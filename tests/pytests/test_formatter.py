@@ -1,5 +1,6 @@
 import pytest
 import json
+import os
 import numpy as np
 
 from ale.formatters import formatter
@@ -8,6 +9,7 @@ from ale.base.type_sensor import LineScanner, Framer
 from ale.transformation import FrameChain
 from ale.base.data_naif import NaifSpice
 from ale.rotation import ConstantRotation, TimeDependentRotation
+from ale.drivers import AleJsonEncoder
 
 from conftest import get_image_label
 
@@ -355,6 +357,11 @@ def test_no_projection(test_frame_driver):
     # isn't using real projection so it should be None
     assert isd.get("projection", None) == None
 
+def test_section_order(driver):
+    keys = list(formatter.to_isd(driver))
+    assert keys.index('radii') < keys.index('body_rotation') < keys.index('instrument_pointing') < keys.index('naif_keywords')
+    assert keys[-2:] == ['instrument_position', 'sun_position']
+
 def test_isis_projection():
     isd = formatter.to_isd(DummyLineScannerDriver(get_image_label('B10_013341_1010_XN_79S172W', "isis3")))
     assert isd.get("projection", None) == "+proj=sinu +lon_0=148.36859083039 +x_0=0 +y_0=0 +R=3396190 +units=m +no_defs"
@@ -364,3 +371,57 @@ def test_isis_geotransform():
     expected = (-219771.1526456, 1455.4380969907, 0.0, 5175537.8728989, 0.0, -1455.4380969907)
     for value, truth in zip(isd.get("geotransform", None), expected):
         pytest.approx(value, truth)
+
+def test_base_isd_sections(driver, monkeypatch):
+    isd = formatter.to_isd(driver)
+    base_isd = json.loads(json.dumps(isd, cls=AleJsonEncoder))
+    base_isd['image_lines'] = 1
+    base_isd['body_rotation'] = {'old': True}
+    base_isd['instrument_position'] = {'old': True}
+    monkeypatch.setattr(formatter, 'dependent_sections', lambda isd, kernels, nadir: {'instrument_position'})
+    updated = formatter.to_isd(driver, base_isd=base_isd, changed_kernels=['new.bsp'])
+    assert updated['image_lines'] == 1
+    assert updated['body_rotation'] == {'old': True}
+    np.testing.assert_equal(updated['instrument_position']['positions'], isd['instrument_position']['positions'])
+    assert base_isd['instrument_position'] == {'old': True}
+    assert 'kernel_provenance' not in updated
+
+def test_base_isd_metadata(driver, monkeypatch):
+    base_isd = {'image_lines': 1}
+    monkeypatch.setattr(formatter, 'dependent_sections', lambda isd, kernels, nadir: {'metadata'})
+    updated = formatter.to_isd(driver, base_isd=base_isd, changed_kernels=['new.ti'])
+    assert updated['image_lines'] == 512
+    assert 'body_rotation' in updated
+
+@pytest.fixture
+def frame_kernels(monkeypatch):
+    kernel_types = {'sc.bc': ('DAF', 'CK'), 'moon.bpc': ('DAF', 'PCK'),
+                    'sc.bsp': ('DAF', 'SPK'), 'inst.ti': ('KPL', 'IK')}
+    frames = {-85000: (-85, 3, -85000), -85600: (-85, 4, -85600),
+              10020: (301, 2, 301), 1: (0, 1, 1)}
+    def getfat(kernel):
+        return kernel_types[os.path.basename(kernel)]
+    monkeypatch.setattr(formatter.spice, 'getfat', getfat)
+    monkeypatch.setattr(formatter.spice, 'frinfo', lambda frame: frames[frame])
+    monkeypatch.setattr(formatter.spice, 'ckobj', lambda kernel: [-85000])
+    monkeypatch.setattr(formatter.spice, 'pckfrm', lambda kernel: [301])
+    return {'instrument_pointing': {'time_dependent_frames': [-85000, 1],
+                                    'constant_frames': [-85600, -85000]},
+            'body_rotation': {'time_dependent_frames': [10020, 1]}}
+
+def test_kernel_sections(frame_kernels):
+    isd = frame_kernels
+    assert formatter.kernel_sections('sc.bc', isd) == {'instrument_pointing'}
+    assert formatter.kernel_sections('moon.bpc', isd) == {'body_rotation', 'instrument_position', 'sun_position'}
+    assert formatter.kernel_sections('sc.bsp', isd) == {'instrument_position', 'sun_position'}
+    assert 'instrument_pointing' in formatter.kernel_sections('sc.bsp', isd, nadir=True)
+    assert 'metadata' in formatter.kernel_sections('inst.ti', isd)
+    assert 'metadata' in formatter.kernel_sections('unknown.bsp', isd)
+
+def test_dependent_sections(frame_kernels):
+    isd = dict(frame_kernels)
+    isd['kernel_provenance'] = {'instrument_pointing': ['removed.bc'], 'metadata': []}
+    # Removed kernels only change the sections that used them
+    assert formatter.dependent_sections(isd, ['removed.bc']) == {'instrument_pointing'}
+    assert formatter.dependent_sections(isd, ['sc.bsp', 'sc.bc']) == {'instrument_position', 'sun_position', 'instrument_pointing'}
+    assert formatter.dependent_sections(isd, []) == set()
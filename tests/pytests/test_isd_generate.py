@@ -10,10 +10,17 @@
 #
 # SPDX-License-Identifier: CC0-1.0
 
+import concurrent.futures
+import json
+import os
+import tempfile
 import unittest
 from unittest.mock import call, patch
 
+import brotli
+
 import ale.isd_generate as isdg
+from ale.formatters.formatter import to_isd
 
 
 class TestFile(unittest.TestCase):
@@ -46,3 +53,136 @@ class TestFile(unittest.TestCase):
             self.assertEqual(
                 m_path_wt.call_args_list, [call(json_text)]
             )
+
+    def test_file_to_isd_compress_and_binary(self):
+        with patch("ale.loads") as m_loads:
+            with self.assertRaises(ValueError):
+                isdg.file_to_isd("dummy.cub", compress=True, binary=True)
+            m_loads.assert_not_called()
+
+    @patch("ale.isd_generate.Path.write_text")
+    def test_file_to_isd_update(self, m_path_wt):
+        with patch("ale.isd_generate.read_isd", return_value={"old": True}) as m_read, \
+             patch("ale.isd_generate.os.path.exists", return_value=True), \
+             patch("ale.loads", return_value="json") as m_loads:
+            isdg.file_to_isd("dummy.cub", update=True, changed_kernels=["new.bsp"], provenance=True)
+            m_read.assert_called_once_with("dummy.json")
+            formatter = m_loads.call_args[1]["formatter"]
+            self.assertIs(formatter.func, to_isd)
+            self.assertEqual(
+                formatter.keywords,
+                {"record_provenance": True, "base_isd": {"old": True}, "changed_kernels": ["new.bsp"]}
+            )
+            self.assertEqual(m_path_wt.call_args_list, [call("json")])
+
+        # Without an existing ISD, it is generated as usual
+        with patch("ale.isd_generate.os.path.exists", return_value=False), \
+             patch("ale.loads", return_value="json") as m_loads:
+            isdg.file_to_isd("dummy.cub", update=True, changed_kernels=["new.bsp"])
+            self.assertEqual(
+                m_loads.call_args_list,
+                [call("dummy.cub", props={}, verbose=True, only_isis_spice=False, only_naif_spice=False)]
+            )
+
+    def test_files_to_isd(self):
+        with patch("ale.isd_generate.file_to_isd", side_effect=[None, ValueError("bad"), None]) as m_file_to_isd:
+            errors = isdg.files_to_isd(["a.cub", "b.cub", "c.cub"], kernels=["k.tm"])
+            self.assertEqual(errors, [("b.cub", "bad")])
+            self.assertEqual(
+                m_file_to_isd.call_args_list,
+                [call("a.cub", kernels=["k.tm"]), call("b.cub", kernels=["k.tm"]), call("c.cub", kernels=["k.tm"])]
+            )
+
+
+class TestMain(unittest.TestCase):
+
+    def test_multiple_files_compress(self):
+        argv = ["isd_generate", "-c", "a.cub", "b.cub"]
+        with patch("sys.argv", argv), \
+             patch("ale.isd_generate.concurrent.futures.ProcessPoolExecutor",
+                   concurrent.futures.ThreadPoolExecutor), \
+             patch("ale.isd_generate.file_to_isd") as m_file_to_isd:
+            isdg.main()
+            self.assertEqual(m_file_to_isd.call_count, 2)
+            self.assertEqual(
+                sorted(c.args[0] for c in m_file_to_isd.call_args_list),
+                ["a.cub", "b.cub"]
+            )
+            for c in m_file_to_isd.call_args_list:
+                self.assertTrue(c.kwargs["compress"])
+                self.assertFalse(c.kwargs["binary"])
+
+
+class TestReadIsd(unittest.TestCase):
+
+    def setUp(self):
+        self.isd = {
+            "name_model": "USGS_ASTRO_LINE_SCANNER_SENSOR_MODEL",
+            "instrument_position": {
+                "ephemeris_times": [0.0, 1.0],
+                "positions": [[1.0, 2.0, 3.0], [4.0, 5.0, 6.0]],
+                "velocities": [[0.0, 0.0, 1.0], [0.0, 1.0, 0.0]]
+            }
+        }
+        self.tmpdir = tempfile.TemporaryDirectory()
+
+    def tearDown(self):
+        self.tmpdir.cleanup()
+
+    def test_json(self):
+        isd_file = os.path.join(self.tmpdir.name, "isd.json")
+        with open(isd_file, "w") as f:
+            json.dump(self.isd, f)
+        self.assertEqual(isdg.read_isd(isd_file), self.isd)
+
+    def test_compressed(self):
+        isd_file = os.path.join(self.tmpdir.name, "isd.br")
+        isdg.compress_json(self.isd, isd_file)
+        self.assertEqual(isdg.read_isd(isd_file), self.isd)
+
+    def test_double_encoded_compressed(self):
+        # Written by older versions of compress_json, which serialized the
+        # already serialized ISD
+        isd_file = os.path.join(self.tmpdir.name, "isd.br")
+        with open(isd_file, "wb") as f:
+            f.write(brotli.compress(json.dumps(json.dumps(self.isd)).encode("utf-8")))
+        self.assertEqual(isdg.read_isd(isd_file), self.isd)
+
+    def test_binary(self):
+        isd_file = os.path.join(self.tmpdir.name, "isd.bisd")
+        isdg.write_binary_isd(self.isd, isd_file)
+        self.assertEqual(isdg.read_isd(isd_file), self.isd)
+
+
+class TestGroupByKernels(unittest.TestCase):
+
+    def test_given_kernels(self):
+        files = ["a.cub", "b.cub", "c.cub", "d.cub", "e.cub"]
+        self.assertEqual(isdg.group_by_kernels(files, ["k.tm"], 1), [files])
+        self.assertEqual(
+            isdg.group_by_kernels(files, ["k.tm"], 2),
+            [["a.cub", "b.cub", "c.cub"], ["d.cub", "e.cub"]]
+        )
+        self.assertEqual(
+            isdg.group_by_kernels(files[:2], ["k.tm"], 4),
+            [["a.cub"], ["b.cub"]]
+        )
+
+    def test_cube_kernels(self):
+        cube_kernels = {
+            "a.cub": ["one.bsp", "one.bc"],
+            "b.cub": ["two.bsp"],
+            "c.cub": ["one.bsp", "one.bc"],
+        }
+        def generate_kernels(file, expand=False):
+            if file not in cube_kernels:
+                raise KeyError("Kernels")
+            return cube_kernels[file]
+
+        with patch("ale.util.generate_kernels_from_cube", side_effect=generate_kernels):
+            self.assertEqual(isdg.kernel_set("a.cub"), ("one.bsp", "one.bc"))
+            self.assertEqual(isdg.kernel_set("label.lbl"), ())
+            self.assertEqual(
+                isdg.group_by_kernels(["a.cub", "b.cub", "label.lbl", "c.cub"]),
+                [["a.cub", "c.cub"], ["b.cub"], ["label.lbl"]]
+            )
@@ -2,6 +2,7 @@ import pytest
 from importlib import reload
 import json
 import os
+import threading
 
 import ale
 from ale import util
@@ -49,6 +50,53 @@ def test_loads_invalid_label():
     with pytest.raises(Exception):
         ale.loads('Not a label path')
 
+def test_loads_invalid_label_stats():
+    stats = {}
+    with pytest.raises(Exception):
+        ale.loads('Not a label path', stats=stats)
+    stage_names = [stage['name'] for stage in stats['stages']]
+    assert stage_names[:2] == ['find_drivers', 'parse_label']
+    assert 'json_dumps' not in stage_names
+    assert stats['stages'][0]['size'] == len(stats['drivers'])
+    assert all(attempt['error'] is not None for attempt in stats['drivers'])
+    json.dumps(stats)
+
+def test_load_many_invalid_labels():
+    results = ale.load_many(['Not a label path', 'Also not a label path'])
+    assert len(results) == 2
+    assert all(isinstance(result, Exception) for result in results)
+
+def test_load_many_callback_stats():
+    calls = []
+    stats = {}
+    result = ale.load_many(['Not a label path', 'Also not a label path'],
+                           callback=lambda *args: calls.append(args), stats=stats)
+    assert result is None
+    assert [call[0] for call in calls] == [0, 1]
+    assert all(call[1] is None and call[2] for call in calls)
+    assert [stage['name'] for stage in stats['stages']] == ['find_drivers']
+    assert len(stats['labels']) == 2
+    assert 'find_drivers' not in [stage['name'] for stage in stats['labels'][0]['stages']]
+    assert not ale.base.data_naif.kernel_pool.warm
+    json.dumps(stats)
+
+def test_load_many_uses_its_own_kernel_pool():
+    pools = []
+    def callback(index, isd, error):
+        other = []
+        thread = threading.Thread(target=lambda: other.append(ale.base.data_naif.active_kernel_pool()))
+        thread.start()
+        thread.join()
+        pools.append((ale.base.data_naif.active_kernel_pool(), other[0]))
+
+    ale.load_many(['Not a label path'], callback=callback)
+    batch_pool, other_pool = pools[0]
+    assert batch_pool is not ale.base.data_naif.kernel_pool
+    assert batch_pool.warm
+    assert other_pool is ale.base.data_naif.kernel_pool
+    assert not ale.base.data_naif.kernel_pool.warm
+    assert ale.base.data_naif.active_kernel_pool() is ale.base.data_naif.kernel_pool
+
 def test_load_invalid_spice_root(monkeypatch):
     monkeypatch.delenv('ALESPICEROOT', raising=False)
     reload(ale)
@@ -77,6 +125,24 @@ def test_load_mes_from_metakernels(tmpdir, monkeypatch, mess_kernels):
     assert usgscsm_isd_obj['name_sensor'] == 'MERCURY DUAL IMAGING SYSTEM NARROW ANGLE CAMERA'
     assert usgscsm_isd_obj['name_model'] == 'USGS_ASTRO_FRAME_SENSOR_MODEL'
 
+def test_load_records_furnished_kernels(tmpdir, monkeypatch, mess_kernels):
+    monkeypatch.setenv('ALESPICEROOT', str(tmpdir))
+
+    # reload module to repopulate ale.spice_root
+    reload(ale)
+
+    label_file = get_image_label('EN1072174528M')
+    tmpdir.mkdir('mess')
+    metakernel = tmpdir.join('mess', 'mess_2015_v1.tm')
+    with open(metakernel, 'w+') as mk_file:
+        mk_file.write(util.write_metakernel_from_kernel_list(mess_kernels))
+
+    isd = ale.load(label_file, props={'record_kernels': True})
+    assert str(metakernel) in isd['furnished_kernels']
+    assert all(os.path.abspath(kernel) in isd['furnished_kernels'] for kernel in mess_kernels)
+
+    assert 'furnished_kernels' not in ale.load(label_file)
+
 def test_load_mes_with_no_metakernels(tmpdir, monkeypatch, mess_kernels):
     monkeypatch.setenv('ALESPICEROOT', str(tmpdir))
 